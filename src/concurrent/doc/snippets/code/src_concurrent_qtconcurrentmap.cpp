@@ -182,3 +182,15 @@ struct Scaled
 QList<QImage> images = ...;
 QFuture<QImage> thumbnails = QtConcurrent::mapped(images, Scaled(100));
 //! [14]
+
+//! [15]
+QImage scaled(const QString &fileName)
+{
+    return QImage(fileName).scaled(100, 100);
+}
+
+QStringList fileNames = ...;
+QFuture<QImage> thumbnails = QtConcurrent::mappedStreamed(fileNames, scaled, 64);
+while (thumbnails.hasNextResult())
+    save(thumbnails.takeNextResult());
+//! [15]
@@ -159,7 +159,8 @@ public:
 
     IterateKernel(Iterator _begin, Iterator _end)
         : begin(_begin), end(_end), current(_begin), currentIndex(0),
-           forIteration(selectIteration(typename std::iterator_traits<Iterator>::iterator_category())), progressReportingEnabled(true)
+           forIteration(selectIteration(typename std::iterator_traits<Iterator>::iterator_category())), progressReportingEnabled(true),
+           resultBufferLimit(0), maxStreamingBlockSize(0)
     {
         iterationCount =  forIteration ? std::distance(_begin, _end) : 0;
     }
@@ -176,6 +177,25 @@ public:
         progressReportingEnabled = this->isProgressReportingEnabled();
         if (progressReportingEnabled && iterationCount > 0)
             this->setProgressRange(0, iterationCount);
+
+        // When streaming, keep blocks small enough for all threads to work
+        // within the result buffer.
+        resultBufferLimit = this->futureInterface ? this->futureInterface->resultBufferLimit() : 0;
+        if (resultBufferLimit > 0)
+            maxStreamingBlockSize = qMax(1, resultBufferLimit / (2 * qMax(1, this->threadPool->maxThreadCount())));
+    }
+
+    bool shouldThrottleThread()
+    {
+        if (resultBufferLimit > 0
+            && !this->futureInterface->hasResultBufferSpace(currentIndex.load() + 1))
+            return true;
+        return ThreadEngine<T>::shouldThrottleThread();
+    }
+
+    bool waitForResultBufferSpace(int endIndex)
+    {
+        return resultBufferLimit == 0 || this->futureInterface->waitForResultBufferSpace(endIndex);
     }
 
     bool shouldStartThread()
@@ -203,7 +223,9 @@ public:
             if (this->isCanceled())
                 break;
 
-            const int currentBlockSize = blockSizeManager.blockSize();
+            int currentBlockSize = blockSizeManager.blockSize();
+            if (resultBufferLimit > 0)
+                currentBlockSize = qMin(currentBlockSize, maxStreamingBlockSize);
 
             if (currentIndex.load() >= iterationCount)
                 break;
@@ -217,6 +239,10 @@ public:
                 break;
             }
 
+            // (only waits if the results are streamed and the consumer is behind.)
+            if (!waitForResultBufferSpace(endIndex))
+                break;
+
             this->waitForResume(); // (only waits if the qfuture is paused.)
 
             if (shouldStartThread())
@@ -262,6 +288,9 @@ public:
             int index = currentIndex.fetchAndAddRelaxed(1);
             iteratorThreads.testAndSetRelease(1, 0);
 
+            if (!waitForResultBufferSpace(index + 1))
+                return ThreadFinished;
+
             this->waitForResume(); // (only waits if the qfuture is paused.)
 
             if (shouldStartThread())
@@ -293,6 +322,9 @@ public:
 
     bool progressReportingEnabled;
     QAtomicInt completed;
+
+    int resultBufferLimit;
+    int maxStreamingBlockSize;
 };
 
 } // namespace QtConcurrent
@@ -157,6 +157,21 @@
     undefined, while QtConcurrent::OrderedReduce ensures that the reduction
     is done in the order of the original sequence.
 
+    \section1 Concurrent Map with Streamed Results
+
+    QtConcurrent::mapped() keeps every result in the QFuture until the future
+    is destroyed, so mapping a very large sequence needs memory for all of the
+    results at once. QtConcurrent::mappedStreamed() instead delivers the
+    results in the order of the original sequence and only lets the map
+    function run ahead of the consumer by a bounded number of items. Once that
+    many results are waiting, the worker threads stop until the consumer has
+    taken some of them with QFuture::takeNextResult():
+
+    \snippet code/src_concurrent_qtconcurrentmap.cpp 15
+
+    Results that have been taken are removed from the future, so the memory
+    used stays constant regardless of the length of the sequence.
+
     \section1 Additional API Features
 
     \section2 Using Iterators instead of Sequence
@@ -263,6 +278,30 @@
     QFuture::const_iterator or QFutureIterator to iterate through the results.
 */
 
+/*!
+    \fn QFuture<T> QtConcurrent::mappedStreamed(const Sequence &sequence, MapFunction function, int bufferSize)
+    \since 5.3
+
+    Calls \a function once for each item in \a sequence and returns a future
+    from which the mapped items are taken in order with
+    QFuture::hasNextResult() and QFuture::takeNextResult(). At most
+    \a bufferSize results are computed ahead of the consumer.
+
+    Keep taking results until hasNextResult() returns \c false, or cancel the
+    future; destroying every QFuture referring to the computation cancels
+    it as well.
+*/
+
+/*!
+    \fn QFuture<T> QtConcurrent::mappedStreamed(ConstIterator begin, ConstIterator end, MapFunction function, int bufferSize)
+    \since 5.3
+
+    Calls \a function once for each item from \a begin to \a end and
+    returns a future from which the mapped items are taken in order with
+    QFuture::hasNextResult() and QFuture::takeNextResult(). At most
+    \a bufferSize results are computed ahead of the consumer.
+*/
+
 /*!
     \fn QFuture<T> QtConcurrent::mappedReduced(const Sequence &sequence,
     MapFunction mapFunction, ReduceFunction reduceFunction,
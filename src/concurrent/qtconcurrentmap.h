@@ -66,6 +66,11 @@ namespace QtConcurrent {
     template <typename T>
     QFuture<T> mapped(ConstIterator begin, ConstIterator end, MapFunction function);
 
+    template <typename T>
+    QFuture<T> mappedStreamed(const Sequence &sequence, MapFunction function, int bufferSize = 1024);
+    template <typename T>
+    QFuture<T> mappedStreamed(ConstIterator begin, ConstIterator end, MapFunction function, int bufferSize = 1024);
+
     template <typename T>
     QFuture<T> mappedReduced(const Sequence &sequence,
                              MapFunction function,
@@ -188,6 +193,22 @@ QFuture<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType> mapped(
     return startMapped<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType>(begin, end, QtPrivate::createFunctionWrapper(map));
 }
 
+// mappedStreamed() for sequences
+template <typename Sequence, typename MapFunctor>
+QFuture<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType> mappedStreamed(const Sequence &sequence, MapFunctor map, int bufferSize = 1024)
+{
+    return startMapped<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType>(sequence, QtPrivate::createFunctionWrapper(map))
+        .startAsynchronously(qMax(1, bufferSize));
+}
+
+// mappedStreamed() for iterator ranges.
+template <typename Iterator, typename MapFunctor>
+QFuture<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType> mappedStreamed(Iterator begin, Iterator end, MapFunctor map, int bufferSize = 1024)
+{
+    return startMapped<typename QtPrivate::MapResultType<void, MapFunctor>::ResultType>(begin, end, QtPrivate::createFunctionWrapper(map))
+        .startAsynchronously(qMax(1, bufferSize));
+}
+
 // blockingMap() for sequences
 template <typename Sequence, typename MapFunctor>
 void blockingMap(Sequence &sequence, MapFunctor map)
@@ -158,10 +158,13 @@ public:
     }
 
     // Runs the user algorithm using multiple threads.
-    // Does not block, returns a future.
-    QFuture<T> startAsynchronously()
+    // Does not block, returns a future. A non-zero resultBufferLimit
+    // streams the results: at most that many results are held until
+    // they are taken from the future.
+    QFuture<T> startAsynchronously(int resultBufferLimit = 0)
     {
         futureInterface = new QFutureInterface<T>();
+        futureInterface->setResultBufferLimit(resultBufferLimit);
 
         // reportStart() must be called before starting threads, otherwise the
         // user algorithm might finish while reportStart() is running, which
@@ -211,9 +214,9 @@ public:
     inline ThreadEngineStarterBase(const ThreadEngineStarterBase &other)
     : threadEngine(other.threadEngine) { }
 
-    QFuture<T> startAsynchronously()
+    QFuture<T> startAsynchronously(int resultBufferLimit = 0)
     {
-        return threadEngine->startAsynchronously();
+        return threadEngine->startAsynchronously(resultBufferLimit);
     }
 
     operator QFuture<T>()
@@ -48,6 +48,100 @@ QT_BEGIN_NAMESPACE
 
 enum { Endian = 0, Data = 1 };
 
+// Converts the leading ASCII run of \a src to UTF-16 and returns its length.
+static inline int asciiToUtf16(ushort *dst, const uchar *src, int len)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2) && !defined(QT_BOOTSTRAPPED)
+    if (qCpuHasFeature(AVX2)) {
+        i = qt_utf8_fromAscii_avx2(dst, src, len);
+    } else
+#endif
+    {
+#if defined(__SSE2__)
+        const __m128i zero = _mm_setzero_si128();
+        for ( ; i + 16 <= len; i += 16) {
+            const __m128i chunk = _mm_loadu_si128((const __m128i *)(src + i));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi8(chunk, zero));
+            _mm_storeu_si128((__m128i *)(dst + i + 8), _mm_unpackhi_epi8(chunk, zero));
+
+            const uint nonAscii = _mm_movemask_epi8(chunk);
+            if (nonAscii)
+                return i + qCountTrailingZeroBits(nonAscii);
+        }
+#elif defined(__ARM_NEON__)
+        const uint8x16_t nonAsciiBit = vdupq_n_u8(0x80);
+        for ( ; i + 16 <= len; i += 16) {
+            const uint8x16_t chunk = vld1q_u8(src + i);
+            const uint64x2_t nonAscii = vreinterpretq_u64_u8(vandq_u8(chunk, nonAsciiBit));
+            if (vgetq_lane_u64(nonAscii, 0) | vgetq_lane_u64(nonAscii, 1))
+                break; // let the loop below find the end of the run
+            vst1q_u16(dst + i, vmovl_u8(vget_low_u8(chunk)));
+            vst1q_u16(dst + i + 8, vmovl_u8(vget_high_u8(chunk)));
+        }
+#endif
+    }
+    for ( ; i < len && src[i] < 0x80; ++i)
+        dst[i] = src[i];
+    return i;
+}
+
+// Converts the leading ASCII run of \a src to Latin 1 and returns its length.
+static inline int utf16ToAscii(uchar *dst, const ushort *src, int len)
+{
+    int i = 0;
+#if defined(QT_COMPILER_SUPPORTS_AVX2) && !defined(QT_BOOTSTRAPPED)
+    if (qCpuHasFeature(AVX2)) {
+        i = qt_utf8_toAscii_avx2(dst, src, len);
+    } else
+#endif
+    {
+#if defined(__SSE2__)
+        const __m128i nonAsciiBits = _mm_set1_epi16(short(0xff80));
+        const __m128i zero = _mm_setzero_si128();
+        for ( ; i + 16 <= len; i += 16) {
+            const __m128i chunk1 = _mm_loadu_si128((const __m128i *)(src + i));
+            const __m128i chunk2 = _mm_loadu_si128((const __m128i *)(src + i + 8));
+            _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(chunk1, chunk2));
+
+            // 0xffff for each ASCII character
+            const __m128i ascii1 = _mm_cmpeq_epi16(_mm_and_si128(chunk1, nonAsciiBits), zero);
+            const __m128i ascii2 = _mm_cmpeq_epi16(_mm_and_si128(chunk2, nonAsciiBits), zero);
+            const uint nonAscii = ~uint(_mm_movemask_epi8(_mm_packs_epi16(ascii1, ascii2))) & 0xffff;
+            if (nonAscii)
+                return i + qCountTrailingZeroBits(nonAscii);
+        }
+#elif defined(__ARM_NEON__)
+        const uint16x8_t nonAsciiBits = vdupq_n_u16(0xff80);
+        for ( ; i + 16 <= len; i += 16) {
+            const uint16x8_t chunk1 = vld1q_u16(src + i);
+            const uint16x8_t chunk2 = vld1q_u16(src + i + 8);
+            const uint64x2_t nonAscii = vreinterpretq_u64_u16(vandq_u16(vorrq_u16(chunk1, chunk2), nonAsciiBits));
+            if (vgetq_lane_u64(nonAscii, 0) | vgetq_lane_u64(nonAscii, 1))
+                break; // let the loop below find the end of the run
+            vst1q_u8(dst + i, vcombine_u8(vmovn_u16(chunk1), vmovn_u16(chunk2)));
+        }
+#endif
+    }
+    for ( ; i < len && src[i] < 0x80; ++i)
+        dst[i] = uchar(src[i]);
+    return i;
+}
+
+static inline bool isContinuationByte(uchar ch)
+{
+    return (ch & 0xc0) == 0x80;
+}
+
+// Returns true if \a ch1 .. \a ch3 form a three-byte sequence that is
+// neither overlong nor encodes a UTF-16 surrogate.
+static inline bool isValidThreeByteSequence(uchar ch1, uchar ch2, uchar ch3)
+{
+    return isContinuationByte(ch2) && isContinuationByte(ch3)
+            && (ch1 != 0xe0 || ch2 >= 0xa0)
+            && (ch1 != 0xed || ch2 < 0xa0);
+}
+
 QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len, QTextCodec::ConverterState *state)
 {
     uchar replacement = '?';
@@ -102,6 +196,11 @@ QByteArray QUtf8::convertFromUnicode(const QChar *uc, int len, QTextCodec::Conve
 
         if (u < 0x80) {
             *cursor++ = (uchar)u;
+
+            // convert the rest of the ASCII run in bulk
+            const int n = utf16ToAscii(cursor, reinterpret_cast<const ushort *>(ch + 1), end - ch - 1);
+            cursor += n;
+            ch += n;
         } else {
             if (u < 0x0800) {
                 *cursor++ = 0xc0 | ((uchar) (u >> 6));
@@ -200,6 +299,22 @@ QString QUtf8::convertToUnicode(const char *chars, int len, QTextCodec::Converte
             if (ch < 128) {
                 *qch++ = ushort(ch);
                 headerdone = true;
+
+                // convert the rest of the ASCII run in bulk
+                const int n = asciiToUtf16(qch, reinterpret_cast<const uchar *>(chars) + i + 1, len - i - 1);
+                qch += n;
+                i += n;
+            } else if (ch >= 0xc2 && ch < 0xe0 && i + 1 < len && isContinuationByte(chars[i + 1])) {
+                // complete two-byte sequence
+                *qch++ = ((ch & 0x1f) << 6) | (uchar(chars[i + 1]) & 0x3f);
+                ++i;
+                headerdone = true;
+            } else if ((ch & 0xf0) == 0xe0 && headerdone && i + 2 < len
+                       && isValidThreeByteSequence(ch, chars[i + 1], chars[i + 2])) {
+                // complete three-byte sequence
+                *qch++ = ((ch & 0x0f) << 12) | ((uchar(chars[i + 1]) & 0x3f) << 6)
+                        | (uchar(chars[i + 2]) & 0x3f);
+                i += 2;
             } else if ((ch & 0xe0) == 0xc0) {
                 uc = ch & 0x1f;
                 need = 1;
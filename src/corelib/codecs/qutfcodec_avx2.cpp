@@ -0,0 +1,93 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qutfcodec_p.h"
+
+#ifdef QT_COMPILER_SUPPORTS_AVX2
+
+QT_BEGIN_NAMESPACE
+
+int qt_utf8_fromAscii_avx2(ushort *dst, const uchar *src, int len)
+{
+    int i = 0;
+    for ( ; i + 32 <= len; i += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i *)(src + i));
+
+        // widen both halves to 16 bits and store them, whether or not they are ASCII
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(chunk)));
+        _mm256_storeu_si256((__m256i *)(dst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(chunk, 1)));
+
+        // the most significant bit is set for non-ASCII bytes
+        const uint nonAscii = _mm256_movemask_epi8(chunk);
+        if (nonAscii)
+            return i + qCountTrailingZeroBits(nonAscii);
+    }
+    return i;
+}
+
+int qt_utf8_toAscii_avx2(uchar *dst, const ushort *src, int len)
+{
+    const __m256i nonAsciiBits = _mm256_set1_epi16(short(0xff80));
+    const __m256i zero = _mm256_setzero_si256();
+
+    int i = 0;
+    for ( ; i + 32 <= len; i += 32) {
+        const __m256i chunk1 = _mm256_loadu_si256((const __m256i *)(src + i));
+        const __m256i chunk2 = _mm256_loadu_si256((const __m256i *)(src + i + 16));
+
+        // packing works per 128-bit lane, so restore the order of the quadwords afterwards
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(chunk1, chunk2), 0xd8);
+        _mm256_storeu_si256((__m256i *)(dst + i), packed);
+
+        // 0xffff for each ASCII character
+        const __m256i ascii1 = _mm256_cmpeq_epi16(_mm256_and_si256(chunk1, nonAsciiBits), zero);
+        const __m256i ascii2 = _mm256_cmpeq_epi16(_mm256_and_si256(chunk2, nonAsciiBits), zero);
+        const __m256i ascii = _mm256_permute4x64_epi64(_mm256_packs_epi16(ascii1, ascii2), 0xd8);
+        const uint nonAscii = ~uint(_mm256_movemask_epi8(ascii));
+        if (nonAscii)
+            return i + qCountTrailingZeroBits(nonAscii);
+    }
+    return i;
+}
+
+QT_END_NAMESPACE
+
+#endif // QT_COMPILER_SUPPORTS_AVX2
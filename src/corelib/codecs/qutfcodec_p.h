@@ -53,8 +53,10 @@
 // We mean it.
 //
 
+#include "QtCore/qalgorithms.h"
 #include "QtCore/qtextcodec.h"
 #include "private/qtextcodec_p.h"
+#include "private/qsimd_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -65,6 +67,14 @@ enum DataEndianness
     LittleEndianness
 };
 
+// ASCII conversion kernels used by QUtf8: they convert the leading ASCII run
+// of the \a len units at \a src and return its length. They may write past
+// the returned length, but never past \a len units of \a dst.
+#if defined(QT_COMPILER_SUPPORTS_AVX2) && !defined(QT_BOOTSTRAPPED)
+int qt_utf8_fromAscii_avx2(ushort *dst, const uchar *src, int len);
+int qt_utf8_toAscii_avx2(uchar *dst, const ushort *src, int len);
+#endif
+
 struct QUtf8
 {
     static QString convertToUnicode(const char *, int, QTextCodec::ConverterState *);
@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the documentation of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:BSD$
+** You may use this file under the terms of the BSD license as follows:
+**
+** "Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are
+** met:
+**   * Redistributions of source code must retain the above copyright
+**     notice, this list of conditions and the following disclaimer.
+**   * Redistributions in binary form must reproduce the above copyright
+**     notice, this list of conditions and the following disclaimer in
+**     the documentation and/or other materials provided with the
+**     distribution.
+**   * Neither the name of Digia Plc and its Subsidiary(-ies) nor the names
+**     of its contributors may be used to endorse or promote products derived
+**     from this software without specific prior written permission.
+**
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+** "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+** LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+** A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+** OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+** SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+** LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+** DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+** THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+** (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE."
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+//! [0]
+  QFile file("export.json");
+  file.open(QIODevice::ReadOnly);
+  QJsonStreamReader json(&file);
+  while (!json.atEnd()) {
+        json.readNext();
+        ... // do processing
+  }
+  if (json.hasError()) {
+        ... // do error handling
+  }
+//! [0]
+
+
+//! [1]
+  void Client::readyRead()
+  {
+      reader.addData(socket->readAll());
+      while (!reader.atEnd()) {
+          if (!readingRecord && reader.readNext() != QJsonStreamReader::StartObject)
+              continue;
+          QJsonValue record = reader.readValue();
+          readingRecord = record.isUndefined(); // incomplete, continue later
+          if (!readingRecord)
+              processRecord(record.toObject());
+      }
+      if (reader.hasError())
+          ... // do error handling
+  }
+//! [1]
+
+
+//! [2]
+  QJsonStreamWriter stream(&file);
+  stream.setAutoFormatting(true);
+  stream.writeStartObject();
+  stream.writeValue("name", QStringLiteral("Qt"));
+  stream.writeStartArray("versions");
+  stream.writeValue(5.2);
+  stream.writeValue(5.3);
+  stream.writeEndArray();
+  stream.writeEndObject();
+//! [2]
@@ -201,69 +201,94 @@ inline void QDirPrivate::resolveAbsoluteEntry() const
 }
 
 /* For sorting */
+// The sort keys are worked out once per entry before sorting, instead of
+// in every comparison; std::sort then only moves pointers around.
 struct QDirSortItem
 {
-    mutable QString filename_cache;
-    mutable QString suffix_cache;
+    void init(const QFileInfo &fileInfo, QDir::SortFlags sort);
+
+    QString filename_cache;
+    QString suffix_cache;
     QFileInfo item;
+    qint64 key;     // modification time or size
+    bool keyValid;  // false for an invalid modification time
+    bool isDir;
 };
 
+void QDirSortItem::init(const QFileInfo &fileInfo, QDir::SortFlags sort)
+{
+    item = fileInfo;
+    key = 0;
+    keyValid = true;
+    isDir = (sort & (QDir::DirsFirst | QDir::DirsLast)) && item.isDir();
+
+    const int sortBy = (sort & QDir::SortByMask) | (sort & QDir::Type);
+    const bool ic = sort & QDir::IgnoreCase;
+
+    switch (sortBy) {
+      case QDir::Time: {
+        QDateTime modified = item.lastModified();
+
+        // QDateTime by default will do all sorts of conversions on these to
+        // find timezones, which is incredibly expensive. As we aren't
+        // presenting these to the user, we don't care (at all) about the
+        // local timezone, so force them to UTC to avoid that conversion.
+        modified.setTimeSpec(Qt::UTC);
+        keyValid = modified.isValid();
+        if (keyValid)
+            key = modified.toMSecsSinceEpoch();
+        break;
+      }
+      case QDir::Size:
+        key = item.size();
+        break;
+      case QDir::Type:
+        suffix_cache = ic ? item.suffix().toLower() : item.suffix();
+        break;
+      default:
+        ;
+    }
+
+    if (sortBy != QDir::Unsorted)
+        filename_cache = ic ? item.fileName().toLower() : item.fileName();
+}
 
 class QDirSortItemComparator
 {
     int qt_cmp_si_sort_flags;
 public:
     QDirSortItemComparator(int flags) : qt_cmp_si_sort_flags(flags) {}
-    bool operator()(const QDirSortItem &, const QDirSortItem &) const;
+    bool operator()(const QDirSortItem *, const QDirSortItem *) const;
 };
 
-bool QDirSortItemComparator::operator()(const QDirSortItem &n1, const QDirSortItem &n2) const
+bool QDirSortItemComparator::operator()(const QDirSortItem *f1, const QDirSortItem *f2) const
 {
-    const QDirSortItem* f1 = &n1;
-    const QDirSortItem* f2 = &n2;
-
-    if ((qt_cmp_si_sort_flags & QDir::DirsFirst) && (f1->item.isDir() != f2->item.isDir()))
-        return f1->item.isDir();
-    if ((qt_cmp_si_sort_flags & QDir::DirsLast) && (f1->item.isDir() != f2->item.isDir()))
-        return !f1->item.isDir();
+    if ((qt_cmp_si_sort_flags & QDir::DirsFirst) && (f1->isDir != f2->isDir))
+        return f1->isDir;
+    if ((qt_cmp_si_sort_flags & QDir::DirsLast) && (f1->isDir != f2->isDir))
+        return !f1->isDir;
 
     int r = 0;
     int sortBy = (qt_cmp_si_sort_flags & QDir::SortByMask)
                  | (qt_cmp_si_sort_flags & QDir::Type);
 
     switch (sortBy) {
-      case QDir::Time: {
-        QDateTime firstModified = f1->item.lastModified();
-        QDateTime secondModified = f2->item.lastModified();
-
-        // QDateTime by default will do all sorts of conversions on these to
-        // find timezones, which is incredibly expensive. As we aren't
-        // presenting these to the user, we don't care (at all) about the
-        // local timezone, so force them to UTC to avoid that conversion.
-        firstModified.setTimeSpec(Qt::UTC);
-        secondModified.setTimeSpec(Qt::UTC);
-
-        r = firstModified.secsTo(secondModified);
+      case QDir::Time:
+        // Compare whole seconds, so that entries modified within the same
+        // second are ordered by name. Each side is truncated on its own:
+        // truncating the difference (as secsTo() does) is not transitive,
+        // which std::sort() relies on. An invalid time compares equal to
+        // anything, as secsTo() returns 0 for it.
+        if (f1->keyValid && f2->keyValid)
+            r = int(qBound<qint64>(-1, f2->key / 1000 - f1->key / 1000, 1));
         break;
-      }
       case QDir::Size:
-          r = int(qBound<qint64>(-1, f2->item.size() - f1->item.size(), 1));
+        r = int(qBound<qint64>(-1, f2->key - f1->key, 1));
         break;
       case QDir::Type:
-      {
-        bool ic = qt_cmp_si_sort_flags & QDir::IgnoreCase;
-
-        if (f1->suffix_cache.isNull())
-            f1->suffix_cache = ic ? f1->item.suffix().toLower()
-                               : f1->item.suffix();
-        if (f2->suffix_cache.isNull())
-            f2->suffix_cache = ic ? f2->item.suffix().toLower()
-                               : f2->item.suffix();
-
         r = qt_cmp_si_sort_flags & QDir::LocaleAware
             ? f1->suffix_cache.localeAwareCompare(f2->suffix_cache)
             : f1->suffix_cache.compare(f2->suffix_cache);
-      }
         break;
       default:
         ;
@@ -271,15 +296,6 @@ bool QDirSortItemComparator::operator()(const QDirSortItem &n1, const QDirSortIt
 
     if (r == 0 && sortBy != QDir::Unsorted) {
         // Still not sorted - sort by name
-        bool ic = qt_cmp_si_sort_flags & QDir::IgnoreCase;
-
-        if (f1->filename_cache.isNull())
-            f1->filename_cache = ic ? f1->item.fileName().toLower()
-                                    : f1->item.fileName();
-        if (f2->filename_cache.isNull())
-            f2->filename_cache = ic ? f2->item.fileName().toLower()
-                                    : f2->item.fileName();
-
         r = qt_cmp_si_sort_flags & QDir::LocaleAware
             ? f1->filename_cache.localeAwareCompare(f2->filename_cache)
             : f1->filename_cache.compare(f2->filename_cache);
@@ -304,17 +320,22 @@ inline void QDirPrivate::sortFileList(QDir::SortFlags sort, QFileInfoList &l,
             }
         } else {
             QScopedArrayPointer<QDirSortItem> si(new QDirSortItem[n]);
-            for (int i = 0; i < n; ++i)
-                si[i].item = l.at(i);
-            std::sort(si.data(), si.data() + n, QDirSortItemComparator(sort));
+            QScopedArrayPointer<QDirSortItem *> sorted(new QDirSortItem *[n]);
+            for (int i = 0; i < n; ++i) {
+                si[i].init(l.at(i), sort);
+                sorted[i] = &si[i];
+            }
+            std::sort(sorted.data(), sorted.data() + n, QDirSortItemComparator(sort));
             // put them back in the list(s)
             if (infos) {
+                infos->reserve(n);
                 for (int i = 0; i < n; ++i)
-                    infos->append(si[i].item);
+                    infos->append(sorted[i]->item);
             }
             if (names) {
+                names->reserve(n);
                 for (int i = 0; i < n; ++i)
-                    names->append(si[i].item.fileName());
+                    names->append(sorted[i]->item.fileName());
             }
         }
     }
@@ -85,6 +85,22 @@
     enables iterating through all subdirectories of the assigned path,
     following all symbolic links. Symbolic link loops (e.g., "link" => "." or
     "link" => "..") are automatically detected and ignored.
+
+    \value ParallelSubdirectories When combined with Subdirectories, the
+    subdirectories are listed ahead of the caller by
+    QThreadPool::globalInstance(), several at a time. The entries are still
+    returned in the same order as without this flag; directories are read in
+    chunks, and at most a few chunks per pool thread are kept in memory.
+    Combined with FollowSymlinks, a directory that can be reached through
+    several paths is followed through the one listed first, which may not
+    be the one the sequential walk reaches first, so the entries returned
+    can differ from those of a walk without this flag. This flag was
+    introduced in Qt 5.3.
+
+    \value UnorderedResults When combined with ParallelSubdirectories, the
+    entries of each directory are returned as soon as it has been listed,
+    instead of in the order of a depth-first walk. This flag was introduced
+    in Qt 5.3.
 */
 
 #include "qdiriterator.h"
@@ -94,6 +110,12 @@
 #include <QtCore/qset.h>
 #include <QtCore/qstack.h>
 #include <QtCore/qvariant.h>
+#ifndef QT_NO_THREAD
+#include <QtCore/qmutex.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qwaitcondition.h>
+#endif
 
 #include <QtCore/private/qfilesystemiterator_p.h>
 #include <QtCore/private/qfilesystementry_p.h>
@@ -101,8 +123,16 @@
 #include <QtCore/private/qfilesystemengine_p.h>
 #include <QtCore/private/qfileinfo_p.h>
 
+#if !defined(QT_NO_THREAD) && !defined(QT_NO_FILESYSTEMITERATOR)
+#  define QDIRITERATOR_PARALLEL
+#endif
+
 QT_BEGIN_NAMESPACE
 
+#ifdef QDIRITERATOR_PARALLEL
+class QDirIteratorWalker;
+#endif
+
 template <class Iterator>
 class QDirIteratorPrivateIteratorStack : public QStack<Iterator *>
 {
@@ -118,12 +148,14 @@ class QDirIteratorPrivate
 public:
     QDirIteratorPrivate(const QFileSystemEntry &entry, const QStringList &nameFilters,
                         QDir::Filters filters, QDirIterator::IteratorFlags flags, bool resolveEngine = true);
+    ~QDirIteratorPrivate();
 
     void advance();
 
     bool entryMatches(const QString & fileName, const QFileInfo &fileInfo);
     void pushDirectory(const QFileInfo &fileInfo);
     void checkAndPushDirectory(const QFileInfo &);
+    bool isDirectoryToFollow(const QFileInfo &fileInfo) const;
     bool matchesFilters(const QString &fileName, const QFileInfo &fi) const;
 
     QScopedPointer<QAbstractFileEngine> engine;
@@ -141,6 +173,9 @@ public:
 #ifndef QT_NO_FILESYSTEMITERATOR
     QDirIteratorPrivateIteratorStack<QFileSystemIterator> nativeIterators;
 #endif
+#ifdef QDIRITERATOR_PARALLEL
+    QDirIteratorWalker *walker;
+#endif
 
     QFileInfo currentFileInfo;
     QFileInfo nextFileInfo;
@@ -149,6 +184,402 @@ public:
     QSet<QString> visitedLinks;
 };
 
+#ifdef QDIRITERATOR_PARALLEL
+/*!
+    \internal
+
+    Lists the directories of a recursive QDirIterator on a thread pool, ahead
+    of the thread that owns the iterator.
+
+    Each directory is a Node, listed in chunks of at most ChunkSize entries by
+    whoever takes it first: a pool thread, or the owning thread when it needs
+    entries nobody is listing yet. A node whose listing is not finished goes
+    back to the queue after each chunk, behind the subdirectories found in
+    that chunk, so the pool follows the depth-first order in which the entries
+    are handed out. To bound memory, the pool threads stop taking chunks while
+    too many entries have not been consumed yet; a huge directory is then
+    listed no further ahead of the iterator than a small one.
+
+    In ordered mode every subdirectory hangs off the entry that leads to it,
+    and next() walks that tree depth-first, as the sequential iterator does.
+    With QDirIterator::UnorderedResults the chunks are handed out in the
+    order they complete.
+
+    The walker is reference counted: the iterator holds one reference and
+    every runnable given to the pool another, so runnables that only start
+    after the iterator is gone find it cancelled and quit.
+*/
+class QDirIteratorWalker
+{
+public:
+    QDirIteratorWalker(const QDirIteratorPrivate *iterator, const QFileInfo &root);
+
+    bool next(QFileInfo *fileInfo);
+    void release();
+
+    void work();
+    void deref()
+    {
+        if (!ref.deref())
+            delete this;
+    }
+
+    enum { ChunkSize = 256 };
+
+    struct Node;
+    struct Entry
+    {
+        Entry() : subdirectory(0), matches(false) {}
+
+        QFileInfo fileInfo;
+        Node *subdirectory;
+        bool matches;
+    };
+
+    static void deleteSubdirectories(const QVector<Entry> &entries)
+    {
+        for (int i = 0; i < entries.size(); ++i)
+            delete entries.at(i).subdirectory;
+    }
+
+    struct Node
+    {
+        enum State { Pending, Listing, Listed };
+
+        explicit Node(const QFileSystemEntry &entry) : directory(entry), iterator(0), state(Pending) {}
+        ~Node()
+        {
+            delete iterator;
+            for (int i = 0; i < chunks.size(); ++i)
+                deleteSubdirectories(chunks.at(i));
+        }
+
+        QFileSystemEntry directory;
+        QFileSystemIterator *iterator;  // between chunks
+        QList<QVector<Entry> > chunks;  // ordered mode only
+        State state;
+    };
+
+private:
+    struct Frame
+    {
+        Frame() : node(0), index(0) {}
+        explicit Frame(Node *n) : node(n), index(0) {}
+
+        Node *node;                     // 0 in unordered mode
+        QVector<Entry> entries;         // the chunk being consumed
+        int index;
+    };
+
+    ~QDirIteratorWalker() {}
+
+    Node *takePending(bool force);
+    void runListing(Node *node);
+    void startWorkers();
+
+    const QDirIteratorPrivate * const d;
+    const bool ordered;
+    QThreadPool * const pool;
+    const int maxBuffered;
+
+    QAtomicInt ref;
+    QMutex mutex;
+    QWaitCondition changed;
+    // all below are protected by mutex
+    QList<Node *> pending;
+    QList<QVector<Entry> > listed;  // unordered mode only
+    QSet<QString> visitedLinks;
+    int buffered;               // entries listed and not consumed
+    int listing;                // chunks being listed
+    int workers;                // runnables given to the pool
+    bool cancelled;
+
+    // only used by the thread owning the iterator
+    QStack<Frame> frames;
+};
+
+Q_DECLARE_TYPEINFO(QDirIteratorWalker::Entry, Q_MOVABLE_TYPE);
+
+class QDirIteratorWalkerRunnable : public QRunnable
+{
+public:
+    explicit QDirIteratorWalkerRunnable(QDirIteratorWalker *w) : walker(w) {}
+
+    void run()
+    {
+        walker->work();
+        walker->deref();
+    }
+
+private:
+    QDirIteratorWalker *walker;
+};
+
+QDirIteratorWalker::QDirIteratorWalker(const QDirIteratorPrivate *iterator, const QFileInfo &root)
+    : d(iterator),
+      ordered(!(iterator->iteratorFlags & QDirIterator::UnorderedResults)),
+      pool(QThreadPool::globalInstance()),
+      maxBuffered(qMax(4 * pool->maxThreadCount(), 8) * ChunkSize),
+      ref(1),
+      buffered(0),
+      listing(0),
+      workers(0),
+      cancelled(false)
+{
+    if (d->iteratorFlags & QDirIterator::FollowSymlinks)
+        visitedLinks << root.canonicalFilePath();
+
+    Node *node = new Node(d->dirEntry);
+    if (ordered)
+        frames.push(Frame(node));
+    pending << node;
+
+    QMutexLocker locker(&mutex);
+    startWorkers();
+}
+
+/*!
+    \internal
+
+    Stops the pool threads and drops the iterator's reference.
+*/
+void QDirIteratorWalker::release()
+{
+    {
+        QMutexLocker locker(&mutex);
+        cancelled = true;
+        while (listing)
+            changed.wait(&mutex);
+    }
+
+    // Nothing touches the nodes anymore. In ordered mode all of them are
+    // owned by the frames, directly or through their entries; in unordered
+    // mode the ones not fully listed are all pending.
+    if (!ordered)
+        qDeleteAll(pending);
+    pending.clear();
+    listed.clear();
+    while (!frames.isEmpty()) {
+        const Frame frame = frames.pop();
+        deleteSubdirectories(frame.entries);
+        delete frame.node;
+    }
+
+    deref();
+}
+
+/*!
+    \internal
+
+    Takes the next directory to list a chunk of, or returns 0 if there is none
+    or, unless \a force is true, enough entries are waiting to be consumed.
+    Called with the mutex locked.
+*/
+QDirIteratorWalker::Node *QDirIteratorWalker::takePending(bool force)
+{
+    if (cancelled || (!force && buffered >= maxBuffered))
+        return 0;
+
+    while (!pending.isEmpty()) {
+        Node *node = pending.takeFirst();
+        if (node->state == Node::Pending) {
+            node->state = Node::Listing;
+            return node;
+        }
+    }
+    return 0;
+}
+
+/*!
+    \internal
+
+    Lists the next chunk of \a node with the mutex unlocked and queues the
+    subdirectories found in it. Called with the mutex locked.
+*/
+void QDirIteratorWalker::runListing(Node *node)
+{
+    ++listing;
+    mutex.unlock();
+
+    const bool followSymlinks = d->iteratorFlags & QDirIterator::FollowSymlinks;
+    QVector<Entry> chunk;
+    QVector<Node *> subdirectories;
+
+    if (!node->iterator)
+        node->iterator = new QFileSystemIterator(node->directory, d->filters, d->nameFilters,
+                                                 d->iteratorFlags);
+    QFileSystemEntry entry;
+    QFileSystemMetaData metaData;
+    bool done = false;
+    while (chunk.size() < ChunkSize) {
+        if (!node->iterator->advance(entry, metaData)) {
+            done = true;
+            break;
+        }
+
+        Entry result;
+        result.fileInfo = QFileInfo(new QFileInfoPrivate(entry, metaData));
+
+        if (d->isDirectoryToFollow(result.fileInfo)) {
+            bool follow = true;
+            if (followSymlinks) {
+                const QString canonicalPath = result.fileInfo.canonicalFilePath();
+                QMutexLocker locker(&mutex);
+                if (visitedLinks.contains(canonicalPath))
+                    follow = false;
+                else
+                    visitedLinks << canonicalPath;
+            }
+            if (follow) {
+                Node *subdirectory = new Node(entry);
+                subdirectories << subdirectory;
+                if (ordered)
+                    result.subdirectory = subdirectory;
+            }
+        }
+
+        result.matches = d->matchesFilters(entry.fileName(), result.fileInfo);
+        if (result.matches || result.subdirectory)
+            chunk << result;
+    }
+    if (done) {
+        delete node->iterator;
+        node->iterator = 0;
+    }
+
+    mutex.lock();
+    --listing;
+
+    for (int i = 0; i < subdirectories.size(); ++i)
+        pending.insert(i, subdirectories.at(i));
+    if (done) {
+        node->state = Node::Listed;
+    } else {
+        node->state = Node::Pending;
+        pending.insert(subdirectories.size(), node);
+    }
+
+    buffered += chunk.size();
+    if (ordered) {
+        if (!chunk.isEmpty())
+            node->chunks << chunk;
+    } else {
+        if (!chunk.isEmpty())
+            listed << chunk;
+        if (done)
+            delete node;
+    }
+
+    startWorkers();
+    changed.wakeAll();
+}
+
+/*!
+    \internal
+
+    Hands more runnables to the pool if there is work for them. Called with
+    the mutex locked.
+*/
+void QDirIteratorWalker::startWorkers()
+{
+    const int maxWorkers = qMin(pool->maxThreadCount(), pending.size());
+    while (!cancelled && workers < maxWorkers && buffered + workers * ChunkSize < maxBuffered) {
+        ++workers;
+        ref.ref();
+        pool->start(new QDirIteratorWalkerRunnable(this));
+    }
+}
+
+/*!
+    \internal
+
+    Lists chunks on a pool thread until there is nothing left to do.
+*/
+void QDirIteratorWalker::work()
+{
+    QMutexLocker locker(&mutex);
+    while (Node *node = takePending(false))
+        runListing(node);
+    --workers;
+}
+
+/*!
+    \internal
+
+    Stores the next matching entry in \a fileInfo and returns \c true, or
+    returns \c false at the end of the walk.
+*/
+bool QDirIteratorWalker::next(QFileInfo *fileInfo)
+{
+    forever {
+        if (frames.isEmpty()) {
+            if (ordered)
+                return false;
+
+            QMutexLocker locker(&mutex);
+            while (listed.isEmpty()) {
+                if (Node *node = takePending(true))
+                    runListing(node);
+                else if (listing)
+                    changed.wait(&mutex);
+                else
+                    return false;
+            }
+            Frame frame;
+            frame.entries = listed.takeFirst();
+            buffered -= frame.entries.size();
+            startWorkers();
+            frames.push(frame);
+        }
+
+        Frame &frame = frames.top();
+        if (frame.index == frame.entries.size()) {
+            Node *node = frame.node;
+            if (!node) {
+                frames.pop();
+                continue;
+            }
+
+            QMutexLocker locker(&mutex);
+            while (node->chunks.isEmpty() && node->state != Node::Listed) {
+                if (node->state == Node::Pending) {
+                    // Nobody is listing it right now; list a chunk on this thread.
+                    pending.removeOne(node);
+                    node->state = Node::Listing;
+                    runListing(node);
+                } else {
+                    changed.wait(&mutex);
+                }
+            }
+
+            if (node->chunks.isEmpty()) {
+                locker.unlock();
+                frames.pop();
+                delete node;
+                continue;
+            }
+
+            frame.entries = node->chunks.takeFirst();
+            frame.index = 0;
+            buffered -= frame.entries.size();
+            startWorkers();
+        }
+
+        Entry &entry = frame.entries[frame.index++];
+        Node *subdirectory = entry.subdirectory;
+        const bool matches = entry.matches;
+        if (matches)
+            *fileInfo = entry.fileInfo;
+        entry = Entry();
+
+        if (subdirectory)
+            frames.push(Frame(subdirectory));
+        if (matches)
+            return true;
+    }
+}
+#endif // QDIRITERATOR_PARALLEL
+
 /*!
     \internal
 */
@@ -158,6 +589,9 @@ QDirIteratorPrivate::QDirIteratorPrivate(const QFileSystemEntry &entry, const QS
       , nameFilters(nameFilters.contains(QLatin1String("*")) ? QStringList() : nameFilters)
       , filters(QDir::NoFilter == filters ? QDir::AllEntries : filters)
       , iteratorFlags(flags)
+#ifdef QDIRITERATOR_PARALLEL
+      , walker(0)
+#endif
 {
 #ifndef QT_NO_REGEXP
     nameRegExps.reserve(nameFilters.size());
@@ -173,10 +607,36 @@ QDirIteratorPrivate::QDirIteratorPrivate(const QFileSystemEntry &entry, const QS
     QFileInfo fileInfo(new QFileInfoPrivate(dirEntry, metaData));
 
     // Populate fields for hasNext() and next()
+#ifdef QDIRITERATOR_PARALLEL
+    if (!engine && (iteratorFlags & QDirIterator::Subdirectories)
+            && (iteratorFlags & QDirIterator::ParallelSubdirectories)) {
+#ifndef QT_NO_REGEXP
+        // matchesFilters() matches on copies of the name filters, and copying
+        // a QRegExp prepares the engine of the original if it has none yet.
+        // Do that here, so the pool threads only ever read the originals.
+        for (int i = 0; i < nameRegExps.size(); ++i) {
+            const QRegExp prepared = nameRegExps.at(i);
+            Q_UNUSED(prepared);
+        }
+#endif
+        walker = new QDirIteratorWalker(this, fileInfo);
+    } else
+#endif
     pushDirectory(fileInfo);
     advance();
 }
 
+/*!
+    \internal
+*/
+QDirIteratorPrivate::~QDirIteratorPrivate()
+{
+#ifdef QDIRITERATOR_PARALLEL
+    if (walker)
+        walker->release();
+#endif
+}
+
 /*!
     \internal
 */
@@ -230,6 +690,19 @@ inline bool QDirIteratorPrivate::entryMatches(const QString & fileName, const QF
 */
 void QDirIteratorPrivate::advance()
 {
+#ifdef QDIRITERATOR_PARALLEL
+    if (walker) {
+        QFileInfo info;
+        if (walker->next(&info)) {
+            currentFileInfo = nextFileInfo;
+            nextFileInfo = info;
+            return;
+        }
+
+        walker->release();
+        walker = 0;
+    } else
+#endif
     if (engine) {
         while (!fileEngineIterators.isEmpty()) {
             // Find the next valid iterator that matches the filters.
@@ -272,34 +745,48 @@ void QDirIteratorPrivate::advance()
     \internal
  */
 void QDirIteratorPrivate::checkAndPushDirectory(const QFileInfo &fileInfo)
+{
+    if (!isDirectoryToFollow(fileInfo))
+        return;
+
+    // Stop link loops
+    if (!visitedLinks.isEmpty() &&
+        visitedLinks.contains(fileInfo.canonicalFilePath()))
+        return;
+
+    pushDirectory(fileInfo);
+}
+
+/*!
+    \internal
+
+    Returns \c true if the iteration should descend into \a fileInfo, not
+    taking symbolic link loops into account.
+ */
+bool QDirIteratorPrivate::isDirectoryToFollow(const QFileInfo &fileInfo) const
 {
     // If we're doing flat iteration, we're done.
     if (!(iteratorFlags & QDirIterator::Subdirectories))
-        return;
+        return false;
 
     // Never follow non-directory entries
     if (!fileInfo.isDir())
-        return;
+        return false;
 
     // Follow symlinks only when asked
     if (!(iteratorFlags & QDirIterator::FollowSymlinks) && fileInfo.isSymLink())
-        return;
+        return false;
 
     // Never follow . and ..
     QString fileName = fileInfo.fileName();
     if (QLatin1String(".") == fileName || QLatin1String("..") == fileName)
-        return;
+        return false;
 
     // No hidden directories unless requested
     if (!(filters & QDir::AllDirs) && !(filters & QDir::Hidden) && fileInfo.isHidden())
-        return;
-
-    // Stop link loops
-    if (!visitedLinks.isEmpty() &&
-        visitedLinks.contains(fileInfo.canonicalFilePath()))
-        return;
+        return false;
 
-    pushDirectory(fileInfo);
+    return true;
 }
 
 /*!
@@ -498,6 +985,10 @@ QString QDirIterator::next()
 */
 bool QDirIterator::hasNext() const
 {
+#ifdef QDIRITERATOR_PARALLEL
+    if (d->walker)
+        return true;
+#endif
     if (d->engine)
         return !d->fileEngineIterators.isEmpty();
     else
@@ -332,9 +332,17 @@ void QFileSystemMetaData::fillFromDirEnt(const QT_DIRENT &entry)
     }
 #elif defined(_DIRENT_HAVE_D_TYPE) || defined(Q_OS_BSD4)
     // BSD4 includes Mac OS X
+    fillFromDirEntType(entry.d_type);
+#else
+    Q_UNUSED(entry)
+#endif
+}
 
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(Q_OS_BSD4)
+void QFileSystemMetaData::fillFromDirEntType(unsigned char type)
+{
     // ### This will clear all entry flags and knownFlagsMask
-    switch (entry.d_type)
+    switch (type)
     {
     case DT_DIR:
         knownFlagsMask = QFileSystemMetaData::LinkType
@@ -388,10 +396,8 @@ void QFileSystemMetaData::fillFromDirEnt(const QT_DIRENT &entry)
     default:
         clear();
     }
-#else
-    Q_UNUSED(entry)
-#endif
 }
+#endif
 
 #endif
 
@@ -60,7 +60,7 @@
 
 QT_BEGIN_NAMESPACE
 
-class QFileSystemEngine
+class Q_AUTOTEST_EXPORT QFileSystemEngine
 {
 public:
     static bool isCaseSensitive()
@@ -95,6 +95,10 @@ public:
 #if defined(Q_OS_UNIX)
     static bool fillMetaData(int fd, QFileSystemMetaData &data); // what = PosixStatFlags
 #endif
+#if defined(Q_OS_LINUX)
+    static bool fillMetaData(int dirFd, const char *fileName, QFileSystemMetaData &data,
+                             QFileSystemMetaData::MetaDataFlags what);
+#endif
 #if defined(Q_OS_WIN)
 
     static bool uncListSharesOnServer(const QString &server, QStringList *list); //Used also by QFSFileEngineIterator::hasNext()
@@ -131,6 +135,11 @@ public:
                                                                   QFileSystemMetaData &data);
 private:
     static QString slowCanonicalized(const QString &path);
+#if defined(Q_OS_UNIX)
+    template <typename Lookup>
+    static bool fillStatMetaData(const Lookup &lookup, QFileSystemMetaData &data,
+                                 QFileSystemMetaData::MetaDataFlags what);
+#endif
 #if defined(Q_OS_WIN)
     static void clearWinStatData(QFileSystemMetaData &data);
 #endif
@@ -52,6 +52,9 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <errno.h>
+#if defined(Q_OS_LINUX)
+# include <fcntl.h>
+#endif
 
 
 #if defined(Q_OS_MAC)
@@ -61,6 +64,14 @@
 
 QT_BEGIN_NAMESPACE
 
+#if defined(Q_OS_LINUX)
+# if defined(QT_USE_XOPEN_LFS_EXTENSIONS) && defined(QT_LARGEFILE_SUPPORT)
+#  define QT_FSTATAT ::fstatat64
+# else
+#  define QT_FSTATAT ::fstatat
+# endif
+#endif
+
 #if defined(Q_OS_MACX)
 static inline bool _q_isMacHidden(const char *nativePath)
 {
@@ -421,46 +432,55 @@ QString QFileSystemEngine::bundleName(const QFileSystemEntry &entry)
 }
 #endif
 
-//static
-bool QFileSystemEngine::fillMetaData(const QFileSystemEntry &entry, QFileSystemMetaData &data,
-        QFileSystemMetaData::MetaDataFlags what)
+namespace {
+// Looks an entry up by its full path
+struct PathLookup
 {
-#if defined(Q_OS_MACX)
-    if (what & QFileSystemMetaData::BundleType) {
-        if (!data.hasFlags(QFileSystemMetaData::DirectoryType))
-            what |= QFileSystemMetaData::DirectoryType;
-    }
-    if (what & QFileSystemMetaData::HiddenAttribute) {
-        // Mac OS >= 10.5: st_flags & UF_HIDDEN
-        what |= QFileSystemMetaData::PosixStatFlags;
-    }
-#endif // defined(Q_OS_MACX)
+    explicit PathLookup(const char *nativePath) : path(nativePath) { }
 
-    if (what & QFileSystemMetaData::PosixStatFlags)
-        what |= QFileSystemMetaData::PosixStatFlags;
+    bool lstat(QT_STATBUF *statBuffer) const { return QT_LSTAT(path, statBuffer) == 0; }
+    bool stat(QT_STATBUF *statBuffer) const { return QT_STAT(path, statBuffer) == 0; }
+    bool access(int mode) const { return QT_ACCESS(path, mode) == 0; }
 
-    if (what & QFileSystemMetaData::ExistsAttribute) {
-        //  FIXME:  Would other queries being performed provide this bit?
-        what |= QFileSystemMetaData::PosixStatFlags;
-    }
+    const char *path;
+};
 
-    data.entryFlags &= ~what;
+#if defined(Q_OS_LINUX)
+// Looks an entry up by its name inside an open directory
+struct DirFdLookup
+{
+    DirFdLookup(int fd, const char *name) : dirFd(fd), fileName(name) { }
 
-    const char * nativeFilePath;
-    int nativeFilePathLength;
-    {
-        const QByteArray &path = entry.nativeFilePath();
-        nativeFilePath = path.constData();
-        nativeFilePathLength = path.size();
-        Q_UNUSED(nativeFilePathLength);
-    }
+    bool lstat(QT_STATBUF *statBuffer) const
+    { return QT_FSTATAT(dirFd, fileName, statBuffer, AT_SYMLINK_NOFOLLOW) == 0; }
+    bool stat(QT_STATBUF *statBuffer) const
+    { return QT_FSTATAT(dirFd, fileName, statBuffer, 0) == 0; }
+    bool access(int mode) const { return ::faccessat(dirFd, fileName, mode, 0) == 0; }
+
+    int dirFd;
+    const char *fileName;
+};
+#endif
+}
+
+/*!
+    \internal
 
+    Fills in the link type, the stat flags and the user permissions requested
+    in \a what, looking the entry up through \a lookup. Returns false if the
+    entry does not exist.
+*/
+//static
+template <typename Lookup>
+bool QFileSystemEngine::fillStatMetaData(const Lookup &lookup, QFileSystemMetaData &data,
+                                         QFileSystemMetaData::MetaDataFlags what)
+{
     bool entryExists = true; // innocent until proven otherwise
 
     QT_STATBUF statBuffer;
     bool statBufferValid = false;
     if (what & QFileSystemMetaData::LinkType) {
-        if (QT_LSTAT(nativeFilePath, &statBuffer) == 0) {
+        if (lookup.lstat(&statBuffer)) {
             if (S_ISLNK(statBuffer.st_mode)) {
                 data.entryFlags |= QFileSystemMetaData::LinkType;
             } else {
@@ -476,7 +496,7 @@ bool QFileSystemEngine::fillMetaData(const QFileSystemEntry &entry, QFileSystemM
 
     if (statBufferValid || (what & QFileSystemMetaData::PosixStatFlags)) {
         if (entryExists && !statBufferValid)
-            statBufferValid = (QT_STAT(nativeFilePath, &statBuffer) == 0);
+            statBufferValid = lookup.stat(&statBuffer);
 
         if (statBufferValid)
             data.fillFromStatBuf(statBuffer);
@@ -495,43 +515,82 @@ bool QFileSystemEngine::fillMetaData(const QFileSystemEntry &entry, QFileSystemM
             | QFileSystemMetaData::ExistsAttribute;
     }
 
-#if defined(Q_OS_MACX)
-    if (what & QFileSystemMetaData::AliasType)
-    {
-        if (entryExists) {
-            FSRef fref;
-            if (FSPathMakeRef((const UInt8 *)nativeFilePath, &fref, NULL) == noErr) {
-                Boolean isAlias, isFolder;
-                if (FSIsAliasFile(&fref, &isAlias, &isFolder) == noErr) {
-                    if (isAlias)
-                        data.entryFlags |= QFileSystemMetaData::AliasType;
-                }
-            }
-        }
-        data.knownFlagsMask |= QFileSystemMetaData::AliasType;
-    }
-#endif
-
     if (what & QFileSystemMetaData::UserPermissions) {
         // calculate user permissions
 
         if (entryExists) {
             if (what & QFileSystemMetaData::UserReadPermission) {
-                if (QT_ACCESS(nativeFilePath, R_OK) == 0)
+                if (lookup.access(R_OK))
                     data.entryFlags |= QFileSystemMetaData::UserReadPermission;
             }
             if (what & QFileSystemMetaData::UserWritePermission) {
-                if (QT_ACCESS(nativeFilePath, W_OK) == 0)
+                if (lookup.access(W_OK))
                     data.entryFlags |= QFileSystemMetaData::UserWritePermission;
             }
             if (what & QFileSystemMetaData::UserExecutePermission) {
-                if (QT_ACCESS(nativeFilePath, X_OK) == 0)
+                if (lookup.access(X_OK))
                     data.entryFlags |= QFileSystemMetaData::UserExecutePermission;
             }
         }
         data.knownFlagsMask |= (what & QFileSystemMetaData::UserPermissions);
     }
 
+    return entryExists;
+}
+
+//static
+bool QFileSystemEngine::fillMetaData(const QFileSystemEntry &entry, QFileSystemMetaData &data,
+        QFileSystemMetaData::MetaDataFlags what)
+{
+#if defined(Q_OS_MACX)
+    if (what & QFileSystemMetaData::BundleType) {
+        if (!data.hasFlags(QFileSystemMetaData::DirectoryType))
+            what |= QFileSystemMetaData::DirectoryType;
+    }
+    if (what & QFileSystemMetaData::HiddenAttribute) {
+        // Mac OS >= 10.5: st_flags & UF_HIDDEN
+        what |= QFileSystemMetaData::PosixStatFlags;
+    }
+#endif // defined(Q_OS_MACX)
+
+    if (what & QFileSystemMetaData::PosixStatFlags)
+        what |= QFileSystemMetaData::PosixStatFlags;
+
+    if (what & QFileSystemMetaData::ExistsAttribute) {
+        //  FIXME:  Would other queries being performed provide this bit?
+        what |= QFileSystemMetaData::PosixStatFlags;
+    }
+
+    data.entryFlags &= ~what;
+
+    const char * nativeFilePath;
+    int nativeFilePathLength;
+    {
+        const QByteArray &path = entry.nativeFilePath();
+        nativeFilePath = path.constData();
+        nativeFilePathLength = path.size();
+        Q_UNUSED(nativeFilePathLength);
+    }
+
+    const bool entryExists = fillStatMetaData(PathLookup(nativeFilePath), data, what);
+
+#if defined(Q_OS_MACX)
+    if (what & QFileSystemMetaData::AliasType)
+    {
+        if (entryExists) {
+            FSRef fref;
+            if (FSPathMakeRef((const UInt8 *)nativeFilePath, &fref, NULL) == noErr) {
+                Boolean isAlias, isFolder;
+                if (FSIsAliasFile(&fref, &isAlias, &isFolder) == noErr) {
+                    if (isAlias)
+                        data.entryFlags |= QFileSystemMetaData::AliasType;
+                }
+            }
+        }
+        data.knownFlagsMask |= QFileSystemMetaData::AliasType;
+    }
+#endif
+
     if (what & QFileSystemMetaData::HiddenAttribute
             && !data.isHidden()) {
         QString fileName = entry.fileName();
@@ -556,6 +615,41 @@ bool QFileSystemEngine::fillMetaData(const QFileSystemEntry &entry, QFileSystemM
     return data.hasFlags(what);
 }
 
+#if defined(Q_OS_LINUX)
+/*!
+    \internal
+
+    Same as fillMetaData() above, but for the entry \a fileName inside the
+    open directory \a dirFd. Used by QFileSystemIterator to resolve the
+    entries of a directory without walking their full paths again.
+*/
+//static
+bool QFileSystemEngine::fillMetaData(int dirFd, const char *fileName, QFileSystemMetaData &data,
+        QFileSystemMetaData::MetaDataFlags what)
+{
+    // the entry may not have been typed from its directory entry at all, so
+    // make sure a failed stat never leaves a stale ExistsAttribute behind
+    if (what & (QFileSystemMetaData::PosixStatFlags | QFileSystemMetaData::ExistsAttribute))
+        what |= QFileSystemMetaData::PosixStatFlags | QFileSystemMetaData::ExistsAttribute;
+
+    data.entryFlags &= ~what;
+
+    const bool entryExists = fillStatMetaData(DirFdLookup(dirFd, fileName), data, what);
+
+    if (what & QFileSystemMetaData::HiddenAttribute) {
+        if (fileName[0] == '.')
+            data.entryFlags |= QFileSystemMetaData::HiddenAttribute;
+        data.knownFlagsMask |= QFileSystemMetaData::HiddenAttribute;
+    }
+
+    if (!entryExists) {
+        data.clearFlags(what);
+        return false;
+    }
+    return data.hasFlags(what);
+}
+#endif
+
 //static
 bool QFileSystemEngine::createDirectory(const QFileSystemEntry &entry, bool createParents)
 {
@@ -92,6 +92,16 @@ private:
     bool uncFallback;
     int uncShareIndex;
     bool onlyDirs;
+#elif defined(Q_OS_LINUX)
+    int dirFd;
+    // for getdents64
+    QScopedPointer<char, QScopedPointerPodDeleter> buffer;
+    int bufferOffset;
+    int bufferLength;
+    // what to resolve relative to dirFd before handing out an entry
+    bool resolveLinks;
+    QFileSystemMetaData::MetaDataFlags prefetchFlags;
+    int lastError;
 #else
     QT_DIR *dir;
     QT_DIRENT *dirEntry;
@@ -47,8 +47,120 @@
 #include <stdlib.h>
 #include <errno.h>
 
+#if defined(Q_OS_LINUX)
+# include <QtCore/private/qcore_unix_p.h>
+# include <QtCore/private/qfilesystemengine_p.h>
+# include <fcntl.h>
+# include <sys/syscall.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
+#if defined(Q_OS_LINUX)
+
+// Layout of the records returned by the getdents64 system call
+struct qt_linux_dirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+// Room for a couple of thousand entries per system call
+enum { DirentBufferSize = 64 * 1024 };
+
+QFileSystemIterator::QFileSystemIterator(const QFileSystemEntry &entry, QDir::Filters filters,
+                                         const QStringList &nameFilters, QDirIterator::IteratorFlags flags)
+    : nativePath(entry.nativeFilePath())
+    , dirFd(-1)
+    , bufferOffset(0)
+    , bufferLength(0)
+    , resolveLinks(false)
+    , prefetchFlags(0)
+    , lastError(0)
+{
+    // d_type already tells files, directories and symlinks apart. A symlink
+    // (or an entry the file system could not type) needs a stat to find out
+    // what it points to, which is needed by any filter looking at the type;
+    // do it here relative to the directory instead of through the full path.
+    resolveLinks = !(filters & QDir::System)
+            || (filters & QDir::NoSymLinks)
+            || !(filters & (QDir::Dirs | QDir::AllDirs))
+            || !(filters & QDir::Files)
+            || (!nameFilters.isEmpty() && (filters & QDir::AllDirs))
+            || (flags & QDirIterator::Subdirectories);
+
+    if (!(filters & QDir::Hidden))
+        prefetchFlags |= QFileSystemMetaData::HiddenAttribute;
+
+    const QDir::Filters permissions = filters & QDir::PermissionMask;
+    if (permissions && permissions != QDir::PermissionMask) {
+        if (permissions & QDir::Readable)
+            prefetchFlags |= QFileSystemMetaData::UserReadPermission;
+        if (permissions & QDir::Writable)
+            prefetchFlags |= QFileSystemMetaData::UserWritePermission;
+        if (permissions & QDir::Executable)
+            prefetchFlags |= QFileSystemMetaData::UserExecutePermission;
+    }
+
+    if ((dirFd = qt_safe_open(nativePath.constData(), O_RDONLY | O_DIRECTORY)) == -1) {
+        lastError = errno;
+    } else {
+        if (!nativePath.endsWith('/'))
+            nativePath.append('/');
+
+        char *p = static_cast<char *>(::malloc(DirentBufferSize));
+        Q_CHECK_PTR(p);
+        buffer.reset(p);
+    }
+}
+
+QFileSystemIterator::~QFileSystemIterator()
+{
+    if (dirFd != -1)
+        qt_safe_close(dirFd);
+}
+
+bool QFileSystemIterator::advance(QFileSystemEntry &fileEntry, QFileSystemMetaData &metaData)
+{
+    if (dirFd == -1)
+        return false;
+
+    if (bufferOffset >= bufferLength) {
+        long length;
+        EINTR_LOOP(length, ::syscall(SYS_getdents64, dirFd, buffer.data(), DirentBufferSize));
+        if (length <= 0) {
+            lastError = length ? errno : 0;
+            return false;
+        }
+        bufferOffset = 0;
+        bufferLength = int(length);
+    }
+
+    const qt_linux_dirent64 *dirEntry =
+            reinterpret_cast<const qt_linux_dirent64 *>(buffer.data() + bufferOffset);
+    bufferOffset += dirEntry->d_reclen;
+
+    fileEntry = QFileSystemEntry(nativePath + QByteArray(dirEntry->d_name), QFileSystemEntry::FromNativePath());
+    metaData.fillFromDirEntType(dirEntry->d_type);
+
+    QFileSystemMetaData::MetaDataFlags what = prefetchFlags;
+    if (resolveLinks) {
+        if (dirEntry->d_type == DT_LNK)
+            what |= QFileSystemMetaData::PosixStatFlags;
+        else if (dirEntry->d_type == DT_UNKNOWN)
+            what |= QFileSystemMetaData::LinkType | QFileSystemMetaData::PosixStatFlags;
+    }
+    if (what)
+        QFileSystemEngine::fillMetaData(dirFd, dirEntry->d_name, metaData, what);
+
+    return true;
+}
+
+#else
+
 QFileSystemIterator::QFileSystemIterator(const QFileSystemEntry &entry, QDir::Filters filters,
                                          const QStringList &nameFilters, QDirIterator::IteratorFlags flags)
     : nativePath(entry.nativeFilePath())
@@ -128,6 +240,8 @@ bool QFileSystemIterator::advance(QFileSystemEntry &fileEntry, QFileSystemMetaDa
     return false;
 }
 
+#endif // Q_OS_LINUX
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_FILESYSTEMITERATOR
@@ -440,6 +440,7 @@ void QProcessPrivate::Channel::clear()
     type = Normal;
     file.clear();
     process = 0;
+    device = 0;
 }
 
 /*! \fn bool QProcessPrivate::startDetached(const QString &program, const QStringList &arguments, const QString &workingDirectory, qint64 *pid)
@@ -792,6 +793,37 @@ void QProcessPrivate::Channel::clear()
     \sa readAllStandardError(), readChannel()
 */
 
+/*!
+    \fn void QProcess::standardInputForwarded(qint64 bytes)
+    \since 5.3
+
+    This signal is emitted when \a bytes bytes have been moved from the
+    device set with setStandardInputDevice() to the process' standard
+    input.
+
+    \sa setStandardInputDevice()
+*/
+
+/*!
+    \fn void QProcess::standardOutputForwarded(qint64 bytes)
+    \since 5.3
+
+    This signal is emitted when \a bytes bytes of the process' standard
+    output have been moved to the device set with setStandardOutputDevice().
+
+    \sa setStandardOutputDevice()
+*/
+
+/*!
+    \fn void QProcess::standardErrorForwarded(qint64 bytes)
+    \since 5.3
+
+    This signal is emitted when \a bytes bytes of the process' standard
+    error have been moved to the device set with setStandardErrorDevice().
+
+    \sa setStandardErrorDevice()
+*/
+
 /*!
     \internal
 */
@@ -815,6 +847,7 @@ QProcessPrivate::QProcessPrivate()
     exitCode = 0;
     crashed = false;
     dying = false;
+    finishDeferred = false;
     emittedReadyRead = false;
     emittedBytesWritten = false;
 #ifdef Q_OS_WIN
@@ -862,6 +895,7 @@ void QProcessPrivate::cleanup()
     pid = 0;
     sequenceNumber = 0;
     dying = false;
+    finishDeferred = false;
 
     if (stdoutChannel.notifier) {
         delete stdoutChannel.notifier;
@@ -875,6 +909,12 @@ void QProcessPrivate::cleanup()
         delete stdinChannel.notifier;
         stdinChannel.notifier = 0;
     }
+    delete stdoutChannel.deviceNotifier;
+    stdoutChannel.deviceNotifier = 0;
+    stdoutChannel.deviceBlocked = false;
+    delete stderrChannel.deviceNotifier;
+    stderrChannel.deviceNotifier = 0;
+    stderrChannel.deviceBlocked = false;
     if (startupSocketNotifier) {
         delete startupSocketNotifier;
         startupSocketNotifier = 0;
@@ -916,6 +956,23 @@ bool QProcessPrivate::_q_canReadStandardOutput()
         return false;
     }
 
+#ifdef Q_OS_UNIX
+    if (stdoutChannel.device) {
+        qint64 forwarded = forwardFromChannel(&stdoutChannel, available);
+        if (forwarded == -1) {
+            setForwardingBlocked(&stdoutChannel, false);
+            processError = QProcess::ReadError;
+            q->setErrorString(QProcess::tr("Error forwarding the output of the process"));
+            emit q->error(processError);
+        } else if (forwarded > 0) {
+            emit q->standardOutputForwarded(forwarded, QProcess::QPrivateSignal());
+        }
+        if (finishDeferred && !stdoutChannel.deviceBlocked && !stderrChannel.deviceBlocked)
+            finishProcess();
+        return false;
+    }
+#endif
+
     char *ptr = outputReadBuffer.reserve(available);
     qint64 readBytes = readFromStdout(ptr, available);
     if (readBytes == -1) {
@@ -969,6 +1026,23 @@ bool QProcessPrivate::_q_canReadStandardError()
         return false;
     }
 
+#ifdef Q_OS_UNIX
+    if (stderrChannel.device) {
+        qint64 forwarded = forwardFromChannel(&stderrChannel, available);
+        if (forwarded == -1) {
+            setForwardingBlocked(&stderrChannel, false);
+            processError = QProcess::ReadError;
+            q->setErrorString(QProcess::tr("Error forwarding the output of the process"));
+            emit q->error(processError);
+        } else if (forwarded > 0) {
+            emit q->standardErrorForwarded(forwarded, QProcess::QPrivateSignal());
+        }
+        if (finishDeferred && !stdoutChannel.deviceBlocked && !stderrChannel.deviceBlocked)
+            finishProcess();
+        return false;
+    }
+#endif
+
     char *ptr = errorReadBuffer.reserve(available);
     qint64 readBytes = readFromStderr(ptr, available);
     if (readBytes == -1) {
@@ -1009,6 +1083,29 @@ bool QProcessPrivate::_q_canWrite()
     if (stdinChannel.notifier)
         stdinChannel.notifier->setEnabled(false);
 
+#ifdef Q_OS_UNIX
+    if (writeBuffer.isEmpty() && stdinChannel.device && stdinChannel.pipe[1] != -1) {
+        bool atEnd = false;
+        qint64 forwarded = forwardToStdin(&atEnd);
+        if (forwarded == -1) {
+            destroyChannel(&stdinChannel);
+            processError = QProcess::WriteError;
+            q->setErrorString(QProcess::tr("Error forwarding input to the process"));
+            emit q->error(processError);
+            return false;
+        }
+        if (forwarded > 0)
+            emit q->standardInputForwarded(forwarded, QProcess::QPrivateSignal());
+        if (atEnd && writeBuffer.isEmpty()) {
+            // let the process see the end of the source device
+            closeWriteChannel();
+        } else if (stdinChannel.notifier) {
+            stdinChannel.notifier->setEnabled(true);
+        }
+        return true;
+    }
+#endif
+
     if (writeBuffer.isEmpty()) {
 #if defined QPROCESS_DEBUG
         qDebug("QProcessPrivate::canWrite(), not writing anything (empty write buffer).");
@@ -1050,7 +1147,6 @@ bool QProcessPrivate::_q_canWrite()
 */
 bool QProcessPrivate::_q_processDied()
 {
-    Q_Q(QProcess);
 #if defined QPROCESS_DEBUG
     qDebug("QProcessPrivate::_q_processDied()");
 #endif
@@ -1086,7 +1182,27 @@ bool QProcessPrivate::_q_processDied()
     // so the data is made available before the process dies.
     _q_canReadStandardOutput();
     _q_canReadStandardError();
+#ifdef Q_OS_UNIX
+    // a full device still holds back some of the forwarded output, which
+    // would be lost with the pipe; finish once the device has taken it
+    if (stdoutChannel.deviceBlocked || stderrChannel.deviceBlocked) {
+        if (deathNotifier)
+            deathNotifier->setEnabled(false);
+        finishDeferred = true;
+        return false;
+    }
+#endif
 
+    finishProcess();
+    return true;
+}
+
+/*!
+    \internal
+*/
+void QProcessPrivate::finishProcess()
+{
+    Q_Q(QProcess);
     findExitCode();
 
     if (crashed) {
@@ -1113,7 +1229,6 @@ bool QProcessPrivate::_q_processDied()
 #if defined QPROCESS_DEBUG
     qDebug("QProcessPrivate::_q_processDied() process is dead");
 #endif
-    return true;
 }
 
 /*!
@@ -1472,6 +1587,97 @@ void QProcess::setStandardOutputProcess(QProcess *destination)
     dto->stdinChannel.pipeFrom(dfrom);
 }
 
+#if defined(Q_OS_UNIX)
+
+/*!
+    \since 5.3
+
+    Feeds the process' standard input from the \a source device, starting
+    at its current position. Data is moved into the process as it is able
+    to consume it, and standardInputForwarded() is emitted for every chunk.
+    When the end of \a source is reached, the write channel is closed.
+
+    The device must be open for reading when the process starts and must
+    stay valid while the process runs; QProcess does not take ownership of
+    it. Data written with write() is sent before any further data from
+    \a source.
+
+    \a source must be a random-access device, such as a regular file.
+    Sequential devices, such as pipes, FIFOs and terminals, are not
+    supported, because reading from them can block the event loop;
+    forwarding from one fails with QProcess::WriteError.
+
+    On Linux, the data is moved with \e splice(), so it never gets copied
+    into the calling process. This makes forwarding large files cheap
+    compared to reading them and writing the data to the process.
+
+    \note This function is only available on Unix.
+
+    \sa setStandardInputFile(), setStandardOutputDevice()
+*/
+void QProcess::setStandardInputDevice(QFileDevice *source)
+{
+    Q_D(QProcess);
+    d->stdinChannel.forward(source);
+}
+
+/*!
+    \since 5.3
+
+    Forwards the process' standard output to the \a destination device,
+    starting at its current position. standardOutputForwarded() is emitted
+    for every chunk of data that has been forwarded; the standard output read
+    channel itself stays empty, as with setStandardOutputFile().
+
+    The device must be open for writing when the process starts and must
+    stay valid while the process runs; QProcess does not take ownership of
+    it.
+
+    On Linux, the data is moved with \e splice(), so it never gets copied
+    into the calling process, unless \a destination was opened in Append
+    mode.
+
+    If \a destination is a non-blocking pipe or socket that cannot take more
+    data, QProcess waits for it to become writable before forwarding more.
+    Output that is still pending when the process exits is forwarded before
+    finished() is emitted, so the process stays in the Running state until
+    \a destination has taken it, unless kill() is called.
+
+    \note This function is only available on Unix.
+
+    \sa setStandardOutputFile(), setStandardOutputProcess(),
+        setStandardErrorDevice(), setStandardInputDevice()
+*/
+void QProcess::setStandardOutputDevice(QFileDevice *destination)
+{
+    Q_D(QProcess);
+    d->stdoutChannel.forward(destination);
+}
+
+/*!
+    \since 5.3
+
+    Forwards the process' standard error to the \a destination device, and
+    emits standardErrorForwarded() for every chunk of data that has been
+    forwarded.
+
+    See setStandardOutputDevice() for more information.
+
+    Note: if setProcessChannelMode() was called with an argument of
+    QProcess::MergedChannels, this function has no effect.
+
+    \note This function is only available on Unix.
+
+    \sa setStandardErrorFile(), setStandardOutputDevice()
+*/
+void QProcess::setStandardErrorDevice(QFileDevice *destination)
+{
+    Q_D(QProcess);
+    d->stderrChannel.forward(destination);
+}
+
+#endif
+
 #if defined(Q_OS_WIN)
 
 /*!
@@ -1860,6 +2066,12 @@ void QProcess::setProcessState(ProcessState state)
 
     \warning This function is called by QProcess on Unix and Mac OS X
     only. On Windows and QNX, it is not called.
+
+    \note On Linux, QProcess starts the children of objects that are not
+    instances of a QProcess subclass with \e posix_spawn(), which is
+    considerably faster than \e fork() when the calling process uses a lot
+    of memory. Subclasses are always started with \e fork(), so that this
+    function can be called.
 */
 void QProcess::setupChildProcess()
 {
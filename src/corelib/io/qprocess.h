@@ -61,6 +61,7 @@ QT_BEGIN_NAMESPACE
 
 class QProcessPrivate;
 class QProcessEnvironmentPrivate;
+class QFileDevice;
 
 class Q_CORE_EXPORT QProcessEnvironment
 {
@@ -169,6 +170,12 @@ public:
     void setStandardErrorFile(const QString &fileName, OpenMode mode = Truncate);
     void setStandardOutputProcess(QProcess *destination);
 
+#if defined(Q_OS_UNIX) || defined(Q_QDOC)
+    void setStandardInputDevice(QFileDevice *source);
+    void setStandardOutputDevice(QFileDevice *destination);
+    void setStandardErrorDevice(QFileDevice *destination);
+#endif
+
 #if defined(Q_OS_WIN)
     QString nativeArguments() const;
     void setNativeArguments(const QString &arguments);
@@ -249,6 +256,22 @@ Q_SIGNALS:
 #endif
     );
 
+    void standardInputForwarded(qint64 bytes
+#if !defined(Q_QDOC)
+        , QPrivateSignal
+#endif
+    );
+    void standardOutputForwarded(qint64 bytes
+#if !defined(Q_QDOC)
+        , QPrivateSignal
+#endif
+    );
+    void standardErrorForwarded(qint64 bytes
+#if !defined(Q_QDOC)
+        , QPrivateSignal
+#endif
+    );
+
 protected:
     void setProcessState(ProcessState state);
 
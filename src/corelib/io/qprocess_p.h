@@ -249,7 +249,8 @@ public:
             // if you add "= 4" here, increase the number of bits below
         };
 
-        Channel() : process(0), notifier(0), type(Normal), closed(false), append(false)
+        Channel() : process(0), device(0), notifier(0), deviceNotifier(0), type(Normal),
+                    closed(false), append(false), deviceBlocked(false)
         {
             pipe[0] = INVALID_Q_PIPE;
             pipe[1] = INVALID_Q_PIPE;
@@ -279,14 +280,23 @@ public:
             type = PipeSink;
         }
 
+        void forward(QFileDevice *fileDevice)
+        {
+            clear();
+            device = fileDevice;
+        }
+
         QString file;
         QProcessPrivate *process;
+        QFileDevice *device;
         QSocketNotifier *notifier;
+        QSocketNotifier *deviceNotifier;
         Q_PIPE pipe[2];
 
         unsigned type : 2;
         bool closed : 1;
         bool append : 1;
+        bool deviceBlocked : 1;
     };
 
     QProcessPrivate();
@@ -310,6 +320,7 @@ public:
     int sequenceNumber;
 
     bool dying;
+    bool finishDeferred;
     bool emittedReadyRead;
     bool emittedBytesWritten;
 
@@ -351,6 +362,8 @@ public:
     void startProcess();
 #if defined(Q_OS_UNIX) && !defined(Q_OS_QNX)
     void execChild(const char *workingDirectory, char **path, char **argv, char **envp);
+    bool canSpawnChild(const char *workingDirectory) const;
+    pid_t spawnChild(const char *workingDirectory, char **path, char **argv, char **envp);
 #elif defined(Q_OS_QNX)
     pid_t spawnChild(const char *workingDirectory, char **argv, char **envp);
 #endif
@@ -358,8 +371,12 @@ public:
     void terminateProcess();
     void killProcess();
     void findExitCode();
+    void finishProcess();
 #ifdef Q_OS_UNIX
     bool waitForDeadChild();
+    qint64 forwardFromChannel(Channel *channel, qint64 maxlen);
+    void setForwardingBlocked(Channel *channel, bool blocked);
+    qint64 forwardToStdin(bool *atEnd);
 #endif
 #ifdef Q_OS_WIN
     bool drainOutputPipes();
@@ -94,6 +94,7 @@ QT_END_NAMESPACE
 #include <private/qcoreapplication_p.h>
 #include <private/qthread_p.h>
 #include <qfile.h>
+#include <qfiledevice.h>
 #include <qfileinfo.h>
 #include <qlist.h>
 #include <qhash.h>
@@ -113,6 +114,29 @@ QT_END_NAMESPACE
 #include <sys/neutrino.h>
 #endif
 
+#ifdef Q_OS_LINUX
+#include <sys/syscall.h>
+#  ifdef SYS_pidfd_open
+#    define QPROCESS_USE_PIDFD
+#  endif
+#  ifdef SPLICE_F_MOVE
+#    define QPROCESS_USE_SPLICE
+#  endif
+#endif
+
+// glibc implements posix_spawn() with clone(CLONE_VM | CLONE_VFORK) and
+// reports exec() failures back to the caller since 2.24.
+#if defined(__GLIBC__) && defined(__GLIBC_PREREQ)
+#  if __GLIBC_PREREQ(2, 24)
+#    define QPROCESS_USE_POSIX_SPAWN
+#    include <spawn.h>
+#    include <typeinfo>
+#  endif
+#  if __GLIBC_PREREQ(2, 29)
+#    define QPROCESS_POSIX_SPAWN_CHDIR
+#  endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 // POSIX requires PIPE_BUF to be 512 or larger
@@ -151,6 +175,52 @@ static void qt_sa_sigchld_sigaction(int signum, siginfo_t *info, void *context)
     }
 }
 
+static int qt_open_process_fd(pid_t pid)
+{
+#ifdef QPROCESS_USE_PIDFD
+    return ::syscall(SYS_pidfd_open, pid, 0);
+#else
+    Q_UNUSED(pid);
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+/*
+    Returns true if the kernel hands out process descriptors. A process
+    descriptor becomes readable when the child exits, so it can stand in for
+    the death pipe, and neither the SIGCHLD handler nor the process manager
+    thread are needed.
+*/
+static bool qt_has_process_fd()
+{
+    static QBasicAtomicInt supported = Q_BASIC_ATOMIC_INITIALIZER(-1);
+    int result = supported.load();
+    if (result == -1) {
+        int fd = qt_open_process_fd(::getpid());
+        result = fd != -1;
+        if (fd != -1)
+            qt_safe_close(fd);
+        supported.store(result);
+    }
+    return result;
+}
+
+/*
+    Returns true if SIGCHLD is ignored or set up with SA_NOCLDWAIT. The
+    kernel then reaps children by itself and waitpid() cannot collect their
+    exit status. A process descriptor does not change that, but the SIGCHLD
+    handler installed by the process manager does.
+*/
+static bool qt_sigchld_ignored()
+{
+    struct sigaction action;
+    ::sigaction(SIGCHLD, 0, &action);
+    if (action.sa_flags & SA_NOCLDWAIT)
+        return true;
+    return !(action.sa_flags & SA_SIGINFO) && action.sa_handler == SIG_IGN;
+}
+
 static inline void add_fd(int &nfds, int fd, fd_set *fdset)
 {
     FD_SET(fd, fdset);
@@ -158,6 +228,29 @@ static inline void add_fd(int &nfds, int fd, fd_set *fdset)
         nfds = fd;
 }
 
+// An output channel waits for more output, or for the device it is
+// forwarded to while that device cannot take more data.
+static inline void add_output_fd(int &nfds, const QProcessPrivate::Channel &channel,
+                                 fd_set *fdread, fd_set *fdwrite)
+{
+    if (channel.pipe[0] == -1)
+        return;
+    if (channel.deviceBlocked)
+        add_fd(nfds, channel.device->handle(), fdwrite);
+    else
+        add_fd(nfds, channel.pipe[0], fdread);
+}
+
+static inline bool is_output_ready(const QProcessPrivate::Channel &channel,
+                                   fd_set *fdread, fd_set *fdwrite)
+{
+    if (channel.pipe[0] == -1)
+        return false;
+    if (channel.deviceBlocked)
+        return FD_ISSET(channel.device->handle(), fdwrite);
+    return FD_ISSET(channel.pipe[0], fdread);
+}
+
 struct QProcessInfo {
     QProcess *process;
     int deathPipe;
@@ -177,6 +270,7 @@ public:
     void catchDeadChildren();
     void add(pid_t pid, QProcess *process);
     void remove(QProcess *process);
+    void installSigChldHandler();
     void lock();
     void unlock();
 
@@ -212,6 +306,13 @@ QProcessManager::QProcessManager()
     // circumstances want to block.
     qt_safe_pipe(qt_qprocess_deadChild_pipe, O_NONBLOCK);
 
+    installSigChldHandler();
+
+    processManagerInstance = this;
+}
+
+void QProcessManager::installSigChldHandler()
+{
     // set up the SIGCHLD handler, which writes a single byte to the dead
     // child pipe every time a child dies.
 
@@ -225,8 +326,6 @@ QProcessManager::QProcessManager()
     // function
     action.sa_flags = SA_NOCLDSTOP | SA_SIGINFO;
     ::sigaction(SIGCHLD, &action, &qt_sa_old_sigchld_handler);
-
-    processManagerInstance = this;
 }
 
 QProcessManager::~QProcessManager()
@@ -570,14 +669,16 @@ void QProcessPrivate::startProcess()
     qDebug("QProcessPrivate::startProcess()");
 #endif
 
-    processManager()->start();
+    // The child is watched through a process descriptor if possible, which
+    // needs neither the death pipe nor the process manager.
+    const bool useProcessFd = qt_has_process_fd() && !qt_sigchld_ignored();
 
     // Initialize pipes
     if (!createChannel(stdinChannel) ||
         !createChannel(stdoutChannel) ||
         !createChannel(stderrChannel) ||
         qt_create_pipe(childStartedPipe) != 0 ||
-        qt_create_pipe(deathPipe) != 0) {
+        (!useProcessFd && qt_create_pipe(deathPipe) != 0)) {
         processError = QProcess::FailedToStart;
         q->setErrorString(qt_error_string(errno));
         emit q->error(processError);
@@ -590,11 +691,17 @@ void QProcessPrivate::startProcess()
                                                     QSocketNotifier::Read, q);
         QObject::connect(startupSocketNotifier, SIGNAL(activated(int)),
                          q, SLOT(_q_startupNotification()));
+    }
 
-        deathNotifier = new QSocketNotifier(deathPipe[0],
-                                            QSocketNotifier::Read, q);
-        QObject::connect(deathNotifier, SIGNAL(activated(int)),
-                         q, SLOT(_q_processDied()));
+    // The process manager's SIGCHLD handler has to be in place before the
+    // child can die; otherwise an ignored SIGCHLD would let the kernel reap
+    // it. The application may also have ignored SIGCHLD after the manager
+    // installed its handler.
+    if (!useProcessFd) {
+        QProcessManager *manager = processManager();
+        if (qt_sigchld_ignored())
+            manager->installSigChldHandler();
+        manager->start();
     }
 
     // Start the process (platform dependent)
@@ -676,27 +783,38 @@ void QProcessPrivate::startProcess()
         }
     }
 
-    // Start the process manager, and fork off the child process.
-    processManager()->lock();
+    // Fork off the child process, or spawn it if nothing needs to run in
+    // the child before exec.
 #if defined(Q_OS_QNX)
     pid_t childPid = spawnChild(workingDirPtr, argv, envp);
 #else
-    pid_t childPid = fork();
+    pid_t childPid;
+#  ifdef QPROCESS_USE_POSIX_SPAWN
+    if (canSpawnChild(workingDirPtr)) {
+        childPid = spawnChild(workingDirPtr, path, argv, envp);
+    } else
+#  endif
+    {
+        childPid = fork();
+        if (childPid == 0) {
+            execChild(workingDirPtr, path, argv, envp);
+            ::_exit(-1);
+        }
+    }
     int lastForkErrno = errno;
 #endif
-    if (childPid != 0) {
-        // Clean up duplicated memory.
-        free(dupProgramName);
-        for (int i = 1; i <= arguments.count(); ++i)
-            free(argv[i]);
-        for (int i = 0; i < envc; ++i)
-            free(envp[i]);
-        for (int i = 0; i < pathc; ++i)
-            free(path[i]);
-        delete [] argv;
-        delete [] envp;
-        delete [] path;
-    }
+
+    // Clean up duplicated memory.
+    free(dupProgramName);
+    for (int i = 1; i <= arguments.count(); ++i)
+        free(argv[i]);
+    for (int i = 0; i < envc; ++i)
+        free(envp[i]);
+    for (int i = 0; i < pathc; ++i)
+        free(path[i]);
+    delete [] argv;
+    delete [] envp;
+    delete [] path;
 
     // This is not a valid check under QNX, because the semantics are
     // different. While under other platforms where fork() may succeed and exec() can still fail,
@@ -714,7 +832,6 @@ void QProcessPrivate::startProcess()
 #if defined (QPROCESS_DEBUG)
         qDebug("fork failed: %s", qPrintable(qt_error_string(lastForkErrno)));
 #endif
-        processManager()->unlock();
         q->setProcessState(QProcess::NotRunning);
         processError = QProcess::FailedToStart;
         q->setErrorString(QProcess::tr("Resource error (fork failure): %1").arg(qt_error_string(lastForkErrno)));
@@ -722,23 +839,54 @@ void QProcessPrivate::startProcess()
         cleanup();
         return;
     }
-
-    // Start the child.
-    if (childPid == 0) {
-        execChild(workingDirPtr, path, argv, envp);
-        ::_exit(-1);
-    }
 #endif
 
-    // Register the child. In the mean time, we can get a SIGCHLD, so we need
-    // to keep the lock held to avoid a race to catch the child.
-    processManager()->add(childPid, q);
+    // Register the child. A childPid of 0 means spawnChild() failed and has
+    // already reported the error through childStartedPipe.
     pid = Q_PID(childPid);
-    processManager()->unlock();
+    if (childPid > 0) {
+        int processFd = useProcessFd ? qt_open_process_fd(childPid) : -1;
+        if (processFd != -1) {
+            deathPipe[0] = processFd;
+        } else {
+            if (useProcessFd) {
+                // pidfd_open() only fails here when we are out of file
+                // descriptors; fall back to the death pipe and the manager
+                if (qt_create_pipe(deathPipe) != 0) {
+                    int lastPipeErrno = errno;
+                    ::kill(childPid, SIGKILL);
+                    qt_safe_waitpid(childPid, 0, 0);
+                    pid = 0;
+                    q->setProcessState(QProcess::NotRunning);
+                    processError = QProcess::FailedToStart;
+                    q->setErrorString(qt_error_string(lastPipeErrno));
+                    emit q->error(processError);
+                    cleanup();
+                    return;
+                }
+                processManager()->start();
+            }
+            processManager()->lock();
+            processManager()->add(childPid, q);
+            processManager()->unlock();
+
+            // The child may have died before it was registered, in which
+            // case its SIGCHLD went unnoticed; make sure we check once.
+            qt_safe_write(deathPipe[1], "", 1);
+        }
+    }
+
+    if (threadData->hasEventDispatcher()) {
+        deathNotifier = new QSocketNotifier(deathPipe[0],
+                                            QSocketNotifier::Read, q);
+        QObject::connect(deathNotifier, SIGNAL(activated(int)),
+                         q, SLOT(_q_processDied()));
+    }
 
     // parent
     // close the ends we don't use and make all pipes non-blocking
-    ::fcntl(deathPipe[0], F_SETFL, ::fcntl(deathPipe[0], F_GETFL) | O_NONBLOCK);
+    if (deathPipe[1] != -1)
+        ::fcntl(deathPipe[0], F_SETFL, ::fcntl(deathPipe[0], F_GETFL) | O_NONBLOCK);
     qt_safe_close(childStartedPipe[1]);
     childStartedPipe[1] = -1;
 
@@ -764,6 +912,10 @@ void QProcessPrivate::startProcess()
     }
     if (stderrChannel.pipe[0] != -1)
         ::fcntl(stderrChannel.pipe[0], F_SETFL, ::fcntl(stderrChannel.pipe[0], F_GETFL) | O_NONBLOCK);
+
+    // start feeding the process from its input device
+    if (stdinChannel.device && stdinChannel.notifier)
+        stdinChannel.notifier->setEnabled(true);
 }
 
 #if defined(Q_OS_QNX)
@@ -938,6 +1090,103 @@ void QProcessPrivate::execChild(const char *workingDir, char **path, char **argv
     qt_safe_close(childStartedPipe[1]);
     childStartedPipe[1] = -1;
 }
+
+#ifdef QPROCESS_USE_POSIX_SPAWN
+bool QProcessPrivate::canSpawnChild(const char *workingDir) const
+{
+    // setupChildProcess() has to run between fork() and exec(), so only
+    // plain QProcess objects can be spawned; a subclass might override it.
+    if (typeid(*q_func()) != typeid(QProcess))
+        return false;
+#ifndef QPROCESS_POSIX_SPAWN_CHDIR
+    if (workingDir)
+        return false;
+#else
+    Q_UNUSED(workingDir);
+#endif
+    return true;
+}
+
+/*
+    Starts the child with posix_spawn(), which does not copy the page tables
+    of the parent and is therefore much cheaper than fork() for processes
+    with a large address space. The child only inherits the standard channels
+    set up below and the descriptors not marked close-on-exec, exactly as in
+    execChild(). Returns 0 if the child could not be started, after writing
+    the error to childStartedPipe.
+*/
+pid_t QProcessPrivate::spawnChild(const char *workingDir, char **path, char **argv, char **envp)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+
+    // copy the stdin socket if asked to
+    if (inputChannelMode != QProcess::ForwardedInputChannel)
+        posix_spawn_file_actions_adddup2(&actions, stdinChannel.pipe[0], STDIN_FILENO);
+
+    // copy the stdout and stderr if asked to
+    if (processChannelMode != QProcess::ForwardedChannels) {
+        if (processChannelMode != QProcess::ForwardedOutputChannel)
+            posix_spawn_file_actions_adddup2(&actions, stdoutChannel.pipe[1], STDOUT_FILENO);
+
+        // merge stdout and stderr if asked to
+        if (processChannelMode == QProcess::MergedChannels)
+            posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        else if (processChannelMode != QProcess::ForwardedErrorChannel)
+            posix_spawn_file_actions_adddup2(&actions, stderrChannel.pipe[1], STDERR_FILENO);
+    }
+
+#ifdef QPROCESS_POSIX_SPAWN_CHDIR
+    if (workingDir)
+        posix_spawn_file_actions_addchdir_np(&actions, workingDir);
+#endif
+
+    // reset the signal that we ignored
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF);
+
+    pid_t childPid = 0;
+    int result;
+    if (!envp) {
+        result = ::posix_spawnp(&childPid, argv[0], &actions, &attributes, argv, environ);
+    } else if (path) {
+        result = ENOENT;
+        for (char **arg = path; *arg && result != 0; ++arg) {
+            argv[0] = *arg;
+#if defined (QPROCESS_DEBUG)
+            fprintf(stderr, "QProcessPrivate::spawnChild() searching / starting %s\n", argv[0]);
+#endif
+            result = ::posix_spawn(&childPid, argv[0], &actions, &attributes, argv, envp);
+        }
+    } else {
+#if defined (QPROCESS_DEBUG)
+        fprintf(stderr, "QProcessPrivate::spawnChild() starting %s\n", argv[0]);
+#endif
+        result = ::posix_spawn(&childPid, argv[0], &actions, &attributes, argv, envp);
+    }
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (result != 0) {
+        // notify failure
+        QString error = qt_error_string(result);
+#if defined (QPROCESS_DEBUG)
+        fprintf(stderr, "QProcessPrivate::spawnChild() failed (%s)\n", qPrintable(error));
+#endif
+        qt_safe_write(childStartedPipe[1], error.data(), error.length() * sizeof(QChar));
+        qt_safe_close(childStartedPipe[1]);
+        childStartedPipe[1] = -1;
+        return 0;
+    }
+    return childPid;
+}
+#endif // QPROCESS_USE_POSIX_SPAWN
 #endif
 
 bool QProcessPrivate::processStarted()
@@ -1024,12 +1273,145 @@ qint64 QProcessPrivate::writeToStdin(const char *data, qint64 maxlen)
     return written;
 }
 
+/*
+    Moves up to \a maxlen bytes from the read end of \a channel to the
+    device the channel is forwarded to. Returns the number of bytes moved, or
+    -1 on error. \a maxlen is what the pipe holds, so if the device takes
+    less without an error, it is a full pipe or socket; the channel then waits
+    for the device to become writable instead of for more output.
+*/
+qint64 QProcessPrivate::forwardFromChannel(Channel *channel, qint64 maxlen)
+{
+    QFileDevice *device = channel->device;
+    qint64 total = 0;
+
+#ifdef QPROCESS_USE_SPLICE
+    // splice() cannot write to files opened with O_APPEND; everything else
+    // either works or fails with EINVAL, and then we fall back to copying.
+    int fd = device->handle();
+    if (fd != -1 && !(device->openMode() & QIODevice::Append) && device->flush()) {
+        const bool sequential = device->isSequential();
+        loff_t offset = device->pos();
+        ssize_t moved = 0;
+        while (total < maxlen) {
+            EINTR_LOOP(moved, ::splice(channel->pipe[0], 0, fd, sequential ? 0 : &offset,
+                                       size_t(maxlen - total), SPLICE_F_MOVE | SPLICE_F_NONBLOCK));
+            if (moved <= 0)
+                break;
+            total += moved;
+        }
+        int spliceErrno = errno;
+        if (!sequential && !device->seek(offset))
+            return -1;
+        if (moved >= 0 || spliceErrno == EAGAIN) {
+            setForwardingBlocked(channel, moved < 0 && total < maxlen);
+            return total;
+        }
+        if (spliceErrno != EINVAL && spliceErrno != ENOSYS)
+            return -1;
+    }
+#endif
+
+    // copy through user space
+    char buffer[16384];
+    while (total < maxlen) {
+        qint64 readBytes = qt_safe_read(channel->pipe[0], buffer,
+                                        qMin<qint64>(sizeof buffer, maxlen - total));
+        if (readBytes <= 0)
+            break;
+        if (device->write(buffer, readBytes) != readBytes)
+            return -1;
+        total += readBytes;
+    }
+    return total;
+}
+
+/*
+    Makes the output \a channel wait for the device it is forwarded to to
+    become writable if \a blocked is true, or for more output otherwise.
+    Watching the pipe while the device is full would wake the event loop
+    again and again for output that cannot be moved.
+*/
+void QProcessPrivate::setForwardingBlocked(Channel *channel, bool blocked)
+{
+    Q_Q(QProcess);
+    if (channel->deviceBlocked == blocked)
+        return;
+    channel->deviceBlocked = blocked;
+    if (!channel->notifier)
+        return;
+
+    if (blocked && !channel->deviceNotifier) {
+        channel->deviceNotifier = new QSocketNotifier(channel->device->handle(),
+                                                      QSocketNotifier::Write, q);
+        if (channel == &stdoutChannel) {
+            QObject::connect(channel->deviceNotifier, SIGNAL(activated(int)),
+                             q, SLOT(_q_canReadStandardOutput()));
+        } else {
+            QObject::connect(channel->deviceNotifier, SIGNAL(activated(int)),
+                             q, SLOT(_q_canReadStandardError()));
+        }
+    }
+    if (channel->deviceNotifier)
+        channel->deviceNotifier->setEnabled(blocked);
+    channel->notifier->setEnabled(!blocked);
+}
+
+/*
+    Moves data from the device the standard input channel is forwarded from
+    into the process. Returns the number of bytes moved, or -1 on error.
+    \a atEnd is set to true once the device has no more data.
+
+    Only random-access devices are supported: reading from a pipe or a FIFO
+    could block the event loop, and the data it returned could not be put
+    back when the process does not take all of it.
+*/
+qint64 QProcessPrivate::forwardToStdin(bool *atEnd)
+{
+    QFileDevice *device = stdinChannel.device;
+    if (device->isSequential())
+        return -1;
+
+#ifdef QPROCESS_USE_SPLICE
+    int fd = device->handle();
+    if (fd != -1) {
+        loff_t offset = device->pos();
+        ssize_t moved;
+        EINTR_LOOP(moved, ::splice(fd, &offset, stdinChannel.pipe[1], 0, 1 << 20,
+                                   SPLICE_F_MOVE | SPLICE_F_NONBLOCK));
+        if (moved >= 0) {
+            *atEnd = moved == 0;
+            return device->seek(offset) ? qint64(moved) : qint64(-1);
+        }
+        if (errno == EAGAIN)
+            return 0;
+        if (errno != EINVAL && errno != ENOSYS)
+            return -1;
+    }
+#endif
+
+    // copy through user space
+    char buffer[16384];
+    qint64 readBytes = device->read(buffer, sizeof buffer);
+    if (readBytes <= 0) {
+        *atEnd = true;
+        return readBytes;
+    }
+    qint64 written = writeToStdin(buffer, readBytes);
+    if (written < 0)
+        return -1;
+    // the pipe is full; leave the rest in the device for the next round
+    if (written < readBytes && !device->seek(device->pos() - (readBytes - written)))
+        return -1;
+    return written;
+}
+
 void QProcessPrivate::terminateProcess()
 {
 #if defined (QPROCESS_DEBUG)
     qDebug("QProcessPrivate::killProcess()");
 #endif
-    if (pid)
+    if (pid && !finishDeferred)
         ::kill(pid_t(pid), SIGTERM);
 }
 
@@ -1038,6 +1420,11 @@ void QProcessPrivate::killProcess()
 #if defined (QPROCESS_DEBUG)
     qDebug("QProcessPrivate::killProcess()");
 #endif
+    if (finishDeferred) {
+        // the process is gone already; drop the output the devices did not take
+        finishProcess();
+        return;
+    }
     if (pid)
         ::kill(pid_t(pid), SIGKILL);
 }
@@ -1146,18 +1533,17 @@ bool QProcessPrivate::waitForReadyRead(int msecs)
         FD_ZERO(&fdread);
         FD_ZERO(&fdwrite);
 
-        int nfds = deathPipe[0];
-        FD_SET(deathPipe[0], &fdread);
+        int nfds = -1;
+        if (!finishDeferred)
+            add_fd(nfds, deathPipe[0], &fdread);
 
         if (processState == QProcess::Starting)
             add_fd(nfds, childStartedPipe[0], &fdread);
 
-        if (stdoutChannel.pipe[0] != -1)
-            add_fd(nfds, stdoutChannel.pipe[0], &fdread);
-        if (stderrChannel.pipe[0] != -1)
-            add_fd(nfds, stderrChannel.pipe[0], &fdread);
+        add_output_fd(nfds, stdoutChannel, &fdread, &fdwrite);
+        add_output_fd(nfds, stderrChannel, &fdread, &fdwrite);
 
-        if (!writeBuffer.isEmpty() && stdinChannel.pipe[1] != -1)
+        if ((!writeBuffer.isEmpty() || stdinChannel.device) && stdinChannel.pipe[1] != -1)
             add_fd(nfds, stdinChannel.pipe[1], &fdwrite);
 
         int timeout = qt_timeout_value(msecs, stopWatch.elapsed());
@@ -1181,12 +1567,12 @@ bool QProcessPrivate::waitForReadyRead(int msecs)
 	}
 
         bool readyReadEmitted = false;
-	if (stdoutChannel.pipe[0] != -1 && FD_ISSET(stdoutChannel.pipe[0], &fdread)) {
+	if (is_output_ready(stdoutChannel, &fdread, &fdwrite)) {
 	    bool canRead = _q_canReadStandardOutput();
             if (processChannel == QProcess::StandardOutput && canRead)
                 readyReadEmitted = true;
 	}
-	if (stderrChannel.pipe[0] != -1 && FD_ISSET(stderrChannel.pipe[0], &fdread)) {
+	if (is_output_ready(stderrChannel, &fdread, &fdwrite)) {
 	    bool canRead = _q_canReadStandardError();
             if (processChannel == QProcess::StandardError && canRead)
                 readyReadEmitted = true;
@@ -1197,7 +1583,10 @@ bool QProcessPrivate::waitForReadyRead(int msecs)
 	if (stdinChannel.pipe[1] != -1 && FD_ISSET(stdinChannel.pipe[1], &fdwrite))
 	    _q_canWrite();
 
-	if (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread)) {
+        // forwarding the last of the output finishes a deferred process
+        if (processState == QProcess::NotRunning)
+            return false;
+	if (!finishDeferred && (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread))) {
             if (_q_processDied())
                 return false;
         }
@@ -1222,16 +1611,15 @@ bool QProcessPrivate::waitForBytesWritten(int msecs)
         FD_ZERO(&fdread);
         FD_ZERO(&fdwrite);
 
-        int nfds = deathPipe[0];
-        FD_SET(deathPipe[0], &fdread);
+        int nfds = -1;
+        if (!finishDeferred)
+            add_fd(nfds, deathPipe[0], &fdread);
 
         if (processState == QProcess::Starting)
             add_fd(nfds, childStartedPipe[0], &fdread);
 
-        if (stdoutChannel.pipe[0] != -1)
-            add_fd(nfds, stdoutChannel.pipe[0], &fdread);
-        if (stderrChannel.pipe[0] != -1)
-            add_fd(nfds, stderrChannel.pipe[0], &fdread);
+        add_output_fd(nfds, stdoutChannel, &fdread, &fdwrite);
+        add_output_fd(nfds, stderrChannel, &fdread, &fdwrite);
 
 
         if (!writeBuffer.isEmpty() && stdinChannel.pipe[1] != -1)
@@ -1261,13 +1649,16 @@ bool QProcessPrivate::waitForBytesWritten(int msecs)
 	if (stdinChannel.pipe[1] != -1 && FD_ISSET(stdinChannel.pipe[1], &fdwrite))
 	    return _q_canWrite();
 
-	if (stdoutChannel.pipe[0] != -1 && FD_ISSET(stdoutChannel.pipe[0], &fdread))
+	if (is_output_ready(stdoutChannel, &fdread, &fdwrite))
 	    _q_canReadStandardOutput();
 
-	if (stderrChannel.pipe[0] != -1 && FD_ISSET(stderrChannel.pipe[0], &fdread))
+	if (is_output_ready(stderrChannel, &fdread, &fdwrite))
 	    _q_canReadStandardError();
 
-	if (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread)) {
+        // forwarding the last of the output finishes a deferred process
+        if (processState == QProcess::NotRunning)
+            return false;
+	if (!finishDeferred && (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread))) {
             if (_q_processDied())
                 return false;
         }
@@ -1297,15 +1688,13 @@ bool QProcessPrivate::waitForFinished(int msecs)
         if (processState == QProcess::Starting)
             add_fd(nfds, childStartedPipe[0], &fdread);
 
-        if (stdoutChannel.pipe[0] != -1)
-            add_fd(nfds, stdoutChannel.pipe[0], &fdread);
-        if (stderrChannel.pipe[0] != -1)
-            add_fd(nfds, stderrChannel.pipe[0], &fdread);
+        add_output_fd(nfds, stdoutChannel, &fdread, &fdwrite);
+        add_output_fd(nfds, stderrChannel, &fdread, &fdwrite);
 
-        if (processState == QProcess::Running)
+        if (processState == QProcess::Running && !finishDeferred)
             add_fd(nfds, deathPipe[0], &fdread);
 
-        if (!writeBuffer.isEmpty() && stdinChannel.pipe[1] != -1)
+        if ((!writeBuffer.isEmpty() || stdinChannel.device) && stdinChannel.pipe[1] != -1)
             add_fd(nfds, stdinChannel.pipe[1], &fdwrite);
 
         int timeout = qt_timeout_value(msecs, stopWatch.elapsed());
@@ -1330,13 +1719,16 @@ bool QProcessPrivate::waitForFinished(int msecs)
 	if (stdinChannel.pipe[1] != -1 && FD_ISSET(stdinChannel.pipe[1], &fdwrite))
 	    _q_canWrite();
 
-	if (stdoutChannel.pipe[0] != -1 && FD_ISSET(stdoutChannel.pipe[0], &fdread))
+	if (is_output_ready(stdoutChannel, &fdread, &fdwrite))
 	    _q_canReadStandardOutput();
 
-	if (stderrChannel.pipe[0] != -1 && FD_ISSET(stderrChannel.pipe[0], &fdread))
+	if (is_output_ready(stderrChannel, &fdread, &fdwrite))
 	    _q_canReadStandardError();
 
-	if (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread)) {
+        // forwarding the last of the output finishes a deferred process
+        if (processState == QProcess::NotRunning)
+            return true;
+	if (!finishDeferred && (deathPipe[0] == -1 || FD_ISSET(deathPipe[0], &fdread))) {
             if (_q_processDied())
                 return true;
 	}
@@ -1355,21 +1747,36 @@ bool QProcessPrivate::waitForWrite(int msecs)
 void QProcessPrivate::findExitCode()
 {
     Q_Q(QProcess);
-    processManager()->remove(q);
+    if (serial)
+        processManager()->remove(q);
 }
 
 bool QProcessPrivate::waitForDeadChild()
 {
     Q_Q(QProcess);
 
-    // read a byte from the death pipe
+    // read a byte from the death pipe; if the child is watched through a
+    // process descriptor, there is nothing to read and this is a no-op
     char c;
     qt_safe_read(deathPipe[0], &c, 1);
 
+    // there is no child if spawning it failed
+    if (!pid)
+        return true;
+
     // check if our process is dead
     int exitStatus;
-    if (qt_safe_waitpid(pid_t(pid), &exitStatus, WNOHANG) > 0) {
-        processManager()->remove(q);
+    pid_t waitResult = qt_safe_waitpid(pid_t(pid), &exitStatus, WNOHANG);
+    if (waitResult < 0 && errno == ECHILD) {
+        // somebody else reaped our child, so its exit status is lost
+        if (serial)
+            processManager()->remove(q);
+        crashed = true;
+        return true;
+    }
+    if (waitResult > 0) {
+        if (serial)
+            processManager()->remove(q);
         crashed = !WIFEXITED(exitStatus);
         exitCode = WEXITSTATUS(exitStatus);
 #if defined QPROCESS_DEBUG
@@ -1426,7 +1833,8 @@ bool QProcessPrivate::startDetached(const QString &program, const QStringList &a
 
 bool QProcessPrivate::startDetached(const QString &program, const QStringList &arguments, const QString &workingDirectory, qint64 *pid)
 {
-    processManager()->start();
+    if (!qt_has_process_fd())
+        processManager()->start();
 
     QByteArray encodedWorkingDirectory = QFile::encodeName(workingDirectory);
 
@@ -1544,7 +1952,10 @@ bool QProcessPrivate::startDetached(const QString &program, const QStringList &a
 
 void QProcessPrivate::initializeProcessManager()
 {
-    (void) processManager();
+    // the SIGCHLD handler is only needed when children cannot be watched
+    // through process descriptors
+    if (!qt_has_process_fd())
+        (void) processManager();
 }
 
 QT_END_NAMESPACE
@@ -53,6 +53,9 @@
 #include "qmutex.h"
 #include "qlibraryinfo.h"
 #include "qtemporaryfile.h"
+#include "qbuffer.h"
+#include "qendian.h"
+#include "quuid.h"
 
 #ifndef QT_NO_TEXTCODEC
 #  include "qtextcodec.h"
@@ -224,7 +227,7 @@ static bool unixLock(int handle, int lockType)
 #endif
 
 QConfFile::QConfFile(const QString &fileName, bool _userPerms)
-    : name(fileName), size(0), ref(1), userPerms(_userPerms)
+    : name(fileName), size(0), journalRecords(0), ref(1), userPerms(_userPerms)
 {
     usedHashFunc()->insert(name, this);
 }
@@ -985,7 +988,12 @@ QStringList QSettingsPrivate::splitArgs(const QString &s, int idx)
 
 void QConfFileSettingsPrivate::initFormat()
 {
-    extension = (format == QSettings::NativeFormat) ? QLatin1String(".conf") : QLatin1String(".ini");
+    if (format == QSettings::NativeFormat)
+        extension = QLatin1String(".conf");
+    else if (format == QSettings::JournalFormat)
+        extension = QLatin1String(".journal");
+    else
+        extension = QLatin1String(".ini");
     readFunc = 0;
     writeFunc = 0;
 #if defined(Q_OS_MAC)
@@ -994,7 +1002,7 @@ void QConfFileSettingsPrivate::initFormat()
     caseSensitivity = IniCaseSensitivity;
 #endif
 
-    if (format > QSettings::IniFormat) {
+    if (format > QSettings::JournalFormat) {
         QMutexLocker locker(&settingsGlobalMutex);
         const CustomFormatVector *customFormatVector = customFormatVectorFunc();
 
@@ -1012,7 +1020,7 @@ void QConfFileSettingsPrivate::initFormat()
 void QConfFileSettingsPrivate::initAccess()
 {
     if (confFiles[spec]) {
-        if (format > QSettings::IniFormat) {
+        if (format > QSettings::JournalFormat) {
             if (!readFunc)
                 setStatus(QSettings::AccessError);
         }
@@ -1391,7 +1399,7 @@ QString QConfFileSettingsPrivate::fileName() const
 
 bool QConfFileSettingsPrivate::isWritable() const
 {
-    if (format > QSettings::IniFormat && !writeFunc)
+    if (format > QSettings::JournalFormat && !writeFunc)
         return false;
 
     QConfFile *confFile = confFiles[spec].data();
@@ -1494,120 +1502,127 @@ void QConfFileSettingsPrivate::syncConfFile(int confFileNo)
         }
     }
 
-    /*
-        We hold the lock. Let's reread the file if it has changed
-        since last time we read it.
-    */
-    QFileInfo fileInfo(confFile->name);
-    bool mustReadFile = true;
+#ifndef QT_NO_DATASTREAM
+    if (format == QSettings::JournalFormat) {
+        syncJournalFile(confFile, file, readOnly);
+    } else
+#endif
+    {
+        /*
+            We hold the lock. Let's reread the file if it has changed
+            since last time we read it.
+        */
+        QFileInfo fileInfo(confFile->name);
+        bool mustReadFile = true;
 
-    if (!readOnly)
-        mustReadFile = (confFile->size != fileInfo.size()
-                        || (confFile->size != 0 && confFile->timeStamp != fileInfo.lastModified()));
+        if (!readOnly)
+            mustReadFile = (confFile->size != fileInfo.size()
+                            || (confFile->size != 0 && confFile->timeStamp != fileInfo.lastModified()));
 
-    if (mustReadFile) {
-        confFile->unparsedIniSections.clear();
-        confFile->originalKeys.clear();
+        if (mustReadFile) {
+            confFile->unparsedIniSections.clear();
+            confFile->originalKeys.clear();
 
-        /*
-            Files that we can't read (because of permissions or
-            because they don't exist) are treated as empty files.
-        */
-        if (file.isReadable() && fileInfo.size() != 0) {
+            /*
+                Files that we can't read (because of permissions or
+                because they don't exist) are treated as empty files.
+            */
+            if (file.isReadable() && fileInfo.size() != 0) {
 #ifdef Q_OS_MAC
-            if (format == QSettings::NativeFormat) {
-                ok = readPlistFile(confFile->name, &confFile->originalKeys);
-            } else
+                if (format == QSettings::NativeFormat) {
+                    ok = readPlistFile(confFile->name, &confFile->originalKeys);
+                } else
 #endif
-            {
-                if (format <= QSettings::IniFormat) {
-                    QByteArray data = file.readAll();
-                    ok = readIniFile(data, &confFile->unparsedIniSections);
-                } else {
-                    if (readFunc) {
-                        QSettings::SettingsMap tempNewKeys;
-                        ok = readFunc(file, tempNewKeys);
-
-                        if (ok) {
-                            QSettings::SettingsMap::const_iterator i = tempNewKeys.constBegin();
-                            while (i != tempNewKeys.constEnd()) {
-                                confFile->originalKeys.insert(QSettingsKey(i.key(),
-                                                                           caseSensitivity),
-                                                              i.value());
-                                ++i;
+                {
+                    if (format <= QSettings::IniFormat) {
+                        QByteArray data = file.readAll();
+                        ok = readIniFile(data, &confFile->unparsedIniSections);
+                    } else {
+                        if (readFunc) {
+                            QSettings::SettingsMap tempNewKeys;
+                            ok = readFunc(file, tempNewKeys);
+
+                            if (ok) {
+                                QSettings::SettingsMap::const_iterator i = tempNewKeys.constBegin();
+                                while (i != tempNewKeys.constEnd()) {
+                                    confFile->originalKeys.insert(QSettingsKey(i.key(),
+                                                                               caseSensitivity),
+                                                                  i.value());
+                                    ++i;
+                                }
                             }
+                        } else {
+                            ok = false;
                         }
-                    } else {
-                        ok = false;
                     }
                 }
+
+                if (!ok)
+                    setStatus(QSettings::FormatError);
             }
 
-            if (!ok)
-                setStatus(QSettings::FormatError);
+            confFile->size = fileInfo.size();
+            confFile->timeStamp = fileInfo.lastModified();
         }
 
-        confFile->size = fileInfo.size();
-        confFile->timeStamp = fileInfo.lastModified();
-    }
-
-    /*
-        We also need to save the file. We still hold the file lock,
-        so everything is under control.
-    */
-    if (!readOnly) {
-        ensureAllSectionsParsed(confFile);
-        ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
+        /*
+            We also need to save the file. We still hold the file lock,
+            so everything is under control.
+        */
+        if (!readOnly) {
+            ensureAllSectionsParsed(confFile);
+            ParsedSettingsMap mergedKeys = confFile->mergedKeyMap();
 
-        if (file.isWritable()) {
+            if (file.isWritable()) {
 #ifdef Q_OS_MAC
-            if (format == QSettings::NativeFormat) {
-                ok = writePlistFile(confFile->name, mergedKeys);
-            } else
+                if (format == QSettings::NativeFormat) {
+                    ok = writePlistFile(confFile->name, mergedKeys);
+                } else
 #endif
-            {
-                file.seek(0);
-                file.resize(0);
-
-                if (format <= QSettings::IniFormat) {
-                    ok = writeIniFile(file, mergedKeys);
-                    if (!ok) {
-                        // try to restore old data; might work if the disk was full and the new data
-                        // was larger than the old data
-                        file.seek(0);
-                        file.resize(0);
-                        writeIniFile(file, confFile->originalKeys);
-                    }
-                } else {
-                    if (writeFunc) {
-                        QSettings::SettingsMap tempOriginalKeys;
-
-                        ParsedSettingsMap::const_iterator i = mergedKeys.constBegin();
-                        while (i != mergedKeys.constEnd()) {
-                            tempOriginalKeys.insert(i.key(), i.value());
-                            ++i;
+                {
+                    file.seek(0);
+                    file.resize(0);
+
+                    if (format <= QSettings::IniFormat) {
+                        ok = writeIniFile(file, mergedKeys);
+                        if (!ok) {
+                            // try to restore old data; might work if the disk was full and the new data
+                            // was larger than the old data
+                            file.seek(0);
+                            file.resize(0);
+                            writeIniFile(file, confFile->originalKeys);
                         }
-                        ok = writeFunc(file, tempOriginalKeys);
                     } else {
-                        ok = false;
+                        if (writeFunc) {
+                            QSettings::SettingsMap tempOriginalKeys;
+
+                            ParsedSettingsMap::const_iterator i = mergedKeys.constBegin();
+                            while (i != mergedKeys.constEnd()) {
+                                tempOriginalKeys.insert(i.key(), i.value());
+                                ++i;
+                            }
+                            ok = writeFunc(file, tempOriginalKeys);
+                        } else {
+                            ok = false;
+                        }
                     }
                 }
+            } else {
+                ok = false;
             }
-        } else {
-            ok = false;
-        }
 
-        if (ok) {
-            confFile->unparsedIniSections.clear();
-            confFile->originalKeys = mergedKeys;
-            confFile->addedKeys.clear();
-            confFile->removedKeys.clear();
+            if (ok) {
+                confFile->unparsedIniSections.clear();
+                confFile->originalKeys = mergedKeys;
+                confFile->addedKeys.clear();
+                confFile->removedKeys.clear();
 
-            QFileInfo fileInfo(confFile->name);
-            confFile->size = fileInfo.size();
-            confFile->timeStamp = fileInfo.lastModified();
-        } else {
-            setStatus(QSettings::AccessError);
+                QFileInfo fileInfo(confFile->name);
+                confFile->size = fileInfo.size();
+                confFile->timeStamp = fileInfo.lastModified();
+            } else {
+                setStatus(QSettings::AccessError);
+            }
         }
     }
 
@@ -1963,13 +1978,399 @@ bool QConfFileSettingsPrivate::writeIniFile(QIODevice &device, const ParsedSetti
     return !writeError;
 }
 
+#ifndef QT_NO_DATASTREAM
+
+/*
+    A JournalFormat file starts with a 20-byte header (a big endian
+    magic number and a random journal ID) followed by a sequence of
+    records. Each
+    record is a 6-byte header (payload size and qChecksum() of the
+    payload) and a QDataStream payload holding the operation, the key
+    and, for JournalSetKey, the value.
+
+    Writers only append records for the keys they changed. Readers
+    remember how far into the file they got and only replay what other
+    writers appended since. Replaying only checks the records and sorts
+    them by section; like the sections of an INI file, a section is
+    decoded when one of its keys is first needed. When the journal holds too many superseded
+    records, it is rewritten in place with one record per key and a
+    new journal ID, which tells other readers to replay it from the
+    start. The ID also catches journals that were deleted or replaced
+    by another file.
+*/
+static const quint32 JournalMagic = 0x514a726e; // "QJrn"
+enum {
+    JournalIdSize = 16,
+    JournalHeaderSize = 4 + JournalIdSize,
+    JournalRecordHeaderSize = 6,
+    JournalMinCompactRecords = 1024
+};
+enum JournalOperation { JournalSetKey = 1, JournalRemoveKey = 2 };
+
+static void appendJournalRecord(QDataStream &stream, QByteArray &block, JournalOperation op,
+                                const QString &key, const QVariant &value)
+{
+    static const char placeholder[JournalRecordHeaderSize] = { 0 };
+    int recordStart = block.size();
+    stream.writeRawData(placeholder, JournalRecordHeaderSize);
+    stream << quint8(op) << key;
+    if (op == JournalSetKey)
+        stream << value;
+
+    int payloadSize = block.size() - recordStart - JournalRecordHeaderSize;
+    uchar *header = reinterpret_cast<uchar *>(block.data() + recordStart);
+    qToBigEndian<quint32>(payloadSize, header);
+    qToBigEndian<quint16>(qChecksum(block.constData() + recordStart + JournalRecordHeaderSize,
+                                    payloadSize), header + 4);
+}
+
+/*
+    Computes the same CRC-16 as qChecksum(), four bytes at a time instead
+    of a nibble at a time. Every record is checked whenever a journal is
+    replayed from the start, and with qChecksum() that was the most
+    expensive part of opening a large journal.
+*/
+struct JournalChecksumTables
+{
+    JournalChecksumTables();
+    quint16 table[4][256];
+};
+
+JournalChecksumTables::JournalChecksumTables()
+{
+    for (int i = 0; i < 256; ++i) {
+        quint16 crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+        table[0][i] = crc;
+    }
+    for (int t = 1; t < 4; ++t) {
+        for (int i = 0; i < 256; ++i)
+            table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xff];
+    }
+}
+
+Q_GLOBAL_STATIC(JournalChecksumTables, journalChecksumTables)
+
+static quint16 journalChecksum(const char *data, uint len)
+{
+    const quint16 (*table)[256] = journalChecksumTables()->table;
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    uint crc = 0xffff;
+    for (; len >= 4; len -= 4, p += 4) {
+        crc ^= p[0] | (p[1] << 8);
+        crc = table[3][crc & 0xff] ^ table[2][crc >> 8] ^ table[1][p[2]] ^ table[0][p[3]];
+    }
+    while (len--)
+        crc = (crc >> 8) ^ table[0][(crc ^ *p++) & 0xff];
+    return ~crc & 0xffff;
+}
+
+/*
+    Checks the records in \a data and sorts them into \a sections by the
+    first component of their key, like the sections of an INI file, and
+    returns the number of bytes they take up. The records are not decoded
+    yet; ensureSectionParsed() replays a section with readJournalRecords()
+    when one of its keys is needed.
+
+    Stops at an incomplete record, or one that fails its checksum, at the
+    end of the data: that is what a writer that died halfway through an
+    append leaves behind, and the next append overwrites it. A bad record
+    anywhere else means the journal is corrupt, and \a corrupt is set to
+    true; the records after it are neither replayed nor overwritten.
+*/
+static int splitJournalRecords(const QByteArray &data, UnparsedSettingsMap *sections,
+                               Qt::CaseSensitivity cs, int *numRecords, bool *corrupt)
+{
+    const char *begin = data.constData();
+    const int size = data.size();
+    int pos = 0;
+
+    // compacted journals are sorted by key, so consecutive records usually
+    // share a section and are copied as one run
+    QByteArray *run = 0;
+    int runStart = 0;
+    QByteArray runSection;
+
+    while (size - pos >= JournalRecordHeaderSize) {
+        const uchar *header = reinterpret_cast<const uchar *>(begin + pos);
+        const quint32 payloadSize = qFromBigEndian<quint32>(header);
+        if (payloadSize > quint32(size - pos - JournalRecordHeaderSize))
+            break;
+
+        const int next = pos + JournalRecordHeaderSize + payloadSize;
+        const char *payload = begin + pos + JournalRecordHeaderSize;
+        if (journalChecksum(payload, payloadSize) != qFromBigEndian<quint16>(header + 4)) {
+            *corrupt = (next != size);
+            break;
+        }
+
+        // the payload starts with the operation and the key, a QString in
+        // QDataStream format: its size in bytes, then big endian UTF-16
+        quint32 keySize = payloadSize >= 5
+                          ? qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(payload + 1))
+                          : 0;
+        if (keySize == 0 || keySize % 2 || keySize > payloadSize - 5) {
+            *corrupt = true;
+            break;
+        }
+        const char *key = payload + 5;
+        quint32 sectionSize = 0;
+        while (sectionSize < keySize && !(key[sectionSize] == 0 && key[sectionSize + 1] == '/'))
+            sectionSize += 2;
+        sectionSize = sectionSize < keySize ? sectionSize + 2 : 0;
+
+        if (!run || quint32(runSection.size()) != sectionSize
+                || memcmp(runSection.constData(), key, sectionSize) != 0) {
+            if (run)
+                run->append(begin + runStart, pos - runStart);
+            QString section(sectionSize / 2, Qt::Uninitialized);
+            for (quint32 i = 0; i < sectionSize / 2; ++i)
+                section[i] = QChar(qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(key + 2 * i)));
+            run = &(*sections)[QSettingsKey(section, cs)];
+            runStart = pos;
+            runSection = QByteArray(key, sectionSize);
+        }
+        ++*numRecords;
+        pos = next;
+    }
+    if (run)
+        run->append(begin + runStart, pos - runStart);
+    return pos;
+}
+
+/*
+    Replays the records of one section, as sorted out by
+    splitJournalRecords(), into \a map. Returns false if a record can't be
+    decoded.
+*/
+static bool readJournalRecords(const QByteArray &data, ParsedSettingsMap *map,
+                               Qt::CaseSensitivity cs)
+{
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_2);
+    QIODevice *device = stream.device();
+    int pos = 0;
+
+    while (pos < data.size()) {
+        const uchar *header = reinterpret_cast<const uchar *>(data.constData() + pos);
+        int next = pos + JournalRecordHeaderSize + qFromBigEndian<quint32>(header);
+        device->seek(pos + JournalRecordHeaderSize);
+        quint8 op;
+        QString key;
+        QVariant value;
+        stream >> op >> key;
+        if (op == JournalSetKey)
+            stream >> value;
+        if (stream.status() != QDataStream::Ok || device->pos() != next || key.isEmpty()
+                || (op != JournalSetKey && op != JournalRemoveKey))
+            return false;
+
+        // compacted journals are sorted by key, so try appending first
+        if (op == JournalSetKey)
+            map->insert(map->constEnd(), QSettingsKey(key, cs), value);
+        else
+            map->remove(QSettingsKey(key, cs));
+        pos = next;
+    }
+    return true;
+}
+
+/*
+    Called by syncConfFile() with the file lock held.
+*/
+void QConfFileSettingsPrivate::syncJournalFile(QConfFile *confFile, QFile &file, bool readOnly)
+{
+    qint64 fileSize = file.isReadable() ? file.size() : 0;
+    qint64 validSize = 0;
+    bool corrupt = false;
+
+    /*
+        Catch up with what the other writers appended since we last
+        looked, or replay the whole journal if it was compacted (or
+        replaced) in the meantime.
+    */
+    QByteArray journalId;
+    if (fileSize > 0) {
+        file.seek(0);
+        QByteArray header = file.read(JournalHeaderSize);
+        if (header.size() != JournalHeaderSize
+                || qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(header.constData()))
+                   != JournalMagic) {
+            confFile->unparsedIniSections.clear();
+            confFile->originalKeys.clear();
+            confFile->journalRecords = 0;
+            setStatus(QSettings::FormatError);
+        } else {
+            journalId = header.mid(4);
+            qint64 from = confFile->size;
+            const bool replayAll = journalId != confFile->journalId
+                                   || from < JournalHeaderSize || from > fileSize;
+            if (replayAll) {
+                confFile->unparsedIniSections.clear();
+                confFile->originalKeys.clear();
+                confFile->journalRecords = 0;
+                from = JournalHeaderSize;
+            }
+
+            validSize = from;
+            if (from < fileSize) {
+                file.seek(from);
+                QByteArray data = file.read(fileSize - from);
+                UnparsedSettingsMap sections;
+                validSize += splitJournalRecords(data, &sections, caseSensitivity,
+                                                 &confFile->journalRecords, &corrupt);
+                if (corrupt)
+                    setStatus(QSettings::FormatError);
+
+                /*
+                    Sections that haven't been looked at yet stay undecoded;
+                    new records for them go after the ones already waiting.
+                    Sections that have been decoded get the new records
+                    replayed right away.
+                */
+                UnparsedSettingsMap::const_iterator i;
+                for (i = sections.constBegin(); i != sections.constEnd(); ++i) {
+                    UnparsedSettingsMap::iterator j = confFile->unparsedIniSections.find(i.key());
+                    if (j != confFile->unparsedIniSections.end())
+                        j.value() += i.value();
+                    else if (replayAll)
+                        confFile->unparsedIniSections.insert(i.key(), i.value());
+                    else if (!readJournalRecords(i.value(), &confFile->originalKeys, caseSensitivity))
+                        setStatus(QSettings::FormatError);
+                }
+            }
+        }
+    } else {
+        confFile->unparsedIniSections.clear();
+        confFile->originalKeys.clear();
+        confFile->journalRecords = 0;
+    }
+
+    /*
+        Don't write to a corrupt journal: truncating it at the bad record
+        would destroy the valid records after it, and appending after
+        them would add records that nobody replays. The changes stay
+        pending, and status() reports the FormatError.
+    */
+    if (!readOnly && !corrupt) {
+        ParsedSettingsMap &originalKeys = confFile->originalKeys;
+
+        // the changed keys are compared with their current values, and
+        // compacting needs all of them
+        ParsedSettingsMap::const_iterator i;
+        for (i = confFile->removedKeys.constBegin(); i != confFile->removedKeys.constEnd(); ++i)
+            ensureSectionParsed(confFile, i.key());
+        for (i = confFile->addedKeys.constBegin(); i != confFile->addedKeys.constEnd(); ++i)
+            ensureSectionParsed(confFile, i.key());
+        const int maxRecords = confFile->journalRecords + confFile->addedKeys.size()
+                               + confFile->removedKeys.size();
+        if (maxRecords > qMax(2 * originalKeys.size(), int(JournalMinCompactRecords)))
+            ensureAllSectionsParsed(confFile);
+
+        const int compactThreshold = qMax(2 * originalKeys.size(), int(JournalMinCompactRecords));
+        QByteArray block;
+        QBuffer buffer(&block);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream stream(&buffer);
+        stream.setVersion(QDataStream::Qt_5_2);
+        int numRecords = confFile->journalRecords;
+        bool compact = validSize == 0 || numRecords > compactThreshold;
+
+        if (!compact) {
+            for (i = confFile->removedKeys.constBegin(); i != confFile->removedKeys.constEnd(); ++i) {
+                if (originalKeys.contains(i.key()) && !confFile->addedKeys.contains(i.key())) {
+                    appendJournalRecord(stream, block, JournalRemoveKey, i.key().originalCaseKey(),
+                                        QVariant());
+                    ++numRecords;
+                }
+            }
+            for (i = confFile->addedKeys.constBegin(); i != confFile->addedKeys.constEnd(); ++i) {
+                ParsedSettingsMap::const_iterator j = originalKeys.constFind(i.key());
+                if (j == originalKeys.constEnd() || j.value() != i.value()) {
+                    appendJournalRecord(stream, block, JournalSetKey, i.key().originalCaseKey(), i.value());
+                    ++numRecords;
+                }
+            }
+            compact = numRecords > compactThreshold;
+        }
+
+        ParsedSettingsMap mergedKeys;
+        QByteArray newJournalId;
+        if (compact) {
+            mergedKeys = confFile->mergedKeyMap();
+            newJournalId = QUuid::createUuid().toRfc4122();
+            buffer.seek(0);
+            block.clear();
+            stream << JournalMagic;
+            stream.writeRawData(newJournalId.constData(), newJournalId.size());
+
+            for (i = mergedKeys.constBegin(); i != mergedKeys.constEnd(); ++i)
+                appendJournalRecord(stream, block, JournalSetKey, i.key().originalCaseKey(), i.value());
+            numRecords = mergedKeys.size();
+            validSize = 0;
+        }
+
+        bool ok = file.isWritable();
+        if (ok && compact) {
+            /*
+                Overwrite the old journal from the start instead of
+                truncating it first: the compacted journal is usually
+                smaller, so this doesn't need more disk space. If it
+                fails anyway, try to put the old contents back.
+            */
+            QByteArray oldData;
+            if (fileSize > 0) {
+                file.seek(0);
+                oldData = file.readAll();
+            }
+            ok = file.seek(0) && file.write(block) == block.size() && file.flush()
+                 && file.resize(block.size());
+            if (!ok && file.seek(0) && file.write(oldData) == oldData.size() && file.flush())
+                file.resize(oldData.size());
+        } else if (ok && !block.isEmpty()) {
+            if (validSize < file.size())
+                ok = file.resize(validSize);
+            ok = ok && file.seek(validSize) && file.write(block) == block.size() && file.flush();
+            // drop a partial append
+            if (!ok)
+                file.resize(validSize);
+        }
+
+        if (ok) {
+            if (compact) {
+                journalId = newJournalId;
+                originalKeys = mergedKeys;
+            } else {
+                // same as mergedKeyMap(), without copying all the keys
+                for (i = confFile->removedKeys.constBegin(); i != confFile->removedKeys.constEnd(); ++i)
+                    originalKeys.remove(i.key());
+                for (i = confFile->addedKeys.constBegin(); i != confFile->addedKeys.constEnd(); ++i)
+                    originalKeys.insert(i.key(), i.value());
+            }
+            confFile->addedKeys.clear();
+            confFile->removedKeys.clear();
+            confFile->journalRecords = numRecords;
+            validSize += block.size();
+        } else {
+            setStatus(QSettings::AccessError);
+        }
+    }
+
+    confFile->journalId = journalId;
+    confFile->size = validSize;
+    confFile->timeStamp = QFileInfo(confFile->name).lastModified();
+}
+
+#endif // QT_NO_DATASTREAM
+
 void QConfFileSettingsPrivate::ensureAllSectionsParsed(QConfFile *confFile) const
 {
     UnparsedSettingsMap::const_iterator i = confFile->unparsedIniSections.constBegin();
     const UnparsedSettingsMap::const_iterator end = confFile->unparsedIniSections.constEnd();
 
     for (; i != end; ++i) {
-        if (!QConfFileSettingsPrivate::readIniSection(i.key(), i.value(), &confFile->originalKeys, iniCodec))
+        if (!readSection(i.key(), i.value(), &confFile->originalKeys))
             setStatus(QSettings::FormatError);
     }
     confFile->unparsedIniSections.clear();
@@ -1997,11 +2398,25 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
             return;
     }
 
-    if (!QConfFileSettingsPrivate::readIniSection(i.key(), i.value(), &confFile->originalKeys, iniCodec))
+    if (!readSection(i.key(), i.value(), &confFile->originalKeys))
         setStatus(QSettings::FormatError);
     confFile->unparsedIniSections.erase(i);
 }
 
+/*
+    Parses a section left in unparsedIniSections: the text of an INI
+    section, or the records of a journal that belong to one section.
+*/
+bool QConfFileSettingsPrivate::readSection(const QSettingsKey &section, const QByteArray &data,
+                                           ParsedSettingsMap *settingsMap) const
+{
+#ifndef QT_NO_DATASTREAM
+    if (format == QSettings::JournalFormat)
+        return readJournalRecords(data, settingsMap, caseSensitivity);
+#endif
+    return readIniSection(section, data, settingsMap, iniCodec);
+}
+
 /*!
     \class QSettings
     \inmodule QtCore
@@ -2270,6 +2685,12 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
     imports changes made by other processes (in addition to writing
     the changes from this QSettings).
 
+    With IniFormat, every sync() that has changes to write rereads and
+    rewrites the whole file. Applications that keep many keys in one
+    file and sync it often can use QSettings::JournalFormat instead,
+    where the cost of sync() depends on the number of changed keys
+    rather than on the size of the file.
+
     \section1 Platform-Specific Notes
 
     \section2 Locations Where Application Settings Are Stored
@@ -2478,6 +2899,14 @@ void QConfFileSettingsPrivate::ensureSectionParsed(QConfFile *confFile,
                          API; on Unix, this means textual
                          configuration files in INI format.
     \value IniFormat  Store the settings in INI files.
+    \value JournalFormat  Store the settings in a binary, append-only
+                          journal (with the \c .journal extension).
+                          sync() only writes the keys that changed
+                          and only reads back what other processes
+                          appended since the last sync(); the file
+                          is compacted when it accumulates too many
+                          superseded entries. This value was
+                          introduced in Qt 5.3.
     \value InvalidFormat Special value returned by registerFormat().
     \omitvalue CustomFormat1
     \omitvalue CustomFormat2
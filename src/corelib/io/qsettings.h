@@ -86,6 +86,7 @@ public:
     enum Format {
         NativeFormat,
         IniFormat,
+        JournalFormat,
 
         InvalidFormat = 16,
         CustomFormat1,
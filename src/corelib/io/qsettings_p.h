@@ -66,6 +66,8 @@
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
+
 #ifndef Q_OS_WIN
 #define QT_QSETTINGS_ALWAYS_CASE_SENSITIVE_AND_FORGET_ORIGINAL_KEY_ORDER
 #endif
@@ -161,6 +163,8 @@ public:
     ParsedSettingsMap originalKeys;
     ParsedSettingsMap addedKeys;
     ParsedSettingsMap removedKeys;
+    QByteArray journalId;
+    int journalRecords;
     QAtomicInt ref;
     QMutex mutex;
     bool userPerms;
@@ -297,12 +301,17 @@ private:
     void initAccess();
     void syncConfFile(int confFileNo);
     bool writeIniFile(QIODevice &device, const ParsedSettingsMap &map);
+#ifndef QT_NO_DATASTREAM
+    void syncJournalFile(QConfFile *confFile, QFile &file, bool readOnly);
+#endif
 #ifdef Q_OS_MAC
     bool readPlistFile(const QString &fileName, ParsedSettingsMap *map) const;
     bool writePlistFile(const QString &fileName, const ParsedSettingsMap &map) const;
 #endif
     void ensureAllSectionsParsed(QConfFile *confFile) const;
     void ensureSectionParsed(QConfFile *confFile, const QSettingsKey &key) const;
+    bool readSection(const QSettingsKey &section, const QByteArray &data,
+                     ParsedSettingsMap *settingsMap) const;
 
     QScopedSharedPointer<QConfFile> confFiles[NumConfFiles];
     QSettings::ReadFunc readFunc;
@@ -129,12 +129,27 @@ void Data::compact()
     header = h;
     this->alloc = alloc;
     compactionCounter = 0;
+
+    if (validationCache) {
+        // everything below the root has moved
+        validationCache->states.clear();
+        validationCache->states.insert(sizeof(Header), ValidationCache::Shallow);
+    }
 }
 
-bool Data::valid() const
+bool Data::validHeader() const
 {
+    if (alloc < int(sizeof(Header) + sizeof(Base)))
+        return false;
     if (header->tag != QJsonDocument::BinaryFormatTag || header->version != 1u)
         return false;
+    return header->root()->size <= alloc - sizeof(Header);
+}
+
+bool Data::valid() const
+{
+    if (!validHeader())
+        return false;
 
     bool res = false;
     if (header->root()->is_object)
@@ -145,6 +160,36 @@ bool Data::valid() const
     return res;
 }
 
+bool Data::validate(const Base *b, bool recursive) const
+{
+    Q_ASSERT(validationCache);
+    QMutexLocker locker(&validationCache->mutex);
+    int &state = validationCache->states[offsetOf(b)];
+    if (state == ValidationCache::Invalid)
+        return false;
+    if (state == ValidationCache::Recursive || (state == ValidationCache::Shallow && !recursive))
+        return true;
+
+    bool res;
+    if (b->isObject())
+        res = static_cast<const Object *>(b)->isValid(recursive);
+    else
+        res = static_cast<const Array *>(b)->isValid(recursive);
+    if (!res)
+        state = ValidationCache::Invalid;
+    else
+        state = recursive ? ValidationCache::Recursive : ValidationCache::Shallow;
+    return res;
+}
+
+int Data::validationState(const Base *b) const
+{
+    if (!validationCache)
+        return ValidationCache::Recursive;
+    QMutexLocker locker(&validationCache->mutex);
+    return validationCache->states.value(offsetOf(b), ValidationCache::Unchecked);
+}
+
 
 int Base::reserveSpace(uint dataSize, int posInTable, uint numItems, bool replace)
 {
@@ -203,7 +248,7 @@ int Object::indexOf(const QString &key, bool *exists)
     return min;
 }
 
-bool Object::isValid() const
+bool Object::isValid(bool recursive) const
 {
     if (tableOffset + length*sizeof(offset) > size)
         return false;
@@ -216,7 +261,7 @@ bool Object::isValid() const
         int s = e->size();
         if (table()[i] + s > tableOffset)
             return false;
-        if (!e->value.isValid(this))
+        if (!e->value.isValid(this, recursive))
             return false;
     }
     return true;
@@ -224,13 +269,13 @@ bool Object::isValid() const
 
 
 
-bool Array::isValid() const
+bool Array::isValid(bool recursive) const
 {
     if (tableOffset + length*sizeof(offset) > size)
         return false;
 
     for (uint i = 0; i < length; ++i) {
-        if (!at(i).isValid(this))
+        if (!at(i).isValid(this, recursive))
             return false;
     }
     return true;
@@ -299,7 +344,7 @@ int Value::usedStorage(const Base *b) const
     return alignedSize(s);
 }
 
-bool Value::isValid(const Base *b) const
+bool Value::isValid(const Base *b, bool recursive) const
 {
     int offset = 0;
     switch (type) {
@@ -318,16 +363,23 @@ bool Value::isValid(const Base *b) const
         break;
     }
 
+    // a nested array or object is always stored after its parent's header and is
+    // strictly smaller than its parent; anything else could make the tree a cycle
+    const bool isContainer = (type == QJsonValue::Array || type == QJsonValue::Object);
     if (!offset)
-        return true;
+        return !isContainer;
     if (offset + sizeof(uint) > b->tableOffset)
         return false;
+    if (isContainer && (offset + sizeof(Base) > b->tableOffset || base(b)->size < sizeof(Base)))
+        return false;
 
     int s = usedStorage(b);
     if (!s)
         return true;
     if (s < 0 || offset + s > (int)b->tableOffset)
         return false;
+    if (!recursive)
+        return true;
     if (type == QJsonValue::Array)
         return static_cast<Array *>(base(b))->isValid();
     if (type == QJsonValue::Object)
@@ -355,6 +407,11 @@ int Value::requiredStorage(QJsonValue &v, bool *compressed)
     }
     case QJsonValue::Array:
     case QJsonValue::Object:
+        // the whole subtree gets copied, so it has to be checked as a whole
+        if (v.d && v.base && !v.d->ensureValid(v.base, true)) {
+            v.base = 0;
+            return sizeof(QJsonPrivate::Base);
+        }
         if (v.d && v.d->compactionCounter) {
             v.detach();
             v.d->compact();
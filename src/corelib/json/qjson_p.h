@@ -58,6 +58,9 @@
 #include <qjsondocument.h>
 #include <qjsonarray.h>
 #include <qatomic.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qmutex.h>
 #include <qstring.h>
 #include <qendian.h>
 #include <qnumeric.h>
@@ -338,8 +341,19 @@ public:
         return !operator ==(str);
     }
     inline bool operator >=(const QString &str) const {
-        // ###
-        return toString() >= str;
+        // compare in place, this is used for every step of a key lookup
+        const int alen = d->length;
+        const int blen = str.length();
+        const qle_ushort *a = d->utf16;
+        const ushort *b = reinterpret_cast<const ushort *>(str.constData());
+        const ushort *e = b + qMin(alen, blen);
+        while (b < e && *a == *b) {
+            ++a;
+            ++b;
+        }
+        if (b == e)
+            return alen >= blen;
+        return ushort(*a) > *b;
     }
 
     inline bool operator<(const Latin1String &str) const;
@@ -528,7 +542,7 @@ public:
     }
     int indexOf(const QString &key, bool *exists);
 
-    bool isValid() const;
+    bool isValid(bool recursive = true) const;
 };
 
 
@@ -538,7 +552,7 @@ public:
     inline Value at(int i) const;
     inline Value &operator [](int i);
 
-    bool isValid() const;
+    bool isValid(bool recursive = true) const;
 };
 
 
@@ -567,7 +581,7 @@ public:
     Latin1String asLatin1String(const Base *b) const;
     Base *base(const Base *b) const;
 
-    bool isValid(const Base *b) const;
+    bool isValid(const Base *b, bool recursive = true) const;
 
     static int requiredStorage(QJsonValue &v, bool *compressed);
     static uint valueToStore(const QJsonValue &v, uint offset);
@@ -695,6 +709,27 @@ inline Base *Value::base(const Base *b) const
     return reinterpret_cast<Base *>(data(b));
 }
 
+/*
+ Documents loaded with QJsonDocument::ValidateOnAccess are not checked as a whole. Instead every
+ object and array is checked, non-recursively, the first time a QJsonObject or QJsonArray is created
+ for it, and the result is remembered here by offset from the start of the data. Anything that walks
+ a subtree without going through QJsonObject or QJsonArray (the writer, or copying a value into
+ another document) asks for a recursive check first.
+ */
+class ValidationCache
+{
+public:
+    enum State {
+        Unchecked,
+        Shallow,
+        Recursive,
+        Invalid
+    };
+
+    QMutex mutex;
+    QHash<uint, int> states;
+};
+
 class Data {
 public:
     enum Validation {
@@ -711,13 +746,15 @@ public:
     };
     uint compactionCounter : 31;
     uint ownsData : 1;
+    ValidationCache *validationCache;
+    QFile *mappedFile;
 
     inline Data(char *raw, int a)
-        : alloc(a), rawData(raw), compactionCounter(0), ownsData(true)
+        : alloc(a), rawData(raw), compactionCounter(0), ownsData(true), validationCache(0), mappedFile(0)
     {
     }
     inline Data(int reserved, QJsonValue::Type valueType)
-        : rawData(0), compactionCounter(0), ownsData(true)
+        : rawData(0), compactionCounter(0), ownsData(true), validationCache(0), mappedFile(0)
     {
         Q_ASSERT(valueType == QJsonValue::Array || valueType == QJsonValue::Object);
 
@@ -733,7 +770,12 @@ public:
         b->length = 0;
     }
     inline ~Data()
-    { if (ownsData) free(rawData); }
+    {
+        if (ownsData)
+            free(rawData);
+        delete validationCache;
+        delete mappedFile;
+    }
 
     uint offsetOf(const void *ptr) const { return (uint)(((char *)ptr - rawData)); }
 
@@ -750,7 +792,7 @@ public:
     Data *clone(Base *b, int reserve = 0)
     {
         int size = sizeof(Header) + b->size;
-        if (b == header->root() && ref.load() == 1 && alloc >= size + reserve)
+        if (b == header->root() && ref.load() == 1 && ownsData && alloc >= size + reserve)
             return this;
 
         if (reserve) {
@@ -766,12 +808,23 @@ public:
         h->version = 1;
         Data *d = new Data(raw, size);
         d->compactionCounter = (b == header->root()) ? compactionCounter : 0;
+        if (validationCache) {
+            d->validationCache = new ValidationCache;
+            d->validationCache->states.insert(sizeof(Header), validationState(b));
+        }
         return d;
     }
 
     void compact();
+    bool validHeader() const;
     bool valid() const;
 
+    // true if b may be accessed; always the case unless the data is validated on access
+    inline bool ensureValid(const Base *b, bool recursive = false) const
+    { return !validationCache || validate(b, recursive); }
+    bool validate(const Base *b, bool recursive) const;
+    int validationState(const Base *b) const;
+
 private:
     Q_DISABLE_COPY(Data)
 };
@@ -145,6 +145,12 @@ QJsonArray::QJsonArray(QJsonPrivate::Data *data, QJsonPrivate::Array *array)
 {
     Q_ASSERT(data);
     Q_ASSERT(array);
+    if (!d->ensureValid(a)) {
+        // a broken part of a document that is validated on access
+        d = 0;
+        a = 0;
+        return;
+    }
     d->ref.ref();
 }
 
@@ -1064,7 +1070,8 @@ void QJsonArray::detach(uint reserve)
         d->ref.ref();
         return;
     }
-    if (reserve == 0 && d->ref.load() == 1)
+    // data that isn't ours (fromRawData() or a mapped file) is never written to
+    if (reserve == 0 && d->ref.load() == 1 && d->ownsData)
         return;
 
     QJsonPrivate::Data *x = d->clone(a, reserve);
@@ -1092,7 +1099,7 @@ void QJsonArray::compact()
 #if !defined(QT_NO_DEBUG_STREAM) && !defined(QT_JSON_READONLY)
 QDebug operator<<(QDebug dbg, const QJsonArray &a)
 {
-    if (!a.a) {
+    if (!a.a || !a.d->ensureValid(a.a, true)) {
         dbg << "QJsonArray()";
         return dbg;
     }
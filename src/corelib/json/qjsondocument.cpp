@@ -43,6 +43,8 @@
 #include <qjsonobject.h>
 #include <qjsonvalue.h>
 #include <qjsonarray.h>
+#include <qfile.h>
+#include <qscopedpointer.h>
 #include <qstringlist.h>
 #include <qvariant.h>
 #include <qdebug.h>
@@ -74,8 +76,8 @@ QT_BEGIN_NAMESPACE
     and isObject(). The array or object contained in the document can be retrieved using
     array() or object() and then read or manipulated.
 
-    A document can also be created from a stored binary representation using fromBinaryData() or
-    fromRawData().
+    A document can also be created from a stored binary representation using fromBinaryData(),
+    fromRawData() or, without reading the whole file, fromBinaryFile().
 
     \sa {JSON Support in Qt}, {JSON Save Game Example}
 */
@@ -157,14 +159,41 @@ QJsonDocument &QJsonDocument::operator =(const QJsonDocument &other)
 /*! \enum QJsonDocument::DataValidation
 
   This value is used to tell QJsonDocument whether to validate the binary data
-  when converting to a QJsonDocument using fromBinaryData() or fromRawData().
+  when converting to a QJsonDocument using fromBinaryData(), fromRawData() or
+  fromBinaryFile().
 
   \value Validate Validate the data before using it. This is the default.
   \value BypassValidation Bypasses data validation. Only use if you received the
   data from a trusted place and know it's valid, as using of invalid data can crash
   the application.
+  \value ValidateOnAccess Only check the header and the top-level object or array
+  up front, and check every other object and array the first time it is accessed.
+  A part of the document that turns out to be invalid is treated as an empty
+  object or array. Converting the document back to JSON, or copying a value into
+  another document, checks the affected part completely. This value was added in
+  Qt 5.3.
   */
 
+/*
+  Checks \a d according to \a validation and sets it up for validation
+  on access. Returns false if \a d must not be used.
+ */
+static bool checkData(QJsonPrivate::Data *d, QJsonDocument::DataValidation validation)
+{
+    switch (validation) {
+    case QJsonDocument::Validate:
+        return d->valid();
+    case QJsonDocument::BypassValidation:
+        return true;
+    case QJsonDocument::ValidateOnAccess:
+        break;
+    }
+    if (!d->validHeader())
+        return false;
+    d->validationCache = new QJsonPrivate::ValidationCache;
+    return d->ensureValid(d->header->root());
+}
+
 /*!
  Creates a QJsonDocument that uses the first \a size bytes from
  \a data. It assumes \a data contains a binary encoded JSON document.
@@ -192,7 +221,7 @@ QJsonDocument QJsonDocument::fromRawData(const char *data, int size, DataValidat
     QJsonPrivate::Data *d = new QJsonPrivate::Data((char *)data, size);
     d->ownsData = false;
 
-    if (validation != BypassValidation && !d->valid()) {
+    if (!checkData(d, validation)) {
         delete d;
         return QJsonDocument();
     }
@@ -249,7 +278,61 @@ QJsonDocument QJsonDocument::fromBinaryData(const QByteArray &data, DataValidati
     memcpy(raw, data.constData(), size);
     QJsonPrivate::Data *d = new QJsonPrivate::Data(raw, size);
 
-    if (validation != BypassValidation && !d->valid()) {
+    if (!checkData(d, validation)) {
+        delete d;
+        return QJsonDocument();
+    }
+
+    return QJsonDocument(d);
+}
+
+/*!
+ \since 5.3
+
+ Creates a QJsonDocument from the binary JSON file \a fileName, as
+ written by toBinaryData(), by mapping the file into memory with
+ QFile::map() instead of reading it. Nothing is copied until the
+ document, or an object or array taken from it, is modified.
+
+ \a validation decides how the data is checked. The default,
+ ValidateOnAccess, only checks the parts of the document that are
+ actually used, so loading a large file takes constant time and only
+ the pages that are accessed are read from disk. Object keys are
+ stored sorted, so QJsonObject::value() is a binary search that does
+ not touch the rest of the object.
+
+ The file is kept open and mapped for as long as any QJsonDocument,
+ QJsonObject, QJsonArray or QJsonValue references the data. It must
+ not be modified during that time.
+
+ Returns a null document if the file cannot be opened or does not
+ contain a valid binary JSON document. Files that cannot be mapped,
+ such as compressed resources, are read into memory instead.
+
+ \sa fromBinaryData(), fromRawData(), toBinaryData(), DataValidation
+ */
+QJsonDocument QJsonDocument::fromBinaryFile(const QString &fileName, DataValidation validation)
+{
+    QScopedPointer<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::ReadOnly))
+        return QJsonDocument();
+
+    const qint64 size = file->size();
+    if (size < qint64(sizeof(QJsonPrivate::Header) + sizeof(QJsonPrivate::Base)) || size > INT_MAX)
+        return QJsonDocument();
+
+    uchar *data = file->map(0, size);
+    if (!data || (quintptr(data) & 3)) {
+        if (data)
+            file->unmap(data);
+        return fromBinaryData(file->readAll(), validation);
+    }
+
+    QJsonPrivate::Data *d = new QJsonPrivate::Data(reinterpret_cast<char *>(data), int(size));
+    d->ownsData = false;
+    d->mappedFile = file.take();
+
+    if (!checkData(d, validation)) {
         delete d;
         return QJsonDocument();
     }
@@ -343,7 +426,7 @@ QByteArray QJsonDocument::toJson() const
 #ifndef QT_JSON_READONLY
 QByteArray QJsonDocument::toJson(JsonFormat format) const
 {
-    if (!d)
+    if (!d || !d->ensureValid(d->header->root(), true))
         return QByteArray();
 
     QByteArray json;
@@ -569,7 +652,7 @@ bool QJsonDocument::isNull() const
 #if !defined(QT_NO_DEBUG_STREAM) && !defined(QT_JSON_READONLY)
 QDebug operator<<(QDebug dbg, const QJsonDocument &o)
 {
-    if (!o.d) {
+    if (!o.d || !o.d->ensureValid(o.d->header->root(), true)) {
         dbg << "QJsonDocument()";
         return dbg;
     }
@@ -123,6 +123,12 @@ QJsonObject::QJsonObject(QJsonPrivate::Data *data, QJsonPrivate::Object *object)
 {
     Q_ASSERT(d);
     Q_ASSERT(o);
+    if (!d->ensureValid(o)) {
+        // a broken part of a document that is validated on access
+        d = 0;
+        o = 0;
+        return;
+    }
     d->ref.ref();
 }
 
@@ -980,7 +986,8 @@ void QJsonObject::detach(uint reserve)
         d->ref.ref();
         return;
     }
-    if (reserve == 0 && d->ref.load() == 1)
+    // data that isn't ours (fromRawData() or a mapped file) is never written to
+    if (reserve == 0 && d->ref.load() == 1 && d->ownsData)
         return;
 
     QJsonPrivate::Data *x = d->clone(o, reserve);
@@ -1041,7 +1048,7 @@ void QJsonObject::setValueAt(int i, const QJsonValue &val)
 #if !defined(QT_NO_DEBUG_STREAM) && !defined(QT_JSON_READONLY)
 QDebug operator<<(QDebug dbg, const QJsonObject &o)
 {
-    if (!o.o) {
+    if (!o.o || !o.d->ensureValid(o.o, true)) {
         dbg << "QJsonObject()";
         return dbg;
     }
@@ -251,16 +251,7 @@ void Parser::eatBOM()
 
 bool Parser::eatSpace()
 {
-    while (json < end) {
-        if (*json > Space)
-            break;
-        if (*json != Space &&
-            *json != Tab &&
-            *json != LineFeed &&
-            *json != Return)
-            break;
-        ++json;
-    }
+    json = skipWhitespace(json, end);
     return (json < end);
 }
 
@@ -698,30 +689,27 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
         return false;
     }
 
-    QByteArray number(start, json - start);
-    DEBUG << "numberstring" << number;
-
-    if (isInt) {
-        bool ok;
-        int n = number.toInt(&ok);
-        if (ok && n < (1<<25) && n > -(1<<25)) {
-            val->int_value = n;
-            val->latinOrIntValue = true;
-            END;
-            return true;
-        }
-    }
-
-    bool ok;
     union {
         quint64 ui;
         double d;
     };
-    d = number.toDouble(&ok);
+    if (!convertNumberFast(start, json, &d)) {
+        QByteArray number(start, json - start);
+        DEBUG << "numberstring" << number;
 
-    if (!ok) {
-        lastError = QJsonParseError::IllegalNumber;
-        return false;
+        bool ok;
+        d = number.toDouble(&ok);
+        if (!ok) {
+            lastError = QJsonParseError::IllegalNumber;
+            return false;
+        }
+    }
+
+    if (isInt && d < (1<<25) && d > -(1<<25)) {
+        val->int_value = int(d);
+        val->latinOrIntValue = true;
+        END;
+        return true;
     }
 
     int pos = reserveSpace(sizeof(double));
@@ -759,109 +747,6 @@ bool Parser::parseNumber(QJsonPrivate::Value *val, int baseOffset)
 
         unescaped = %x20-21 / %x23-5B / %x5D-10FFFF
  */
-static inline bool addHexDigit(char digit, uint *result)
-{
-    *result <<= 4;
-    if (digit >= '0' && digit <= '9')
-        *result |= (digit - '0');
-    else if (digit >= 'a' && digit <= 'f')
-        *result |= (digit - 'a') + 10;
-    else if (digit >= 'A' && digit <= 'F')
-        *result |= (digit - 'A') + 10;
-    else
-        return false;
-    return true;
-}
-
-static inline bool scanEscapeSequence(const char *&json, const char *end, uint *ch)
-{
-    ++json;
-    if (json >= end)
-        return false;
-
-    DEBUG << "scan escape" << (char)*json;
-    uint escaped = *json++;
-    switch (escaped) {
-    case '"':
-        *ch = '"'; break;
-    case '\\':
-        *ch = '\\'; break;
-    case '/':
-        *ch = '/'; break;
-    case 'b':
-        *ch = 0x8; break;
-    case 'f':
-        *ch = 0xc; break;
-    case 'n':
-        *ch = 0xa; break;
-    case 'r':
-        *ch = 0xd; break;
-    case 't':
-        *ch = 0x9; break;
-    case 'u': {
-        *ch = 0;
-        if (json > end - 4)
-            return false;
-        for (int i = 0; i < 4; ++i) {
-            if (!addHexDigit(*json, ch))
-                return false;
-            ++json;
-        }
-        return true;
-    }
-    default:
-        // this is not as strict as one could be, but allows for more Json files
-        // to be parsed correctly.
-        *ch = escaped;
-        return true;
-    }
-    return true;
-}
-
-static inline bool scanUtf8Char(const char *&json, const char *end, uint *result)
-{
-    int need;
-    uint min_uc;
-    uint uc;
-    uchar ch = *json++;
-    if (ch < 128) {
-        *result = ch;
-        return true;
-    } else if ((ch & 0xe0) == 0xc0) {
-        uc = ch & 0x1f;
-        need = 1;
-        min_uc = 0x80;
-    } else if ((ch & 0xf0) == 0xe0) {
-        uc = ch & 0x0f;
-        need = 2;
-        min_uc = 0x800;
-    } else if ((ch&0xf8) == 0xf0) {
-        uc = ch & 0x07;
-        need = 3;
-        min_uc = 0x10000;
-    } else {
-        return false;
-    }
-
-    if (json >= end - need)
-        return false;
-
-    for (int i = 0; i < need; ++i) {
-        ch = *json++;
-        if ((ch&0xc0) != 0x80)
-            return false;
-        uc = (uc << 6) | (ch & 0x3f);
-    }
-
-    if (uc < min_uc ||
-        QChar::isSurrogate(uc) || uc > QChar::LastValidCodePoint) {
-        return false;
-    }
-
-    *result = uc;
-    return true;
-}
-
 bool Parser::parseString(bool *latin1)
 {
     *latin1 = true;
@@ -873,7 +758,18 @@ bool Parser::parseString(bool *latin1)
 
     int stringPos = reserveSpace(2);
     BEGIN << "parse string stringPos=" << stringPos << json;
+    // a latin1 string must not get longer than 0x8000, see below
+    const char *latin1End = (end - start > 0x7fff) ? start + 0x7fff : end;
     while (json < end) {
+        const char *run = scanPlainString(json, latin1End);
+        if (run != json) {
+            const int length = run - json;
+            int pos = reserveSpace(length);
+            memcpy(data + pos, json, length);
+            json = run;
+            continue;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
@@ -922,6 +818,15 @@ bool Parser::parseString(bool *latin1)
     current = outStart + sizeof(int);
 
     while (json < end) {
+        const char *run = scanPlainString(json, end);
+        if (run != json) {
+            int pos = reserveSpace(2 * (run - json));
+            QJsonPrivate::qle_ushort *out = reinterpret_cast<QJsonPrivate::qle_ushort *>(data + pos);
+            while (json < run)
+                *out++ = ushort(uchar(*json++));
+            continue;
+        }
+
         uint ch = 0;
         if (*json == '"')
             break;
@@ -53,13 +53,269 @@
 // We mean it.
 //
 
+#include <qalgorithms.h>
 #include <qjsondocument.h>
 #include <qvarlengtharray.h>
+#include <private/qsimd_p.h>
 
 QT_BEGIN_NAMESPACE
 
 namespace QJsonPrivate {
 
+inline bool isJsonSpace(char ch)
+{
+    return ch == 0x20 || ch == 0x09 || ch == 0x0a || ch == 0x0d;
+}
+
+// Returns the first character at or after \a json that is not whitespace.
+inline const char *skipWhitespace(const char *json, const char *end)
+{
+    // most runs of whitespace are a single space or none at all
+    if (json == end || !isJsonSpace(*json))
+        return json;
+    ++json;
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i tab = _mm_set1_epi8(0x09);
+    const __m128i lineFeed = _mm_set1_epi8(0x0a);
+    const __m128i carriageReturn = _mm_set1_epi8(0x0d);
+    while (end - json >= 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)json);
+        const __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+                                        _mm_or_si128(_mm_cmpeq_epi8(chunk, lineFeed), _mm_cmpeq_epi8(chunk, carriageReturn)));
+        const uint other = ~uint(_mm_movemask_epi8(ws)) & 0xffff;
+        if (other)
+            return json + qCountTrailingZeroBits(other);
+        json += 16;
+    }
+#elif defined(__ARM_NEON__)
+    while (end - json >= 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(json));
+        const uint8x16_t ws = vorrq_u8(vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(0x20)), vceqq_u8(chunk, vdupq_n_u8(0x09))),
+                                       vorrq_u8(vceqq_u8(chunk, vdupq_n_u8(0x0a)), vceqq_u8(chunk, vdupq_n_u8(0x0d))));
+        const uint64x2_t other = vreinterpretq_u64_u8(vmvnq_u8(ws));
+        if (vgetq_lane_u64(other, 0) | vgetq_lane_u64(other, 1))
+            break; // let the loop below find the end of the run
+        json += 16;
+    }
+#endif
+    while (json < end && isJsonSpace(*json))
+        ++json;
+    return json;
+}
+
+// Returns the end of the run of characters at \a json that can be copied
+// into a string unchanged: ASCII other than the quotation mark and the
+// backslash.
+inline const char *scanPlainString(const char *json, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    while (end - json >= 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i *)json);
+        const __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        // the sign bit is set for everything that is not ASCII
+        const uint stop = uint(_mm_movemask_epi8(_mm_or_si128(special, chunk)));
+        if (stop)
+            return json + qCountTrailingZeroBits(stop);
+        json += 16;
+    }
+#elif defined(__ARM_NEON__)
+    while (end - json >= 16) {
+        const uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t *>(json));
+        const uint8x16_t special = vorrq_u8(vceqq_u8(chunk, vdupq_n_u8('"')), vceqq_u8(chunk, vdupq_n_u8('\\')));
+        const uint64x2_t stop = vreinterpretq_u64_u8(vorrq_u8(special, vandq_u8(chunk, vdupq_n_u8(0x80))));
+        if (vgetq_lane_u64(stop, 0) | vgetq_lane_u64(stop, 1))
+            break; // let the loop below find the end of the run
+        json += 16;
+    }
+#endif
+    while (json < end && uchar(*json) < 0x80 && *json != '"' && *json != '\\')
+        ++json;
+    return json;
+}
+
+/*
+    Converts the JSON number in [json, end) to a double if that can be done
+    exactly with a single multiplication or division: with at most 19
+    significant digits, a mantissa of at most 2^53 and a decimal exponent
+    between -22 and 22. Both operands are exact then, so the result is
+    correctly rounded. Returns false for everything else, including
+    malformed numbers; the caller then falls back to a full conversion.
+*/
+inline bool convertNumberFast(const char *json, const char *end, double *result)
+{
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+    // excess precision would round twice
+    Q_UNUSED(json);
+    Q_UNUSED(end);
+    Q_UNUSED(result);
+    return false;
+#else
+    static const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const bool negative = (json < end && *json == '-');
+    if (negative)
+        ++json;
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    const char *start = json;
+    while (json < end && *json >= '0' && *json <= '9') {
+        mantissa = mantissa * 10 + uint(*json++ - '0');
+        ++digits;
+    }
+    if (json == start || digits > 19)
+        return false;
+
+    if (json < end && *json == '.') {
+        start = ++json;
+        while (json < end && *json >= '0' && *json <= '9') {
+            mantissa = mantissa * 10 + uint(*json++ - '0');
+            ++digits;
+            --exponent;
+        }
+        if (json == start || digits > 19)
+            return false;
+    }
+
+    if (json < end && (*json == 'e' || *json == 'E')) {
+        ++json;
+        const bool negativeExponent = (json < end && *json == '-');
+        if (json < end && (*json == '-' || *json == '+'))
+            ++json;
+        start = json;
+        int e = 0;
+        while (json < end && *json >= '0' && *json <= '9') {
+            if (e < 1000)
+                e = e * 10 + (*json - '0');
+            ++json;
+        }
+        if (json == start)
+            return false;
+        exponent += negativeExponent ? -e : e;
+    }
+
+    if (json != end || mantissa > (Q_UINT64_C(1) << 53) || exponent < -22 || exponent > 22)
+        return false;
+
+    double d = double(mantissa);
+    if (exponent < 0)
+        d /= powersOf10[-exponent];
+    else
+        d *= powersOf10[exponent];
+    *result = negative ? -d : d;
+    return true;
+#endif
+}
+
+inline bool addHexDigit(char digit, uint *result)
+{
+    *result <<= 4;
+    if (digit >= '0' && digit <= '9')
+        *result |= (digit - '0');
+    else if (digit >= 'a' && digit <= 'f')
+        *result |= (digit - 'a') + 10;
+    else if (digit >= 'A' && digit <= 'F')
+        *result |= (digit - 'A') + 10;
+    else
+        return false;
+    return true;
+}
+
+inline bool scanEscapeSequence(const char *&json, const char *end, uint *ch)
+{
+    ++json;
+    if (json >= end)
+        return false;
+
+    uint escaped = *json++;
+    switch (escaped) {
+    case '"':
+        *ch = '"'; break;
+    case '\\':
+        *ch = '\\'; break;
+    case '/':
+        *ch = '/'; break;
+    case 'b':
+        *ch = 0x8; break;
+    case 'f':
+        *ch = 0xc; break;
+    case 'n':
+        *ch = 0xa; break;
+    case 'r':
+        *ch = 0xd; break;
+    case 't':
+        *ch = 0x9; break;
+    case 'u': {
+        *ch = 0;
+        if (json > end - 4)
+            return false;
+        for (int i = 0; i < 4; ++i) {
+            if (!addHexDigit(*json, ch))
+                return false;
+            ++json;
+        }
+        return true;
+    }
+    default:
+        // this is not as strict as one could be, but allows for more Json files
+        // to be parsed correctly.
+        *ch = escaped;
+        return true;
+    }
+    return true;
+}
+
+inline bool scanUtf8Char(const char *&json, const char *end, uint *result)
+{
+    int need;
+    uint min_uc;
+    uint uc;
+    uchar ch = *json++;
+    if (ch < 128) {
+        *result = ch;
+        return true;
+    } else if ((ch & 0xe0) == 0xc0) {
+        uc = ch & 0x1f;
+        need = 1;
+        min_uc = 0x80;
+    } else if ((ch & 0xf0) == 0xe0) {
+        uc = ch & 0x0f;
+        need = 2;
+        min_uc = 0x800;
+    } else if ((ch&0xf8) == 0xf0) {
+        uc = ch & 0x07;
+        need = 3;
+        min_uc = 0x10000;
+    } else {
+        return false;
+    }
+
+    if (json >= end - need)
+        return false;
+
+    for (int i = 0; i < need; ++i) {
+        ch = *json++;
+        if ((ch&0xc0) != 0x80)
+            return false;
+        uc = (uc << 6) | (ch & 0x3f);
+    }
+
+    if (uc < min_uc ||
+        QChar::isSurrogate(uc) || uc > QChar::LastValidCodePoint) {
+        return false;
+    }
+
+    *result = uc;
+    return true;
+}
+
 class Parser
 {
 public:
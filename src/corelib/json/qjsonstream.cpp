@@ -0,0 +1,1412 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qjsonstream.h"
+#include "qjsonobject.h"
+#include "qjsonarray.h"
+#include "qjsonparser_p.h"
+#include "qjsonwriter_p.h"
+
+#include <qiodevice.h>
+#include <qvector.h>
+#include <qvarlengtharray.h>
+#include <qdebug.h>
+
+QT_BEGIN_NAMESPACE
+
+static const int nestingLimit = 1024;
+static const int readChunkSize = 64 * 1024;
+static const int writeBufferSize = 16 * 1024;
+
+class QJsonStreamReaderPrivate
+{
+public:
+    enum State {
+        ExpectValue,
+        ExpectValueOrEndArray,
+        ExpectKey,
+        ExpectKeyOrEndObject,
+        ExpectColon,
+        ExpectSeparatorOrEnd
+    };
+
+    struct Frame {
+        QJsonObject object;
+        QJsonArray array;
+        QString key;
+        bool isObject;
+    };
+
+    QJsonStreamReaderPrivate();
+
+    void init();
+    QJsonStreamReader::TokenType next();
+    QJsonStreamReader::TokenType scan();
+    bool fetchData();
+    void compact();
+    void raiseError(QJsonParseError::ParseError e, const char *where);
+
+    QJsonStreamReader::TokenType scanString(const char *&json, const char *end, QJsonStreamReader::TokenType type);
+    QJsonStreamReader::TokenType scanNumber(const char *&json, const char *end);
+    QJsonStreamReader::TokenType scanLiteral(const char *&json, const char *end,
+                                             const char *literal, int length,
+                                             QJsonStreamReader::TokenType type);
+
+    inline void valueDone()
+    { state = containers.isEmpty() ? ExpectValue : ExpectSeparatorOrEnd; }
+
+    QIODevice *device;
+    QByteArray buffer;
+    int pos;
+    int stringScanned;
+    qint64 consumed;
+    bool atStart;
+    bool finished;
+    bool atEnd;
+
+    QByteArray containers;
+    State state;
+
+    QJsonStreamReader::TokenType type;
+    QString text;
+    double number;
+    bool boolean;
+
+    QJsonParseError::ParseError error;
+
+    QVector<Frame> frames;
+    int skipDepth;
+};
+
+QJsonStreamReaderPrivate::QJsonStreamReaderPrivate()
+    : device(0)
+{
+    init();
+}
+
+void QJsonStreamReaderPrivate::init()
+{
+    buffer.clear();
+    pos = 0;
+    stringScanned = 0;
+    consumed = 0;
+    atStart = true;
+    finished = false;
+    atEnd = false;
+    containers.clear();
+    state = ExpectValue;
+    type = QJsonStreamReader::NoToken;
+    text.clear();
+    number = 0;
+    boolean = false;
+    error = QJsonParseError::NoError;
+    frames.clear();
+    skipDepth = 0;
+}
+
+void QJsonStreamReaderPrivate::compact()
+{
+    if (!pos)
+        return;
+    buffer.remove(0, pos);
+    consumed += pos;
+    pos = 0;
+}
+
+/*
+    Appends the next chunk of the device to the buffer. Returns false if
+    no data is available right now; \c finished is set if none will ever
+    be, which is the case for a closed device or a random-access device
+    that has been read to its end. Without a device, \c finished is set by
+    finishData().
+*/
+bool QJsonStreamReaderPrivate::fetchData()
+{
+    if (!device || finished)
+        return false;
+    if (!device->isReadable()) {
+        finished = true;
+        return false;
+    }
+
+    compact();
+    const int oldSize = buffer.size();
+    buffer.resize(oldSize + readChunkSize);
+    qint64 read = device->read(buffer.data() + oldSize, readChunkSize);
+    buffer.resize(oldSize + int(qMax(read, qint64(0))));
+    if (read > 0)
+        return true;
+    if (read < 0 || (!device->isSequential() && device->atEnd()))
+        finished = true;
+    return false;
+}
+
+void QJsonStreamReaderPrivate::raiseError(QJsonParseError::ParseError e, const char *where)
+{
+    error = e;
+    pos = where - buffer.constData();
+    type = QJsonStreamReader::Invalid;
+    atEnd = true;
+    frames.clear();
+    skipDepth = 0;
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::next()
+{
+    if (error != QJsonParseError::NoError)
+        return QJsonStreamReader::Invalid;
+
+    forever {
+        const bool wasFinished = finished;
+        QJsonStreamReader::TokenType t = scan();
+        if (t != QJsonStreamReader::NoToken) {
+            atEnd = (t == QJsonStreamReader::Invalid);
+            return type = t;
+        }
+        if (fetchData())
+            continue;
+        // scan once more if we just learned that no more data follows, so
+        // a trailing number gets reported
+        if (finished && !wasFinished)
+            continue;
+        break;
+    }
+
+    if (finished && (!containers.isEmpty() || state != ExpectValue)) {
+        raiseError(containers.endsWith('{') ? QJsonParseError::UnterminatedObject
+                                            : QJsonParseError::UnterminatedArray,
+                   buffer.constData() + buffer.size());
+        return QJsonStreamReader::Invalid;
+    }
+
+    atEnd = true;
+    text.clear();
+    return type = QJsonStreamReader::NoToken;
+}
+
+/*
+    Tries to read one token from the buffered data. Returns NoToken if the
+    buffer ends before a complete token; pos is only ever advanced past
+    complete tokens, so scanning can resume once more data has arrived.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::scan()
+{
+    const char *begin = buffer.constData();
+    const char *json = begin + pos;
+    const char *end = begin + buffer.size();
+
+    if (atStart) {
+        // eat UTF-8 byte order mark
+        static const char utf8bom[3] = { '\xef', '\xbb', '\xbf' };
+        const int available = int(qMin(end - json, ptrdiff_t(3)));
+        if (memcmp(json, utf8bom, available) == 0) {
+            if (available < 3 && !finished)
+                return QJsonStreamReader::NoToken;
+            if (available == 3)
+                json += 3;
+        }
+        atStart = false;
+    }
+
+    forever {
+        json = QJsonPrivate::skipWhitespace(json, end);
+        pos = json - begin;
+        if (json == end)
+            return QJsonStreamReader::NoToken;
+
+        const char c = *json;
+        switch (state) {
+        case ExpectColon:
+            if (c != ':') {
+                raiseError(QJsonParseError::MissingNameSeparator, json);
+                return QJsonStreamReader::Invalid;
+            }
+            ++json;
+            state = ExpectValue;
+            continue;
+
+        case ExpectSeparatorOrEnd: {
+            const bool inObject = containers.endsWith('{');
+            if (c == ',') {
+                ++json;
+                state = inObject ? ExpectKey : ExpectValue;
+                continue;
+            }
+            if (c != (inObject ? '}' : ']')) {
+                raiseError(inObject ? QJsonParseError::UnterminatedObject
+                                    : QJsonParseError::MissingValueSeparator, json);
+                return QJsonStreamReader::Invalid;
+            }
+            containers.chop(1);
+            pos = json + 1 - begin;
+            valueDone();
+            return inObject ? QJsonStreamReader::EndObject : QJsonStreamReader::EndArray;
+        }
+
+        case ExpectKeyOrEndObject:
+        case ExpectKey:
+            if (c == '"')
+                return scanString(json, end, QJsonStreamReader::Key);
+            if (c == '}' && state == ExpectKeyOrEndObject) {
+                containers.chop(1);
+                pos = json + 1 - begin;
+                valueDone();
+                return QJsonStreamReader::EndObject;
+            }
+            raiseError(c == '}' ? QJsonParseError::MissingObject
+                                : QJsonParseError::UnterminatedObject, json);
+            return QJsonStreamReader::Invalid;
+
+        case ExpectValueOrEndArray:
+            if (c == ']') {
+                containers.chop(1);
+                pos = json + 1 - begin;
+                valueDone();
+                return QJsonStreamReader::EndArray;
+            }
+            // fall through
+        case ExpectValue:
+            switch (c) {
+            case '{':
+            case '[':
+                if (containers.size() >= nestingLimit) {
+                    raiseError(QJsonParseError::DeepNesting, json);
+                    return QJsonStreamReader::Invalid;
+                }
+                containers.append(c);
+                pos = json + 1 - begin;
+                if (c == '{') {
+                    state = ExpectKeyOrEndObject;
+                    return QJsonStreamReader::StartObject;
+                }
+                state = ExpectValueOrEndArray;
+                return QJsonStreamReader::StartArray;
+            case '"':
+                return scanString(json, end, QJsonStreamReader::String);
+            case 't':
+                return scanLiteral(json, end, "true", 4, QJsonStreamReader::Bool);
+            case 'f':
+                return scanLiteral(json, end, "false", 5, QJsonStreamReader::Bool);
+            case 'n':
+                return scanLiteral(json, end, "null", 4, QJsonStreamReader::Null);
+            case '-':
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                return scanNumber(json, end);
+            default:
+                raiseError(QJsonParseError::IllegalValue, json);
+                return QJsonStreamReader::Invalid;
+            }
+        }
+    }
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::scanString(const char *&json, const char *end,
+                                                                  QJsonStreamReader::TokenType t)
+{
+    // find the closing quote first; stringScanned remembers how far a
+    // previous call got, so a long string arriving in many chunks is not
+    // rescanned from its start every time
+    const char *start = json + 1;
+    const char *quote = start + stringScanned;
+    bool plain = (stringScanned == 0);
+    while ((quote = QJsonPrivate::scanPlainString(quote, end)) < end) {
+        if (*quote == '"')
+            break;
+        plain = false;
+        if (*quote == '\\') {
+            // resume at the backslash if its escaped character is missing
+            if (quote + 1 >= end)
+                break;
+            quote += 2;
+        } else {
+            ++quote;
+        }
+    }
+    if (quote >= end || *quote != '"') {
+        if (finished) {
+            raiseError(QJsonParseError::UnterminatedString, end);
+            return QJsonStreamReader::Invalid;
+        }
+        stringScanned = int(quote - start);
+        return QJsonStreamReader::NoToken;
+    }
+    stringScanned = 0;
+
+    if (plain) {
+        text = QString::fromLatin1(start, int(quote - start));
+    } else {
+        // every input byte yields at most one UTF-16 code unit
+        text.resize(int(quote - start));
+        ushort *out = reinterpret_cast<ushort *>(text.data());
+        const ushort *outStart = out;
+        const char *s = start;
+        while (s < quote) {
+            const char *run = QJsonPrivate::scanPlainString(s, quote);
+            while (s < run)
+                *out++ = uchar(*s++);
+            if (s == quote)
+                break;
+
+            uint ch = 0;
+            if (*s == '\\') {
+                if (!QJsonPrivate::scanEscapeSequence(s, quote + 1, &ch)) {
+                    raiseError(QJsonParseError::IllegalEscapeSequence, s);
+                    return QJsonStreamReader::Invalid;
+                }
+            } else if (!QJsonPrivate::scanUtf8Char(s, quote + 1, &ch)) {
+                raiseError(QJsonParseError::IllegalUTF8String, s);
+                return QJsonStreamReader::Invalid;
+            }
+            if (QChar::requiresSurrogates(ch)) {
+                *out++ = QChar::highSurrogate(ch);
+                *out++ = QChar::lowSurrogate(ch);
+            } else {
+                *out++ = ushort(ch);
+            }
+        }
+        text.truncate(int(out - outStart));
+    }
+
+    json = quote + 1;
+    pos = json - buffer.constData();
+    if (t == QJsonStreamReader::Key)
+        state = ExpectColon;
+    else
+        valueDone();
+    return t;
+}
+
+/*
+    number = [ minus ] int [ frac ] [ exp ]
+
+    The grammar is checked the same way as in the Parser; a number that
+    runs up to the end of the buffer is incomplete unless the input is
+    finished.
+*/
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::scanNumber(const char *&json, const char *end)
+{
+    const char *start = json;
+    const char *s = json;
+
+    if (s < end && *s == '-')
+        ++s;
+    if (s < end && *s == '0') {
+        ++s;
+    } else {
+        while (s < end && *s >= '0' && *s <= '9')
+            ++s;
+    }
+    if (s < end && *s == '.') {
+        ++s;
+        while (s < end && *s >= '0' && *s <= '9')
+            ++s;
+    }
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        ++s;
+        if (s < end && (*s == '-' || *s == '+'))
+            ++s;
+        while (s < end && *s >= '0' && *s <= '9')
+            ++s;
+    }
+
+    if (s == end && !finished)
+        return QJsonStreamReader::NoToken;
+    if (s == end && !containers.isEmpty()) {
+        raiseError(QJsonParseError::TerminationByNumber, s);
+        return QJsonStreamReader::Invalid;
+    }
+
+    if (!QJsonPrivate::convertNumberFast(start, s, &number)) {
+        bool ok;
+        number = QByteArray::fromRawData(start, int(s - start)).toDouble(&ok);
+        if (!ok) {
+            raiseError(QJsonParseError::IllegalNumber, start);
+            return QJsonStreamReader::Invalid;
+        }
+    }
+
+    json = s;
+    pos = json - buffer.constData();
+    valueDone();
+    return QJsonStreamReader::Double;
+}
+
+QJsonStreamReader::TokenType QJsonStreamReaderPrivate::scanLiteral(const char *&json, const char *end,
+                                                                   const char *literal, int length,
+                                                                   QJsonStreamReader::TokenType t)
+{
+    const int available = int(qMin(end - json, ptrdiff_t(length)));
+    if (memcmp(json, literal, available) != 0 || (available < length && finished)) {
+        raiseError(QJsonParseError::IllegalValue, json);
+        return QJsonStreamReader::Invalid;
+    }
+    if (available < length)
+        return QJsonStreamReader::NoToken;
+
+    boolean = (literal[0] == 't');
+    json += length;
+    pos = json - buffer.constData();
+    valueDone();
+    return t;
+}
+
+/*!
+    \class QJsonStreamReader
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.3
+
+    \brief The QJsonStreamReader class provides a fast parser for reading
+    JSON text incrementally.
+
+    QJsonStreamReader is the JSON counterpart of QXmlStreamReader. Instead
+    of building a complete QJsonDocument in memory, it reports the text as
+    a stream of tokens, and only ever holds the token that is currently
+    being read. This makes it suitable for documents that are too large to
+    be loaded as a whole, such as multi-gigabyte exports.
+
+    The data is read from a QIODevice set with setDevice(), or added in
+    chunks with addData(). The basic loop looks like this:
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 0
+
+    readNext() returns the type of the token it has read. Objects and
+    arrays are reported as StartObject/EndObject and StartArray/EndArray
+    pairs; inside an object every member is a Key token followed by its
+    value. The key or string is available from text(), and scalar values
+    from toDouble(), toBool() or value().
+
+    Any number of JSON values, separated by whitespace, can follow each
+    other in the input. This allows reading JSON-lines style data, where
+    every line holds one value. Unlike QJsonDocument::fromJson(), top-level
+    values do not need to be objects or arrays.
+
+    \section1 Incremental Parsing
+
+    When the input runs out in the middle of a value, readNext() returns
+    NoToken and atEnd() returns \c true, without raising an error. Parsing
+    continues where it left off once more data has been added with
+    addData(), or has arrived on the device. This makes it possible to
+    parse data as it arrives from the network:
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 1
+
+    Since a number only ends at the character that follows it, a number at
+    the very end of the input is only reported once the reader knows that
+    no more data will arrive. That is the case for a random-access device
+    that has been read to its end, a device that has been closed, the data
+    passed to the QByteArray constructor, and data added with addData()
+    once finishData() has been called. Only then is input that ends in the
+    middle of a value reported as an error, such as
+    QJsonParseError::UnterminatedArray or QJsonParseError::UnterminatedString.
+
+    readValue() and skipCurrentValue() can be resumed in the same way, so
+    a whole object can be read at once even if it arrives in pieces.
+
+    \section1 Error Handling
+
+    Syntax errors are reported with the same QJsonParseError::ParseError
+    codes that QJsonDocument::fromJson() uses. Once an error has been
+    raised, readNext() returns Invalid, and hasError() and atEnd() return
+    \c true. characterOffset() then tells where in the input the error was
+    found.
+
+    \sa QJsonStreamWriter, QJsonDocument, QXmlStreamReader
+*/
+
+/*!
+    \enum QJsonStreamReader::TokenType
+
+    This enum specifies the type of token the reader just read.
+
+    \value NoToken The reader has not read anything yet, or needs more
+    data to read the next token.
+
+    \value Invalid An error has occurred, reported in error() and
+    errorString().
+
+    \value StartObject The reader reports the start of an object.
+
+    \value EndObject The reader reports the end of an object.
+
+    \value StartArray The reader reports the start of an array.
+
+    \value EndArray The reader reports the end of an array.
+
+    \value Key The reader reports the key of an object member in text().
+    The member's value follows as the next token.
+
+    \value String The reader reports a string value in text().
+
+    \value Double The reader reports a number in toDouble().
+
+    \value Bool The reader reports \c true or \c false in toBool().
+
+    \value Null The reader reports a \c null value.
+*/
+
+/*!
+    Constructs a stream reader without any data.
+
+    \sa setDevice(), addData()
+*/
+QJsonStreamReader::QJsonStreamReader()
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+}
+
+/*!
+    Creates a new stream reader that reads from \a device.
+
+    \sa setDevice(), clear()
+*/
+QJsonStreamReader::QJsonStreamReader(QIODevice *device)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Creates a new stream reader that reads from \a data. The data is
+    treated as complete input, as if finishData() had been called.
+
+    \sa addData(), clear()
+*/
+QJsonStreamReader::QJsonStreamReader(const QByteArray &data)
+    : d_ptr(new QJsonStreamReaderPrivate)
+{
+    addData(data);
+    finishData();
+}
+
+/*!
+    Destructs the reader.
+*/
+QJsonStreamReader::~QJsonStreamReader()
+{
+}
+
+/*!
+    Sets the current device to \a device. Setting the device resets the
+    stream to its initial state.
+
+    \sa device(), clear()
+*/
+void QJsonStreamReader::setDevice(QIODevice *device)
+{
+    Q_D(QJsonStreamReader);
+    d->init();
+    d->device = device;
+}
+
+/*!
+    Returns the current device associated with the QJsonStreamReader, or 0
+    if no device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamReader::device() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->device;
+}
+
+/*!
+    Adds more \a data for the reader to read. This function does nothing
+    if the reader has a device(), or if finishData() has been called.
+
+    \sa readNext(), finishData(), clear()
+*/
+void QJsonStreamReader::addData(const QByteArray &data)
+{
+    Q_D(QJsonStreamReader);
+    if (d->device) {
+        qWarning("QJsonStreamReader: addData() with device()");
+        return;
+    }
+    if (d->finished) {
+        qWarning("QJsonStreamReader: addData() after finishData()");
+        return;
+    }
+    d->compact();
+    d->buffer += data;
+    if (d->error == QJsonParseError::NoError)
+        d->atEnd = false;
+}
+
+/*!
+    Tells the reader that no more data will be added with addData().
+
+    The reader can then report a number at the very end of the data, and
+    reports an error if the data ends in the middle of a value. Call
+    readNext() afterwards to read the remaining tokens. This function does
+    nothing if the reader has a device().
+
+    \sa addData(), clear()
+*/
+void QJsonStreamReader::finishData()
+{
+    Q_D(QJsonStreamReader);
+    if (d->device || d->finished)
+        return;
+    d->finished = true;
+    if (d->error == QJsonParseError::NoError)
+        d->atEnd = false;
+}
+
+/*!
+    Removes any device() or data from the reader and resets its internal
+    state to the initial state.
+
+    \sa addData()
+*/
+void QJsonStreamReader::clear()
+{
+    Q_D(QJsonStreamReader);
+    d->init();
+    d->device = 0;
+}
+
+/*!
+    Returns \c true if the reader has consumed all data that is currently
+    available, or if an error has occurred; otherwise returns \c false.
+
+    Unless an error has occurred, reading can continue when more data has
+    been added with addData() or has arrived on the device().
+
+    \sa hasError(), readNext()
+*/
+bool QJsonStreamReader::atEnd() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->atEnd;
+}
+
+/*!
+    Reads the next token and returns its type.
+
+    If the available data ends before the next complete token, NoToken is
+    returned and atEnd() returns \c true. Once an error() is reported,
+    further reading is not possible, and this function returns Invalid.
+
+    Calling readNext() abandons a readValue() or skipCurrentValue() that
+    is waiting for more data.
+
+    \sa tokenType(), tokenString()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::readNext()
+{
+    Q_D(QJsonStreamReader);
+    d->frames.clear();
+    d->skipDepth = 0;
+    return d->next();
+}
+
+/*!
+    Reads the value starting at the current token and returns it. For a
+    StartObject or StartArray token, the complete object or array is read
+    and the current token is its matching EndObject or EndArray
+    afterwards. For a scalar token, value() is returned.
+
+    If the data ends before the value is complete, an undefined QJsonValue
+    is returned and atEnd() returns \c true. Call readValue() again after
+    more data has become available to continue reading the value. An
+    undefined value is also returned for a Key token, and if an error
+    occurs.
+
+    \sa skipCurrentValue(), value()
+*/
+QJsonValue QJsonStreamReader::readValue()
+{
+    Q_D(QJsonStreamReader);
+    if (d->frames.isEmpty()) {
+        if (d->type != StartObject && d->type != StartArray)
+            return value();
+        QJsonStreamReaderPrivate::Frame frame;
+        frame.isObject = (d->type == StartObject);
+        d->frames.append(frame);
+    }
+
+    forever {
+        QJsonValue v;
+        switch (d->next()) {
+        case NoToken:
+            return QJsonValue(QJsonValue::Undefined);
+        case Invalid:
+            return QJsonValue(QJsonValue::Undefined);
+        case Key:
+            d->frames.last().key = d->text;
+            continue;
+        case StartObject:
+        case StartArray: {
+            QJsonStreamReaderPrivate::Frame frame;
+            frame.isObject = (d->type == StartObject);
+            d->frames.append(frame);
+            continue;
+        }
+        case EndObject:
+            v = d->frames.last().object;
+            d->frames.removeLast();
+            break;
+        case EndArray:
+            v = d->frames.last().array;
+            d->frames.removeLast();
+            break;
+        default:
+            v = value();
+            break;
+        }
+
+        if (d->frames.isEmpty())
+            return v;
+        QJsonStreamReaderPrivate::Frame &parent = d->frames.last();
+        if (parent.isObject)
+            parent.object.insert(parent.key, v);
+        else
+            parent.array.append(v);
+    }
+}
+
+/*!
+    Skips the object or array starting at the current token, without
+    building it in memory. Afterwards the current token is the matching
+    EndObject or EndArray. If the current token is not a StartObject or
+    StartArray token, nothing is skipped.
+
+    Returns \c true once the value has been skipped. Returns \c false if
+    the data ended before the end of the value, or if an error occurred.
+    In the former case, call skipCurrentValue() again after more data has
+    become available.
+
+    \sa readValue()
+*/
+bool QJsonStreamReader::skipCurrentValue()
+{
+    Q_D(QJsonStreamReader);
+    if (!d->skipDepth) {
+        if (d->type != StartObject && d->type != StartArray)
+            return d->type != Invalid;
+        d->skipDepth = 1;
+    }
+
+    while (d->skipDepth) {
+        switch (d->next()) {
+        case NoToken:
+        case Invalid:
+            return false;
+        case StartObject:
+        case StartArray:
+            ++d->skipDepth;
+            break;
+        case EndObject:
+        case EndArray:
+            --d->skipDepth;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+/*!
+    Returns the type of the current token.
+
+    \sa tokenString()
+*/
+QJsonStreamReader::TokenType QJsonStreamReader::tokenType() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type;
+}
+
+/*!
+    Returns the current token as a string.
+
+    \sa tokenType()
+*/
+QString QJsonStreamReader::tokenString() const
+{
+    static const char names[] =
+        "NoToken\0Invalid\0StartObject\0EndObject\0StartArray\0EndArray\0"
+        "Key\0String\0Double\0Bool\0Null\0";
+    static const short indices[] = { 0, 8, 16, 28, 38, 49, 58, 62, 69, 76, 81 };
+
+    Q_D(const QJsonStreamReader);
+    return QLatin1String(names + indices[d->type]);
+}
+
+/*!
+    Returns the nesting depth of the current position: the number of
+    objects and arrays that have been started but not yet ended. The
+    depth is 1 after the StartObject or StartArray token of a top-level
+    value, and 0 after its end.
+*/
+int QJsonStreamReader::depth() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->containers.size();
+}
+
+/*!
+    Returns the number of bytes of input consumed so far. After an error,
+    this is the offset at which the error was found.
+*/
+qint64 QJsonStreamReader::characterOffset() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->consumed + d->pos;
+}
+
+/*!
+    Returns the key for a Key token and the string for a String token;
+    otherwise returns a null string.
+
+    \sa value()
+*/
+QString QJsonStreamReader::text() const
+{
+    Q_D(const QJsonStreamReader);
+    if (d->type == Key || d->type == String)
+        return d->text;
+    return QString();
+}
+
+/*!
+    Returns the number for a Double token; otherwise returns 0.
+
+    \sa value()
+*/
+double QJsonStreamReader::toDouble() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type == Double ? d->number : 0;
+}
+
+/*!
+    Returns the value of a Bool token; otherwise returns \c false.
+
+    \sa value()
+*/
+bool QJsonStreamReader::toBool() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->type == Bool && d->boolean;
+}
+
+/*!
+    Returns the scalar value of the current String, Double, Bool or Null
+    token. For all other tokens an undefined value is returned.
+
+    \sa readValue()
+*/
+QJsonValue QJsonStreamReader::value() const
+{
+    Q_D(const QJsonStreamReader);
+    switch (d->type) {
+    case String:
+        return QJsonValue(d->text);
+    case Double:
+        return QJsonValue(d->number);
+    case Bool:
+        return QJsonValue(d->boolean);
+    case Null:
+        return QJsonValue(QJsonValue::Null);
+    default:
+        return QJsonValue(QJsonValue::Undefined);
+    }
+}
+
+/*!
+    Returns the type of the current error, or QJsonParseError::NoError if
+    no error occurred.
+
+    \sa errorString(), hasError()
+*/
+QJsonParseError::ParseError QJsonStreamReader::error() const
+{
+    Q_D(const QJsonStreamReader);
+    return d->error;
+}
+
+/*!
+    Returns the error message that was set with error().
+
+    \sa QJsonParseError::errorString()
+*/
+QString QJsonStreamReader::errorString() const
+{
+    Q_D(const QJsonStreamReader);
+    QJsonParseError e;
+    e.error = d->error;
+    e.offset = int(d->consumed + d->pos);
+    return e.errorString();
+}
+
+/*!
+    \fn bool QJsonStreamReader::hasError() const
+
+    Returns \c true if an error has occurred, otherwise \c false.
+
+    \sa errorString(), error()
+*/
+
+/*!
+    \fn bool QJsonStreamReader::isStartObject() const
+
+    Returns \c true if tokenType() equals \l StartObject; otherwise
+    returns \c false.
+*/
+
+/*!
+    \fn bool QJsonStreamReader::isEndObject() const
+
+    Returns \c true if tokenType() equals \l EndObject; otherwise returns
+    \c false.
+*/
+
+/*!
+    \fn bool QJsonStreamReader::isStartArray() const
+
+    Returns \c true if tokenType() equals \l StartArray; otherwise returns
+    \c false.
+*/
+
+/*!
+    \fn bool QJsonStreamReader::isEndArray() const
+
+    Returns \c true if tokenType() equals \l EndArray; otherwise returns
+    \c false.
+*/
+
+/*!
+    \fn bool QJsonStreamReader::isKey() const
+
+    Returns \c true if tokenType() equals \l Key; otherwise returns
+    \c false.
+*/
+
+
+class QJsonStreamWriterPrivate
+{
+public:
+    struct Frame {
+        bool isObject;
+        int count;
+    };
+
+    QJsonStreamWriterPrivate();
+
+    QByteArray &out() { return array ? *array : buffer; }
+    void indent(int level);
+    void separate();
+    bool beginValue(const char *function);
+    void endValue();
+    void flush();
+
+    QIODevice *device;
+    QByteArray *array;
+    QByteArray buffer;
+    QVarLengthArray<Frame, 16> frames;
+    bool keyWritten;
+    bool autoFormatting;
+    bool hasError;
+};
+
+QJsonStreamWriterPrivate::QJsonStreamWriterPrivate()
+    : device(0), array(0), keyWritten(false), autoFormatting(false), hasError(false)
+{
+}
+
+void QJsonStreamWriterPrivate::indent(int level)
+{
+    QByteArray &json = out();
+    for (int i = 0; i < level; ++i)
+        json += "    ";
+}
+
+// writes the separator and indentation before the next member or element
+void QJsonStreamWriterPrivate::separate()
+{
+    if (frames.isEmpty())
+        return;
+    if (frames.last().count++)
+        out() += autoFormatting ? ",\n" : ",";
+    if (autoFormatting)
+        indent(frames.size());
+}
+
+bool QJsonStreamWriterPrivate::beginValue(const char *function)
+{
+    if (frames.isEmpty() || !frames.last().isObject) {
+        separate();
+        return true;
+    }
+    if (!keyWritten) {
+        qWarning("QJsonStreamWriter::%s: no key written for the value in an object", function);
+        return false;
+    }
+    keyWritten = false;
+    return true;
+}
+
+void QJsonStreamWriterPrivate::endValue()
+{
+    if (frames.isEmpty()) {
+        out() += '\n';
+        flush();
+    } else if (buffer.size() >= writeBufferSize) {
+        flush();
+    }
+}
+
+void QJsonStreamWriterPrivate::flush()
+{
+    if (array || buffer.isEmpty())
+        return;
+    if (device && device->write(buffer) != buffer.size())
+        hasError = true;
+    buffer.resize(0);
+}
+
+/*!
+    \class QJsonStreamWriter
+    \inmodule QtCore
+    \ingroup json
+    \reentrant
+    \since 5.3
+
+    \brief The QJsonStreamWriter class provides a JSON writer with a
+    simple streaming API.
+
+    QJsonStreamWriter is the counterpart to QJsonStreamReader for writing
+    JSON. It writes the text to a QIODevice or a QByteArray as it is
+    produced, so a large document never needs to exist in memory as a
+    whole.
+
+    Objects and arrays are opened with writeStartObject() and
+    writeStartArray() and closed with writeEndObject() and writeEndArray().
+    Inside an object, every value must be preceded by a key, either by
+    calling writeKey() or by using the overloads that take a key:
+
+    \snippet code/src_corelib_json_qjsonstream.cpp 2
+
+    writeValue() writes a scalar, or a complete QJsonObject or QJsonArray.
+
+    Every top-level value is terminated with a newline. Writing several
+    top-level values in a row therefore produces JSON-lines style output,
+    which QJsonStreamReader can read back value by value.
+
+    By default the output is compact. With setAutoFormatting() enabled, it
+    is indented in the same way as QJsonDocument::toJson() with
+    QJsonDocument::Indented.
+
+    When writing to a device, the output is buffered in small chunks. The
+    buffer is written to the device at the end of every top-level value,
+    when it has grown past a few kilobytes, on flush() and when the
+    writer is destroyed.
+
+    \sa QJsonStreamReader, QJsonDocument, QXmlStreamWriter
+*/
+
+/*!
+    Constructs a stream writer.
+
+    \sa setDevice()
+*/
+QJsonStreamWriter::QJsonStreamWriter()
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+}
+
+/*!
+    Constructs a stream writer that writes into \a device.
+*/
+QJsonStreamWriter::QJsonStreamWriter(QIODevice *device)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    setDevice(device);
+}
+
+/*!
+    Constructs a stream writer that appends to \a array.
+*/
+QJsonStreamWriter::QJsonStreamWriter(QByteArray *array)
+    : d_ptr(new QJsonStreamWriterPrivate)
+{
+    d_ptr->array = array;
+}
+
+/*!
+    Destructor. Any buffered output is written to the device.
+*/
+QJsonStreamWriter::~QJsonStreamWriter()
+{
+    flush();
+}
+
+/*!
+    Sets the current device to \a device. Output buffered for the
+    previous device is written to it first.
+
+    \sa device()
+*/
+void QJsonStreamWriter::setDevice(QIODevice *device)
+{
+    Q_D(QJsonStreamWriter);
+    flush();
+    d->device = device;
+    d->array = 0;
+}
+
+/*!
+    Returns the device associated with the QJsonStreamWriter, or 0 if no
+    device has been assigned.
+
+    \sa setDevice()
+*/
+QIODevice *QJsonStreamWriter::device() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->device;
+}
+
+/*!
+    Enables auto formatting if \a enable is \c true, otherwise disables
+    it. Auto formatting is disabled by default.
+
+    With auto formatting, the output is indented like the output of
+    QJsonDocument::toJson() with QJsonDocument::Indented.
+*/
+void QJsonStreamWriter::setAutoFormatting(bool enable)
+{
+    Q_D(QJsonStreamWriter);
+    d->autoFormatting = enable;
+}
+
+/*!
+    Returns \c true if auto formatting is enabled, otherwise \c false.
+
+    \sa setAutoFormatting()
+*/
+bool QJsonStreamWriter::autoFormatting() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->autoFormatting;
+}
+
+/*!
+    Writes the start of an object. Inside an object, a key must have been
+    written first.
+
+    \sa writeEndObject(), writeKey()
+*/
+void QJsonStreamWriter::writeStartObject()
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeStartObject"))
+        return;
+    d->out() += d->autoFormatting ? "{\n" : "{";
+    QJsonStreamWriterPrivate::Frame frame = { true, 0 };
+    d->frames.append(frame);
+}
+
+/*!
+    \overload
+
+    Writes \a key followed by the start of an object. This is a
+    convenience function for use inside an object.
+*/
+void QJsonStreamWriter::writeStartObject(const QString &key)
+{
+    writeKey(key);
+    writeStartObject();
+}
+
+/*!
+    Closes the object opened by the matching writeStartObject().
+*/
+void QJsonStreamWriter::writeEndObject()
+{
+    Q_D(QJsonStreamWriter);
+    if (d->frames.isEmpty() || !d->frames.last().isObject || d->keyWritten) {
+        qWarning("QJsonStreamWriter::writeEndObject: no matching object to end");
+        return;
+    }
+    const bool empty = !d->frames.last().count;
+    d->frames.removeLast();
+    if (d->autoFormatting) {
+        if (!empty)
+            d->out() += '\n';
+        d->indent(d->frames.size());
+    }
+    d->out() += '}';
+    d->endValue();
+}
+
+/*!
+    Writes the start of an array. Inside an object, a key must have been
+    written first.
+
+    \sa writeEndArray(), writeKey()
+*/
+void QJsonStreamWriter::writeStartArray()
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeStartArray"))
+        return;
+    d->out() += d->autoFormatting ? "[\n" : "[";
+    QJsonStreamWriterPrivate::Frame frame = { false, 0 };
+    d->frames.append(frame);
+}
+
+/*!
+    \overload
+
+    Writes \a key followed by the start of an array. This is a
+    convenience function for use inside an object.
+*/
+void QJsonStreamWriter::writeStartArray(const QString &key)
+{
+    writeKey(key);
+    writeStartArray();
+}
+
+/*!
+    Closes the array opened by the matching writeStartArray().
+*/
+void QJsonStreamWriter::writeEndArray()
+{
+    Q_D(QJsonStreamWriter);
+    if (d->frames.isEmpty() || d->frames.last().isObject) {
+        qWarning("QJsonStreamWriter::writeEndArray: no matching array to end");
+        return;
+    }
+    const bool empty = !d->frames.last().count;
+    d->frames.removeLast();
+    if (d->autoFormatting) {
+        if (!empty)
+            d->out() += '\n';
+        d->indent(d->frames.size());
+    }
+    d->out() += ']';
+    d->endValue();
+}
+
+/*!
+    Writes \a key for the next member of the current object. The member's
+    value has to be written next.
+*/
+void QJsonStreamWriter::writeKey(const QString &key)
+{
+    Q_D(QJsonStreamWriter);
+    if (d->frames.isEmpty() || !d->frames.last().isObject || d->keyWritten) {
+        qWarning("QJsonStreamWriter::writeKey: a key can only be written for an object member");
+        return;
+    }
+    d->separate();
+    QJsonPrivate::Writer::stringToJson(key, d->out());
+    d->out() += ": ";
+    d->keyWritten = true;
+}
+
+/*!
+    Writes \a value. Objects and arrays are written completely. Inside an
+    object, a key must have been written first.
+*/
+void QJsonStreamWriter::writeValue(const QJsonValue &value)
+{
+    Q_D(QJsonStreamWriter);
+    if (!d->beginValue("writeValue"))
+        return;
+    if (d->autoFormatting)
+        QJsonPrivate::Writer::valueToJson(value, d->out(), d->frames.size());
+    else
+        QJsonPrivate::Writer::valueToJson(value, d->out(), 0, true);
+    d->endValue();
+}
+
+/*!
+    \overload
+
+    Writes the member \a key with \a value to the current object.
+*/
+void QJsonStreamWriter::writeValue(const QString &key, const QJsonValue &value)
+{
+    writeKey(key);
+    writeValue(value);
+}
+
+/*!
+    Returns the number of objects and arrays that have been started but
+    not yet ended.
+*/
+int QJsonStreamWriter::depth() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->frames.size();
+}
+
+/*!
+    Writes all buffered output to the device().
+
+    Output is written automatically at the end of every top-level value,
+    so calling this is only needed to push out part of a large value.
+*/
+void QJsonStreamWriter::flush()
+{
+    Q_D(QJsonStreamWriter);
+    d->flush();
+}
+
+/*!
+    Returns \c true if writing to the device failed; otherwise returns
+    \c false.
+*/
+bool QJsonStreamWriter::hasError() const
+{
+    Q_D(const QJsonStreamWriter);
+    return d->hasError;
+}
+
+QT_END_NAMESPACE
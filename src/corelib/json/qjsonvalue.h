@@ -60,6 +60,7 @@ namespace QJsonPrivate {
     class Array;
     class Value;
     class Entry;
+    class Writer;
 }
 
 class Q_CORE_EXPORT QJsonValue
@@ -120,6 +121,7 @@ private:
     friend class QJsonPrivate::Value;
     friend class QJsonArray;
     friend class QJsonObject;
+    friend class QJsonPrivate::Writer;
     friend Q_CORE_EXPORT QDebug operator<<(QDebug, const QJsonValue &);
 
     QJsonValue(QJsonPrivate::Data *d, QJsonPrivate::Base *b, const QJsonPrivate::Value& v);
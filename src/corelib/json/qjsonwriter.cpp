@@ -41,6 +41,7 @@
 
 #include "qjsonwriter_p.h"
 #include "qjson_p.h"
+#include "qlocale.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -164,8 +165,8 @@ static void valueToJson(const QJsonPrivate::Base *b, const QJsonPrivate::Value &
         break;
     case QJsonValue::Double: {
         const double d = v.toDouble(b);
-        if (qIsFinite(d)) // +2 to format to ensure the expected precision
-            json += QByteArray::number(d, 'g', std::numeric_limits<double>::digits10 + 2); // ::digits10 is 15
+        if (qIsFinite(d))
+            json += QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
         else
             json += "null"; // +INF || -INF || NaN (see RFC4627#section2.4)
         break;
@@ -260,4 +261,52 @@ void Writer::arrayToJson(const QJsonPrivate::Array *a, QByteArray &json, int ind
     json += compact ? "]" : "]\n";
 }
 
+void Writer::valueToJson(const QJsonValue &v, QByteArray &json, int indent, bool compact)
+{
+    switch (v.t) {
+    case QJsonValue::Bool:
+        json += v.b ? "true" : "false";
+        break;
+    case QJsonValue::Double:
+        if (qIsFinite(v.dbl))
+            json += QByteArray::number(v.dbl, 'g', QLocale::FloatingPointShortest);
+        else
+            json += "null";
+        break;
+    case QJsonValue::String:
+        stringToJson(v.toString(), json);
+        break;
+    case QJsonValue::Array: {
+        const QJsonPrivate::Array *a = static_cast<QJsonPrivate::Array *>(v.base);
+        if (v.d && !v.d->ensureValid(a, true))
+            a = 0;
+        json += compact ? "[" : "[\n";
+        arrayContentToJson(a, json, indent + (compact ? 0 : 1), compact);
+        json += QByteArray(4*indent, ' ');
+        json += "]";
+        break;
+    }
+    case QJsonValue::Object: {
+        const QJsonPrivate::Object *o = static_cast<QJsonPrivate::Object *>(v.base);
+        if (v.d && !v.d->ensureValid(o, true))
+            o = 0;
+        json += compact ? "{" : "{\n";
+        objectContentToJson(o, json, indent + (compact ? 0 : 1), compact);
+        json += QByteArray(4*indent, ' ');
+        json += "}";
+        break;
+    }
+    case QJsonValue::Null:
+    default:
+        json += "null";
+    }
+}
+
+void Writer::stringToJson(const QString &s, QByteArray &json)
+{
+    json += '"';
+    json += escapedString(s);
+    json += '"';
+}
+
 QT_END_NAMESPACE
@@ -301,6 +301,10 @@ bool QCoreApplicationPrivate::is_app_closing = false;
 Q_CORE_EXPORT uint qGlobalPostedEventsCount()
 {
     QThreadData *currentThreadData = QThreadData::current();
+    if (currentThreadData->postEventList.hasIncomingEvents()) {
+        QMutexLocker locker(&currentThreadData->postEventList.mutex);
+        QCoreApplicationPrivate::mergeIncomingPostedEvents(currentThreadData);
+    }
     return currentThreadData->postEventList.size() - currentThreadData->postEventList.startOffset;
 }
 
@@ -443,6 +447,7 @@ void QCoreApplicationPrivate::cleanupThreadData()
 
         // need to clear the state of the mainData, just in case a new QCoreApplication comes along.
         QMutexLocker locker(&threadData->postEventList.mutex);
+        mergeIncomingPostedEvents(threadData);
         for (int i = 0; i < threadData->postEventList.size(); ++i) {
             const QPostEvent &pe = threadData->postEventList.at(i);
             if (pe.event) {
@@ -1239,6 +1244,48 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
         return;
     }
 
+    if (priority == Qt::NormalEventPriority && event->type() != QEvent::DeferredDelete) {
+        // fast path: push the event onto the lock-free stack of the receiver's
+        // thread; compression happens when it is merged into the list
+        QScopedPointer<QEvent> eventDeleter(event);
+        QPostEventList::IncomingEvent *node = new QPostEventList::IncomingEvent;
+        eventDeleter.take();
+
+        // announce ourselves before checking the thread, so that moveToThread()
+        // either sees us and waits, or we see the object's new thread; the
+        // ordered ref() pairs with the ordered first read of incomingPosters
+        // in QPostEventList::waitForIncomingPosters()
+        forever {
+            data->postEventList.incomingPosters.ref();
+            if (data == *pdata)
+                break;
+            data->postEventList.leaveIncoming();
+
+            // if object has moved to another thread, follow it
+            data = *pdata;
+            if (!data) {
+                // posting during destruction? just delete the event to prevent a leak
+                delete node;
+                delete event;
+                return;
+            }
+        }
+
+        node->event = QPostEvent(receiver, event, priority);
+        event->posted = true;
+        QPostEventList::IncomingEvent *head;
+        do {
+            head = data->postEventList.incoming.load();
+            node->next = head;
+        } while (!data->postEventList.incoming.testAndSetRelease(head, node));
+        data->postEventList.leaveIncoming();
+
+        QAbstractEventDispatcher* dispatcher = data->eventDispatcher.loadAcquire();
+        if (dispatcher)
+            dispatcher->wakeUp();
+        return;
+    }
+
     // lock the post event mutex
     data->postEventList.mutex.lock();
 
@@ -1258,6 +1305,9 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
 
     QMutexUnlocker locker(&data->postEventList.mutex);
 
+    // keep the posting order with respect to the lock-free fast path
+    QCoreApplicationPrivate::mergeIncomingPostedEvents(data);
+
     // if this is one of the compressible events, do compression
     if (receiver->d_func()->postedEvents
         && self && self->compressEvent(event, receiver, &data->postEventList)) {
@@ -1285,6 +1335,63 @@ void QCoreApplication::postEvent(QObject *receiver, QEvent *event, int priority)
         dispatcher->wakeUp();
 }
 
+/*!
+  \internal
+  Moves the events pushed onto the lock-free stack by postEvent() into the
+  posted event list of their receiver's thread, compressing them on the way.
+
+  Must be called with the post event mutex of \a data locked. The receivers
+  normally live in \a data; only QObject::moveToThread() calls this for
+  objects that have just left, and it holds the target's mutex as well.
+*/
+void QCoreApplicationPrivate::mergeIncomingPostedEvents(QThreadData *data)
+{
+    QPostEventList::IncomingEvent *node = data->postEventList.incoming.fetchAndStoreAcquire(0);
+    if (!node)
+        return;
+
+    // the stack holds the events in reverse posting order
+    QPostEventList::IncomingEvent *first = 0;
+    while (node) {
+        QPostEventList::IncomingEvent *next = node->next;
+        node->next = first;
+        first = node;
+        node = next;
+    }
+
+    while (first) {
+        node = first;
+        first = node->next;
+        QPostEvent pe = node->event;
+        delete node;
+
+        QObject *receiver = pe.receiver;
+        QThreadData *receiverData = receiver->d_func()->threadData;
+        QPostEventList &list = receiverData->postEventList;
+
+        // if this is one of the compressible events, do compression
+        if (receiver->d_func()->postedEvents
+            && QCoreApplication::self
+            && QCoreApplication::self->compressEvent(pe.event, receiver, &list)) {
+            continue;
+        }
+
+        // delete the event on exceptions to protect against memory leaks till the event is
+        // properly owned in the postEventList
+        QScopedPointer<QEvent> eventDeleter(pe.event);
+        list.addEvent(pe);
+        eventDeleter.take();
+        ++receiver->d_func()->postedEvents;
+        receiverData->canWait = false;
+
+        if (receiverData != data) {
+            QAbstractEventDispatcher *dispatcher = receiverData->eventDispatcher.loadAcquire();
+            if (dispatcher)
+                dispatcher->wakeUp();
+        }
+    }
+}
+
 /*!
   \internal
   Returns \c true if \a event was compressed away (possibly deleted) and should not be added to the list.
@@ -1337,6 +1444,10 @@ bool QCoreApplication::compressEvent(QEvent *event, QObject *receiver, QPostEven
   If \a receiver is null, the events of \a event_type are sent for all
   objects. If \a event_type is 0, all the events are sent for \a receiver.
 
+  Events posted while this function sends events, from the event handlers
+  or from other threads, are sent by the next call, in the order given by
+  their priority and posting order.
+
   \note This method must be called from the same thread as its QObject parameter, \a receiver.
 
   \sa flush(), postEvent()
@@ -1365,6 +1476,7 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
     ++data->postEventList.recursion;
 
     QMutexLocker locker(&data->postEventList.mutex);
+    mergeIncomingPostedEvents(data);
 
     // by default, we assume that the event dispatcher can go to sleep after
     // processing all events. if any new events are posted while we send
@@ -1401,6 +1513,10 @@ void QCoreApplicationPrivate::sendPostedEvents(QObject *receiver, int event_type
                 data->canWait = false;
             }
 
+            // events posted on the lock-free path during this pass end up
+            // behind it, just like the ones that took the mutex
+            QCoreApplicationPrivate::mergeIncomingPostedEvents(data);
+
             --data->postEventList.recursion;
             if (!data->postEventList.recursion && !data->canWait && data->hasEventDispatcher())
                 data->eventDispatcher.load()->wakeUp();
@@ -1521,6 +1637,7 @@ void QCoreApplication::removePostedEvents(QObject *receiver, int eventType)
 {
     QThreadData *data = receiver ? receiver->d_func()->threadData : QThreadData::current();
     QMutexLocker locker(&data->postEventList.mutex);
+    QCoreApplicationPrivate::mergeIncomingPostedEvents(data);
 
     // the QObject destructor calls this function directly.  this can
     // happen while the event loop is in the middle of posting events,
@@ -1586,6 +1703,7 @@ void QCoreApplicationPrivate::removePostedEvent(QEvent * event)
     QThreadData *data = QThreadData::current();
 
     QMutexLocker locker(&data->postEventList.mutex);
+    mergeIncomingPostedEvents(data);
 
     if (data->postEventList.size() == 0) {
 #if defined(QT_DEBUG)
@@ -115,6 +115,7 @@ public:
     static QThread *theMainThread;
     static QThread *mainThread();
     static void sendPostedEvents(QObject *receiver, int event_type, QThreadData *data);
+    static void mergeIncomingPostedEvents(QThreadData *data);
 
 #if !defined (QT_NO_DEBUG) || defined (QT_MAC_FRAMEWORK_BUILD)
     void checkReceiverThread(QObject *receiver);
@@ -60,6 +60,11 @@
 #  include <sys/eventfd.h>
 #endif
 
+#ifndef QT_NO_EPOLL
+#  include <sys/epoll.h>
+#  include <poll.h>
+#endif
+
 // VxWorks doesn't correctly set the _POSIX_... options
 #if defined(Q_OS_VXWORKS)
 #  if defined(_POSIX_MONOTONIC_CLOCK) && (_POSIX_MONOTONIC_CLOCK <= 0)
@@ -147,6 +152,26 @@ QEventDispatcherUNIXPrivate::QEventDispatcherUNIXPrivate()
         qFatal("QEventDispatcherUNIXPrivate(): Can not continue without a thread pipe");
 
     sn_highest = -1;
+
+#ifndef QT_NO_EPOLL
+    // epoll(7) is opt-in: subclasses reimplementing select() would be bypassed
+    epollFd = -1;
+    if (!qEnvironmentVariableIsEmpty("QT_EVENT_DISPATCHER_EPOLL")) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd == -1) {
+            perror("QEventDispatcherUNIXPrivate(): Unable to create epoll instance, using select()");
+        } else {
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = thread_pipe[0];
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, thread_pipe[0], &ev) == -1) {
+                perror("QEventDispatcherUNIXPrivate(): Unable to watch thread pipe, using select()");
+                close(epollFd);
+                epollFd = -1;
+            }
+        }
+    }
+#endif
 }
 
 QEventDispatcherUNIXPrivate::~QEventDispatcherUNIXPrivate()
@@ -167,6 +192,17 @@ QEventDispatcherUNIXPrivate::~QEventDispatcherUNIXPrivate()
         close(thread_pipe[1]);
 #endif
 
+#ifndef QT_NO_EPOLL
+    if (epollFd != -1) {
+        close(epollFd);
+        QHash<int, QSockNotSetEpoll>::const_iterator it = sn_epoll.constBegin();
+        for ( ; it != sn_epoll.constEnd(); ++it) {
+            for (int type = 0; type < 3; ++type)
+                delete it.value().notifiers[type];
+        }
+    }
+#endif
+
     // cleanup timers
     qDeleteAll(timerList);
 }
@@ -280,36 +316,220 @@ int QEventDispatcherUNIXPrivate::initThreadWakeUp()
 
 int QEventDispatcherUNIXPrivate::processThreadWakeUp(int nsel)
 {
-    if (nsel > 0 && FD_ISSET(thread_pipe[0], &sn_vec[0].select_fds)) {
-        // some other thread woke us up... consume the data on the thread pipe so that
-        // select doesn't immediately return next time
+    if (nsel > 0 && FD_ISSET(thread_pipe[0], &sn_vec[0].select_fds))
+        return consumeThreadWakeUp();
+    return 0;
+}
+
+int QEventDispatcherUNIXPrivate::consumeThreadWakeUp()
+{
+    // some other thread woke us up... consume the data on the thread pipe so that
+    // select doesn't immediately return next time
 #if defined(Q_OS_VXWORKS)
-        char c[16];
-        ::read(thread_pipe[0], c, sizeof(c));
-        ::ioctl(thread_pipe[0], FIOFLUSH, 0);
+    char c[16];
+    ::read(thread_pipe[0], c, sizeof(c));
+    ::ioctl(thread_pipe[0], FIOFLUSH, 0);
 #else
 #  ifndef QT_NO_EVENTFD
-        if (thread_pipe[1] == -1) {
-            // eventfd
-            eventfd_t value;
-            eventfd_read(thread_pipe[0], &value);
-        } else
+    if (thread_pipe[1] == -1) {
+        // eventfd
+        eventfd_t value;
+        eventfd_read(thread_pipe[0], &value);
+    } else
 #  endif
-        {
-            char c[16];
-            while (::read(thread_pipe[0], c, sizeof(c)) > 0) {
-            }
+    {
+        char c[16];
+        while (::read(thread_pipe[0], c, sizeof(c)) > 0) {
         }
+    }
 #endif
-        if (!wakeUps.testAndSetRelease(1, 0)) {
-            // hopefully, this is dead code
-            qWarning("QEventDispatcherUNIX: internal error, wakeUps.testAndSetRelease(1, 0) failed!");
+    if (!wakeUps.testAndSetRelease(1, 0)) {
+        // hopefully, this is dead code
+        qWarning("QEventDispatcherUNIX: internal error, wakeUps.testAndSetRelease(1, 0) failed!");
+    }
+    return 1;
+}
+
+#ifndef QT_NO_EPOLL
+static const char *socketNotifierTypeName(int type)
+{
+    static const char *t[] = { "Read", "Write", "Exception" };
+    return t[type];
+}
+
+// number of ready descriptors fetched from the kernel per epoll_wait() call
+enum { EpollEventBatch = 256 };
+
+int QEventDispatcherUNIXPrivate::doEpoll(QEventLoop::ProcessEventsFlags flags, timespec *timeout)
+{
+    Q_Q(QEventDispatcherUNIX);
+
+    // epoll_wait() only has millisecond resolution; round up so that timers
+    // never get woken up before they are due
+    int msecs = -1;
+    if (timeout) {
+        const qint64 ms = qint64(timeout->tv_sec) * 1000 + (timeout->tv_nsec + 999999) / 1000000;
+        msecs = int(qMin<qint64>(ms, INT_MAX));
+    }
+
+    if ((flags & QEventLoop::ExcludeSocketNotifiers) && !sn_epoll.isEmpty()) {
+        // the epoll set is level-triggered, so ready notifiers would make
+        // epoll_wait() return immediately; only wait for the thread pipe
+        pollfd pfd;
+        pfd.fd = thread_pipe[0];
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int nsel;
+        EINTR_LOOP(nsel, ::poll(&pfd, 1, msecs));
+        if (nsel == -1)
+            perror("poll");
+        return nsel > 0 ? consumeThreadWakeUp() : 0;
+    }
+
+    if (!sn_epoll_always_ready.isEmpty()) {
+        // select() wouldn't block either
+        msecs = 0;
+        for (int i = 0; i < sn_epoll_always_ready.size(); ++i) {
+            QSockNotSetEpoll &set = sn_epoll[sn_epoll_always_ready.at(i)];
+            setEpollNotifierPending(set, QSocketNotifier::Read);
+            setEpollNotifierPending(set, QSocketNotifier::Write);
         }
-        return 1;
     }
-    return 0;
+
+    epoll_event events[EpollEventBatch];
+    int nsel;
+    EINTR_LOOP(nsel, epoll_wait(epollFd, events, EpollEventBatch, msecs));
+    if (nsel == -1) {
+        perror("epoll_wait");
+        return 0;
+    }
+
+    int nevents = 0;
+    for (int i = 0; i < nsel; ++i) {
+        const int fd = events[i].data.fd;
+        if (fd == thread_pipe[0]) {
+            nevents += consumeThreadWakeUp();
+            continue;
+        }
+
+        QHash<int, QSockNotSetEpoll>::iterator it = sn_epoll.find(fd);
+        if (it == sn_epoll.end())
+            continue;
+
+        // report the same conditions select() would: errors and hang-ups
+        // make a descriptor both readable and writable
+        const quint32 revents = events[i].events;
+        if (revents & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            setEpollNotifierPending(it.value(), QSocketNotifier::Read);
+        if (revents & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+            setEpollNotifierPending(it.value(), QSocketNotifier::Write);
+        if (revents & EPOLLPRI)
+            setEpollNotifierPending(it.value(), QSocketNotifier::Exception);
+    }
+
+    return nevents + q->activateSocketNotifiers();
 }
 
+void QEventDispatcherUNIXPrivate::setEpollNotifierPending(QSockNotSetEpoll &set, int type)
+{
+    QSockNot *sn = set.notifiers[type];
+    if (!sn || (set.pending & (1 << type)))
+        return;
+
+    // random activation order, see QEventDispatcherUNIX::setSocketNotifierPending()
+    if (sn_pending_list.isEmpty())
+        sn_pending_list.append(sn);
+    else
+        sn_pending_list.insert((qrand() & 0xff) % (sn_pending_list.size() + 1), sn);
+    set.pending |= 1 << type;
+}
+
+bool QEventDispatcherUNIXPrivate::updateEpollEvents(int fd, const QSockNotSetEpoll &set, int op)
+{
+    epoll_event ev;
+    ev.events = 0;
+    if (set.notifiers[QSocketNotifier::Read])
+        ev.events |= EPOLLIN;
+    if (set.notifiers[QSocketNotifier::Write])
+        ev.events |= EPOLLOUT;
+    if (set.notifiers[QSocketNotifier::Exception])
+        ev.events |= EPOLLPRI;
+    ev.data.fd = fd;
+    return epoll_ctl(epollFd, op, fd, &ev) == 0;
+}
+
+void QEventDispatcherUNIXPrivate::registerEpollNotifier(QSocketNotifier *notifier)
+{
+    const int sockfd = notifier->socket();
+    const int type = notifier->type();
+
+    QSockNotSetEpoll &set = sn_epoll[sockfd];
+    const bool added = set.isEmpty();
+    if (QSockNot *old = set.notifiers[type]) {
+        qWarning("QSocketNotifier: Multiple socket notifiers for "
+                 "same socket %d and type %s", sockfd, socketNotifierTypeName(type));
+        sn_pending_list.removeAll(old);
+        delete old;
+    }
+
+    QSockNot *sn = new QSockNot;
+    sn->obj = notifier;
+    sn->fd = sockfd;
+    sn->queue = 0;
+    set.notifiers[type] = sn;
+    set.pending &= ~(1 << type);
+
+    if (set.alwaysReady)
+        return;
+    if (!updateEpollEvents(sockfd, set, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD)) {
+        if (errno == EPERM) {
+            // a regular file or a directory
+            set.alwaysReady = true;
+            sn_epoll_always_ready.append(sockfd);
+            return;
+        }
+        qErrnoWarning("QSocketNotifier: Unable to watch socket %d with epoll", sockfd);
+        delete sn;
+        set.notifiers[type] = 0;
+        if (set.isEmpty())
+            sn_epoll.remove(sockfd);
+    }
+}
+
+void QEventDispatcherUNIXPrivate::unregisterEpollNotifier(QSocketNotifier *notifier)
+{
+    const int sockfd = notifier->socket();
+    const int type = notifier->type();
+
+    QHash<int, QSockNotSetEpoll>::iterator it = sn_epoll.find(sockfd);
+    if (it == sn_epoll.end())
+        return;
+    QSockNotSetEpoll &set = it.value();
+    QSockNot *sn = set.notifiers[type];
+    if (!sn || sn->obj != notifier) // not found
+        return;
+
+    sn_pending_list.removeAll(sn);
+    delete sn;
+    set.notifiers[type] = 0;
+    set.pending &= ~(1 << type);
+
+    // the descriptor may already have been closed, in which case the kernel
+    // has dropped it from the epoll set on its own; ignore errors here
+    if (set.isEmpty()) {
+        if (set.alwaysReady) {
+            sn_epoll_always_ready.removeOne(sockfd);
+        } else {
+            epoll_event ev;
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, sockfd, &ev);
+        }
+        sn_epoll.erase(it);
+    } else if (!set.alwaysReady) {
+        updateEpollEvents(sockfd, set, EPOLL_CTL_MOD);
+    }
+}
+#endif // QT_NO_EPOLL
+
 QEventDispatcherUNIX::QEventDispatcherUNIX(QObject *parent)
     : QAbstractEventDispatcher(*new QEventDispatcherUNIXPrivate, parent)
 { }
@@ -420,11 +640,12 @@ QSockNotType::~QSockNotType()
 void QEventDispatcherUNIX::registerSocketNotifier(QSocketNotifier *notifier)
 {
     Q_ASSERT(notifier);
+    Q_D(QEventDispatcherUNIX);
     int sockfd = notifier->socket();
     int type = notifier->type();
 #ifndef QT_NO_DEBUG
     if (sockfd < 0
-        || unsigned(sockfd) >= FD_SETSIZE) {
+        || (unsigned(sockfd) >= FD_SETSIZE && !d->usesEpoll())) {
         qWarning("QSocketNotifier: Internal error");
         return;
     } else if (notifier->thread() != thread()
@@ -434,7 +655,13 @@ void QEventDispatcherUNIX::registerSocketNotifier(QSocketNotifier *notifier)
     }
 #endif
 
-    Q_D(QEventDispatcherUNIX);
+#ifndef QT_NO_EPOLL
+    if (d->epollFd != -1) {
+        d->registerEpollNotifier(notifier);
+        return;
+    }
+#endif
+
     QSockNotType::List &list = d->sn_vec[type].list;
     fd_set *fds  = &d->sn_vec[type].enabled_fds;
     QSockNot *sn;
@@ -464,11 +691,12 @@ void QEventDispatcherUNIX::registerSocketNotifier(QSocketNotifier *notifier)
 void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
 {
     Q_ASSERT(notifier);
+    Q_D(QEventDispatcherUNIX);
     int sockfd = notifier->socket();
     int type = notifier->type();
 #ifndef QT_NO_DEBUG
     if (sockfd < 0
-        || unsigned(sockfd) >= FD_SETSIZE) {
+        || (unsigned(sockfd) >= FD_SETSIZE && !d->usesEpoll())) {
         qWarning("QSocketNotifier: Internal error");
         return;
     } else if (notifier->thread() != thread()
@@ -478,7 +706,13 @@ void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
     }
 #endif
 
-    Q_D(QEventDispatcherUNIX);
+#ifndef QT_NO_EPOLL
+    if (d->epollFd != -1) {
+        d->unregisterEpollNotifier(notifier);
+        return;
+    }
+#endif
+
     QSockNotType::List &list = d->sn_vec[type].list;
     fd_set *fds  =  &d->sn_vec[type].enabled_fds;
     QSockNot *sn = 0;
@@ -510,18 +744,28 @@ void QEventDispatcherUNIX::unregisterSocketNotifier(QSocketNotifier *notifier)
 void QEventDispatcherUNIX::setSocketNotifierPending(QSocketNotifier *notifier)
 {
     Q_ASSERT(notifier);
+    Q_D(QEventDispatcherUNIX);
     int sockfd = notifier->socket();
     int type = notifier->type();
 #ifndef QT_NO_DEBUG
     if (sockfd < 0
-        || unsigned(sockfd) >= FD_SETSIZE) {
+        || (unsigned(sockfd) >= FD_SETSIZE && !d->usesEpoll())) {
         qWarning("QSocketNotifier: Internal error");
         return;
     }
     Q_ASSERT(notifier->thread() == thread() && thread() == QThread::currentThread());
 #endif
 
-    Q_D(QEventDispatcherUNIX);
+#ifndef QT_NO_EPOLL
+    if (d->epollFd != -1) {
+        QHash<int, QSockNotSetEpoll>::iterator it = d->sn_epoll.find(sockfd);
+        if (it != d->sn_epoll.end() && it.value().notifiers[type]
+            && it.value().notifiers[type]->obj == notifier)
+            d->setEpollNotifierPending(it.value(), type);
+        return;
+    }
+#endif
+
     QSockNotType::List &list = d->sn_vec[type].list;
     QSockNot *sn = 0;
     int i;
@@ -568,6 +812,17 @@ int QEventDispatcherUNIX::activateSocketNotifiers()
     QEvent event(QEvent::SockAct);
     while (!d->sn_pending_list.isEmpty()) {
         QSockNot *sn = d->sn_pending_list.takeFirst();
+#ifndef QT_NO_EPOLL
+        if (d->epollFd != -1) {
+            // unregistering a notifier removes it from sn_pending_list,
+            // so its set is still there
+            QSockNotSetEpoll &set = d->sn_epoll[sn->fd];
+            set.pending &= ~(1 << sn->obj->type());
+            QCoreApplication::sendEvent(sn->obj, &event);
+            ++n_act;
+            continue;
+        }
+#endif
         if (FD_ISSET(sn->fd, sn->queue)) {
             FD_CLR(sn->fd, sn->queue);
             QCoreApplication::sendEvent(sn->obj, &event);
@@ -612,6 +867,11 @@ bool QEventDispatcherUNIX::processEvents(QEventLoop::ProcessEventsFlags flags)
             tm->tv_nsec = 0l;
         }
 
+#ifndef QT_NO_EPOLL
+        if (d->epollFd != -1)
+            nevents = d->doEpoll(flags, tm);
+        else
+#endif
         nevents = d->doSelect(flags, tm);
 
         // activate timers
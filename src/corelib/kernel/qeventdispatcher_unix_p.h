@@ -54,6 +54,7 @@
 //
 
 #include "QtCore/qabstracteventdispatcher.h"
+#include "QtCore/qhash.h"
 #include "QtCore/qlist.h"
 #include "private/qabstracteventdispatcher_p.h"
 #include "private/qcore_unix_p.h"
@@ -68,6 +69,10 @@
 #  endif
 #endif
 
+#if !defined(Q_OS_LINUX) && !defined(QT_NO_EPOLL)
+#  define QT_NO_EPOLL
+#endif
+
 QT_BEGIN_NAMESPACE
 
 struct QSockNot
@@ -92,6 +97,25 @@ public:
 
 };
 
+#ifndef QT_NO_EPOLL
+struct QSockNotSetEpoll
+{
+    QSockNotSetEpoll() : pending(0), alwaysReady(false)
+    { notifiers[0] = notifiers[1] = notifiers[2] = 0; }
+
+    bool isEmpty() const
+    { return !notifiers[0] && !notifiers[1] && !notifiers[2]; }
+
+    // read, write and exception notifier for one descriptor
+    QSockNot *notifiers[3];
+    // bitmask of the types above that are waiting for activation
+    int pending;
+    // epoll refuses regular files; select() reports those as always
+    // readable and writable, so the descriptor isn't in the epoll set
+    bool alwaysReady;
+};
+#endif
+
 class QEventDispatcherUNIXPrivate;
 
 class Q_CORE_EXPORT QEventDispatcherUNIX : public QAbstractEventDispatcher
@@ -144,6 +168,24 @@ public:
     int doSelect(QEventLoop::ProcessEventsFlags flags, timespec *timeout);
     virtual int initThreadWakeUp();
     virtual int processThreadWakeUp(int nsel);
+    int consumeThreadWakeUp();
+
+    inline bool usesEpoll() const
+    {
+#ifndef QT_NO_EPOLL
+        return epollFd != -1;
+#else
+        return false;
+#endif
+    }
+
+#ifndef QT_NO_EPOLL
+    int doEpoll(QEventLoop::ProcessEventsFlags flags, timespec *timeout);
+    void registerEpollNotifier(QSocketNotifier *notifier);
+    void unregisterEpollNotifier(QSocketNotifier *notifier);
+    void setEpollNotifierPending(QSockNotSetEpoll &set, int type);
+    bool updateEpollEvents(int fd, const QSockNotSetEpoll &set, int op);
+#endif
 
     bool mainThread;
 
@@ -161,6 +203,15 @@ public:
     // pending socket notifiers list
     QSockNotType::List sn_pending_list;
 
+#ifndef QT_NO_EPOLL
+    // if epollFd is -1, select(2) is used and sn_vec holds the notifiers;
+    // otherwise the notifiers live in sn_epoll, keyed by descriptor
+    int epollFd;
+    QHash<int, QSockNotSetEpoll> sn_epoll;
+    // descriptors in sn_epoll that are always ready
+    QList<int> sn_epoll_always_ready;
+#endif
+
     QAtomicInt wakeUps;
     QAtomicInt interrupt; // bool
 };
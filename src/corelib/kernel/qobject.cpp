@@ -232,7 +232,7 @@ QObjectPrivate::~QObjectPrivate()
             QAbstractEventDispatcherPrivate::releaseTimerId(extraData->runningTimers.at(i));
     }
 
-    if (postedEvents)
+    if (postedEvents || threadData->postEventList.hasIncomingEvents())
         QCoreApplication::removePostedEvents(q_ptr, 0);
 
     threadData->deref();
@@ -272,32 +272,216 @@ static void computeOffsets(const QMetaObject *metaobject, int *signalOffset, int
     QObjectPrivate::signalIndex (not QMetaObject::indexOfSignal).
     Negative index means connections to all signals.
 
-    This vector is protected by the object mutex (signalSlotMutexes())
+    Modifications of this vector are protected by the object mutex
+    (signalSlotLock()). QMetaObject::activate() reads it without locking:
+    it registers itself in inUse, and while inUse is non-zero connections
+    are only appended or have their receiver reset to 0, never unlinked
+    or freed. The lists of the signals live in a SignalVector that is
+    replaced, not reallocated, when it grows.
+
+    A disconnected connection stays in its list until the next
+    cleanConnectionLists(), like before. Its slot object is destroyed right
+    away if nobody traverses the lists, as activate() only looks at the
+    slot object of connections whose receiver it has seen set; otherwise,
+    like the replaced SignalVectors, it is released by whoever leaves the
+    lists last.
 
     Each Connection is also part of a 'senders' linked list. The mutex
     of the receiver must be locked when touching the pointers of this
     linked list.
 */
-class QObjectConnectionListVector : public QVector<QObjectPrivate::ConnectionList>
+class QObjectConnectionListVector
 {
 public:
+    enum {
+        DirtyFlag = 0x40000000, // some Connection have been disconnected (their receiver is 0) but not removed from the list yet
+        DeferredFlag = 0x20000000, // a slot object or a SignalVector must be released once nobody traverses the lists
+        CleaningFlag = 0x10000000, // cleanConnectionLists() or takeSlotObject() has the lists to itself
+        UsersMask = CleaningFlag - 1
+    };
+
+    struct SignalVector
+    {
+        explicit SignalVector(int count)
+            : count(count), lists(new QObjectPrivate::ConnectionList[count]), retired(0)
+        { }
+        ~SignalVector() { delete [] lists; }
+
+        int count;
+        QObjectPrivate::ConnectionList *lists;
+        SignalVector *retired; // the vectors this one replaced, that may still be in use
+    };
+
     bool orphaned; //the QObject owner of this vector has been destroyed while the vector was inUse
-    bool dirty; //some Connection have been disconnected (their receiver is 0) but not removed from the list yet
-    int inUse; //number of functions that are currently accessing this object or its connections
+    QAtomicInt inUse; //number of functions that are currently accessing this object or its connections, plus the flags above
     QObjectPrivate::ConnectionList allsignals;
+    QAtomicPointer<SignalVector> signalVector;
 
     QObjectConnectionListVector()
-        : QVector<QObjectPrivate::ConnectionList>(), orphaned(false), dirty(false), inUse(0)
+        : orphaned(false), inUse(0), signalVector(0)
     { }
 
+    ~QObjectConnectionListVector()
+    {
+        SignalVector *vector = signalVector.load();
+        while (vector) {
+            SignalVector *retired = vector->retired;
+            delete vector;
+            vector = retired;
+        }
+    }
+
+    int count() const
+    {
+        const SignalVector *vector = signalVector.loadAcquire();
+        return vector ? vector->count : 0;
+    }
+
+    // the signalSlotLock() of the owner must be locked
+    void resize(int count)
+    {
+        SignalVector *oldVector = signalVector.load();
+        SignalVector *newVector = new SignalVector(count);
+        if (oldVector) {
+            for (int i = 0; i < oldVector->count; ++i) {
+                newVector->lists[i].first.store(oldVector->lists[i].first.load());
+                newVector->lists[i].last.store(oldVector->lists[i].last.load());
+            }
+        }
+        newVector->retired = oldVector;
+        signalVector.storeRelease(newVector);
+        if (!oldVector)
+            return;
+        if (inUse.testAndSetOrdered(0, CleaningFlag)) {
+            // nobody can be looking at the old vector anymore
+            freeRetiredSignalVectors();
+            inUse.fetchAndAddOrdered(-CleaningFlag);
+        } else {
+            setFlag(DeferredFlag);
+        }
+    }
+
+    // the signalSlotLock() of the owner must be locked
+    void freeRetiredSignalVectors()
+    {
+        SignalVector *vector = signalVector.load();
+        if (!vector)
+            return;
+        SignalVector *retired = vector->retired;
+        vector->retired = 0;
+        while (retired) {
+            SignalVector *next = retired->retired;
+            delete retired;
+            retired = next;
+        }
+    }
+
+    // the signalSlotLock() of the owner must be locked
+    void setFlag(int flag)
+    {
+        // the flags only change while the lock is held, so there is no race
+        if (!(inUse.load() & flag))
+            inUse.fetchAndAddOrdered(flag);
+    }
+
+    void setDirty() { setFlag(DirtyFlag); }
+
+    // The signalSlotLock() of the owner must be locked and the receiver of
+    // c reset to 0. Returns the slot object of c, to be destroyed once the
+    // lock is released, unless someone besides the caller's own \a users
+    // traverses the lists and might still call it.
+    QtPrivate::QSlotObjectBase *takeSlotObject(QObjectPrivate::Connection *c, int users = 0)
+    {
+        if (!c->isSlotObject)
+            return 0;
+        for (bool deferred = false; ; deferred = true) {
+            const int state = (inUse.load() & ~UsersMask) | users;
+            if (inUse.testAndSetOrdered(state, state | CleaningFlag))
+                break;
+            if (deferred)
+                return 0; // released by whoever leaves the lists last
+            // the others might leave before they see the flag, so try again
+            setFlag(DeferredFlag);
+        }
+        c->isSlotObject = false;
+        QtPrivate::QSlotObjectBase *slotObj = c->slotObj;
+        inUse.fetchAndAddOrdered(-CleaningFlag);
+        return slotObj;
+    }
+
     QObjectPrivate::ConnectionList &operator[](int at)
     {
         if (at < 0)
             return allsignals;
-        return QVector<QObjectPrivate::ConnectionList>::operator[](at);
+        return signalVector.loadAcquire()->lists[at];
+    }
+
+    const QObjectPrivate::ConnectionList &at(int at) const
+    {
+        if (at < 0)
+            return allsignals;
+        return signalVector.loadAcquire()->lists[at];
     }
 };
 
+/*!
+  \internal
+  Destroys the slot objects of the connections returned by
+  QObjectPrivate::cleanConnectionLists() and releases the connections.
+
+  This must be called without holding a signalSlotLock(): a slot object
+  might own objects whose destructor locks a mutex of the same pool.
+ */
+static void destroyConnections(QObjectPrivate::Connection *c)
+{
+    while (c) {
+        QObjectPrivate::Connection *next = c->nextConnectionList.load();
+        if (c->isSlotObject) {
+            c->isSlotObject = false;
+            c->slotObj->destroyIfLastRef();
+        }
+        c->deref();
+        c = next;
+    }
+}
+
+/*!
+  \internal
+  Registers a traversal of \a connectionLists, the connection lists of
+  \a sender, that does not hold the signalSlotLock() of \a sender.
+ */
+static inline void enterConnectionLists(QObjectConnectionListVector *connectionLists, const QObject *sender)
+{
+    if (connectionLists->inUse.fetchAndAddOrdered(1) & QObjectConnectionListVector::CleaningFlag) {
+        // cleanConnectionLists() is unlinking connections right now, wait for it
+        connectionLists->inUse.deref();
+        QMutexLocker locker(signalSlotLock(sender));
+        connectionLists->inUse.ref();
+    }
+}
+
+/*!
+  \internal
+  Ends a traversal started with enterConnectionLists(). The last one to
+  leave releases what could not be released during the traversal, or
+  deletes the lists if \a sender has been destroyed meanwhile.
+ */
+static void leaveConnectionLists(QObjectConnectionListVector *connectionLists, QObject *sender)
+{
+    const int state = connectionLists->inUse.fetchAndAddOrdered(-1);
+    if ((state & QObjectConnectionListVector::UsersMask) != 1)
+        return;
+
+    if (connectionLists->orphaned) {
+        delete connectionLists;
+    } else if (state & QObjectConnectionListVector::DeferredFlag) {
+        QMutexLocker locker(signalSlotLock(sender));
+        QObjectPrivate::Connection *garbage = QObjectPrivate::get(sender)->cleanConnectionLists();
+        locker.unlock();
+        destroyConnections(garbage);
+    }
+}
+
 // Used by QAccessibleWidget
 bool QObjectPrivate::isSender(const QObject *receiver, const char *signal) const
 {
@@ -306,15 +490,15 @@ bool QObjectPrivate::isSender(const QObject *receiver, const char *signal) const
     if (signal_index < 0)
         return false;
     QMutexLocker locker(signalSlotLock(q));
-    if (connectionLists) {
+    if (QObjectConnectionListVector *connectionLists = this->connectionLists.load()) {
         if (signal_index < connectionLists->count()) {
             const QObjectPrivate::Connection *c =
-                connectionLists->at(signal_index).first;
+                connectionLists->at(signal_index).first.load();
 
             while (c) {
-                if (c->receiver == receiver)
+                if (c->receiver.load() == receiver)
                     return true;
-                c = c->nextConnectionList;
+                c = c->nextConnectionList.load();
             }
         }
     }
@@ -330,14 +514,14 @@ QObjectList QObjectPrivate::receiverList(const char *signal) const
     if (signal_index < 0)
         return returnValue;
     QMutexLocker locker(signalSlotLock(q));
-    if (connectionLists) {
+    if (QObjectConnectionListVector *connectionLists = this->connectionLists.load()) {
         if (signal_index < connectionLists->count()) {
-            const QObjectPrivate::Connection *c = connectionLists->at(signal_index).first;
+            const QObjectPrivate::Connection *c = connectionLists->at(signal_index).first.load();
 
             while (c) {
-                if (c->receiver)
-                    returnValue << c->receiver;
-                c = c->nextConnectionList;
+                if (QObject *receiver = c->receiver.load())
+                    returnValue << receiver;
+                c = c->nextConnectionList.load();
             }
         }
     }
@@ -363,26 +547,33 @@ QObjectList QObjectPrivate::senderList() const
   this function
 
   Will also add the connection in the sender's list of the receiver.
+
+  Returns the connections removed by cleanConnectionLists(), to be passed
+  to destroyConnections() once the locks have been released.
  */
-void QObjectPrivate::addConnection(int signal, Connection *c)
+QObjectPrivate::Connection *QObjectPrivate::addConnection(int signal, Connection *c)
 {
     Q_ASSERT(c->sender == q_ptr);
-    if (!connectionLists)
+    QObjectConnectionListVector *connectionLists = this->connectionLists.load();
+    if (!connectionLists) {
         connectionLists = new QObjectConnectionListVector();
+        // activate() reads the lists without locking
+        this->connectionLists.storeRelease(connectionLists);
+    }
     if (signal >= connectionLists->count())
         connectionLists->resize(signal + 1);
 
+    // update last before publishing c, so that activate() never finds a
+    // connection past the last one it has seen
     ConnectionList &connectionList = (*connectionLists)[signal];
-    if (connectionList.last) {
-        connectionList.last->nextConnectionList = c;
-    } else {
-        connectionList.first = c;
-    }
-    connectionList.last = c;
-
-    cleanConnectionLists();
+    Connection *last = connectionList.last.load();
+    connectionList.last.storeRelease(c);
+    if (last)
+        last->nextConnectionList.storeRelease(c);
+    else
+        connectionList.first.storeRelease(c);
 
-    c->prev = &(QObjectPrivate::get(c->receiver)->senders);
+    c->prev = &(QObjectPrivate::get(c->receiver.load())->senders);
     c->next = *c->prev;
     *c->prev = c;
     if (c->next)
@@ -393,42 +584,63 @@ void QObjectPrivate::addConnection(int signal, Connection *c)
     } else if (signal < (int)sizeof(connectedSignals) * 8) {
         connectedSignals[signal >> 5] |= (1 << (signal & 0x1f));
     }
+
+    return cleanConnectionLists();
 }
 
-void QObjectPrivate::cleanConnectionLists()
+/*!
+  \internal
+  Removes the disconnected connections from the connection lists and frees
+  the replaced signal vectors, unless someone is still traversing the lists.
+
+  The signalSlotLock() of the object must be locked while calling this
+  function. The removed connections are returned linked through
+  nextConnectionList, and must be passed to destroyConnections() once the
+  lock has been released.
+ */
+QObjectPrivate::Connection *QObjectPrivate::cleanConnectionLists()
 {
-    if (connectionLists->dirty && !connectionLists->inUse) {
-        // remove broken connections
-        for (int signal = -1; signal < connectionLists->count(); ++signal) {
-            QObjectPrivate::ConnectionList &connectionList =
-                (*connectionLists)[signal];
-
-            // Set to the last entry in the connection list that was *not*
-            // deleted.  This is needed to update the list's last pointer
-            // at the end of the cleanup.
-            QObjectPrivate::Connection *last = 0;
-
-            QObjectPrivate::Connection **prev = &connectionList.first;
-            QObjectPrivate::Connection *c = *prev;
-            while (c) {
-                if (c->receiver) {
-                    last = c;
-                    prev = &c->nextConnectionList;
-                    c = *prev;
-                } else {
-                    QObjectPrivate::Connection *next = c->nextConnectionList;
-                    *prev = next;
-                    c->deref();
-                    c = next;
-                }
-            }
+    QObjectConnectionListVector *connectionLists = this->connectionLists.load();
+    const int flags = connectionLists->inUse.load()
+            & (QObjectConnectionListVector::DirtyFlag | QObjectConnectionListVector::DeferredFlag);
+    if (!flags || !connectionLists->inUse.testAndSetOrdered(flags, QObjectConnectionListVector::CleaningFlag))
+        return 0;
 
-            // Correct the connection list's last pointer.
-            // As conectionList.last could equal last, this could be a noop
-            connectionList.last = last;
+    Connection *garbage = 0;
+
+    // remove broken connections
+    for (int signal = -1; signal < connectionLists->count(); ++signal) {
+        QObjectPrivate::ConnectionList &connectionList =
+            (*connectionLists)[signal];
+
+        // Set to the last entry in the connection list that was *not*
+        // deleted.  This is needed to update the list's last pointer
+        // at the end of the cleanup.
+        QObjectPrivate::Connection *last = 0;
+
+        QAtomicPointer<QObjectPrivate::Connection> *prev = &connectionList.first;
+        QObjectPrivate::Connection *c = prev->load();
+        while (c) {
+            QObjectPrivate::Connection *next = c->nextConnectionList.load();
+            if (c->receiver.load()) {
+                last = c;
+                prev = &c->nextConnectionList;
+            } else {
+                prev->store(next);
+                c->nextConnectionList.store(garbage);
+                garbage = c;
+            }
+            c = next;
         }
-        connectionLists->dirty = false;
+
+        // Correct the connection list's last pointer.
+        // As conectionList.last could equal last, this could be a noop
+        connectionList.last.store(last);
     }
+    connectionLists->freeRetiredSignalVectors();
+
+    connectionLists->inUse.fetchAndAddOrdered(-QObjectConnectionListVector::CleaningFlag);
+    return garbage;
 }
 
 /*!
@@ -828,37 +1040,33 @@ QObject::~QObject()
         d->currentSender->ref = 0;
     d->currentSender = 0;
 
-    if (d->connectionLists || d->senders) {
+    if (d->connectionLists.load() || d->senders) {
         QMutex *signalSlotMutex = signalSlotLock(this);
         QMutexLocker locker(signalSlotMutex);
 
         // disconnect all receivers
-        if (d->connectionLists) {
-            ++d->connectionLists->inUse;
-            int connectionListsCount = d->connectionLists->count();
+        if (QObjectConnectionListVector *connectionLists = d->connectionLists.load()) {
+            connectionLists->inUse.ref();
+            int connectionListsCount = connectionLists->count();
             for (int signal = -1; signal < connectionListsCount; ++signal) {
                 QObjectPrivate::ConnectionList &connectionList =
-                    (*d->connectionLists)[signal];
-
-                while (QObjectPrivate::Connection *c = connectionList.first) {
-                    if (!c->receiver) {
-                        connectionList.first = c->nextConnectionList;
-                        c->deref();
-                        continue;
-                    }
-
-                    QMutex *m = signalSlotLock(c->receiver);
-                    bool needToUnlock = QOrderedMutexLocker::relock(signalSlotMutex, m);
-
-                    if (c->receiver) {
-                        *c->prev = c->next;
-                        if (c->next) c->next->prev = c->prev;
+                    (*connectionLists)[signal];
+
+                while (QObjectPrivate::Connection *c = connectionList.first.load()) {
+                    if (QObject *receiver = c->receiver.load()) {
+                        QMutex *m = signalSlotLock(receiver);
+                        bool needToUnlock = QOrderedMutexLocker::relock(signalSlotMutex, m);
+
+                        if (c->receiver.load()) {
+                            *c->prev = c->next;
+                            if (c->next) c->next->prev = c->prev;
+                        }
+                        c->receiver.store(0);
+                        if (needToUnlock)
+                            m->unlock();
                     }
-                    c->receiver = 0;
-                    if (needToUnlock)
-                        m->unlock();
 
-                    connectionList.first = c->nextConnectionList;
+                    connectionList.first.store(c->nextConnectionList.load());
 
                     // The destroy operation must happen outside the lock
                     if (c->isSlotObject) {
@@ -871,12 +1079,11 @@ QObject::~QObject()
                 }
             }
 
-            if (!--d->connectionLists->inUse) {
-                delete d->connectionLists;
-            } else {
-                d->connectionLists->orphaned = true;
-            }
-            d->connectionLists = 0;
+            // whoever leaves the lists last deletes them
+            connectionLists->orphaned = true;
+            if ((connectionLists->inUse.fetchAndAddOrdered(-1) & QObjectConnectionListVector::UsersMask) == 1)
+                delete connectionLists;
+            d->connectionLists.store(0);
         }
 
         /* Disconnect all senders:
@@ -905,15 +1112,13 @@ QObject::~QObject()
                 m->unlock();
                 continue;
             }
-            node->receiver = 0;
-            QObjectConnectionListVector *senderLists = sender->d_func()->connectionLists;
-            if (senderLists)
-                senderLists->dirty = true;
-
+            node->receiver.store(0);
             QtPrivate::QSlotObjectBase *slotObj = Q_NULLPTR;
-            if (node->isSlotObject) {
-                slotObj = node->slotObj;
-                node->isSlotObject = false;
+            QObjectConnectionListVector *senderLists = sender->d_func()->connectionLists.load();
+            if (senderLists) {
+                senderLists->setDirty();
+                // unless the sender is emitting in another thread
+                slotObj = senderLists->takeSlotObject(node);
             }
 
             node = node->next;
@@ -948,6 +1153,8 @@ QObjectPrivate::Connection::~Connection()
     }
     if (isSlotObject)
         slotObj->destroyIfLastRef();
+    if (QThreadData *td = receiverThreadData.load())
+        td->deref();
 }
 
 
@@ -1388,6 +1595,11 @@ void QObject::moveToThread(QThread *targetThread)
     // prepare to move
     d->moveToThread_helper();
 
+    // the connections to the objects being moved; activate() uses the thread
+    // data they cache to decide between direct and queued calls
+    QVector<QObjectPrivate::Connection *> connections;
+    d->collectSenderConnections_helper(&connections);
+
     QOrderedMutexLocker locker(&currentData->postEventList.mutex,
                                &targetData->postEventList.mutex);
 
@@ -1396,9 +1608,26 @@ void QObject::moveToThread(QThread *targetThread)
 
     // move the object
     d_func()->setThreadData_helper(currentData, targetData);
+    for (int i = 0; i < connections.size(); ++i) {
+        targetData->ref();
+        // the old thread data is currentData, which we keep alive
+        connections.at(i)->receiverThreadData.fetchAndStoreOrdered(targetData)->deref();
+    }
+
+    // postEvent() calls that have not seen the new thread yet may still push
+    // events for the moved objects onto the old thread's lock-free stack;
+    // wait for them and move those events along; the wait starts with an
+    // ordered read, so it cannot be reordered before the stores above
+    currentData->postEventList.waitForIncomingPosters();
+    QCoreApplicationPrivate::mergeIncomingPostedEvents(currentData);
 
     locker.unlock();
 
+    // catch the connections made while the objects were being moved
+    d->updateReceiverThreadData_helper();
+    for (int i = 0; i < connections.size(); ++i)
+        connections.at(i)->deref();
+
     // now currentData can commit suicide if it wants to
     currentData->deref();
 }
@@ -1452,6 +1681,64 @@ void QObjectPrivate::setThreadData_helper(QThreadData *currentData, QThreadData
     }
 }
 
+/*
+    Returns a new reference to the thread data to be kept in a new
+    connection to this object. The signalSlotLock() of the object must be
+    locked.
+*/
+QThreadData *QObjectPrivate::connectionThreadData()
+{
+    threadData->ref();
+    return threadData;
+}
+
+/*
+    Adds a reference to the connections to this object and its children to
+    \a connections, so that moveToThread() can update their thread data
+    while it holds the postEventList mutexes: activate() locks the
+    signalSlotLock() before posting events, so it cannot be locked then.
+*/
+void QObjectPrivate::collectSenderConnections_helper(QVector<Connection *> *connections)
+{
+    Q_Q(QObject);
+    {
+        QMutexLocker locker(signalSlotLock(q));
+        for (Connection *c = senders; c; c = c->next) {
+            c->ref();
+            connections->append(c);
+        }
+    }
+
+    for (int i = 0; i < children.size(); ++i) {
+        QObject *child = children.at(i);
+        child->d_func()->collectSenderConnections_helper(connections);
+    }
+}
+
+/*
+    Updates the thread data of the connections to this object and its
+    children that were made while moveToThread() was moving them.
+*/
+void QObjectPrivate::updateReceiverThreadData_helper()
+{
+    Q_Q(QObject);
+    {
+        QMutexLocker locker(signalSlotLock(q));
+        for (Connection *c = senders; c; c = c->next) {
+            if (c->receiverThreadData.load() == threadData)
+                continue;
+            threadData->ref();
+            // the old thread data is kept alive by moveToThread()
+            c->receiverThreadData.fetchAndStoreOrdered(threadData)->deref();
+        }
+    }
+
+    for (int i = 0; i < children.size(); ++i) {
+        QObject *child = children.at(i);
+        child->d_func()->updateReceiverThreadData_helper();
+    }
+}
+
 void QObjectPrivate::_q_reregisterTimers(void *pointer)
 {
     Q_Q(QObject);
@@ -2292,13 +2579,13 @@ int QObject::receivers(const char *signal) const
         }
 
         QMutexLocker locker(signalSlotLock(this));
-        if (d->connectionLists) {
-            if (signal_index < d->connectionLists->count()) {
+        if (QObjectConnectionListVector *connectionLists = d->connectionLists.load()) {
+            if (signal_index < connectionLists->count()) {
                 const QObjectPrivate::Connection *c =
-                    d->connectionLists->at(signal_index).first;
+                    connectionLists->at(signal_index).first.load();
                 while (c) {
-                    receivers += c->receiver ? 1 : 0;
-                    c = c->nextConnectionList;
+                    receivers += c->receiver.load() ? 1 : 0;
+                    c = c->nextConnectionList.load();
                 }
             }
         }
@@ -2343,14 +2630,14 @@ bool QObject::isSignalConnected(const QMetaMethod &signal) const
         return d->isSignalConnected(signalIndex);
 
     QMutexLocker locker(signalSlotLock(this));
-    if (d->connectionLists) {
-        if (signalIndex < uint(d->connectionLists->count())) {
+    if (QObjectConnectionListVector *connectionLists = d->connectionLists.load()) {
+        if (signalIndex < uint(connectionLists->count())) {
             const QObjectPrivate::Connection *c =
-                d->connectionLists->at(signalIndex).first;
+                connectionLists->at(signalIndex).first.load();
             while (c) {
-                if (c->receiver)
+                if (c->receiver.load())
                     return true;
-                c = c->nextConnectionList;
+                c = c->nextConnectionList.load();
             }
         }
     }
@@ -3122,17 +3409,17 @@ QObjectPrivate::Connection *QMetaObjectPrivate::connect(const QObject *sender,
                                signalSlotLock(receiver));
 
     if (type & Qt::UniqueConnection) {
-        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists;
+        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists.load();
         if (connectionLists && connectionLists->count() > signal_index) {
             const QObjectPrivate::Connection *c2 =
-                (*connectionLists)[signal_index].first;
+                (*connectionLists)[signal_index].first.load();
 
             int method_index_absolute = method_index + method_offset;
 
             while (c2) {
-                if (c2->receiver == receiver && c2->method() == method_index_absolute)
+                if (c2->receiver.load() == receiver && c2->method() == method_index_absolute)
                     return 0;
-                c2 = c2->nextConnectionList;
+                c2 = c2->nextConnectionList.load();
             }
         }
         type &= Qt::UniqueConnection - 1;
@@ -3141,18 +3428,20 @@ QObjectPrivate::Connection *QMetaObjectPrivate::connect(const QObject *sender,
     QScopedPointer<QObjectPrivate::Connection> c(new QObjectPrivate::Connection);
     c->sender = s;
     c->signal_index = signal_index;
-    c->receiver = r;
+    c->receiver.store(r);
     c->method_relative = method_index;
     c->method_offset = method_offset;
     c->connectionType = type;
     c->isSlotObject = false;
     c->argumentTypes.store(types);
-    c->nextConnectionList = 0;
+    c->nextConnectionList.store(0);
     c->callFunction = callFunction;
+    c->receiverThreadData.store(QObjectPrivate::get(r)->connectionThreadData());
 
-    QObjectPrivate::get(s)->addConnection(signal_index, c.data());
+    QObjectPrivate::Connection *garbage = QObjectPrivate::get(s)->addConnection(signal_index, c.data());
 
     locker.unlock();
+    destroyConnections(garbage);
     QMetaMethod smethod = QMetaObjectPrivate::signal(smeta, signal_index);
     if (smethod.isValid())
         s->connectNotify(smethod);
@@ -3199,18 +3488,19 @@ bool QMetaObjectPrivate::disconnectHelper(QObjectPrivate::Connection *c,
 {
     bool success = false;
     while (c) {
-        if (c->receiver
-            && (receiver == 0 || (c->receiver == receiver
+        QObject *r = c->receiver.load();
+        if (r
+            && (receiver == 0 || (r == receiver
                            && (method_index < 0 || c->method() == method_index)
                            && (slot == 0 || (c->isSlotObject && c->slotObj->compare(slot)))))) {
             bool needToUnlock = false;
             QMutex *receiverMutex = 0;
-            if (c->receiver) {
-                receiverMutex = signalSlotLock(c->receiver);
+            if (r) {
+                receiverMutex = signalSlotLock(r);
                 // need to relock this receiver and sender in the correct order
                 needToUnlock = QOrderedMutexLocker::relock(senderMutex, receiverMutex);
             }
-            if (c->receiver) {
+            if (c->receiver.load()) {
                 *c->prev = c->next;
                 if (c->next)
                     c->next->prev = c->prev;
@@ -3219,12 +3509,14 @@ bool QMetaObjectPrivate::disconnectHelper(QObjectPrivate::Connection *c,
             if (needToUnlock)
                 receiverMutex->unlock();
 
-            c->receiver = 0;
+            c->receiver.store(0);
 
-            if (c->isSlotObject) {
-                c->isSlotObject = false;
+            // our caller is traversing the lists as well
+            QObjectConnectionListVector *connectionLists = QObjectPrivate::get(c->sender)->connectionLists.load();
+            connectionLists->setDirty();
+            if (QtPrivate::QSlotObjectBase *slotObj = connectionLists->takeSlotObject(c, 1)) {
                 senderMutex->unlock();
-                c->slotObj->destroyIfLastRef();
+                slotObj->destroyIfLastRef();
                 senderMutex->lock();
             }
 
@@ -3233,7 +3525,7 @@ bool QMetaObjectPrivate::disconnectHelper(QObjectPrivate::Connection *c,
             if (disconnectType == DisconnectOne)
                 return success;
         }
-        c = c->nextConnectionList;
+        c = c->nextConnectionList.load();
     }
     return success;
 }
@@ -3255,39 +3547,40 @@ bool QMetaObjectPrivate::disconnect(const QObject *sender,
     QMutex *senderMutex = signalSlotLock(sender);
     QMutexLocker locker(senderMutex);
 
-    QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists;
+    QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists.load();
     if (!connectionLists)
         return false;
 
     // prevent incoming connections changing the connectionLists while unlocked
-    ++connectionLists->inUse;
+    connectionLists->inUse.ref();
 
     bool success = false;
     if (signal_index < 0) {
         // remove from all connection lists
         for (int sig_index = -1; sig_index < connectionLists->count(); ++sig_index) {
             QObjectPrivate::Connection *c =
-                (*connectionLists)[sig_index].first;
-            if (disconnectHelper(c, receiver, method_index, slot, senderMutex, disconnectType)) {
+                (*connectionLists)[sig_index].first.load();
+            if (disconnectHelper(c, receiver, method_index, slot, senderMutex, disconnectType))
                 success = true;
-                connectionLists->dirty = true;
-            }
         }
     } else if (signal_index < connectionLists->count()) {
         QObjectPrivate::Connection *c =
-            (*connectionLists)[signal_index].first;
-        if (disconnectHelper(c, receiver, method_index, slot, senderMutex, disconnectType)) {
+            (*connectionLists)[signal_index].first.load();
+        if (disconnectHelper(c, receiver, method_index, slot, senderMutex, disconnectType))
             success = true;
-            connectionLists->dirty = true;
-        }
     }
 
-    --connectionLists->inUse;
-    Q_ASSERT(connectionLists->inUse >= 0);
-    if (connectionLists->orphaned && !connectionLists->inUse)
-        delete connectionLists;
+    QObjectPrivate::Connection *garbage = 0;
+    const int state = connectionLists->inUse.fetchAndAddOrdered(-1);
+    if ((state & QObjectConnectionListVector::UsersMask) == 1) {
+        if (connectionLists->orphaned)
+            delete connectionLists;
+        else if (state & QObjectConnectionListVector::DeferredFlag)
+            garbage = QObjectPrivate::get(s)->cleanConnectionLists();
+    }
 
     locker.unlock();
+    destroyConnections(garbage);
     if (success) {
         QMetaMethod smethod = QMetaObjectPrivate::signal(smeta, signal_index);
         if (smethod.isValid())
@@ -3434,7 +3727,17 @@ static void queued_activate(QObject *sender, int signal, QObjectPrivate::Connect
     QMetaCallEvent *ev = c->isSlotObject ?
         new QMetaCallEvent(c->slotObj, sender, signal, nargs, types, args) :
         new QMetaCallEvent(c->method_offset, c->method_relative, c->callFunction, sender, signal, nargs, types, args);
-    QCoreApplication::postEvent(c->receiver, ev);
+
+    // the receiver cannot be destroyed while the sender's lock is held
+    QMutexLocker locker(signalSlotLock(sender));
+    QObject * const receiver = c->receiver.load();
+    if (!receiver) {
+        // disconnected meanwhile
+        locker.unlock();
+        delete ev;
+        return;
+    }
+    QCoreApplication::postEvent(receiver, ev);
 }
 
 /*!
@@ -3475,56 +3778,53 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
     Qt::HANDLE currentThreadId = QThread::currentThreadId();
 
     {
-    QMutexLocker locker(signalSlotLock(sender));
+    // The connection lists are traversed without locking: see QObjectConnectionListVector
     struct ConnectionListsRef {
+        QObject *sender;
         QObjectConnectionListVector *connectionLists;
-        ConnectionListsRef(QObjectConnectionListVector *connectionLists) : connectionLists(connectionLists)
+        ConnectionListsRef(QObject *sender, QObjectConnectionListVector *connectionLists)
+            : sender(sender), connectionLists(connectionLists)
         {
             if (connectionLists)
-                ++connectionLists->inUse;
+                enterConnectionLists(connectionLists, sender);
         }
         ~ConnectionListsRef()
         {
-            if (!connectionLists)
-                return;
-
-            --connectionLists->inUse;
-            Q_ASSERT(connectionLists->inUse >= 0);
-            if (connectionLists->orphaned) {
-                if (!connectionLists->inUse)
-                    delete connectionLists;
-            }
+            if (connectionLists)
+                leaveConnectionLists(connectionLists, sender);
         }
 
         QObjectConnectionListVector *operator->() const { return connectionLists; }
     };
-    ConnectionListsRef connectionLists = sender->d_func()->connectionLists;
+    ConnectionListsRef connectionLists(sender, sender->d_func()->connectionLists.loadAcquire());
     if (!connectionLists.connectionLists) {
-        locker.unlock();
         if (qt_signal_spy_callback_set.signal_end_callback != 0)
             qt_signal_spy_callback_set.signal_end_callback(sender, signal_index);
         return;
     }
 
+    const QObjectConnectionListVector::SignalVector *signalVector = connectionLists->signalVector.loadAcquire();
     const QObjectPrivate::ConnectionList *list;
-    if (signal_index < connectionLists->count())
-        list = &connectionLists->at(signal_index);
+    if (signalVector && signal_index < signalVector->count)
+        list = &signalVector->lists[signal_index];
     else
         list = &connectionLists->allsignals;
 
     do {
-        QObjectPrivate::Connection *c = list->first;
+        QObjectPrivate::Connection *c = list->first.loadAcquire();
         if (!c) continue;
         // We need to check against last here to ensure that signals added
         // during the signal emission are not emitted in this emission.
-        QObjectPrivate::Connection *last = list->last;
+        QObjectPrivate::Connection *last = list->last.loadAcquire();
 
         do {
-            if (!c->receiver)
+            QObject * const receiver = c->receiver.loadAcquire();
+            if (!receiver)
                 continue;
 
-            QObject * const receiver = c->receiver;
-            const bool receiverInSameThread = currentThreadId == receiver->d_func()->threadData->threadId;
+            // the receiver may live, and be destroyed, in another thread, so
+            // its thread is looked up through the connection
+            const bool receiverInSameThread = currentThreadId == c->receiverThreadData.loadAcquire()->threadId;
 
             // determine if this connection should be sent immediately or
             // put into the event queue
@@ -3534,7 +3834,6 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                 continue;
 #ifndef QT_NO_THREAD
             } else if (c->connectionType == Qt::BlockingQueuedConnection) {
-                locker.unlock();
                 if (receiverInSameThread) {
                     qWarning("Qt: Dead lock detected while activating a BlockingQueuedConnection: "
                     "Sender is %s(%p), receiver is %s(%p)",
@@ -3545,9 +3844,17 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
                 QMetaCallEvent *ev = c->isSlotObject ?
                     new QMetaCallEvent(c->slotObj, sender, signal_index, 0, 0, argv ? argv : empty_argv, &semaphore) :
                     new QMetaCallEvent(c->method_offset, c->method_relative, c->callFunction, sender, signal_index, 0, 0, argv ? argv : empty_argv, &semaphore);
-                QCoreApplication::postEvent(receiver, ev);
+                {
+                    // the receiver cannot be destroyed while the sender's lock is held
+                    QMutexLocker locker(signalSlotLock(sender));
+                    if (!c->receiver.load()) {
+                        locker.unlock();
+                        delete ev;
+                        continue;
+                    }
+                    QCoreApplication::postEvent(receiver, ev);
+                }
                 semaphore.acquire();
-                locker.relock();
                 continue;
 #endif
             }
@@ -3560,20 +3867,12 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
             const QObjectPrivate::StaticMetaCallFunction callFunction = c->callFunction;
             const int method_relative = c->method_relative;
             if (c->isSlotObject) {
+                // the slot object is not destroyed while we traverse the lists
                 c->slotObj->ref();
                 QScopedPointer<QtPrivate::QSlotObjectBase, QSlotObjectBaseDeleter> obj(c->slotObj);
-                locker.unlock();
                 obj->call(receiver, argv ? argv : empty_argv);
-
-                // Make sure the slot object gets destroyed before the mutex is locked again, as the
-                // destructor of the slot object might also lock a mutex from the signalSlotLock() mutex pool,
-                // and that would deadlock if the pool happens to return the same mutex.
-                obj.reset();
-
-                locker.relock();
             } else if (callFunction && c->method_offset <= receiver->metaObject()->methodOffset()) {
                 //we compare the vtable to make sure we are not in the destructor of the object.
-                locker.unlock();
                 if (qt_signal_spy_callback_set.slot_begin_callback != 0)
                     qt_signal_spy_callback_set.slot_begin_callback(receiver, c->method(), argv ? argv : empty_argv);
 
@@ -3581,10 +3880,8 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
 
                 if (qt_signal_spy_callback_set.slot_end_callback != 0)
                     qt_signal_spy_callback_set.slot_end_callback(receiver, c->method());
-                locker.relock();
             } else {
                 const int method = method_relative + c->method_offset;
-                locker.unlock();
 
                 if (qt_signal_spy_callback_set.slot_begin_callback != 0) {
                     qt_signal_spy_callback_set.slot_begin_callback(receiver,
@@ -3596,13 +3893,11 @@ void QMetaObject::activate(QObject *sender, int signalOffset, int local_signal_i
 
                 if (qt_signal_spy_callback_set.slot_end_callback != 0)
                     qt_signal_spy_callback_set.slot_end_callback(receiver, method);
-
-                locker.relock();
             }
 
             if (connectionLists->orphaned)
                 break;
-        } while (c != last && (c = c->nextConnectionList) != 0);
+        } while (c != last && (c = c->nextConnectionList.loadAcquire()) != 0);
 
         if (connectionLists->orphaned)
             break;
@@ -3873,27 +4168,28 @@ void QObject::dumpObjectInfo()
     // first, look for connections where this object is the sender
     qDebug("  SIGNALS OUT");
 
-    if (d->connectionLists) {
-        for (int signal_index = 0; signal_index < d->connectionLists->count(); ++signal_index) {
+    if (QObjectConnectionListVector *connectionLists = d->connectionLists.load()) {
+        for (int signal_index = 0; signal_index < connectionLists->count(); ++signal_index) {
             const QMetaMethod signal = QMetaObjectPrivate::signal(metaObject(), signal_index);
             qDebug("        signal: %s", signal.methodSignature().constData());
 
             // receivers
             const QObjectPrivate::Connection *c =
-                d->connectionLists->at(signal_index).first;
+                connectionLists->at(signal_index).first.load();
             while (c) {
-                if (!c->receiver) {
+                QObject *receiver = c->receiver.load();
+                if (!receiver) {
                     qDebug("          <Disconnected receiver>");
-                    c = c->nextConnectionList;
+                    c = c->nextConnectionList.load();
                     continue;
                 }
-                const QMetaObject *receiverMetaObject = c->receiver->metaObject();
+                const QMetaObject *receiverMetaObject = receiver->metaObject();
                 const QMetaMethod method = receiverMetaObject->method(c->method());
                 qDebug("          --> %s::%s %s",
                        receiverMetaObject->className(),
-                       c->receiver->objectName().isEmpty() ? "unnamed" : qPrintable(c->receiver->objectName()),
+                       receiver->objectName().isEmpty() ? "unnamed" : qPrintable(receiver->objectName()),
                        method.methodSignature().constData());
-                c = c->nextConnectionList;
+                c = c->nextConnectionList.load();
             }
         }
     } else {
@@ -4467,17 +4763,17 @@ QMetaObject::Connection QObjectPrivate::connectImpl(const QObject *sender, int s
                                signalSlotLock(receiver));
 
     if (type & Qt::UniqueConnection) {
-        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists;
+        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(s)->connectionLists.load();
         if (connectionLists && connectionLists->count() > signal_index) {
             const QObjectPrivate::Connection *c2 =
-                (*connectionLists)[signal_index].first;
+                (*connectionLists)[signal_index].first.load();
 
             while (c2) {
-                if (c2->receiver == receiver && c2->isSlotObject && c2->slotObj->compare(slot)) {
+                if (c2->receiver.load() == receiver && c2->isSlotObject && c2->slotObj->compare(slot)) {
                     slotObj->destroyIfLastRef();
                     return QMetaObject::Connection();
                 }
-                c2 = c2->nextConnectionList;
+                c2 = c2->nextConnectionList.load();
             }
         }
         type = static_cast<Qt::ConnectionType>(type ^ Qt::UniqueConnection);
@@ -4486,7 +4782,7 @@ QMetaObject::Connection QObjectPrivate::connectImpl(const QObject *sender, int s
     QScopedPointer<QObjectPrivate::Connection> c(new QObjectPrivate::Connection);
     c->sender = s;
     c->signal_index = signal_index;
-    c->receiver = r;
+    c->receiver.store(r);
     c->slotObj = slotObj;
     c->connectionType = type;
     c->isSlotObject = true;
@@ -4494,10 +4790,12 @@ QMetaObject::Connection QObjectPrivate::connectImpl(const QObject *sender, int s
         c->argumentTypes.store(types);
         c->ownArgumentTypes = false;
     }
+    c->receiverThreadData.store(QObjectPrivate::get(r)->connectionThreadData());
 
-    QObjectPrivate::get(s)->addConnection(signal_index, c.data());
+    QObjectPrivate::Connection *garbage = QObjectPrivate::get(s)->addConnection(signal_index, c.data());
     QMetaObject::Connection ret(c.take());
     locker.unlock();
+    destroyConnections(garbage);
 
     QMetaMethod method = QMetaObjectPrivate::signal(senderMetaObject, signal_index);
     Q_ASSERT(method.isValid());
@@ -4518,30 +4816,32 @@ bool QObject::disconnect(const QMetaObject::Connection &connection)
 {
     QObjectPrivate::Connection *c = static_cast<QObjectPrivate::Connection *>(connection.d_ptr);
 
-    if (!c || !c->receiver)
+    if (!c || !c->receiver.load())
         return false;
 
     QMutex *senderMutex = signalSlotLock(c->sender);
-    QMutex *receiverMutex = signalSlotLock(c->receiver);
+    QMutex *receiverMutex = signalSlotLock(c->receiver.load());
 
+    QtPrivate::QSlotObjectBase *slotObj;
     {
         QOrderedMutexLocker locker(senderMutex, receiverMutex);
 
-        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(c->sender)->connectionLists;
+        QObjectConnectionListVector *connectionLists = QObjectPrivate::get(c->sender)->connectionLists.load();
         Q_ASSERT(connectionLists);
-        connectionLists->dirty = true;
+        connectionLists->setDirty();
 
         *c->prev = c->next;
         if (c->next)
             c->next->prev = c->prev;
-        c->receiver = 0;
+        c->receiver.store(0);
+
+        // unless the signal is being emitted
+        slotObj = connectionLists->takeSlotObject(c);
     }
 
     // destroy the QSlotObject, if possible
-    if (c->isSlotObject) {
-        c->slotObj->destroyIfLastRef();
-        c->isSlotObject = false;
-    }
+    if (slotObj)
+        slotObj->destroyIfLastRef();
 
     const_cast<QMetaObject::Connection &>(connection).d_ptr = 0;
     c->deref(); // has been removed from the QMetaObject::Connection object
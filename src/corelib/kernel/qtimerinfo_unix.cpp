@@ -41,6 +41,8 @@
 
 #include <qelapsedtimer.h>
 #include <qcoreapplication.h>
+#include <qvarlengtharray.h>
+#include <qmutex.h>
 
 #include "private/qcore_unix_p.h"
 #include "private/qtimerinfo_unix_p.h"
@@ -58,6 +60,156 @@ QT_BEGIN_NAMESPACE
 
 Q_CORE_EXPORT bool qt_disable_lowpriority_timers=false;
 
+static inline qint64 toMSecs(const timespec &ts)
+{
+    return qint64(ts.tv_sec) * 1000 + ts.tv_nsec / (1000 * 1000);
+}
+
+/*
+ * Wakeup times shared by the timers of all threads when
+ * Qt::AA_CoalesceTimersAcrossThreads is set.
+ *
+ * Each thread still waits in its own event dispatcher, but coarse timers
+ * whose accuracy window contains an already scheduled wakeup time are moved
+ * onto that time, so that threads wake up together instead of one after
+ * another.
+ */
+class QTimerWakeupSlots
+{
+public:
+    QTimerWakeupSlots()
+    {
+        for (int i = 0; i < SlotCount; ++i)
+            wakeups[i] = 0;
+    }
+
+    qint64 align(qint64 now, qint64 preferred, qint64 earliest, qint64 latest);
+
+private:
+    enum { SlotCount = 64 };
+    QMutex mutex;
+    qint64 wakeups[SlotCount];
+};
+
+qint64 QTimerWakeupSlots::align(qint64 now, qint64 preferred, qint64 earliest, qint64 latest)
+{
+    QMutexLocker locker(&mutex);
+
+    int match = -1;
+    int unused = -1;
+    int farthest = 0;
+    for (int i = 0; i < SlotCount; ++i) {
+        const qint64 wakeup = wakeups[i];
+        if (wakeup < now) {
+            unused = i;
+            continue;
+        }
+        if (wakeup > wakeups[farthest])
+            farthest = i;
+        if (wakeup < earliest || wakeup > latest)
+            continue;
+        if (match == -1 || qAbs(wakeup - preferred) < qAbs(wakeups[match] - preferred))
+            match = i;
+    }
+
+    if (match != -1)
+        return wakeups[match];
+
+    // no suitable wakeup yet: publish ours, dropping the one furthest away
+    // if the table is full
+    if (unused != -1)
+        wakeups[unused] = preferred;
+    else if (wakeups[farthest] > preferred)
+        wakeups[farthest] = preferred;
+    return preferred;
+}
+
+Q_GLOBAL_STATIC(QTimerWakeupSlots, timerWakeupSlots)
+
+static void alignToSharedWakeup(QTimerInfo *t, const timespec &earliest, const timespec &latest,
+                                const timespec &currentTime)
+{
+    QTimerWakeupSlots *wakeupSlots = timerWakeupSlots();
+    if (!wakeupSlots)
+        return;
+
+    const qint64 now = toMSecs(currentTime);
+    const qint64 wakeup = wakeupSlots->align(now, toMSecs(t->timeout),
+                                             qMax(now, toMSecs(earliest)), toMSecs(latest));
+    t->timeout.tv_sec = wakeup / 1000;
+    t->timeout.tv_nsec = (wakeup % 1000) * 1000 * 1000;
+}
+
+/*
+ * Timer wakeup statistics, see qt_timerWakeupStatistics().
+ */
+static QBasicAtomicInt timerStatisticsEnabled = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInt timerThreadWakeups = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInt timerProcessWakeups = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicAtomicInt timerLastWakeup = Q_BASIC_ATOMIC_INITIALIZER(0);
+static QBasicMutex timerStatisticsMutex;
+// set once, before the statistics are first enabled, so the threads
+// recording wakeups can read it without locking
+static qint64 timerStatisticsBase = 0;
+// milliseconds since timerStatisticsBase
+static QBasicAtomicInt timerStatisticsStart = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+static void recordTimerWakeup(const timespec &scheduled)
+{
+    timerThreadWakeups.ref();
+
+    // threads woken up for the same millisecond count as one process wakeup;
+    // threads that are late for an earlier wakeup are not counted again
+    const int wakeup = int(toMSecs(scheduled) - timerStatisticsBase) - timerStatisticsStart.load();
+    int last = timerLastWakeup.load();
+    while (wakeup > last) {
+        if (timerLastWakeup.testAndSetRelaxed(last, wakeup)) {
+            timerProcessWakeups.ref();
+            break;
+        }
+        last = timerLastWakeup.load();
+    }
+}
+
+static void resetTimerStatistics()
+{
+    const qint64 now = toMSecs(qt_gettime());
+    if (!timerStatisticsBase)
+        timerStatisticsBase = now;
+    timerStatisticsStart.store(int(now - timerStatisticsBase));
+    timerThreadWakeups.store(0);
+    timerProcessWakeups.store(0);
+    timerLastWakeup.store(0);
+}
+
+/*
+    Enables or disables counting of timer wakeups in all threads. Enabling
+    the statistics resets them.
+*/
+void qt_setTimerWakeupStatisticsEnabled(bool enable)
+{
+    QMutexLocker locker(&timerStatisticsMutex);
+    if (enable)
+        resetTimerStatistics();
+    timerStatisticsEnabled.storeRelease(enable);
+}
+
+/*
+    Returns the timer wakeups counted since the statistics were enabled or
+    last reset. If \a reset is true, the counters are reset afterwards.
+*/
+QTimerWakeupStatistics qt_timerWakeupStatistics(bool reset)
+{
+    QMutexLocker locker(&timerStatisticsMutex);
+    QTimerWakeupStatistics statistics;
+    statistics.threadWakeups = timerThreadWakeups.load();
+    statistics.processWakeups = timerProcessWakeups.load();
+    statistics.elapsed = toMSecs(qt_gettime()) - timerStatisticsBase - timerStatisticsStart.load();
+    if (reset)
+        resetTimerStatistics();
+    return statistics;
+}
+
 /*
  * Internal functions for manipulating timer data structures.  The
  * timerBitVec array is used for keeping track of timer identifiers.
@@ -85,6 +237,7 @@ QTimerInfoList::QTimerInfoList()
 #endif
 
     firstTimerInfo = 0;
+    insertionCounter = 0;
 }
 
 timespec QTimerInfoList::updateCurrentTime()
@@ -176,17 +329,111 @@ void QTimerInfoList::repairTimersIfNeeded()
 #endif
 
 /*
-  insert timer info into list
+  Timers with the same timeout fire in the order they were (re)inserted.
 */
-void QTimerInfoList::timerInsert(QTimerInfo *ti)
+static inline bool timerLessThan(const QTimerInfo *t1, const QTimerInfo *t2)
+{
+    if (t1->timeout < t2->timeout)
+        return true;
+    if (t2->timeout < t1->timeout)
+        return false;
+    return t1->sequence < t2->sequence;
+}
+
+void QTimerInfoList::heapSiftUp(int index)
+{
+    QTimerInfo *t = at(index);
+    while (index > 0) {
+        const int parent = (index - 1) / 2;
+        QTimerInfo *p = at(parent);
+        if (!timerLessThan(t, p))
+            break;
+        (*this)[index] = p;
+        p->heapIndex = index;
+        index = parent;
+    }
+    (*this)[index] = t;
+    t->heapIndex = index;
+}
+
+void QTimerInfoList::heapSiftDown(int index)
 {
-    int index = size();
-    while (index--) {
-        const QTimerInfo * const t = at(index);
-        if (!(ti->timeout < t->timeout))
+    const int n = size();
+    QTimerInfo *t = at(index);
+    forever {
+        int child = 2 * index + 1;
+        if (child >= n)
             break;
+        if (child + 1 < n && timerLessThan(at(child + 1), at(child)))
+            ++child;
+        QTimerInfo *c = at(child);
+        if (!timerLessThan(c, t))
+            break;
+        (*this)[index] = c;
+        c->heapIndex = index;
+        index = child;
     }
-    insert(index+1, ti);
+    (*this)[index] = t;
+    t->heapIndex = index;
+}
+
+/*
+  insert timer info into list
+*/
+void QTimerInfoList::timerInsert(QTimerInfo *ti)
+{
+    ti->sequence = insertionCounter++;
+    append(ti);
+    heapSiftUp(size() - 1);
+}
+
+/*
+  remove timer info from list, without deleting it
+*/
+void QTimerInfoList::timerRemove(QTimerInfo *ti)
+{
+    const int index = ti->heapIndex;
+    Q_ASSERT(at(index) == ti);
+    QTimerInfo *last = takeLast();
+    if (last == ti)
+        return;
+
+    (*this)[index] = last;
+    last->heapIndex = index;
+    if (index > 0 && timerLessThan(last, at((index - 1) / 2)))
+        heapSiftUp(index);
+    else
+        heapSiftDown(index);
+}
+
+/*
+  Returns the number of timers in the subtree at \a index that are due.
+*/
+int QTimerInfoList::expiredTimerCount(int index) const
+{
+    if (index >= size() || currentTime < at(index)->timeout)
+        return 0;
+    return 1 + expiredTimerCount(2 * index + 1) + expiredTimerCount(2 * index + 2);
+}
+
+/*
+  Returns the earliest timer in the subtree at \a index that is not being
+  activated right now. Only the (few) timers that are being activated need
+  to be looked through.
+*/
+QTimerInfo *QTimerInfoList::firstInactiveTimer(int index) const
+{
+    if (index >= size())
+        return 0;
+    QTimerInfo *t = at(index);
+    if (!t->activateRef)
+        return t;
+
+    QTimerInfo *left = firstInactiveTimer(2 * index + 1);
+    QTimerInfo *right = firstInactiveTimer(2 * index + 2);
+    if (!left || (right && timerLessThan(right, left)))
+        return right;
+    return left;
 }
 
 inline timespec &operator+=(timespec &t1, int ms)
@@ -250,6 +497,8 @@ static void calculateCoarseTimerTimeout(QTimerInfo *t, timespec currentTime)
 
     // Calculate how much we can round and still keep within 5% error
     uint absMaxRounding = interval / 20;
+    const timespec earliest = t->timeout + -int(absMaxRounding);
+    const timespec latest = t->timeout + int(absMaxRounding);
 
     if (interval < 100 && interval != 25 && interval != 50 && interval != 75) {
         // special mode for timers of less than 100 ms
@@ -332,6 +581,11 @@ recalculate:
         t->timeout.tv_nsec = msec * 1000 * 1000;
     }
 
+    // with coalescing across threads, prefer a wakeup time another thread
+    // has already scheduled within our 5%
+    if (QCoreApplication::testAttribute(Qt::AA_CoalesceTimersAcrossThreads))
+        alignToSharedWakeup(t, earliest, latest, currentTime);
+
     if (t->timeout < currentTime)
         t->timeout += interval;
 }
@@ -388,13 +642,7 @@ bool QTimerInfoList::timerWait(timespec &tm)
     repairTimersIfNeeded();
 
     // Find first waiting timer not already active
-    QTimerInfo *t = 0;
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (!(*it)->activateRef) {
-            t = *it;
-            break;
-        }
-    }
+    QTimerInfo *t = firstInactiveTimer(0);
 
     if (!t)
       return false;
@@ -422,16 +670,13 @@ int QTimerInfoList::timerRemainingTime(int timerId)
     repairTimersIfNeeded();
     timespec tm = {0, 0};
 
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            if (currentTime < t->timeout) {
-                // time to wait
-                tm = roundToMillisecond(t->timeout - currentTime);
-                return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
-            } else {
-                return 0;
-            }
+    if (QTimerInfo *t = timerHash.value(timerId)) {
+        if (currentTime < t->timeout) {
+            // time to wait
+            tm = roundToMillisecond(t->timeout - currentTime);
+            return tm.tv_sec*1000 + tm.tv_nsec/1000/1000;
+        } else {
+            return 0;
         }
     }
 
@@ -494,6 +739,7 @@ void QTimerInfoList::registerTimer(int timerId, int interval, Qt::TimerType time
     }
 
     timerInsert(t);
+    timerHash.insert(timerId, t);
 
 #ifdef QTIMERINFO_DEBUG
     t->expected = expected;
@@ -508,40 +754,43 @@ void QTimerInfoList::registerTimer(int timerId, int interval, Qt::TimerType time
 bool QTimerInfoList::unregisterTimer(int timerId)
 {
     // set timer inactive
-    for (int i = 0; i < count(); ++i) {
-        QTimerInfo *t = at(i);
-        if (t->id == timerId) {
-            // found it
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = 0;
-            if (t->activateRef)
-                *(t->activateRef) = 0;
-            delete t;
-            return true;
-        }
+    QTimerInfo *t = timerHash.take(timerId);
+    if (!t) {
+        // id not found
+        return false;
     }
-    // id not found
-    return false;
+
+    timerRemove(t);
+    if (t == firstTimerInfo)
+        firstTimerInfo = 0;
+    if (t->activateRef)
+        *(t->activateRef) = 0;
+    delete t;
+    return true;
 }
 
 bool QTimerInfoList::unregisterTimers(QObject *object)
 {
     if (isEmpty())
         return false;
+
+    // removing a timer reorders the heap, so collect them first
+    QVarLengthArray<QTimerInfo *, 16> timers;
     for (int i = 0; i < count(); ++i) {
         QTimerInfo *t = at(i);
-        if (t->obj == object) {
-            // object found
-            removeAt(i);
-            if (t == firstTimerInfo)
-                firstTimerInfo = 0;
-            if (t->activateRef)
-                *(t->activateRef) = 0;
-            delete t;
-            // move back one so that we don't skip the new current item
-            --i;
-        }
+        if (t->obj == object)
+            timers.append(t);
+    }
+
+    for (int i = 0; i < timers.size(); ++i) {
+        QTimerInfo *t = timers.at(i);
+        timerHash.remove(t->id);
+        timerRemove(t);
+        if (t == firstTimerInfo)
+            firstTimerInfo = 0;
+        if (t->activateRef)
+            *(t->activateRef) = 0;
+        delete t;
     }
     return true;
 }
@@ -579,11 +828,8 @@ int QTimerInfoList::activateTimers()
 
 
     // Find out how many timer have expired
-    for (QTimerInfoList::const_iterator it = constBegin(); it != constEnd(); ++it) {
-        if (currentTime < (*it)->timeout)
-            break;
-        maxCount++;
-    }
+    maxCount = expiredTimerCount(0);
+    const timespec scheduled = first()->timeout;
 
     //fire the timers.
     while (maxCount--) {
@@ -605,7 +851,7 @@ int QTimerInfoList::activateTimers()
         }
 
         // remove from list
-        removeFirst();
+        timerRemove(currentTimerInfo);
 
 #ifdef QTIMERINFO_DEBUG
         float diff;
@@ -648,6 +894,8 @@ int QTimerInfoList::activateTimers()
     }
 
     firstTimerInfo = 0;
+    if (n_act && timerStatisticsEnabled.loadAcquire())
+        recordTimerWakeup(scheduled);
     // qDebug() << "Thread" << QThread::currentThreadId() << "activated" << n_act << "timers";
     return n_act;
 }
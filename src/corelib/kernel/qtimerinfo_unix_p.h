@@ -56,6 +56,7 @@
 // #define QTIMERINFO_DEBUG
 
 #include "qabstracteventdispatcher.h"
+#include "qhash.h"
 
 #include <sys/time.h> // struct timeval
 
@@ -69,6 +70,8 @@ struct QTimerInfo {
     timespec timeout;  // - when to actually fire
     QObject *obj;     // - object to receive event
     QTimerInfo **activateRef; // - ref from activateTimers
+    int heapIndex;    // - position in QTimerInfoList
+    quint64 sequence; // - insertion order, orders timers with equal timeouts
 
 #ifdef QTIMERINFO_DEBUG
     timeval expected; // when timer is expected to fire
@@ -77,6 +80,19 @@ struct QTimerInfo {
 #endif
 };
 
+// Timer wakeups counted while statistics are enabled: threadWakeups is
+// the number of times any thread woke up to activate timers, processWakeups
+// the number of distinct scheduled wakeup times (in milliseconds) among those.
+struct QTimerWakeupStatistics
+{
+    int threadWakeups;
+    int processWakeups;
+    qint64 elapsed; // milliseconds since the statistics were reset
+};
+
+Q_CORE_EXPORT void qt_setTimerWakeupStatisticsEnabled(bool enable);
+Q_CORE_EXPORT QTimerWakeupStatistics qt_timerWakeupStatistics(bool reset = false);
+
 class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
 {
 #if ((_POSIX_MONOTONIC_CLOCK-0 <= 0) && !defined(Q_OS_MAC)) || defined(QT_BOOTSTRAPPED)
@@ -92,6 +108,17 @@ class Q_CORE_EXPORT QTimerInfoList : public QList<QTimerInfo*>
     // state variables used by activateTimers()
     QTimerInfo *firstTimerInfo;
 
+    // The list itself is a binary min-heap ordered by timeout, so first()
+    // is always the next timer to fire; timers are also indexed by id.
+    QHash<int, QTimerInfo *> timerHash;
+    quint64 insertionCounter;
+
+    void heapSiftUp(int index);
+    void heapSiftDown(int index);
+    void timerRemove(QTimerInfo *);
+    int expiredTimerCount(int index) const;
+    QTimerInfo *firstInactiveTimer(int index) const;
+
 public:
     QTimerInfoList();
 
@@ -57,6 +57,11 @@ class QFutureWatcher;
 template <>
 class QFutureWatcher<void>;
 
+namespace QtPrivate {
+template <typename Function, typename Arg> struct ContinuationResult;
+struct FutureAccess;
+}
+
 template <typename T>
 class QFuture
 {
@@ -104,6 +109,9 @@ public:
     operator T() const { return result(); }
     QList<T> results() const { return d.results(); }
 
+    bool hasNextResult() const { return d.waitForNextResultToTake() != -1; }
+    T takeNextResult() { return d.takeNextResult(); }
+
     class const_iterator
     {
     public:
@@ -151,8 +159,20 @@ public:
     const_iterator end() const { return const_iterator(this, -1); }
     const_iterator constEnd() const { return const_iterator(this, -1); }
 
+    template <typename Function>
+    QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<T> >::Type>
+    then(Function function) const;
+    template <typename Function>
+    QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<T> >::Type>
+    then(QThreadPool *pool, Function function) const;
+#ifndef QT_NO_EXCEPTIONS
+    template <typename Function>
+    QFuture<T> onFailed(Function handler) const;
+#endif
+
 private:
     friend class QFutureWatcher<T>;
+    friend struct QtPrivate::FutureAccess;
 
 public: // Warning: the d pointer is not documented and is considered private.
     mutable QFutureInterface<T> d;
@@ -241,8 +261,20 @@ public:
     QString progressText() const { return d.progressText(); }
     void waitForFinished() { d.waitForFinished(); }
 
+    template <typename Function>
+    QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<void> >::Type>
+    then(Function function) const;
+    template <typename Function>
+    QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<void> >::Type>
+    then(QThreadPool *pool, Function function) const;
+#ifndef QT_NO_EXCEPTIONS
+    template <typename Function>
+    QFuture<void> onFailed(Function handler) const;
+#endif
+
 private:
     friend class QFutureWatcher<void>;
+    friend struct QtPrivate::FutureAccess;
 
 #ifdef QFUTURE_TEST
 public:
@@ -269,6 +301,8 @@ QFuture<void> qToVoidFuture(const QFuture<T> &future)
 
 QT_END_NAMESPACE
 
+#include <QtCore/qfuture_impl.h>
+
 #endif // QT_NO_QFUTURE
 
 #endif // QFUTURE_H
@@ -0,0 +1,488 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef Q_QDOC
+
+#ifndef QFUTURE_H
+#error Do not include qfuture_impl.h directly
+#endif
+
+#if 0
+#pragma qt_sync_skip_header_check
+#pragma qt_sync_stop_processing
+#endif
+
+#include <QtCore/qatomic.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+
+
+namespace QtFuture {
+
+template <typename T>
+struct WhenAnyResult
+{
+    WhenAnyResult() : index(-1) { }
+    WhenAnyResult(int index, const QFuture<T> &future) : index(index), future(future) { }
+
+    int index;
+    QFuture<T> future;
+};
+
+} // namespace QtFuture
+
+namespace QtPrivate {
+
+template <typename T> struct ContinuationValueType { typedef T Type; };
+template <typename T> struct ContinuationValueType<T &> { typedef T Type; };
+template <typename T> struct ContinuationValueType<const T &> { typedef T Type; };
+
+/*
+    The type of the future returned by then(): the return type of calling
+    Function with an Arg. Without decltype, the callable has to be a plain
+    function pointer or a function object with a result_type typedef.
+*/
+template <typename Function, typename Arg>
+struct ContinuationResult
+{
+#ifdef Q_COMPILER_DECLTYPE
+    typedef typename ContinuationValueType<
+        decltype((*static_cast<Function *>(0))(*static_cast<const Arg *>(0)))>::Type Type;
+#else
+    typedef typename Function::result_type Type;
+#endif
+};
+
+#ifndef Q_COMPILER_DECLTYPE
+template <typename R, typename Param, typename Arg>
+struct ContinuationResult<R (*)(Param), Arg> { typedef R Type; };
+#endif
+
+struct FutureAccess
+{
+    template <typename T>
+    static QFutureInterfaceBase &interface(const QFuture<T> &future) { return future.d; }
+
+    template <typename T>
+    static QFuture<T> future(const QFutureInterfaceBase &interface)
+    {
+        QFutureInterface<T> typed(interface);
+        return QFuture<T>(&typed);
+    }
+};
+
+// Finishes promise as canceled unless it has been finished already, so
+// whatever waits for it does not hang when its parent is dropped unfinished.
+inline void cancelUnfinished(QFutureInterfaceBase &promise)
+{
+    if (promise.isFinished())
+        return;
+    promise.reportCanceled();
+    promise.reportFinished();
+}
+
+template <typename R>
+struct ContinuationInvoker
+{
+    template <typename Function, typename Arg>
+    static void invoke(QFutureInterface<R> &promise, Function &function, const Arg &arg)
+    { promise.reportResult(function(arg)); }
+};
+
+template <>
+struct ContinuationInvoker<void>
+{
+    template <typename Function, typename Arg>
+    static void invoke(QFutureInterface<void> &, Function &function, const Arg &arg)
+    { function(arg); }
+};
+
+// Passes the exception or cancellation of a failed parent on to promise.
+// Returns false if the parent completed successfully.
+inline bool propagateFailure(QFutureInterfaceBase &parent, QFutureInterfaceBase &promise)
+{
+    if (!parent.isCanceled())
+        return false;
+#ifndef QT_NO_EXCEPTIONS
+    if (parent.exceptionStore().hasException()) {
+        promise.reportException(*parent.exceptionStore().exception().exception());
+        return true;
+    }
+#endif
+    promise.reportCanceled();
+    return true;
+}
+
+template <typename Function, typename R, typename T>
+class Continuation : public FutureContinuation
+{
+public:
+    Continuation(Function function, const QFutureInterface<R> &promise)
+        : function(function), promise(promise)
+    { }
+    ~Continuation() { cancelUnfinished(promise); }
+
+    void setFinishedFuture(const QFutureInterfaceBase &future)
+    { parent = FutureAccess::future<T>(future); }
+
+    void run()
+    {
+        if (!promise.isCanceled()
+            && !propagateFailure(FutureAccess::interface(parent), promise)) {
+#ifndef QT_NO_EXCEPTIONS
+            try {
+#endif
+                ContinuationInvoker<R>::invoke(promise, function, parent);
+#ifndef QT_NO_EXCEPTIONS
+            } catch (QException &e) {
+                promise.reportException(e);
+            } catch (...) {
+                promise.reportException(QUnhandledException());
+            }
+#endif
+        }
+        promise.reportFinished();
+    }
+
+    static QFuture<R> create(Function function, const QFuture<T> &parent, QThreadPool *pool)
+    {
+        QFutureInterface<R> promise;
+        promise.reportStarted();
+        QFuture<R> future = promise.future();
+        FutureAccess::interface(parent).addContinuation(new Continuation(function, promise), pool);
+        return future;
+    }
+
+private:
+    Function function;
+    QFuture<T> parent;
+    QFutureInterface<R> promise;
+};
+
+#ifndef QT_NO_EXCEPTIONS
+
+template <typename T>
+struct FailureHandlerInvoker
+{
+    template <typename Function>
+    static void invoke(QFutureInterface<T> &promise, Function &handler, const QException &exception)
+    { promise.reportResult(handler(exception)); }
+
+    static void forwardResults(QFutureInterface<T> &promise, const QFuture<T> &parent)
+    {
+        const QList<T> results = parent.results();
+        if (!results.isEmpty())
+            promise.reportResults(results.toVector());
+    }
+};
+
+template <>
+struct FailureHandlerInvoker<void>
+{
+    template <typename Function>
+    static void invoke(QFutureInterface<void> &, Function &handler, const QException &exception)
+    { handler(exception); }
+
+    static void forwardResults(QFutureInterface<void> &, const QFuture<void> &)
+    { }
+};
+
+template <typename Function, typename T>
+class FailureHandler : public FutureContinuation
+{
+public:
+    FailureHandler(Function handler, const QFutureInterface<T> &promise)
+        : handler(handler), promise(promise)
+    { }
+    ~FailureHandler() { cancelUnfinished(promise); }
+
+    void setFinishedFuture(const QFutureInterfaceBase &future)
+    { parent = FutureAccess::future<T>(future); }
+
+    void run()
+    {
+        QtPrivate::ExceptionStore &exceptionStore = FutureAccess::interface(parent).exceptionStore();
+        if (promise.isCanceled()) {
+            // nothing to do
+        } else if (!parent.isCanceled()) {
+            FailureHandlerInvoker<T>::forwardResults(promise, parent);
+        } else if (!exceptionStore.hasException()) {
+            promise.reportCanceled();
+        } else {
+            try {
+                const ExceptionHolder holder = exceptionStore.exception();
+                FailureHandlerInvoker<T>::invoke(promise, handler, *holder.exception());
+            } catch (QException &e) {
+                promise.reportException(e);
+            } catch (...) {
+                promise.reportException(QUnhandledException());
+            }
+        }
+        promise.reportFinished();
+    }
+
+    static QFuture<T> create(Function handler, const QFuture<T> &parent)
+    {
+        QFutureInterface<T> promise;
+        promise.reportStarted();
+        QFuture<T> future = promise.future();
+        FutureAccess::interface(parent).addContinuation(new FailureHandler(handler, promise));
+        return future;
+    }
+
+private:
+    Function handler;
+    QFuture<T> parent;
+    QFutureInterface<T> promise;
+};
+
+#endif // QT_NO_EXCEPTIONS
+
+// The contexts below only get to see each future once it has finished, so
+// that a future dropped without finishing is not kept alive by them; the
+// combined future is then canceled.
+template <typename T>
+class WhenAllContext
+{
+public:
+    explicit WhenAllContext(int count)
+        : futures(count), remaining(count), canceled(0)
+    {
+        promise.reportStarted();
+    }
+
+    class Watcher : public FutureContinuation
+    {
+    public:
+        Watcher(WhenAllContext *context, int index) : context(context), index(index) { }
+        ~Watcher()
+        {
+            if (context)
+                context->futureFinished(false);
+        }
+        void setFinishedFuture(const QFutureInterfaceBase &future)
+        { context->futures[index] = FutureAccess::future<T>(future); }
+        void run()
+        {
+            WhenAllContext *c = context;
+            context = 0;
+            c->futureFinished(true);
+        }
+    private:
+        WhenAllContext *context;
+        int index;
+    };
+
+    void futureFinished(bool finished)
+    {
+        if (!finished)
+            canceled.store(1);
+        if (remaining.deref())
+            return;
+        if (canceled.load())
+            promise.reportCanceled();
+        else
+            promise.reportResult(futures.toList());
+        promise.reportFinished();
+        delete this;
+    }
+
+    QVector<QFuture<T> > futures;   // each written once, by its own watcher
+    QFutureInterface<QList<QFuture<T> > > promise;
+    QAtomicInt remaining;
+    QAtomicInt canceled;
+};
+
+template <typename T>
+class WhenAnyContext
+{
+public:
+    explicit WhenAnyContext(int count)
+        : remaining(count), done(0)
+    {
+        promise.reportStarted();
+    }
+
+    class Watcher : public FutureContinuation
+    {
+    public:
+        Watcher(WhenAnyContext *context, int index)
+            : context(context), index(index)
+        { }
+        ~Watcher()
+        {
+            if (context)
+                context->futureFinished(-1, QFuture<T>());
+        }
+        void setFinishedFuture(const QFutureInterfaceBase &finishedFuture)
+        { future = FutureAccess::future<T>(finishedFuture); }
+        void run()
+        {
+            WhenAnyContext *c = context;
+            context = 0;
+            c->futureFinished(index, future);
+        }
+    private:
+        WhenAnyContext *context;
+        int index;
+        QFuture<T> future;
+    };
+
+    // index is -1 for a future that was dropped without finishing
+    void futureFinished(int index, const QFuture<T> &future)
+    {
+        if (index != -1 && done.testAndSetRelaxed(0, 1)) {
+            promise.reportResult(QtFuture::WhenAnyResult<T>(index, future));
+            promise.reportFinished();
+        }
+        if (remaining.deref())
+            return;
+        if (done.testAndSetRelaxed(0, 1)) {
+            promise.reportCanceled();
+            promise.reportFinished();
+        }
+        delete this;
+    }
+
+    QFutureInterface<QtFuture::WhenAnyResult<T> > promise;
+    QAtomicInt remaining;
+    QAtomicInt done;
+};
+
+} // namespace QtPrivate
+
+template <typename T>
+template <typename Function>
+QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<T> >::Type>
+QFuture<T>::then(Function function) const
+{
+    return then(static_cast<QThreadPool *>(0), function);
+}
+
+template <typename T>
+template <typename Function>
+QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<T> >::Type>
+QFuture<T>::then(QThreadPool *pool, Function function) const
+{
+    typedef typename QtPrivate::ContinuationResult<Function, QFuture<T> >::Type R;
+    return QtPrivate::Continuation<Function, R, T>::create(function, *this, pool);
+}
+
+template <typename Function>
+QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<void> >::Type>
+QFuture<void>::then(Function function) const
+{
+    return then(static_cast<QThreadPool *>(0), function);
+}
+
+template <typename Function>
+QFuture<typename QtPrivate::ContinuationResult<Function, QFuture<void> >::Type>
+QFuture<void>::then(QThreadPool *pool, Function function) const
+{
+    typedef typename QtPrivate::ContinuationResult<Function, QFuture<void> >::Type R;
+    return QtPrivate::Continuation<Function, R, void>::create(function, *this, pool);
+}
+
+#ifndef QT_NO_EXCEPTIONS
+template <typename T>
+template <typename Function>
+QFuture<T> QFuture<T>::onFailed(Function handler) const
+{
+    return QtPrivate::FailureHandler<Function, T>::create(handler, *this);
+}
+
+template <typename Function>
+QFuture<void> QFuture<void>::onFailed(Function handler) const
+{
+    return QtPrivate::FailureHandler<Function, void>::create(handler, *this);
+}
+#endif
+
+namespace QtFuture {
+
+template <typename T>
+QFuture<QList<QFuture<T> > > whenAll(const QList<QFuture<T> > &futures)
+{
+    QtPrivate::WhenAllContext<T> *context = new QtPrivate::WhenAllContext<T>(futures.count());
+    QFuture<QList<QFuture<T> > > result = context->promise.future();
+    if (futures.isEmpty()) {
+        context->promise.reportResult(futures);
+        context->promise.reportFinished();
+        delete context;
+        return result;
+    }
+
+    // the context deletes itself once the last future has finished,
+    // which may already happen in here
+    for (int i = 0; i < futures.count(); ++i) {
+        QtPrivate::FutureAccess::interface(futures.at(i))
+            .addContinuation(new typename QtPrivate::WhenAllContext<T>::Watcher(context, i));
+    }
+    return result;
+}
+
+template <typename T>
+QFuture<WhenAnyResult<T> > whenAny(const QList<QFuture<T> > &futures)
+{
+    if (futures.isEmpty()) {
+        QFutureInterface<WhenAnyResult<T> > promise;
+        promise.reportStarted();
+        promise.reportResult(WhenAnyResult<T>());
+        promise.reportFinished();
+        return promise.future();
+    }
+
+    QtPrivate::WhenAnyContext<T> *context = new QtPrivate::WhenAnyContext<T>(futures.count());
+    QFuture<WhenAnyResult<T> > result = context->promise.future();
+    for (int i = 0; i < futures.count(); ++i) {
+        QtPrivate::FutureAccess::interface(futures.at(i))
+            .addContinuation(new typename QtPrivate::WhenAnyContext<T>::Watcher(context, i));
+    }
+    return result;
+}
+
+} // namespace QtFuture
+
+QT_END_NAMESPACE
+
+#endif // Q_QDOC
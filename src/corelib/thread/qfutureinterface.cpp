@@ -95,6 +95,7 @@ void QFutureInterfaceBase::cancel()
     d->state = State((d->state & ~Paused) | Canceled);
     d->waitCondition.wakeAll();
     d->pausedWaitCondition.wakeAll();
+    d->bufferWaitCondition.wakeAll();
     d->sendCallOut(QFutureCallOutEvent(QFutureCallOutEvent::Canceled));
 }
 
@@ -259,6 +260,7 @@ void QFutureInterfaceBase::reportException(const QException &exception)
     d->state = State(d->state | Canceled);
     d->waitCondition.wakeAll();
     d->pausedWaitCondition.wakeAll();
+    d->bufferWaitCondition.wakeAll();
     d->sendCallOut(QFutureCallOutEvent(QFutureCallOutEvent::Canceled));
 }
 #endif
@@ -270,7 +272,134 @@ void QFutureInterfaceBase::reportFinished()
         d->state = State((d->state & ~Running) | Finished);
         d->waitCondition.wakeAll();
         d->sendCallOut(QFutureCallOutEvent(QFutureCallOutEvent::Finished));
+
+        if (d->continuations.isEmpty())
+            return;
+
+        // continuations may attach to or wait for this future themselves,
+        // so they must run without the lock held
+        QList<QPair<QtPrivate::FutureContinuation *, QThreadPool *> > continuations;
+        qSwap(continuations, d->continuations);
+        locker.unlock();
+
+        for (int i = 0; i < continuations.count(); ++i)
+            QFutureInterfaceBasePrivate::runContinuation(continuations.at(i).first,
+                                                         continuations.at(i).second, *this);
+    }
+}
+
+/*
+    Arranges for continuation to be run once this future has finished,
+    successfully or not. If pool is 0, the continuation runs directly in
+    the thread that reports the future as finished; otherwise it is started
+    in pool. If the future has already finished, this happens right
+    away. Ownership of continuation is transferred; it is deleted after
+    it has run, or when the future is destroyed without having finished.
+
+    Unlike a QFutureWatcher, this needs neither a QObject nor an event loop.
+*/
+void QFutureInterfaceBase::addContinuation(QtPrivate::FutureContinuation *continuation,
+                                           QThreadPool *pool)
+{
+    QMutexLocker locker(&d->m_mutex);
+    if (!(d->state & Finished)) {
+        d->continuations.append(qMakePair(continuation, pool));
+        return;
     }
+    locker.unlock();
+
+    QFutureInterfaceBasePrivate::runContinuation(continuation, pool, *this);
+}
+
+/*
+    Limits the number of results that may have been reported but not yet
+    taken with takeNextResult() to limit; 0 means no limit. Producers call
+    waitForResultBufferSpace() before computing results, which makes them
+    wait for the consumer instead of buffering the whole computation.
+*/
+void QFutureInterfaceBase::setResultBufferLimit(int limit)
+{
+    QMutexLocker locker(&d->m_mutex);
+    d->m_resultBufferLimit = qMax(0, limit);
+    d->bufferWaitCondition.wakeAll();
+}
+
+int QFutureInterfaceBase::resultBufferLimit() const
+{
+    QMutexLocker locker(&d->m_mutex);
+    return d->m_resultBufferLimit;
+}
+
+bool QFutureInterfaceBase::hasResultBufferSpace(int endIndex) const
+{
+    QMutexLocker locker(&d->m_mutex);
+    return d->internal_hasResultBufferSpace(endIndex);
+}
+
+/*
+    Waits until the results up to endIndex fit into the result buffer.
+    Returns false if the computation was canceled in the meantime, so the
+    producer should stop.
+
+    If every QFuture<T> has been destroyed, nobody can take the results any
+    more; the computation is canceled instead of waiting forever.
+*/
+bool QFutureInterfaceBase::waitForResultBufferSpace(int endIndex)
+{
+    QMutexLocker locker(&d->m_mutex);
+    if (!d->internal_hasResultBufferSpace(endIndex)) {
+        // decrease active thread count since this thread will wait.
+        const ThreadPoolThreadReleaser releaser(QThreadPool::globalInstance());
+
+        while (!(d->state & Canceled) && !d->internal_hasResultBufferSpace(endIndex)) {
+            if (d->refCount.loadT() <= 1) {
+                d->state = State((d->state & ~Paused) | Canceled);
+                d->waitCondition.wakeAll();
+                d->pausedWaitCondition.wakeAll();
+                d->bufferWaitCondition.wakeAll();
+                d->sendCallOut(QFutureCallOutEvent(QFutureCallOutEvent::Canceled));
+                break;
+            }
+            d->bufferWaitCondition.wait(&d->m_mutex);
+        }
+    }
+    return !(d->state & Canceled);
+}
+
+/*
+    Waits for the next result in order that has not been taken yet and
+    returns its index, or -1 if the computation finished without producing
+    it. Throws the stored exception, if any, once no results are left.
+*/
+int QFutureInterfaceBase::waitForNextResultToTake()
+{
+    QMutexLocker lock(&d->m_mutex);
+    const int index = d->m_takenResults;
+    if (!d->internal_isResultReadyAt(index) && (d->state & Running)) {
+        lock.unlock();
+        QThreadPool::globalInstance()->d_func()->stealRunnable(d->runnable);
+        lock.relock();
+
+        while ((d->state & Running) && !d->internal_isResultReadyAt(index))
+            d->waitCondition.wait(&d->m_mutex);
+    }
+    if (d->internal_isResultReadyAt(index))
+        return index;
+
+    lock.unlock();
+    d->m_exceptionStore.throwPossibleException();
+    return -1;
+}
+
+/*
+    Called with the mutex locked after the result returned by
+    waitForNextResultToTake() has been removed from the result store.
+*/
+void QFutureInterfaceBase::resultTaken()
+{
+    ++d->m_takenResults;
+    if (d->m_resultBufferLimit > 0)
+        d->bufferWaitCondition.wakeAll();
 }
 
 void QFutureInterfaceBase::setExpectedResultCount(int resultCount)
@@ -438,17 +567,32 @@ bool QFutureInterfaceBase::refT() const
 
 bool QFutureInterfaceBase::derefT() const
 {
-    return d->refCount.derefT();
+    if (d->m_resultBufferLimit == 0)
+        return d->refCount.derefT();
+
+    // producers waiting for buffer space watch for the last consumer to go
+    QMutexLocker locker(&d->m_mutex);
+    const bool alive = d->refCount.derefT();
+    d->bufferWaitCondition.wakeAll();
+    return alive;
 }
 
 QFutureInterfaceBasePrivate::QFutureInterfaceBasePrivate(QFutureInterfaceBase::State initialState)
     : refCount(1), m_progressValue(0), m_progressMinimum(0), m_progressMaximum(0),
       state(initialState),
-      manualProgress(false), m_expectedResultCount(0), runnable(0)
+      manualProgress(false), m_expectedResultCount(0), runnable(0),
+      m_resultBufferLimit(0), m_takenResults(0)
 {
     progressTime.invalidate();
 }
 
+QFutureInterfaceBasePrivate::~QFutureInterfaceBasePrivate()
+{
+    // continuations of a future that never finished
+    for (int i = 0; i < continuations.count(); ++i)
+        delete continuations.at(i).first;
+}
+
 int QFutureInterfaceBasePrivate::internal_resultCount() const
 {
     return m_results.count(); // ### subtract canceled results.
@@ -504,6 +648,11 @@ void QFutureInterfaceBasePrivate::internal_setThrottled(bool enable)
     }
 }
 
+bool QFutureInterfaceBasePrivate::internal_hasResultBufferSpace(int endIndex) const
+{
+    return m_resultBufferLimit == 0 || endIndex - m_takenResults <= m_resultBufferLimit;
+}
+
 void QFutureInterfaceBasePrivate::sendCallOut(const QFutureCallOutEvent &callOutEvent)
 {
     if (outputConnections.isEmpty())
@@ -582,6 +731,22 @@ void QFutureInterfaceBasePrivate::setState(QFutureInterfaceBase::State newState)
     state = newState;
 }
 
+void QFutureInterfaceBasePrivate::runContinuation(QtPrivate::FutureContinuation *continuation,
+                                                  QThreadPool *pool,
+                                                  const QFutureInterfaceBase &future)
+{
+    continuation->setFinishedFuture(future);
+    if (pool) {
+        pool->start(continuation);
+        return;
+    }
+
+    const bool autoDelete = continuation->autoDelete();
+    continuation->run();
+    if (autoDelete)
+        delete continuation;
+}
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_QFUTURE
@@ -54,10 +54,15 @@ QT_BEGIN_NAMESPACE
 
 
 template <typename T> class QFuture;
+class QThreadPool;
 class QFutureInterfaceBasePrivate;
 class QFutureWatcherBase;
 class QFutureWatcherBasePrivate;
 
+namespace QtPrivate {
+class FutureContinuation;
+}
+
 class Q_CORE_EXPORT QFutureInterfaceBase
 {
 public:
@@ -118,6 +123,15 @@ public:
     void waitForResult(int resultIndex);
     void waitForResume();
 
+    void addContinuation(QtPrivate::FutureContinuation *continuation, QThreadPool *pool = 0);
+
+    void setResultBufferLimit(int limit);
+    int resultBufferLimit() const;
+    bool hasResultBufferSpace(int endIndex) const;
+    bool waitForResultBufferSpace(int endIndex);
+    int waitForNextResultToTake();
+    void resultTaken();
+
     QMutex *mutex() const;
     QtPrivate::ExceptionStore &exceptionStore();
     QtPrivate::ResultStoreBase &resultStoreBase();
@@ -142,6 +156,23 @@ private:
     friend class QFutureWatcherBasePrivate;
 };
 
+namespace QtPrivate {
+
+/*
+    A runnable attached to a future with addContinuation(). The future only
+    hands itself to the continuation once it has finished, so the
+    continuation holds no reference to it while waiting: a future that is
+    dropped without finishing deletes its continuations instead of being
+    kept alive by them.
+*/
+class FutureContinuation : public QRunnable
+{
+public:
+    virtual void setFinishedFuture(const QFutureInterfaceBase &future) = 0;
+};
+
+} // namespace QtPrivate
+
 template <typename T>
 class QFutureInterface : public QFutureInterfaceBase
 {
@@ -156,6 +187,11 @@ public:
     {
         refT();
     }
+    explicit QFutureInterface(const QFutureInterfaceBase &dd)
+        : QFutureInterfaceBase(dd)
+    {
+        refT();
+    }
     ~QFutureInterface()
     {
         if (!derefT())
@@ -184,6 +220,7 @@ public:
     inline const T &resultReference(int index) const;
     inline const T *resultPointer(int index) const;
     inline QList<T> results();
+    inline T takeNextResult();
 private:
     QtPrivate::ResultStore<T> &resultStore()
     { return static_cast<QtPrivate::ResultStore<T> &>(resultStoreBase()); }
@@ -281,6 +318,21 @@ inline QList<T> QFutureInterface<T>::results()
     return res;
 }
 
+template <typename T>
+inline T QFutureInterface<T>::takeNextResult()
+{
+    const int index = waitForNextResultToTake();
+    if (index == -1)
+        return T();
+
+    QMutexLocker lock(mutex());
+    QtPrivate::ResultStore<T> &store = resultStore();
+    const T result = store.resultAt(index).value();
+    store.removeResultsBefore(index + 1);
+    resultTaken();
+    return result;
+}
+
 template <>
 class QFutureInterface<void> : public QFutureInterfaceBase
 {
@@ -291,6 +343,9 @@ public:
     QFutureInterface<void>(const QFutureInterface<void> &other)
         : QFutureInterfaceBase(other)
     { }
+    explicit QFutureInterface<void>(const QFutureInterfaceBase &dd)
+        : QFutureInterfaceBase(dd)
+    { }
 
     static QFutureInterface<void> canceledResult()
     { return QFutureInterface(State(Started | Finished | Canceled)); }
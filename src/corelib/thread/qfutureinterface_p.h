@@ -56,6 +56,7 @@
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qcoreevent.h>
 #include <QtCore/qlist.h>
+#include <QtCore/qpair.h>
 #include <QtCore/qwaitcondition.h>
 #include <QtCore/qrunnable.h>
 
@@ -128,6 +129,7 @@ class QFutureInterfaceBasePrivate
 {
 public:
     QFutureInterfaceBasePrivate(QFutureInterfaceBase::State initialState);
+    ~QFutureInterfaceBasePrivate();
 
     // When the last QFuture<T> reference is removed, we need to make
     // sure that data stored in the ResultStore is cleaned out.
@@ -170,6 +172,16 @@ public:
     QString m_progressText;
     QRunnable *runnable;
 
+    // Streaming: producers wait on bufferWaitCondition while more than
+    // m_resultBufferLimit results have been reported but not yet taken.
+    int m_resultBufferLimit;
+    int m_takenResults;
+    QWaitCondition bufferWaitCondition;
+
+    // Runnables to start once the future finishes, together with the
+    // thread pool to start them in (0 means run them directly).
+    QList<QPair<QtPrivate::FutureContinuation *, QThreadPool *> > continuations;
+
     // Internal functions that does not change the mutex state.
     // The mutex must be locked when calling these.
     int internal_resultCount() const;
@@ -177,12 +189,16 @@ public:
     bool internal_waitForNextResult();
     bool internal_updateProgress(int progress, const QString &progressText = QString());
     void internal_setThrottled(bool enable);
+    bool internal_hasResultBufferSpace(int endIndex) const;
     void sendCallOut(const QFutureCallOutEvent &callOut);
     void sendCallOuts(const QFutureCallOutEvent &callOut1, const QFutureCallOutEvent &callOut2);
     void connectOutputInterface(QFutureCallOutInterface *iface);
     void disconnectOutputInterface(QFutureCallOutInterface *iface);
 
     void setState(QFutureInterfaceBase::State state);
+
+    static void runContinuation(QtPrivate::FutureContinuation *continuation, QThreadPool *pool,
+                                const QFutureInterfaceBase &future);
 };
 
 QT_END_NAMESPACE
@@ -48,6 +48,17 @@
 #include "qwaitcondition.h"
 
 #include "qreadwritelock_p.h"
+#include "qmutex_p.h"
+#include "private/qsimd_p.h"
+
+#include <limits.h>
+
+#ifdef QT_LINUX_FUTEX
+#  include <linux/futex.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#  include <errno.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -142,32 +153,16 @@ QReadWriteLock::~QReadWriteLock()
 */
 void QReadWriteLock::lockForRead()
 {
-    QMutexLocker lock(&d->mutex);
-
-    Qt::HANDLE self = 0;
     if (d->recursive) {
-        self = QThread::currentThreadId();
-
-        QHash<Qt::HANDLE, int>::iterator it = d->currentReaders.find(self);
-        if (it != d->currentReaders.end()) {
-            ++it.value();
-            ++d->accessCount;
-            Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::lockForRead()",
-                       "Overflow in lock counter");
-            return;
-        }
-    }
-
-    while (d->accessCount < 0 || d->waitingWriters) {
-        ++d->waitingReaders;
-        d->readerWait.wait(&d->mutex);
-        --d->waitingReaders;
+        d->recursiveLockForRead(-1);
+        return;
     }
-    if (d->recursive)
-        d->currentReaders.insert(self, 1);
 
-    ++d->accessCount;
-    Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::lockForRead()", "Overflow in lock counter");
+    int state = d->state.load();
+    if (Q_LIKELY(QReadWriteLockPrivate::isReadLockable(state)
+                 && d->state.testAndSetAcquire(state, state + QReadWriteLockPrivate::ReadLocked)))
+        return;
+    d->lockForReadContended(-1);
 }
 
 /*!
@@ -188,31 +183,19 @@ void QReadWriteLock::lockForRead()
 */
 bool QReadWriteLock::tryLockForRead()
 {
-    QMutexLocker lock(&d->mutex);
+    if (d->recursive)
+        return d->recursiveTryLockForRead();
 
-    Qt::HANDLE self = 0;
-    if (d->recursive) {
-        self = QThread::currentThreadId();
-
-        QHash<Qt::HANDLE, int>::iterator it = d->currentReaders.find(self);
-        if (it != d->currentReaders.end()) {
-            ++it.value();
-            ++d->accessCount;
-            Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::tryLockForRead()",
-                       "Overflow in lock counter");
-            return true;
+    forever {
+        const int state = d->state.load();
+        if ((state & QReadWriteLockPrivate::LockMask) >= QReadWriteLockPrivate::MaxReaders) {
+            Q_ASSERT_X((state & QReadWriteLockPrivate::LockMask) != QReadWriteLockPrivate::MaxReaders,
+                       "QReadWriteLock::tryLockForRead()", "Overflow in lock counter");
+            return false;
         }
+        if (d->state.testAndSetAcquire(state, state + QReadWriteLockPrivate::ReadLocked))
+            return true;
     }
-
-    if (d->accessCount < 0)
-        return false;
-    if (d->recursive)
-        d->currentReaders.insert(self, 1);
-
-    ++d->accessCount;
-    Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::tryLockForRead()", "Overflow in lock counter");
-
-    return true;
 }
 
 /*! \overload
@@ -236,36 +219,14 @@ bool QReadWriteLock::tryLockForRead()
 */
 bool QReadWriteLock::tryLockForRead(int timeout)
 {
-    QMutexLocker lock(&d->mutex);
-
-    Qt::HANDLE self = 0;
-    if (d->recursive) {
-        self = QThread::currentThreadId();
-
-        QHash<Qt::HANDLE, int>::iterator it = d->currentReaders.find(self);
-        if (it != d->currentReaders.end()) {
-            ++it.value();
-            ++d->accessCount;
-            Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::tryLockForRead()",
-                       "Overflow in lock counter");
-            return true;
-        }
-    }
-
-    while (d->accessCount < 0 || d->waitingWriters) {
-        ++d->waitingReaders;
-        bool success = d->readerWait.wait(&d->mutex, timeout < 0 ? ULONG_MAX : ulong(timeout));
-        --d->waitingReaders;
-        if (!success)
-            return false;
-    }
     if (d->recursive)
-        d->currentReaders.insert(self, 1);
-
-    ++d->accessCount;
-    Q_ASSERT_X(d->accessCount > 0, "QReadWriteLock::tryLockForRead()", "Overflow in lock counter");
+        return d->recursiveLockForRead(timeout);
 
-    return true;
+    int state = d->state.load();
+    if (QReadWriteLockPrivate::isReadLockable(state)
+        && d->state.testAndSetAcquire(state, state + QReadWriteLockPrivate::ReadLocked))
+        return true;
+    return d->lockForReadContended(timeout);
 }
 
 /*!
@@ -281,30 +242,14 @@ bool QReadWriteLock::tryLockForRead(int timeout)
 */
 void QReadWriteLock::lockForWrite()
 {
-    QMutexLocker lock(&d->mutex);
-
-    Qt::HANDLE self = 0;
     if (d->recursive) {
-        self = QThread::currentThreadId();
-
-        if (d->currentWriter == self) {
-            --d->accessCount;
-            Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::lockForWrite()",
-                       "Overflow in lock counter");
-            return;
-        }
+        d->recursiveLockForWrite(-1);
+        return;
     }
 
-    while (d->accessCount != 0) {
-        ++d->waitingWriters;
-        d->writerWait.wait(&d->mutex);
-        --d->waitingWriters;
-    }
-    if (d->recursive)
-        d->currentWriter = self;
-
-    --d->accessCount;
-    Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::lockForWrite()", "Overflow in lock counter");
+    if (Q_LIKELY(d->state.testAndSetAcquire(0, QReadWriteLockPrivate::WriteLocked)))
+        return;
+    d->lockForWriteContended(-1);
 }
 
 /*!
@@ -324,30 +269,16 @@ void QReadWriteLock::lockForWrite()
 */
 bool QReadWriteLock::tryLockForWrite()
 {
-    QMutexLocker lock(&d->mutex);
-
-    Qt::HANDLE self = 0;
-    if (d->recursive) {
-        self = QThread::currentThreadId();
+    if (d->recursive)
+        return d->recursiveTryLockForWrite();
 
-        if (d->currentWriter == self) {
-            --d->accessCount;
-            Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::lockForWrite()",
-                       "Overflow in lock counter");
+    forever {
+        const int state = d->state.load();
+        if (state & QReadWriteLockPrivate::LockMask)
+            return false;
+        if (d->state.testAndSetAcquire(state, state | QReadWriteLockPrivate::WriteLocked))
             return true;
-        }
     }
-
-    if (d->accessCount != 0)
-        return false;
-    if (d->recursive)
-        d->currentWriter = self;
-
-    --d->accessCount;
-    Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::tryLockForWrite()",
-               "Overflow in lock counter");
-
-    return true;
 }
 
 /*! \overload
@@ -371,76 +302,424 @@ bool QReadWriteLock::tryLockForWrite()
 */
 bool QReadWriteLock::tryLockForWrite(int timeout)
 {
-    QMutexLocker lock(&d->mutex);
+    if (d->recursive)
+        return d->recursiveLockForWrite(timeout);
+
+    if (d->state.testAndSetAcquire(0, QReadWriteLockPrivate::WriteLocked))
+        return true;
+    return d->lockForWriteContended(timeout);
+}
+
+/*!
+    Unlocks the lock.
 
-    Qt::HANDLE self = 0;
+    Attempting to unlock a lock that is not locked is an error, and will result
+    in program termination.
+
+    \sa lockForRead(), lockForWrite(), tryLockForRead(), tryLockForWrite()
+*/
+void QReadWriteLock::unlock()
+{
     if (d->recursive) {
-        self = QThread::currentThreadId();
+        d->recursiveUnlock();
+        return;
+    }
 
-        if (d->currentWriter == self) {
-            --d->accessCount;
-            Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::lockForWrite()",
-                       "Overflow in lock counter");
-            return true;
+    int state = d->state.load();
+    Q_ASSERT_X(state & QReadWriteLockPrivate::LockMask, "QReadWriteLock::unlock()",
+               "Cannot unlock an unlocked lock");
+
+    if ((state & QReadWriteLockPrivate::LockMask) == QReadWriteLockPrivate::WriteLocked) {
+        // released a write lock
+        state = d->state.fetchAndAddRelease(-QReadWriteLockPrivate::WriteLocked)
+                - QReadWriteLockPrivate::WriteLocked;
+        if (state)
+            d->wakeWriterOrReaders(state);
+    } else {
+        // releasing a read lock; only the last reader has anyone to wake
+        state = d->state.fetchAndAddRelease(-QReadWriteLockPrivate::ReadLocked)
+                - QReadWriteLockPrivate::ReadLocked;
+        if (!(state & QReadWriteLockPrivate::LockMask)
+            && (state & QReadWriteLockPrivate::WritersWaiting))
+            d->wakeWriterOrReaders(state);
+    }
+}
+
+/*
+    Futex-based implementation of non-recursive locks
+
+    The algorithm follows the classic three-state futex lock, extended for
+    readers. The lock is free for readers when no writer holds it and
+    nobody is waiting, and free for writers when neither readers nor a
+    writer hold it:
+
+    - A reader that cannot get the lock sets ReadersWaiting and sleeps on
+      the state word itself. Readers are woken all at once.
+    - A writer that cannot get the lock sets WritersWaiting and sleeps on
+      writerNotify, which is incremented before every wake-up so that no
+      wake-up can get lost between checking the state and going to sleep.
+      Writers are woken one at a time; a writer that was woken up keeps
+      WritersWaiting set when it takes the lock, as it can't know whether
+      other writers are still sleeping.
+    - Whoever unlocks the lock completely checks the waiting bits and wakes
+      a writer if there is one, or else all readers.
+
+    Before going to sleep, lockers spin for a while in the hope that the
+    lock becomes free. The number of spins adapts to how long it took for
+    the lock to become free in the past.
+*/
+
+enum { MaxSpins = 200, MinSpins = 16 };
+
+static inline void cpuRelax()
+{
+#if defined(Q_PROCESSOR_X86) && defined(__SSE2__)
+    _mm_pause();
+#endif
+}
+
+static int spinLimit(int averageSpins)
+{
+    // spinning is pointless without another processor to release the lock
+    static const bool singleProcessor = QThread::idealThreadCount() <= 1;
+    if (singleProcessor)
+        return 0;
+    return qMin(int(MaxSpins), 2 * averageSpins + MinSpins);
+}
+
+int QReadWriteLockPrivate::spin(bool forWrite)
+{
+    const int average = averageSpins.load();
+    const int limit = spinLimit(average);
+    int s = state.load();
+    for (int i = 0; i < limit; ++i) {
+        const int locked = s & LockMask;
+        if (forWrite ? locked == 0 : locked != WriteLocked) {
+            averageSpins.store(average + (i - average) / 8);
+            return s;
+        }
+        // others are sleeping already, join them
+        if (s & (forWrite ? WritersWaiting : ReadersWaiting | WritersWaiting))
+            return s;
+        cpuRelax();
+        s = state.load();
+    }
+    // spinning didn't help this time
+    averageSpins.store(average - average / 8);
+    return s;
+}
+
+bool QReadWriteLockPrivate::lockForReadContended(int timeout)
+{
+    QElapsedTimer timer;
+    if (timeout > 0)
+        timer.start();
+
+    int s = timeout == 0 ? state.load() : spin(false);
+    forever {
+        if (isReadLockable(s)) {
+            if (state.testAndSetAcquire(s, s + ReadLocked))
+                return true;
+            s = state.load();
+            continue;
+        }
+        Q_ASSERT_X((s & LockMask) != MaxReaders, "QReadWriteLock::lockForRead()",
+                   "Overflow in lock counter");
+
+        if (!(s & ReadersWaiting)) {
+            if (!state.testAndSetRelaxed(s, s | ReadersWaiting)) {
+                s = state.load();
+                continue;
+            }
+            s |= ReadersWaiting;
+        }
+
+        // a reader that gives up may leave ReadersWaiting set; the next
+        // unlock just wakes nobody then
+        if (!wait(state, s, timeout, timer))
+            return false;
+        s = spin(false);
+    }
+}
+
+bool QReadWriteLockPrivate::lockForWriteContended(int timeout)
+{
+    QElapsedTimer timer;
+    if (timeout > 0)
+        timer.start();
+
+    int s = timeout == 0 ? state.load() : spin(true);
+    int otherWritersWaiting = 0;
+    forever {
+        if (!(s & LockMask)) {
+            if (state.testAndSetAcquire(s, s | WriteLocked | otherWritersWaiting))
+                return true;
+            s = state.load();
+            continue;
+        }
+
+        if (!(s & WritersWaiting)) {
+            if (!state.testAndSetRelaxed(s, s | WritersWaiting)) {
+                s = state.load();
+                continue;
+            }
+        }
+        otherWritersWaiting = WritersWaiting;
+
+        const int notify = writerNotify.loadAcquire();
+        s = state.load();
+        if (!(s & LockMask) || !(s & WritersWaiting))
+            continue;
+
+        if (!wait(writerNotify, notify, timeout, timer)) {
+            // we might have been the writer that was picked to be woken
+            // up; pass that on so no other writer keeps sleeping
+            wakeWriter();
+            return false;
         }
+        s = spin(true);
+    }
+}
+
+// called with the lock not held by anyone, and at least one waiting bit set
+void QReadWriteLockPrivate::wakeWriterOrReaders(int s)
+{
+    Q_ASSERT(!(s & LockMask));
+
+    if (s == WritersWaiting) {
+        if (state.testAndSetRelaxed(s, 0)) {
+            wakeWriter();
+            return;
+        }
+        s = state.load();
+    }
+
+    if (s == (ReadersWaiting | WritersWaiting)) {
+        // leave the readers waiting if there really was a writer to wake up
+        if (!state.testAndSetRelaxed(s, ReadersWaiting))
+            return;
+        if (wakeWriter())
+            return;
+        s = ReadersWaiting;
+    }
+
+    if (s == ReadersWaiting) {
+        if (state.testAndSetRelaxed(s, 0))
+            wake(state, INT_MAX);
+    }
+}
+
+bool QReadWriteLockPrivate::wakeWriter()
+{
+    writerNotify.fetchAndAddRelease(1);
+    return wake(writerNotify, 1) > 0;
+}
+
+#ifdef QT_LINUX_FUTEX
+
+static inline int futexOp(QAtomicInt *word, int op, int value, const struct timespec *timeout = 0)
+{
+    // we use __NR_futex because some libcs (like Android's bionic) don't
+    // provide SYS_futex etc.
+    return syscall(__NR_futex, reinterpret_cast<int *>(word), op | FUTEX_PRIVATE_FLAG,
+                   value, timeout, 0, 0);
+}
+
+// returns false if the timeout expired
+bool QReadWriteLockPrivate::wait(QAtomicInt &word, int expectedValue, int timeout,
+                                 const QElapsedTimer &timer)
+{
+    if (timeout < 0) {
+        futexOp(&word, FUTEX_WAIT, expectedValue);
+        return true;
+    }
+
+    const qint64 remaining = qint64(timeout) * 1000 * 1000 - (timeout ? timer.nsecsElapsed() : 0);
+    if (remaining <= 0)
+        return false;
+    struct timespec ts;
+    ts.tv_sec = remaining / (Q_INT64_C(1000) * 1000 * 1000);
+    ts.tv_nsec = remaining % (Q_INT64_C(1000) * 1000 * 1000);
+    return futexOp(&word, FUTEX_WAIT, expectedValue, &ts) == 0 || errno != ETIMEDOUT;
+}
+
+// returns the number of threads woken up
+int QReadWriteLockPrivate::wake(QAtomicInt &word, int count)
+{
+    return futexOp(&word, FUTEX_WAKE, count);
+}
+
+#else
+
+// Without futexes, sleep on the wait conditions. The word is re-checked
+// with the mutex locked and wake() takes the mutex, so no wake-up gets lost.
+bool QReadWriteLockPrivate::wait(QAtomicInt &word, int expectedValue, int timeout,
+                                 const QElapsedTimer &timer)
+{
+    qint64 remaining = -1;
+    if (timeout >= 0) {
+        remaining = timeout - (timeout ? timer.elapsed() : 0);
+        if (remaining <= 0)
+            return false;
     }
 
-    while (d->accessCount != 0) {
-        ++d->waitingWriters;
-        bool success = d->writerWait.wait(&d->mutex, timeout < 0 ? ULONG_MAX : ulong(timeout));
-        --d->waitingWriters;
+    const bool isState = &word == &state;
+    QMutexLocker locker(&mutex);
+    if (word.load() != expectedValue)
+        return true;
+    int &waiters = isState ? waitingReaders : waitingWriters;
+    ++waiters;
+    const bool woken = (isState ? readerWait : writerWait)
+            .wait(&mutex, remaining < 0 ? ULONG_MAX : ulong(remaining));
+    --waiters;
+    return woken;
+}
+
+int QReadWriteLockPrivate::wake(QAtomicInt &word, int count)
+{
+    const bool isState = &word == &state;
+    QMutexLocker locker(&mutex);
+    const int waiters = isState ? waitingReaders : waitingWriters;
+    if (count == 1)
+        (isState ? readerWait : writerWait).wakeOne();
+    else
+        (isState ? readerWait : writerWait).wakeAll();
+    return qMin(waiters, count);
+}
+
+#endif // QT_LINUX_FUTEX
 
+/*
+    Recursive locks
+*/
+
+bool QReadWriteLockPrivate::recursiveLockForRead(int timeout)
+{
+    QMutexLocker lock(&mutex);
+
+    Qt::HANDLE self = QThread::currentThreadId();
+    QHash<Qt::HANDLE, int>::iterator it = currentReaders.find(self);
+    if (it != currentReaders.end()) {
+        ++it.value();
+        ++accessCount;
+        Q_ASSERT_X(accessCount > 0, "QReadWriteLock::lockForRead()",
+                   "Overflow in lock counter");
+        return true;
+    }
+
+    while (accessCount < 0 || waitingWriters) {
+        ++waitingReaders;
+        bool success = readerWait.wait(&mutex, timeout < 0 ? ULONG_MAX : ulong(timeout));
+        --waitingReaders;
         if (!success)
             return false;
     }
-    if (d->recursive)
-        d->currentWriter = self;
+    currentReaders.insert(self, 1);
 
-    --d->accessCount;
-    Q_ASSERT_X(d->accessCount < 0, "QReadWriteLock::tryLockForWrite()",
-               "Overflow in lock counter");
+    ++accessCount;
+    Q_ASSERT_X(accessCount > 0, "QReadWriteLock::lockForRead()", "Overflow in lock counter");
+    return true;
+}
+
+bool QReadWriteLockPrivate::recursiveTryLockForRead()
+{
+    QMutexLocker lock(&mutex);
+
+    Qt::HANDLE self = QThread::currentThreadId();
+    QHash<Qt::HANDLE, int>::iterator it = currentReaders.find(self);
+    if (it != currentReaders.end()) {
+        ++it.value();
+        ++accessCount;
+        Q_ASSERT_X(accessCount > 0, "QReadWriteLock::tryLockForRead()",
+                   "Overflow in lock counter");
+        return true;
+    }
 
+    if (accessCount < 0)
+        return false;
+    currentReaders.insert(self, 1);
+
+    ++accessCount;
+    Q_ASSERT_X(accessCount > 0, "QReadWriteLock::tryLockForRead()", "Overflow in lock counter");
     return true;
 }
 
-/*!
-    Unlocks the lock.
+bool QReadWriteLockPrivate::recursiveLockForWrite(int timeout)
+{
+    QMutexLocker lock(&mutex);
+
+    Qt::HANDLE self = QThread::currentThreadId();
+    if (currentWriter == self) {
+        --accessCount;
+        Q_ASSERT_X(accessCount < 0, "QReadWriteLock::lockForWrite()",
+                   "Overflow in lock counter");
+        return true;
+    }
 
-    Attempting to unlock a lock that is not locked is an error, and will result
-    in program termination.
+    while (accessCount != 0) {
+        ++waitingWriters;
+        bool success = writerWait.wait(&mutex, timeout < 0 ? ULONG_MAX : ulong(timeout));
+        --waitingWriters;
+        if (!success)
+            return false;
+    }
+    currentWriter = self;
 
-    \sa lockForRead(), lockForWrite(), tryLockForRead(), tryLockForWrite()
-*/
-void QReadWriteLock::unlock()
+    --accessCount;
+    Q_ASSERT_X(accessCount < 0, "QReadWriteLock::lockForWrite()", "Overflow in lock counter");
+    return true;
+}
+
+bool QReadWriteLockPrivate::recursiveTryLockForWrite()
 {
-    QMutexLocker lock(&d->mutex);
+    QMutexLocker lock(&mutex);
+
+    Qt::HANDLE self = QThread::currentThreadId();
+    if (currentWriter == self) {
+        --accessCount;
+        Q_ASSERT_X(accessCount < 0, "QReadWriteLock::tryLockForWrite()",
+                   "Overflow in lock counter");
+        return true;
+    }
 
-    Q_ASSERT_X(d->accessCount != 0, "QReadWriteLock::unlock()", "Cannot unlock an unlocked lock");
+    if (accessCount != 0)
+        return false;
+    currentWriter = self;
+
+    --accessCount;
+    Q_ASSERT_X(accessCount < 0, "QReadWriteLock::tryLockForWrite()",
+               "Overflow in lock counter");
+    return true;
+}
+
+void QReadWriteLockPrivate::recursiveUnlock()
+{
+    QMutexLocker lock(&mutex);
+
+    Q_ASSERT_X(accessCount != 0, "QReadWriteLock::unlock()", "Cannot unlock an unlocked lock");
 
     bool unlocked = false;
-    if (d->accessCount > 0) {
+    if (accessCount > 0) {
         // releasing a read lock
-        if (d->recursive) {
-            Qt::HANDLE self = QThread::currentThreadId();
-            QHash<Qt::HANDLE, int>::iterator it = d->currentReaders.find(self);
-            if (it != d->currentReaders.end()) {
-                if (--it.value() <= 0)
-                    d->currentReaders.erase(it);
-            }
+        Qt::HANDLE self = QThread::currentThreadId();
+        QHash<Qt::HANDLE, int>::iterator it = currentReaders.find(self);
+        if (it != currentReaders.end()) {
+            if (--it.value() <= 0)
+                currentReaders.erase(it);
         }
 
-        unlocked = --d->accessCount == 0;
-    } else if (d->accessCount < 0 && ++d->accessCount == 0) {
+        unlocked = --accessCount == 0;
+    } else if (accessCount < 0 && ++accessCount == 0) {
         // released a write lock
         unlocked = true;
-        d->currentWriter = 0;
+        currentWriter = 0;
     }
 
     if (unlocked) {
-        if (d->waitingWriters) {
-            d->writerWait.wakeOne();
-        } else if (d->waitingReaders) {
-            d->readerWait.wakeAll();
+        if (waitingWriters) {
+            writerWait.wakeOne();
+        } else if (waitingReaders) {
+            readerWait.wakeAll();
         }
     }
 }
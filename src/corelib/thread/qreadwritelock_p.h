@@ -55,6 +55,10 @@
 
 #include <QtCore/qglobal.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qwaitcondition.h>
+#include <QtCore/qelapsedtimer.h>
 
 #ifndef QT_NO_THREAD
 
@@ -63,10 +67,50 @@ QT_BEGIN_NAMESPACE
 struct QReadWriteLockPrivate
 {
     QReadWriteLockPrivate(QReadWriteLock::RecursionMode recursionMode)
-        : accessCount(0), waitingReaders(0), waitingWriters(0),
+        : state(0), writerNotify(0), averageSpins(0),
+          accessCount(0), waitingReaders(0), waitingWriters(0),
           recursive(recursionMode == QReadWriteLock::Recursive), currentWriter(0)
     { }
 
+    // Non-recursive locks keep all of their state in one word: the number
+    // of readers (or WriteLocked) in the low bits, plus a bit each for
+    // sleeping readers and writers. Readers and writers only leave the
+    // fast path when they have to wait, and then spin for a while before
+    // sleeping on a futex (or on the wait conditions below elsewhere).
+    enum {
+        ReadLocked = 1,
+        LockMask = (1 << 28) - 1,
+        WriteLocked = LockMask,
+        MaxReaders = LockMask - 1,
+        ReadersWaiting = 1 << 28,
+        WritersWaiting = 1 << 29
+    };
+
+    static inline bool isReadLockable(int state)
+    {
+        // readers don't overtake waiting writers
+        return (state & LockMask) < MaxReaders
+               && !(state & (ReadersWaiting | WritersWaiting));
+    }
+
+    QAtomicInt state;
+    // bumped every time a writer is woken up; writers sleep on it
+    QAtomicInt writerNotify;
+    // average number of spins after which the lock became free
+    QAtomicInt averageSpins;
+
+    bool lockForReadContended(int timeout);
+    bool lockForWriteContended(int timeout);
+    void wakeWriterOrReaders(int state);
+    bool wakeWriter();
+    int spin(bool forWrite);
+    bool wait(QAtomicInt &word, int expectedValue, int timeout, const QElapsedTimer &timer);
+    int wake(QAtomicInt &word, int count);
+
+    // Recursive locks need to know which threads hold the lock and are
+    // therefore protected by the mutex. On platforms without futexes the
+    // mutex and wait conditions also serve the non-recursive locks to
+    // sleep on.
     QMutex mutex;
     QWaitCondition readerWait;
     QWaitCondition writerWait;
@@ -78,6 +122,22 @@ struct QReadWriteLockPrivate
     bool recursive;
     Qt::HANDLE currentWriter;
     QHash<Qt::HANDLE, int> currentReaders;
+
+    bool recursiveLockForRead(int timeout);
+    bool recursiveTryLockForRead();
+    bool recursiveLockForWrite(int timeout);
+    bool recursiveTryLockForWrite();
+    void recursiveUnlock();
+
+    // for QWaitCondition: negative if locked for writing (less than -1 if
+    // locked recursively), the number of readers if locked for reading
+    int lockState() const
+    {
+        if (recursive)
+            return accessCount;
+        const int locked = state.load() & LockMask;
+        return locked == WriteLocked ? -1 : locked;
+    }
 };
 
 QT_END_NAMESPACE
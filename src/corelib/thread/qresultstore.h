@@ -57,7 +57,7 @@ QT_BEGIN_NAMESPACE
     either individually batched in a QVector. Retriveing results and checking
     which indexes are in the store can be done either by iterating or by random
     accees. In addition results kan be removed from the front of the store,
-    either individually or in batches.
+    either individually or in batches, using removeResultsBefore().
 */
 
 #ifndef Q_QDOC
@@ -211,21 +211,39 @@ public:
     {
         QMap<int, ResultItem>::const_iterator mapIterator = m_results.constBegin();
         while (mapIterator != m_results.constEnd()) {
-            if (mapIterator.value().isVector())
-                delete reinterpret_cast<const QVector<T> *>(mapIterator.value().result);
-            else
-                delete reinterpret_cast<const T *>(mapIterator.value().result);
+            deleteResultItem(mapIterator.value());
             ++mapIterator;
         }
         resultCount = 0;
         m_results.clear();
     }
 
+    // Frees the result items that lie completely before index. The indexes
+    // of the remaining results do not change.
+    void removeResultsBefore(int index)
+    {
+        QMap<int, ResultItem>::iterator mapIterator = m_results.begin();
+        while (mapIterator != m_results.end()
+               && mapIterator.key() + mapIterator.value().count() <= index) {
+            deleteResultItem(mapIterator.value());
+            mapIterator = m_results.erase(mapIterator);
+        }
+    }
+
     ~ResultStore()
     {
         clear();
     }
 
+private:
+    static void deleteResultItem(const ResultItem &item)
+    {
+        if (item.isVector())
+            delete reinterpret_cast<const QVector<T> *>(item.result);
+        else
+            delete reinterpret_cast<const T *>(item.result);
+    }
+
 };
 
 } // namespace QtPrivate
@@ -92,6 +92,15 @@ QThreadData::~QThreadData()
         }
     }
 
+    QPostEventList::IncomingEvent *node = postEventList.incoming.fetchAndStoreAcquire(0);
+    while (node) {
+        QPostEventList::IncomingEvent *next = node->next;
+        node->event.event->posted = false;
+        delete node->event.event;
+        delete node;
+        node = next;
+    }
+
     // fprintf(stderr, "QThreadData %p destroyed\n", this);
 }
 
@@ -484,6 +493,77 @@ uint QThread::stackSize() const
     return d->stackSize;
 }
 
+/*!
+    \since 5.3
+
+    Restricts the thread to run on the processors listed in \a cpus, given
+    by their zero-based index as used by the operating system. An empty
+    list lifts the restriction, and the thread may run on any of the
+    processors the process was allowed to use when it started.
+
+    If the thread is running, the new affinity takes effect immediately;
+    otherwise it is applied when the thread is started.
+
+    Processors that are not present are ignored. Setting the affinity is
+    currently supported on Linux and Windows; on Windows, only the first
+    64 processors can be used.
+
+    \sa cpuAffinity(), numaNodeCpus()
+*/
+void QThread::setCpuAffinity(const QList<int> &cpus)
+{
+    Q_D(QThread);
+    QMutexLocker locker(&d->mutex);
+    d->cpuAffinity = cpus;
+    if (d->running && !d->isInFinish)
+        d->applyCpuAffinity();
+}
+
+/*!
+    \since 5.3
+
+    Returns the processors the thread was restricted to with
+    setCpuAffinity(), or an empty list if it may run on any of them.
+
+    \sa setCpuAffinity()
+*/
+QList<int> QThread::cpuAffinity() const
+{
+    Q_D(const QThread);
+    QMutexLocker locker(&d->mutex);
+    return d->cpuAffinity;
+}
+
+/*!
+    \since 5.3
+
+    Returns the number of NUMA nodes in the system, or 1 if the system
+    does not report its memory topology. Nodes are numbered the same way
+    as by the operating system, so some of them may have no processors.
+
+    \sa numaNodeCpus()
+*/
+int QThread::numaNodeCount()
+{
+    return QThreadPrivate::numaNodes().size();
+}
+
+/*!
+    \since 5.3
+
+    Returns the processors belonging to NUMA node \a node, suitable for
+    passing to setCpuAffinity(). Returns an empty list if the node does
+    not exist or has no processors.
+
+    On systems without NUMA information, node 0 holds all processors.
+
+    \sa numaNodeCount(), setCpuAffinity()
+*/
+QList<int> QThread::numaNodeCpus(int node)
+{
+    return QThreadPrivate::numaNodes().value(node);
+}
+
 /*!
     Enters the event loop and waits until exit() is called, returning the value
     that was passed to exit(). The value returned is 0 if exit() is called via
@@ -63,6 +63,9 @@ public:
     static int idealThreadCount() Q_DECL_NOTHROW;
     static void yieldCurrentThread();
 
+    static int numaNodeCount();
+    static QList<int> numaNodeCpus(int node);
+
     explicit QThread(QObject *parent = 0);
     ~QThread();
 
@@ -92,6 +95,9 @@ public:
     void setStackSize(uint stackSize);
     uint stackSize() const;
 
+    void setCpuAffinity(const QList<int> &cpus);
+    QList<int> cpuAffinity() const;
+
     void exit(int retcode = 0);
 
     QAbstractEventDispatcher *eventDispatcher() const;
@@ -57,6 +57,7 @@
 #include "qplatformdefs.h"
 #include "QtCore/qthread.h"
 #include "QtCore/qmutex.h"
+#include "QtCore/qsemaphore.h"
 #include "QtCore/qstack.h"
 #include "QtCore/qwaitcondition.h"
 #include "QtCore/qmap.h"
@@ -106,10 +107,66 @@ public:
 
     QMutex mutex;
 
+    // Events posted with the default priority bypass the mutex: postEvent()
+    // pushes them onto this lock-free stack, and whoever locks the mutex next
+    // moves them into the list in posting order, see
+    // QCoreApplicationPrivate::mergeIncomingPostedEvents().
+    struct IncomingEvent
+    {
+        QPostEvent event;
+        IncomingEvent *next;
+    };
+    QAtomicPointer<IncomingEvent> incoming;
+    // number of postEvent() calls that are about to push onto the stack, plus
+    // MoverWaitingFlag while QObject::moveToThread() waits for them: the last
+    // one to leave then releases incomingPostersDone
+    enum { MoverWaitingFlag = 0x40000000 };
+    QAtomicInt incomingPosters;
+#ifndef QT_NO_THREAD
+    QSemaphore incomingPostersDone;
+#endif
+
     inline QPostEventList()
         : QVector<QPostEvent>(), recursion(0), startOffset(0), insertionOffset(0)
     { }
 
+    inline bool hasIncomingEvents() const
+    { return incoming.load() != 0; }
+
+    inline void leaveIncoming()
+    {
+#ifndef QT_NO_THREAD
+        if (incomingPosters.fetchAndAddOrdered(-1) == MoverWaitingFlag + 1
+            && incomingPosters.testAndSetOrdered(MoverWaitingFlag, 0))
+            incomingPostersDone.release();
+#else
+        incomingPosters.deref();
+#endif
+    }
+
+    // the mutex must be locked, and the moved objects must already point to
+    // their new thread data
+    void waitForIncomingPosters()
+    {
+#ifndef QT_NO_THREAD
+        // The first read is an ordered read-modify-write, pairing with the
+        // ordered ref() in QCoreApplication::postEvent(): either the poster
+        // sees the new thread data after its ref(), or we see its ref() here.
+        // A plain load could be satisfied before our thread data store is
+        // visible, and both sides would miss each other.
+        int posters = incomingPosters.fetchAndAddOrdered(0);
+        for (;;) {
+            if (!posters)
+                return;
+            if (incomingPosters.testAndSetOrdered(posters, posters | MoverWaitingFlag)) {
+                incomingPostersDone.acquire();
+                return;
+            }
+            posters = incomingPosters.load();
+        }
+#endif
+    }
+
     void addEvent(const QPostEvent &ev) {
         int priority = ev.priority;
         if (isEmpty() ||
@@ -143,6 +200,12 @@ public:
     ~QThreadPrivate();
 
     void setPriority(QThread::Priority prio);
+    void applyCpuAffinity();
+
+    // CPUs of each NUMA node, indexed by node number; nodes without CPUs
+    // have an empty list. There is always at least one node.
+    static const QVector<QList<int> > &numaNodes();
+    static int currentNumaNode();
 
     mutable QMutex mutex;
     QAtomicInt quitLockRef;
@@ -157,6 +220,7 @@ public:
 
     uint stackSize;
     QThread::Priority priority;
+    QList<int> cpuAffinity;
 
     static QThread *threadForId(int id);
 
@@ -237,7 +301,7 @@ public:
     bool canWaitLocked()
     {
         QMutexLocker locker(&postEventList.mutex);
-        return canWait;
+        return canWait && !postEventList.hasIncomingEvents();
     }
 
     // This class provides per-thread (by way of being a QThreadData
@@ -44,6 +44,7 @@
 #include "qplatformdefs.h"
 
 #include <private/qcoreapplication_p.h>
+#include <private/qcore_unix_p.h>
 
 #if defined(Q_OS_BLACKBERRY)
 #  include <private/qeventdispatcher_blackberry_p.h>
@@ -103,6 +104,10 @@
 # define SCHED_IDLE    5
 #endif
 
+#if defined(Q_OS_LINUX) && defined(__GLIBC__) && !defined(QT_LINUXBASE)
+#define QT_HAS_THREAD_CPU_AFFINITY
+#endif
+
 #if defined(Q_OS_DARWIN) || !defined(Q_OS_OPENBSD) && defined(_POSIX_THREAD_PRIORITY_SCHEDULING) && (_POSIX_THREAD_PRIORITY_SCHEDULING-0 >= 0)
 #define QT_HAS_THREAD_PRIORITY_SCHEDULING
 #endif
@@ -314,6 +319,9 @@ void *QThreadPrivate::start(void *arg)
             thr->d_func()->setPriority(QThread::Priority(thr->d_func()->priority & ~ThreadPriorityResetFlag));
         }
 
+        if (!thr->d_func()->cpuAffinity.isEmpty())
+            thr->d_func()->applyCpuAffinity();
+
         data->threadId = (Qt::HANDLE)pthread_self();
         set_thread_data(data);
 
@@ -462,6 +470,118 @@ int QThread::idealThreadCount() Q_DECL_NOTHROW
     return cores;
 }
 
+#if defined(Q_OS_LINUX)
+// Parses a CPU or node list as found in sysfs, e.g. "0-3,8-11"
+static QList<int> parseSysfsList(const QByteArray &list)
+{
+    QList<int> result;
+    foreach (const QByteArray &range, list.trimmed().split(',')) {
+        if (range.isEmpty())
+            continue;
+        const int dash = range.indexOf('-');
+        bool ok1, ok2;
+        const int first = range.left(dash).toInt(&ok1);
+        const int last = dash < 0 ? first : range.mid(dash + 1).toInt(&ok2);
+        if (!ok1 || (dash >= 0 && !ok2))
+            return QList<int>();
+        for (int i = first; i <= last; ++i)
+            result.append(i);
+    }
+    return result;
+}
+
+static QByteArray readSysfsFile(const QByteArray &path)
+{
+    QByteArray contents;
+    int fd = qt_safe_open(path.constData(), O_RDONLY);
+    if (fd == -1)
+        return contents;
+    char buffer[4096];
+    qint64 n;
+    while ((n = qt_safe_read(fd, buffer, sizeof buffer)) > 0)
+        contents.append(buffer, int(n));
+    qt_safe_close(fd);
+    return contents;
+}
+#endif
+
+namespace {
+struct QNumaTopology
+{
+    QNumaTopology();
+
+    QVector<QList<int> > nodes;
+    QVector<int> nodeOfCpu;
+};
+}
+
+QNumaTopology::QNumaTopology()
+{
+#if defined(Q_OS_LINUX)
+    const QList<int> online = parseSysfsList(readSysfsFile("/sys/devices/system/node/online"));
+    foreach (int node, online) {
+        const QByteArray path = "/sys/devices/system/node/node" + QByteArray::number(node) + "/cpulist";
+        const QList<int> cpus = parseSysfsList(readSysfsFile(path));
+        if (nodes.size() <= node)
+            nodes.resize(node + 1);
+        nodes[node] = cpus;
+    }
+#endif
+
+    bool haveCpus = false;
+    for (int i = 0; i < nodes.size() && !haveCpus; ++i)
+        haveCpus = !nodes.at(i).isEmpty();
+    if (!haveCpus) {
+        // no NUMA information, report a single node with all processors
+        QList<int> cpus;
+        for (int cpu = 0; cpu < QThread::idealThreadCount(); ++cpu)
+            cpus.append(cpu);
+        nodes = QVector<QList<int> >(1, cpus);
+    }
+
+    for (int node = 0; node < nodes.size(); ++node) {
+        foreach (int cpu, nodes.at(node)) {
+            if (nodeOfCpu.size() <= cpu)
+                nodeOfCpu.resize(cpu + 1);
+            nodeOfCpu[cpu] = node;
+        }
+    }
+}
+
+Q_GLOBAL_STATIC(QNumaTopology, numaTopology)
+
+#if defined(QT_HAS_THREAD_CPU_AFFINITY)
+// The processors the process was allowed to run on when it started, as
+// set by taskset or a cpuset. Lifting a thread's affinity restores this
+// set rather than allowing every processor.
+static cpu_set_t qt_process_cpu_affinity;
+static bool qt_process_cpu_affinity_valid = false;
+
+static void qt_save_process_cpu_affinity()
+{
+    CPU_ZERO(&qt_process_cpu_affinity);
+    qt_process_cpu_affinity_valid =
+        sched_getaffinity(0, sizeof(qt_process_cpu_affinity), &qt_process_cpu_affinity) == 0;
+}
+Q_CONSTRUCTOR_FUNCTION(qt_save_process_cpu_affinity)
+#endif
+
+const QVector<QList<int> > &QThreadPrivate::numaNodes()
+{
+    return numaTopology()->nodes;
+}
+
+int QThreadPrivate::currentNumaNode()
+{
+#if defined(QT_HAS_THREAD_CPU_AFFINITY)
+    const int cpu = sched_getcpu();
+    const QNumaTopology *topology = numaTopology();
+    if (cpu >= 0 && cpu < topology->nodeOfCpu.size())
+        return topology->nodeOfCpu.at(cpu);
+#endif
+    return 0;
+}
+
 void QThread::yieldCurrentThread()
 {
     sched_yield();
@@ -739,6 +859,37 @@ void QThreadPrivate::setPriority(QThread::Priority threadPriority)
 #endif
 }
 
+// Caller must lock the mutex
+void QThreadPrivate::applyCpuAffinity()
+{
+#if defined(QT_HAS_THREAD_CPU_AFFINITY)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (cpuAffinity.isEmpty()) {
+        if (qt_process_cpu_affinity_valid) {
+            set = qt_process_cpu_affinity;
+        } else {
+            // the kernel drops the processors that don't exist
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                CPU_SET(cpu, &set);
+        }
+    } else {
+        foreach (int cpu, cpuAffinity) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE)
+                CPU_SET(cpu, &set);
+        }
+    }
+
+    int code = pthread_setaffinity_np(thread_id, sizeof(set), &set);
+    if (code != 0) {
+        qWarning("QThread::setCpuAffinity: Cannot set the processor affinity: %s",
+                 qPrintable(qt_error_string(code)));
+    }
+#else
+    qWarning("QThread::setCpuAffinity: Not supported on this platform");
+#endif
+}
+
 #endif // QT_NO_THREAD
 
 QT_END_NAMESPACE
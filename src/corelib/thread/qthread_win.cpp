@@ -514,6 +514,9 @@ void QThread::start(Priority priority)
         qErrnoWarning("QThread::start: Failed to set thread priority");
     }
 
+    if (!d->cpuAffinity.isEmpty())
+        d->applyCpuAffinity();
+
     if (ResumeThread(d->handle) == (DWORD) -1) {
         qErrnoWarning("QThread::start: Failed to resume new thread");
     }
@@ -641,5 +644,49 @@ void QThreadPrivate::setPriority(QThread::Priority threadPriority)
     }
 }
 
+// Caller must hold the mutex
+void QThreadPrivate::applyCpuAffinity()
+{
+    DWORD_PTR processMask, systemMask;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        qErrnoWarning("QThread::setCpuAffinity: Failed to get the process affinity");
+        return;
+    }
+
+    DWORD_PTR mask = processMask;
+    if (!cpuAffinity.isEmpty()) {
+        mask = 0;
+        foreach (int cpu, cpuAffinity) {
+            if (cpu >= 0 && cpu < int(sizeof(DWORD_PTR) * 8))
+                mask |= DWORD_PTR(1) << cpu;
+        }
+        mask &= processMask;
+    }
+
+    if (!mask || !SetThreadAffinityMask(handle, mask))
+        qErrnoWarning("QThread::setCpuAffinity: Failed to set the processor affinity");
+}
+
+// NUMA topology is not queried on Windows; report a single node
+static QVector<QList<int> > singleNumaNode()
+{
+    QList<int> cpus;
+    for (int cpu = 0; cpu < QThread::idealThreadCount(); ++cpu)
+        cpus.append(cpu);
+    return QVector<QList<int> >(1, cpus);
+}
+
+Q_GLOBAL_STATIC_WITH_ARGS(const QVector<QList<int> >, numaNodeList, (singleNumaNode()))
+
+const QVector<QList<int> > &QThreadPrivate::numaNodes()
+{
+    return *numaNodeList();
+}
+
+int QThreadPrivate::currentNumaNode()
+{
+    return 0;
+}
+
 QT_END_NAMESPACE
 #endif // QT_NO_THREAD
@@ -41,6 +41,7 @@
 
 #include "qthreadpool.h"
 #include "qthreadpool_p.h"
+#include "qthread_p.h"
 #include "qelapsedtimer.h"
 
 #include <algorithm>
@@ -59,12 +60,32 @@ class QThreadPoolThread : public QThread
 public:
     QThreadPoolThread(QThreadPoolPrivate *manager);
     void run();
+    void runRunnable(QRunnable *r);
     void registerThreadInactive();
 
     QThreadPoolPrivate *manager;
     QRunnable *runnable;
+    int workQueueIndex;
 };
 
+#if defined(Q_COMPILER_THREAD_LOCAL) || (defined(Q_CC_MSVC) && !defined(Q_OS_WINCE))
+#if defined(Q_CC_MSVC)
+static __declspec(thread) QThreadPoolThread *currentPoolThread = 0;
+#else
+static thread_local QThreadPoolThread *currentPoolThread = 0;
+#endif
+
+static inline QThreadPoolThread *currentThreadPoolThread()
+{ return currentPoolThread; }
+static inline void setCurrentThreadPoolThread(QThreadPoolThread *thread)
+{ currentPoolThread = thread; }
+#else
+// without thread-local storage every start() is treated as coming from
+// outside of the pool and is distributed round-robin over the queues
+static inline QThreadPoolThread *currentThreadPoolThread() { return 0; }
+static inline void setCurrentThreadPoolThread(QThreadPoolThread *) { }
+#endif
+
 /*
     QThreadPool private class.
 */
@@ -74,7 +95,7 @@ public:
     \internal
 */
 QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
-    :manager(manager), runnable(0)
+    :manager(manager), runnable(0), workQueueIndex(0)
 { }
 
 /*
@@ -82,6 +103,8 @@ QThreadPoolThread::QThreadPoolThread(QThreadPoolPrivate *manager)
 */
 void QThreadPoolThread::run()
 {
+    setCurrentThreadPoolThread(this);
+
     QMutexLocker locker(&manager->mutex);
     for(;;) {
         QRunnable *r = runnable;
@@ -89,35 +112,25 @@ void QThreadPoolThread::run()
 
         do {
             if (r) {
-                const bool autoDelete = r->autoDelete();
-
-
-                // run the task
+                // run the task, and then whatever can be taken from the
+                // work-stealing queues without going through the mutex
                 locker.unlock();
-#ifndef QT_NO_EXCEPTIONS
-                try {
-#endif
-                    r->run();
-#ifndef QT_NO_EXCEPTIONS
-                } catch (...) {
-                    qWarning("Qt Concurrent has caught an exception thrown from a worker thread.\n"
-                             "This is not supported, exceptions thrown in worker threads must be\n"
-                             "caught before control returns to Qt Concurrent.");
-                    registerThreadInactive();
-                    throw;
-                }
-#endif
+                do {
+                    runRunnable(r);
+                } while ((r = manager->takeStealableTask(this)) != 0);
                 locker.relock();
-
-                if (autoDelete && !--r->ref)
-                    delete r;
             }
 
             // if too many threads are active, expire this thread
             if (manager->tooManyThreadsActive())
                 break;
 
-            r = !manager->queue.isEmpty() ? manager->queue.takeFirst().first : 0;
+            if (!manager->queue.isEmpty()) {
+                r = manager->queue.takeFirst().first;
+                manager->queuedTasks.deref();
+            } else {
+                r = manager->takeStealableTask(this);
+            }
         } while (r != 0);
 
         if (manager->isExiting) {
@@ -128,21 +141,60 @@ void QThreadPoolThread::run()
         // if too many threads are active, expire this thread
         bool expired = manager->tooManyThreadsActive();
         if (!expired) {
+            // pairs with enqueueStealableTask(): either it sees this thread
+            // sleeping and wakes it up, or we see its task here
+            manager->sleepingThreads.ref();
+            if (manager->stealableTasks.load() > 0) {
+                manager->sleepingThreads.deref();
+                continue;
+            }
+
             ++manager->waitingThreads;
             registerThreadInactive();
             // wait for work, exiting after the expiry timeout is reached
             expired = !manager->runnableReady.wait(locker.mutex(), manager->expiryTimeout);
             ++manager->activeThreads;
+            manager->sleepingThreads.deref();
 
             if (expired)
                 --manager->waitingThreads;
         }
         if (expired) {
             manager->expiredThreads.enqueue(this);
+            manager->liveThreads.deref();
             registerThreadInactive();
             break;
         }
     }
+
+    setCurrentThreadPoolThread(0);
+}
+
+/*
+    \internal
+    Runs \a r without holding the pool's mutex and deletes it afterwards if
+    this was the last reference to an auto-deleting runnable.
+*/
+void QThreadPoolThread::runRunnable(QRunnable *r)
+{
+    const bool autoDelete = r->autoDelete();
+
+#ifndef QT_NO_EXCEPTIONS
+    try {
+#endif
+        r->run();
+#ifndef QT_NO_EXCEPTIONS
+    } catch (...) {
+        qWarning("Qt Concurrent has caught an exception thrown from a worker thread.\n"
+                 "This is not supported, exceptions thrown in worker threads must be\n"
+                 "caught before control returns to Qt Concurrent.");
+        registerThreadInactive();
+        throw;
+    }
+#endif
+
+    if (autoDelete && !r->ref.deref())
+        delete r;
 }
 
 void QThreadPoolThread::registerThreadInactive()
@@ -152,6 +204,81 @@ void QThreadPoolThread::registerThreadInactive()
 }
 
 
+/*
+    \internal
+*/
+void QThreadPoolWorkQueue::push(QRunnable *runnable)
+{
+    QMutexLocker locker(&mutex);
+    runnables.append(runnable);
+    count.store(runnables.size());
+}
+
+QRunnable *QThreadPoolWorkQueue::pop()
+{
+    if (isEmpty())
+        return 0;
+    QMutexLocker locker(&mutex);
+    if (runnables.isEmpty())
+        return 0;
+    QRunnable *r = runnables.takeLast();
+    count.store(runnables.size());
+    return r;
+}
+
+QRunnable *QThreadPoolWorkQueue::steal()
+{
+    QMutexLocker locker(&mutex);
+    if (runnables.isEmpty())
+        return 0;
+    QRunnable *r = runnables.takeFirst();
+    count.store(runnables.size());
+    return r;
+}
+
+bool QThreadPoolWorkQueue::remove(QRunnable *runnable)
+{
+    QMutexLocker locker(&mutex);
+    const int index = runnables.indexOf(runnable);
+    if (index < 0)
+        return false;
+    runnables.removeAt(index);
+    count.store(runnables.size());
+    return true;
+}
+
+QList<QRunnable *> QThreadPoolWorkQueue::takeAll()
+{
+    QMutexLocker locker(&mutex);
+    QList<QRunnable *> result;
+    result.swap(runnables);
+    count.store(0);
+    return result;
+}
+
+QThreadPoolWorkQueues::QThreadPoolWorkQueues(int count)
+{
+    const QVector<QList<int> > &numaNodes = QThreadPrivate::numaNodes();
+    for (int node = 0; node < numaNodes.size(); ++node) {
+        if (!numaNodes.at(node).isEmpty())
+            nodes.append(node);
+    }
+    if (nodes.isEmpty())
+        nodes.append(0);
+
+    // every group gets the same number of queues
+    count = qMax(count, 1);
+    count += (nodes.size() - count % nodes.size()) % nodes.size();
+    queues.resize(count);
+    for (int i = 0; i < count; ++i)
+        queues[i] = new QThreadPoolWorkQueue;
+}
+
+QThreadPoolWorkQueues::~QThreadPoolWorkQueues()
+{
+    qDeleteAll(queues);
+}
+
 /*
     \internal
 */
@@ -164,6 +291,11 @@ QThreadPoolPrivate:: QThreadPoolPrivate()
       activeThreads(0)
 { }
 
+QThreadPoolPrivate::~QThreadPoolPrivate()
+{
+    delete workQueues.load();
+}
+
 bool QThreadPoolPrivate::tryStart(QRunnable *task)
 {
     if (allThreads.isEmpty()) {
@@ -190,10 +322,12 @@ bool QThreadPoolPrivate::tryStart(QRunnable *task)
         Q_ASSERT(thread->runnable == 0);
 
         ++activeThreads;
+        liveThreads.ref();
 
         if (task->autoDelete())
-            ++task->ref;
+            task->ref.ref();
         thread->runnable = task;
+        prepareThread(thread);
         thread->start();
         return true;
     }
@@ -211,7 +345,7 @@ inline bool operator<(const QPair<QRunnable *, int> &p, int priority)
 void QThreadPoolPrivate::enqueueTask(QRunnable *runnable, int priority)
 {
     if (runnable->autoDelete())
-        ++runnable->ref;
+        runnable->ref.ref();
 
     // put it on the queue
     QList<QPair<QRunnable *, int> >::const_iterator begin = queue.constBegin();
@@ -219,6 +353,111 @@ void QThreadPoolPrivate::enqueueTask(QRunnable *runnable, int priority)
     if (it != begin && priority > (*(it - 1)).second)
         it = std::upper_bound(begin, --it, priority);
     queue.insert(it - begin, qMakePair(runnable, priority));
+    queuedTasks.ref();
+}
+
+/*!
+    \internal
+    Puts \a runnable on one of the work-stealing queues: the calling
+    thread's own queue if it is one of our workers, otherwise the next one
+    in round-robin order, restricted to the queues of the caller's NUMA node
+    if the pool is NUMA-aware. The mutex is only taken if a thread needs to
+    be woken up or started to pick the runnable up.
+*/
+void QThreadPoolPrivate::enqueueStealableTask(QRunnable *runnable)
+{
+    if (runnable->autoDelete())
+        runnable->ref.ref();
+
+    QThreadPoolWorkQueues *queues = workQueues.loadAcquire();
+    QThreadPoolThread *current = currentThreadPoolThread();
+    uint index;
+    if (current && current->manager == this) {
+        index = uint(current->workQueueIndex);
+    } else {
+        index = uint(nextWorkQueue.fetchAndAddRelaxed(1));
+        const int group = numaAware.load()
+                          ? queues->groupOfNode(QThreadPrivate::currentNumaNode())
+                          : -1;
+        if (group >= 0) {
+            const uint groups = uint(queues->groupCount());
+            index = uint(group) + (index % (uint(queues->size()) / groups)) * groups;
+        }
+    }
+    queues->at(index % uint(queues->size()))->push(runnable);
+
+    // pairs with the check in QThreadPoolThread::run() before going to sleep
+    stealableTasks.fetchAndAddOrdered(1);
+    if (sleepingThreads.load() > 0 || liveThreads.load() < maxThreadCount) {
+        QMutexLocker locker(&mutex);
+        wakeOrStartThread();
+    }
+}
+
+/*!
+    \internal
+    Returns the next runnable for \a thread from the work-stealing queues:
+    the most recently queued one of its own queue, or failing that the
+    oldest one of another thread's queue, trying the queues of the same NUMA
+    node first. Returns 0 if there is nothing to run, or if a runnable is
+    waiting in the priority queue.
+*/
+QRunnable *QThreadPoolPrivate::takeStealableTask(QThreadPoolThread *thread)
+{
+    QThreadPoolWorkQueues *queues = workQueues.loadAcquire();
+    if (!queues || stealableTasks.load() <= 0 || queuedTasks.load() > 0)
+        return 0;
+
+    const int count = queues->size();
+    const int groups = queues->groupCount();
+    const int index = thread->workQueueIndex % count;
+    QRunnable *r = queues->at(index)->pop();
+    for (int i = groups; !r && i < count; i += groups) {
+        QThreadPoolWorkQueue *victim = queues->at((index + i) % count);
+        if (!victim->isEmpty())
+            r = victim->steal();
+    }
+    for (int i = 1; !r && i < count; ++i) {
+        if (i % groups == 0)
+            continue;
+        QThreadPoolWorkQueue *victim = queues->at((index + i) % count);
+        if (!victim->isEmpty())
+            r = victim->steal();
+    }
+    if (r)
+        stealableTasks.deref();
+    return r;
+}
+
+/*!
+    \internal
+    Wakes up a waiting thread, or starts a new one if the pool is not at its
+    limit yet. Returns false if neither was possible.
+*/
+bool QThreadPoolPrivate::wakeOrStartThread()
+{
+    if (waitingThreads > 0) {
+        --waitingThreads;
+        runnableReady.wakeOne();
+        return true;
+    }
+
+    if (!allThreads.isEmpty() && activeThreadCount() >= maxThreadCount)
+        return false;
+
+    if (!expiredThreads.isEmpty()) {
+        QThreadPoolThread *thread = expiredThreads.dequeue();
+        Q_ASSERT(thread->runnable == 0);
+
+        ++activeThreads;
+        liveThreads.ref();
+        prepareThread(thread);
+        thread->start();
+        return true;
+    }
+
+    startThread();
+    return true;
 }
 
 int QThreadPoolPrivate::activeThreadCount() const
@@ -232,8 +471,14 @@ int QThreadPoolPrivate::activeThreadCount() const
 void QThreadPoolPrivate::tryToStartMoreThreads()
 {
     // try to push tasks on the queue to any available threads
-    while (!queue.isEmpty() && tryStart(queue.first().first))
+    while (!queue.isEmpty() && tryStart(queue.first().first)) {
         queue.removeFirst();
+        queuedTasks.deref();
+    }
+
+    // make sure there are enough threads for the work-stealing queues
+    for (int i = stealableTasks.load(); i > 0 && wakeOrStartThread(); --i)
+        ;
 }
 
 bool QThreadPoolPrivate::tooManyThreadsActive() const
@@ -249,15 +494,59 @@ void QThreadPoolPrivate::startThread(QRunnable *runnable)
 {
     QScopedPointer <QThreadPoolThread> thread(new QThreadPoolThread(this));
     thread->setObjectName(QLatin1String("Thread (pooled)"));
+    thread->workQueueIndex = allThreads.count();
     allThreads.insert(thread.data());
     ++activeThreads;
+    liveThreads.ref();
 
-    if (runnable->autoDelete())
-        ++runnable->ref;
+    if (runnable && runnable->autoDelete())
+        runnable->ref.ref();
     thread->runnable = runnable;
+    prepareThread(thread.data());
     thread.take()->start();
 }
 
+/*!
+    \internal
+    Called with the mutex locked.
+*/
+void QThreadPoolPrivate::setWorkStealingEnabled(bool enabled)
+{
+    if (enabled && !workQueues.load())
+        workQueues.storeRelease(new QThreadPoolWorkQueues(qMax(maxThreadCount, QThread::idealThreadCount())));
+    workStealing.storeRelease(enabled);
+}
+
+/*!
+    \internal
+    Sets up the processor affinity of \a thread before it is (re)started:
+    the pool's affinity, narrowed down to the processors of the thread's
+    NUMA node if the pool is NUMA-aware. Called with the mutex locked.
+*/
+void QThreadPoolPrivate::prepareThread(QThreadPoolThread *thread)
+{
+    QList<int> cpus = cpuAffinity;
+    QThreadPoolWorkQueues *queues = workQueues.load();
+    if (numaAware.load() && queues) {
+        const int node = queues->nodeOfQueue(thread->workQueueIndex % queues->size());
+        QList<int> nodeCpus = QThreadPrivate::numaNodes().value(node);
+        if (!cpus.isEmpty()) {
+            for (QList<int>::iterator it = nodeCpus.begin(); it != nodeCpus.end(); ) {
+                if (cpus.contains(*it))
+                    ++it;
+                else
+                    it = nodeCpus.erase(it);
+            }
+        }
+        // a node outside of the pool's affinity keeps the pool's affinity
+        if (!nodeCpus.isEmpty())
+            cpus = nodeCpus;
+    }
+
+    if (cpus != thread->cpuAffinity())
+        thread->setCpuAffinity(cpus);
+}
+
 /*!
     \internal
     Makes all threads exit, waits for each thread to exit and deletes it.
@@ -285,6 +574,7 @@ void QThreadPoolPrivate::reset()
 
     waitingThreads = 0;
     expiredThreads.clear();
+    liveThreads.store(0);
 
     isExiting = false;
 }
@@ -293,17 +583,16 @@ bool QThreadPoolPrivate::waitForDone(int msecs)
 {
     QMutexLocker locker(&mutex);
     if (msecs < 0) {
-        while (!(queue.isEmpty() && activeThreads == 0))
+        while (!isDone())
             noActiveThreads.wait(locker.mutex());
     } else {
         QElapsedTimer timer;
         timer.start();
         int t;
-        while (!(queue.isEmpty() && activeThreads == 0) &&
-               ((t = msecs - timer.elapsed()) > 0))
+        while (!isDone() && ((t = msecs - timer.elapsed()) > 0))
             noActiveThreads.wait(locker.mutex(), t);
     }
-    return queue.isEmpty() && activeThreads == 0;
+    return isDone();
 }
 
 void QThreadPoolPrivate::clear()
@@ -312,10 +601,22 @@ void QThreadPoolPrivate::clear()
     for (QList<QPair<QRunnable *, int> >::const_iterator it = queue.constBegin();
          it != queue.constEnd(); ++it) {
         QRunnable* r = it->first;
-        if (r->autoDelete() && !--r->ref)
+        if (r->autoDelete() && !r->ref.deref())
             delete r;
     }
     queue.clear();
+    queuedTasks.store(0);
+
+    if (QThreadPoolWorkQueues *queues = workQueues.loadAcquire()) {
+        for (int i = 0; i < queues->size(); ++i) {
+            const QList<QRunnable *> runnables = queues->at(i)->takeAll();
+            stealableTasks.fetchAndAddOrdered(-runnables.size());
+            foreach (QRunnable *r, runnables) {
+                if (r->autoDelete() && !r->ref.deref())
+                    delete r;
+            }
+        }
+    }
 }
 
 /*!
@@ -338,17 +639,27 @@ void QThreadPoolPrivate::stealRunnable(QRunnable *runnable)
             if (it->first == runnable) {
                 found = true;
                 queue.erase(it);
+                queuedTasks.deref();
                 break;
             }
             ++it;
         }
     }
 
+    if (!found) {
+        if (QThreadPoolWorkQueues *queues = workQueues.loadAcquire()) {
+            for (int i = 0; !found && i < queues->size(); ++i)
+                found = queues->at(i)->remove(runnable);
+            if (found)
+                stealableTasks.deref();
+        }
+    }
+
     if (!found)
         return;
 
     const bool autoDelete = runnable->autoDelete();
-    bool del = autoDelete && !--runnable->ref;
+    bool del = autoDelete && !runnable->ref.deref();
 
     runnable->run();
 
@@ -455,6 +766,11 @@ void QThreadPool::start(QRunnable *runnable, int priority)
         return;
 
     Q_D(QThreadPool);
+    if (priority == 0 && d->workStealing.loadAcquire()) {
+        d->enqueueStealableTask(runnable);
+        return;
+    }
+
     QMutexLocker locker(&d->mutex);
     if (!d->tryStart(runnable)) {
         d->enqueueTask(runnable, priority);
@@ -610,6 +926,120 @@ void QThreadPool::releaseThread()
     d->tryToStartMoreThreads();
 }
 
+/*! \property QThreadPool::workStealingEnabled
+    \since 5.3
+
+    This property holds whether the thread pool schedules runnables using
+    per-thread work-stealing queues.
+
+    By default, all runnables passed to start() are put on a single queue
+    shared by all threads of the pool. With many threads running short
+    runnables, the lock protecting that queue can become a bottleneck.
+
+    In work-stealing mode, each thread has a queue of its own. Runnables
+    started from one of the pool's threads are put on that thread's queue,
+    runnables started from other threads are distributed over the queues in
+    turn. A thread runs the most recently queued runnable of its own queue
+    first, and takes the oldest runnable from another thread's queue once its
+    own is empty.
+
+    Runnables started with a non-zero priority still go through the shared
+    queue, which is always served before the per-thread queues. Runnables with the same priority are not
+    guaranteed to be started in the order they were passed to start().
+
+    The default is \c false. The mode can be changed at any time; runnables
+    already queued are run regardless of the new setting.
+
+    \sa start()
+*/
+
+bool QThreadPool::isWorkStealingEnabled() const
+{
+    Q_D(const QThreadPool);
+    return d->workStealing.load();
+}
+
+void QThreadPool::setWorkStealingEnabled(bool enabled)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->setWorkStealingEnabled(enabled);
+}
+
+/*! \property QThreadPool::numaAware
+    \since 5.3
+
+    This property holds whether the thread pool keeps its threads and
+    runnables local to NUMA nodes.
+
+    A NUMA-aware pool divides its threads into one group per NUMA node that
+    has processors, and restricts each thread to the processors of its node.
+    Runnables started from outside of the pool are queued for the threads
+    of the node the calling thread is running on, and idle threads look for
+    work on their own node before taking it from another one. Setting this
+    property to \c true also enables work stealing.
+
+    On systems that do not report a NUMA topology all processors belong to
+    a single node, so enabling this property has no effect beyond what
+    cpuAffinity() does.
+
+    Threads that are already running keep their processor affinity until
+    they expire; it is best to set this property right after creating the
+    pool. The default is \c false.
+
+    \sa workStealingEnabled, cpuAffinity(), QThread::numaNodeCpus()
+*/
+
+bool QThreadPool::isNumaAware() const
+{
+    Q_D(const QThreadPool);
+    return d->numaAware.load();
+}
+
+void QThreadPool::setNumaAware(bool enabled)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    if (enabled)
+        d->setWorkStealingEnabled(true);
+    d->numaAware.store(enabled);
+}
+
+/*!
+    \since 5.3
+
+    Returns the processors that the pool's threads are restricted to, or an
+    empty list if they may run on any of them.
+
+    \sa setCpuAffinity()
+*/
+QList<int> QThreadPool::cpuAffinity() const
+{
+    Q_D(const QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    return d->cpuAffinity;
+}
+
+/*!
+    \since 5.3
+
+    Restricts the threads of the pool to the processors listed in \a cpus,
+    for instance those close to a network interface. An empty list lifts
+    the restriction. If the pool is NUMA-aware, each thread is further
+    restricted to the processors of its own node.
+
+    The affinity is applied to threads as they are started; threads that
+    are already running keep their affinity until they expire.
+
+    \sa cpuAffinity(), numaAware, QThread::setCpuAffinity()
+*/
+void QThreadPool::setCpuAffinity(const QList<int> &cpus)
+{
+    Q_D(QThreadPool);
+    QMutexLocker locker(&d->mutex);
+    d->cpuAffinity = cpus;
+}
+
 /*!
     Waits up to \a msecs milliseconds for all threads to exit and removes all
     threads from the thread pool. Returns \c true if all threads were removed;
@@ -60,6 +60,8 @@ class Q_CORE_EXPORT QThreadPool : public QObject
     Q_PROPERTY(int expiryTimeout READ expiryTimeout WRITE setExpiryTimeout)
     Q_PROPERTY(int maxThreadCount READ maxThreadCount WRITE setMaxThreadCount)
     Q_PROPERTY(int activeThreadCount READ activeThreadCount)
+    Q_PROPERTY(bool workStealingEnabled READ isWorkStealingEnabled WRITE setWorkStealingEnabled)
+    Q_PROPERTY(bool numaAware READ isNumaAware WRITE setNumaAware)
     friend class QFutureInterfaceBase;
 
 public:
@@ -79,6 +81,15 @@ public:
 
     int activeThreadCount() const;
 
+    bool isWorkStealingEnabled() const;
+    void setWorkStealingEnabled(bool enabled);
+
+    bool isNumaAware() const;
+    void setNumaAware(bool enabled);
+
+    QList<int> cpuAffinity() const;
+    void setCpuAffinity(const QList<int> &cpus);
+
     void reserveThread();
     void releaseThread();
 
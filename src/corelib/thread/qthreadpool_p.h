@@ -58,6 +58,7 @@
 #include "QtCore/qwaitcondition.h"
 #include "QtCore/qset.h"
 #include "QtCore/qqueue.h"
+#include "QtCore/qvector.h"
 #include "private/qobject_p.h"
 
 #ifndef QT_NO_THREAD
@@ -65,6 +66,55 @@
 QT_BEGIN_NAMESPACE
 
 class QThreadPoolThread;
+
+/*
+    A double-ended queue of runnables owned by one worker thread when the
+    pool is in work-stealing mode. The owner pushes and pops at the back,
+    other workers steal from the front. Each queue has its own lock, which
+    in practice is only ever contended by an occasional thief.
+*/
+class QThreadPoolWorkQueue
+{
+public:
+    QThreadPoolWorkQueue() : count(0) { }
+
+    void push(QRunnable *runnable);
+    QRunnable *pop();
+    QRunnable *steal();
+    bool remove(QRunnable *runnable);
+    QList<QRunnable *> takeAll();
+
+    bool isEmpty() const { return count.load() == 0; }
+
+private:
+    QMutex mutex;
+    QList<QRunnable *> runnables;
+    QAtomicInt count;
+};
+
+/*
+    The work-stealing queues of a pool, grouped by NUMA node: queue i
+    belongs to node nodes[i % nodes.size()], so the queues of one group are
+    nodes.size() apart. On machines without NUMA there is a single group.
+*/
+class QThreadPoolWorkQueues
+{
+public:
+    explicit QThreadPoolWorkQueues(int count);
+    ~QThreadPoolWorkQueues();
+
+    int size() const { return queues.size(); }
+    QThreadPoolWorkQueue *at(int index) const { return queues.at(index); }
+
+    int groupCount() const { return nodes.size(); }
+    int nodeOfQueue(int index) const { return nodes.at(index % nodes.size()); }
+    int groupOfNode(int node) const { return nodes.indexOf(node); }
+
+private:
+    QVector<QThreadPoolWorkQueue *> queues;
+    QVector<int> nodes;
+};
+
 class Q_CORE_EXPORT QThreadPoolPrivate : public QObjectPrivate
 {
     Q_DECLARE_PUBLIC(QThreadPool)
@@ -72,15 +122,25 @@ class Q_CORE_EXPORT QThreadPoolPrivate : public QObjectPrivate
 
 public:
     QThreadPoolPrivate();
+    ~QThreadPoolPrivate();
 
     bool tryStart(QRunnable *task);
     void enqueueTask(QRunnable *task, int priority = 0);
     int activeThreadCount() const;
 
+    void enqueueStealableTask(QRunnable *task);
+    QRunnable *takeStealableTask(QThreadPoolThread *thread);
+    bool wakeOrStartThread();
+
+    bool isDone() const
+    { return queue.isEmpty() && stealableTasks.load() <= 0 && activeThreads == 0; }
+
     void tryToStartMoreThreads();
     bool tooManyThreadsActive() const;
 
     void startThread(QRunnable *runnable = 0);
+    void setWorkStealingEnabled(bool enabled);
+    void prepareThread(QThreadPoolThread *thread);
     void reset();
     bool waitForDone(int msecs);
     void clear();
@@ -93,6 +153,21 @@ public:
     QList<QPair<QRunnable *, int> > queue;
     QWaitCondition noActiveThreads;
 
+    // work-stealing mode; workQueues is created the first time the mode is
+    // enabled and is only deleted together with the pool, so that workers
+    // can keep draining it without holding the mutex
+    QAtomicInt workStealing;
+    QAtomicPointer<QThreadPoolWorkQueues> workQueues;
+    QAtomicInt nextWorkQueue;
+    QAtomicInt stealableTasks;
+    QAtomicInt queuedTasks;
+    QAtomicInt liveThreads;
+    QAtomicInt sleepingThreads;
+
+    // applied to threads as they are started
+    QList<int> cpuAffinity;
+    QAtomicInt numaAware;
+
     bool isExiting;
     int expiryTimeout;
     int maxThreadCount;
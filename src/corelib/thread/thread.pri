@@ -13,6 +13,7 @@ HEADERS += thread/qmutex.h \
            thread/qexception.h \
            thread/qresultstore.h \
            thread/qfuture.h \
+           thread/qfuture_impl.h \
            thread/qfutureinterface.h \
            thread/qfuturesynchronizer.h \
            thread/qfuturewatcher.h \
@@ -44,6 +44,10 @@
 
 #include <QtCore/qglobal.h>
 
+#if defined(Q_CC_MSVC) && !defined(Q_OS_WINCE)
+#include <intrin.h>
+#endif
+
 QT_BEGIN_NAMESPACE
 
 
@@ -590,6 +594,27 @@ Q_DECL_CONSTEXPR inline uint qPopulationCount(long unsigned int v)
 #undef QALGORITHMS_USE_BUILTIN_POPCOUNT
 #endif
 
+inline uint qCountTrailingZeroBits(quint32 v)
+{
+#if defined(Q_CC_GNU)
+    return v ? __builtin_ctz(v) : 32U;
+#elif defined(Q_CC_MSVC) && !defined(Q_OS_WINCE)
+    unsigned long result;
+    return _BitScanForward(&result, v) ? uint(result) : 32U;
+#else
+    // See http://graphics.stanford.edu/~seander/bithacks.html#ZerosOnRightParallel
+    uint c = 32;
+    v &= ~v + 1;
+    if (v) c--;
+    if (v & 0x0000FFFF) c -= 16;
+    if (v & 0x00FF00FF) c -= 8;
+    if (v & 0x0F0F0F0F) c -= 4;
+    if (v & 0x33333333) c -= 2;
+    if (v & 0x55555555) c -= 1;
+    return c;
+#endif
+}
+
 
 QT_END_NAMESPACE
 
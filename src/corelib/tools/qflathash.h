@@ -0,0 +1,647 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QFLATHASH_H
+#define QFLATHASH_H
+
+#include <QtCore/qalgorithms.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qrefcount.h>
+
+#include <new>
+#include <string.h>
+
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+#include <initializer_list>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+struct Q_CORE_EXPORT QFlatHashData
+{
+    enum {
+        GroupSize = 16,
+        MinimumCapacity = GroupSize
+    };
+
+    // control byte of each slot; full slots hold 7 bits of the key's hash
+    enum {
+        Empty = 0x80,
+        Deleted = 0xfe
+    };
+
+    QtPrivate::RefCount ref;
+    int size;
+    int deleted;
+    int capacity;   // number of slots, a power of two
+    uint seed;
+    uchar *ctrl;    // capacity + GroupSize control bytes, the last group mirrors the first
+    void *nodes;
+
+    static QFlatHashData *allocate(int capacity, int nodeSize, int nodeAlignment);
+    static void free(QFlatHashData *d);
+    static int capacityForSize(int size);
+
+    inline int growthLimit() const { return capacity - capacity / 8; }
+    inline bool isFull(int i) const { return !(ctrl[i] & 0x80); }
+    inline void setControl(int i, uchar c)
+    {
+        ctrl[i] = c;
+        if (i < GroupSize)
+            ctrl[capacity + i] = c;
+    }
+    inline void resetControl()
+    {
+        memset(ctrl, Empty, capacity + GroupSize);
+        deleted = 0;
+    }
+
+    // bit n of the result refers to slot (pos + n) & (capacity - 1)
+    uint match(int pos, uchar h2) const;
+    uint matchEmpty(int pos) const;
+    uint matchFree(int pos) const;
+
+    static const QFlatHashData shared_null;
+};
+
+template <class Key, class T>
+class QFlatHash
+{
+    struct Node
+    {
+        inline Node(const Key &k, const T &v) : key(k), value(v) { }
+        Key key;
+        T value;
+    };
+
+    enum {
+        NodeIsComplex = QTypeInfo<Key>::isComplex || QTypeInfo<T>::isComplex,
+        NodeIsStatic = QTypeInfo<Key>::isStatic || QTypeInfo<T>::isStatic
+    };
+
+    QFlatHashData *d;
+
+    inline Node *nodes() const { return static_cast<Node *>(d->nodes); }
+
+public:
+    inline QFlatHash() : d(const_cast<QFlatHashData *>(&QFlatHashData::shared_null)) { }
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+    inline QFlatHash(std::initializer_list<std::pair<Key, T> > list)
+        : d(const_cast<QFlatHashData *>(&QFlatHashData::shared_null))
+    {
+        reserve(int(list.size()));
+        for (typename std::initializer_list<std::pair<Key, T> >::const_iterator it = list.begin(); it != list.end(); ++it)
+            insert(it->first, it->second);
+    }
+#endif
+    inline QFlatHash(const QFlatHash<Key, T> &other) : d(other.d) { d->ref.ref(); }
+    inline ~QFlatHash() { if (!d->ref.deref()) freeData(d); }
+
+    QFlatHash<Key, T> &operator=(const QFlatHash<Key, T> &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    inline QFlatHash(QFlatHash<Key, T> &&other) : d(other.d)
+    { other.d = const_cast<QFlatHashData *>(&QFlatHashData::shared_null); }
+    inline QFlatHash<Key, T> &operator=(QFlatHash<Key, T> &&other)
+    { qSwap(d, other.d); return *this; }
+#endif
+    inline void swap(QFlatHash<Key, T> &other) { qSwap(d, other.d); }
+
+    bool operator==(const QFlatHash<Key, T> &other) const;
+    inline bool operator!=(const QFlatHash<Key, T> &other) const { return !(*this == other); }
+
+    inline int size() const { return d->size; }
+    inline int count() const { return d->size; }
+    inline bool isEmpty() const { return d->size == 0; }
+
+    inline int capacity() const { return d->capacity; }
+    void reserve(int size);
+    void squeeze();
+
+    inline void detach() { if (d->ref.isShared()) detach_helper(); }
+    inline bool isDetached() const { return !d->ref.isShared(); }
+    inline bool isSharedWith(const QFlatHash<Key, T> &other) const { return d == other.d; }
+
+    void clear();
+
+    int remove(const Key &key);
+    T take(const Key &key);
+
+    inline bool contains(const Key &key) const { return findIndex(key) >= 0; }
+    const T value(const Key &key) const;
+    const T value(const Key &key, const T &defaultValue) const;
+    T &operator[](const Key &key);
+    const T operator[](const Key &key) const;
+
+    const Key key(const T &value) const;
+    const Key key(const T &value, const Key &defaultKey) const;
+    QList<Key> keys() const;
+    QList<T> values() const;
+
+    class const_iterator;
+
+    class iterator
+    {
+        friend class const_iterator;
+        friend class QFlatHash<Key, T>;
+        QFlatHashData *d;
+        int i;
+
+        inline iterator(QFlatHashData *data, int index) : d(data), i(index) { }
+        inline Node *node() const { return static_cast<Node *>(d->nodes) + i; }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T &reference;
+
+        inline iterator() : d(0), i(0) { }
+
+        inline const Key &key() const { return node()->key; }
+        inline T &value() const { return node()->value; }
+        inline T &operator*() const { return node()->value; }
+        inline T *operator->() const { return &node()->value; }
+        inline bool operator==(const iterator &o) const { return i == o.i; }
+        inline bool operator!=(const iterator &o) const { return i != o.i; }
+
+        inline iterator &operator++()
+        {
+            while (++i < d->capacity && !d->isFull(i))
+                ;
+            return *this;
+        }
+        inline iterator operator++(int) { iterator r = *this; ++*this; return r; }
+
+        inline bool operator==(const const_iterator &o) const { return i == o.i; }
+        inline bool operator!=(const const_iterator &o) const { return i != o.i; }
+    };
+    friend class iterator;
+
+    class const_iterator
+    {
+        friend class iterator;
+        friend class QFlatHash<Key, T>;
+        const QFlatHashData *d;
+        int i;
+
+        inline const_iterator(const QFlatHashData *data, int index) : d(data), i(index) { }
+        inline const Node *node() const { return static_cast<const Node *>(d->nodes) + i; }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        inline const_iterator() : d(0), i(0) { }
+        inline const_iterator(const iterator &o) : d(o.d), i(o.i) { }
+
+        inline const Key &key() const { return node()->key; }
+        inline const T &value() const { return node()->value; }
+        inline const T &operator*() const { return node()->value; }
+        inline const T *operator->() const { return &node()->value; }
+        inline bool operator==(const const_iterator &o) const { return i == o.i; }
+        inline bool operator!=(const const_iterator &o) const { return i != o.i; }
+
+        inline const_iterator &operator++()
+        {
+            while (++i < d->capacity && !d->isFull(i))
+                ;
+            return *this;
+        }
+        inline const_iterator operator++(int) { const_iterator r = *this; ++*this; return r; }
+    };
+    friend class const_iterator;
+
+    inline iterator begin() { detach(); return iterator(d, firstIndex()); }
+    inline const_iterator begin() const { return const_iterator(d, firstIndex()); }
+    inline const_iterator cbegin() const { return const_iterator(d, firstIndex()); }
+    inline const_iterator constBegin() const { return const_iterator(d, firstIndex()); }
+    inline iterator end() { detach(); return iterator(d, d->capacity); }
+    inline const_iterator end() const { return const_iterator(d, d->capacity); }
+    inline const_iterator cend() const { return const_iterator(d, d->capacity); }
+    inline const_iterator constEnd() const { return const_iterator(d, d->capacity); }
+
+    iterator erase(iterator it);
+    iterator insert(const Key &key, const T &value);
+    iterator find(const Key &key);
+    inline const_iterator find(const Key &key) const { return constFind(key); }
+    const_iterator constFind(const Key &key) const;
+
+    // STL compatibility
+    typedef T mapped_type;
+    typedef Key key_type;
+    typedef qptrdiff difference_type;
+    typedef int size_type;
+    typedef iterator Iterator;
+    typedef const_iterator ConstIterator;
+
+    inline bool empty() const { return isEmpty(); }
+
+private:
+    static inline uint hashOf(const Key &key, uint seed)
+    {
+        // spread the bits of hash functions like qHash(int), which leave
+        // most of them unchanged
+        uint h = qHash(key, seed);
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        return h ^ (h >> 16);
+    }
+
+    int firstIndex() const;
+    int findIndex(const Key &key) const;
+    int findIndex(const Key &key, uint h) const;
+    int insertIndex(uint h) const;
+    int insertNew(const Key &key, const T &value, uint h);
+    void eraseIndex(int i);
+    void rehash(int capacity);
+    void detach_helper();
+    static void freeData(QFlatHashData *x);
+};
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE QFlatHash<Key, T> &QFlatHash<Key, T>::operator=(const QFlatHash<Key, T> &other)
+{
+    if (d != other.d) {
+        QFlatHashData *o = other.d;
+        o->ref.ref();
+        if (!d->ref.deref())
+            freeData(d);
+        d = o;
+    }
+    return *this;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::freeData(QFlatHashData *x)
+{
+    if (NodeIsComplex) {
+        Node *n = static_cast<Node *>(x->nodes);
+        for (int i = 0; i < x->capacity; ++i) {
+            if (x->isFull(i))
+                n[i].~Node();
+        }
+    }
+    QFlatHashData::free(x);
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::detach_helper()
+{
+    const int capacity = d->capacity ? d->capacity : int(QFlatHashData::MinimumCapacity);
+    QFlatHashData *x = QFlatHashData::allocate(capacity, sizeof(Node), Q_ALIGNOF(Node));
+    if (d->size) {
+        // same capacity and seed: every node keeps its slot
+        x->seed = d->seed;
+        memcpy(x->ctrl, d->ctrl, capacity + QFlatHashData::GroupSize);
+        x->size = d->size;
+        x->deleted = d->deleted;
+        Node *src = nodes();
+        Node *dst = static_cast<Node *>(x->nodes);
+        if (NodeIsComplex) {
+            for (int i = 0; i < capacity; ++i) {
+                if (d->isFull(i))
+                    new (dst + i) Node(src[i]);
+            }
+        } else {
+            memcpy(static_cast<void *>(dst), static_cast<const void *>(src), capacity * sizeof(Node));
+        }
+    }
+    if (!d->ref.deref())
+        freeData(d);
+    d = x;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::rehash(int capacity)
+{
+    Q_ASSERT(!d->ref.isShared());
+    QFlatHashData *x = QFlatHashData::allocate(capacity, sizeof(Node), Q_ALIGNOF(Node));
+    qSwap(d, x);
+
+    Node *src = static_cast<Node *>(x->nodes);
+    for (int i = 0; i < x->capacity; ++i) {
+        if (!x->isFull(i))
+            continue;
+        const uint h = hashOf(src[i].key, d->seed);
+        const int j = insertIndex(h);
+        if (NodeIsStatic) {
+            new (nodes() + j) Node(src[i]);
+            src[i].~Node();
+        } else {
+            memcpy(static_cast<void *>(nodes() + j), static_cast<const void *>(src + i), sizeof(Node));
+        }
+        d->setControl(j, uchar(h & 0x7f));
+    }
+    d->size = x->size;
+    QFlatHashData::free(x);
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE int QFlatHash<Key, T>::firstIndex() const
+{
+    int i = 0;
+    while (i < d->capacity && !d->isFull(i))
+        ++i;
+    return i;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE int QFlatHash<Key, T>::findIndex(const Key &key) const
+{
+    if (!d->size)
+        return -1;
+    return findIndex(key, hashOf(key, d->seed));
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE int QFlatHash<Key, T>::findIndex(const Key &key, uint h) const
+{
+    if (!d->size)
+        return -1;
+    const int mask = d->capacity - 1;
+    const uchar h2 = uchar(h & 0x7f);
+    int pos = int(h >> 7) & mask;
+    for (int step = QFlatHashData::GroupSize; ; step += QFlatHashData::GroupSize) {
+        for (uint m = d->match(pos, h2); m; m &= m - 1) {
+            const int i = (pos + qCountTrailingZeroBits(m)) & mask;
+            if (nodes()[i].key == key)
+                return i;
+        }
+        if (d->matchEmpty(pos))
+            return -1;
+        pos = (pos + step) & mask;
+    }
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE int QFlatHash<Key, T>::insertIndex(uint h) const
+{
+    const int mask = d->capacity - 1;
+    int pos = int(h >> 7) & mask;
+    for (int step = QFlatHashData::GroupSize; ; step += QFlatHashData::GroupSize) {
+        const uint m = d->matchFree(pos);
+        if (m)
+            return (pos + qCountTrailingZeroBits(m)) & mask;
+        pos = (pos + step) & mask;
+    }
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE int QFlatHash<Key, T>::insertNew(const Key &key, const T &value, uint h)
+{
+    Q_ASSERT(!d->ref.isShared());
+    if (d->size + d->deleted >= d->growthLimit()) {
+        // every table has its own seed
+        rehash(QFlatHashData::capacityForSize(d->size + 1));
+        h = hashOf(key, d->seed);
+    }
+
+    const int i = insertIndex(h);
+    if (d->ctrl[i] == QFlatHashData::Deleted)
+        --d->deleted;
+    new (nodes() + i) Node(key, value);
+    d->setControl(i, uchar(h & 0x7f));
+    ++d->size;
+    return i;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::eraseIndex(int i)
+{
+    Q_ASSERT(!d->ref.isShared() && d->isFull(i));
+    nodes()[i].~Node();
+    if (--d->size == 0) {
+        d->resetControl();
+    } else {
+        d->setControl(i, QFlatHashData::Deleted);
+        ++d->deleted;
+    }
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE bool QFlatHash<Key, T>::operator==(const QFlatHash<Key, T> &other) const
+{
+    if (d == other.d)
+        return true;
+    if (size() != other.size())
+        return false;
+    for (const_iterator it = begin(); it != end(); ++it) {
+        const int i = other.findIndex(it.key());
+        if (i < 0 || !(other.nodes()[i].value == it.value()))
+            return false;
+    }
+    return true;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::reserve(int asize)
+{
+    const int capacity = QFlatHashData::capacityForSize(qMax(asize, d->size));
+    if (capacity > d->capacity) {
+        detach();
+        rehash(capacity);
+    }
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatHash<Key, T>::squeeze()
+{
+    if (!d->size) {
+        clear();
+        return;
+    }
+    const int capacity = QFlatHashData::capacityForSize(d->size);
+    if (capacity < d->capacity || d->deleted) {
+        detach();
+        rehash(capacity);
+    }
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE void QFlatHash<Key, T>::clear()
+{
+    *this = QFlatHash<Key, T>();
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE int QFlatHash<Key, T>::remove(const Key &key)
+{
+    if (isEmpty())
+        return 0;
+    detach();
+    const int i = findIndex(key);
+    if (i < 0)
+        return 0;
+    eraseIndex(i);
+    return 1;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE T QFlatHash<Key, T>::take(const Key &key)
+{
+    if (isEmpty())
+        return T();
+    detach();
+    const int i = findIndex(key);
+    if (i < 0)
+        return T();
+    T t = nodes()[i].value;
+    eraseIndex(i);
+    return t;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE const T QFlatHash<Key, T>::value(const Key &key) const
+{
+    const int i = findIndex(key);
+    return i < 0 ? T() : nodes()[i].value;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE const T QFlatHash<Key, T>::value(const Key &key, const T &defaultValue) const
+{
+    const int i = findIndex(key);
+    return i < 0 ? defaultValue : nodes()[i].value;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE T &QFlatHash<Key, T>::operator[](const Key &key)
+{
+    detach();
+    const uint h = hashOf(key, d->seed);
+    int i = findIndex(key, h);
+    if (i < 0)
+        i = insertNew(key, T(), h);
+    return nodes()[i].value;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE const T QFlatHash<Key, T>::operator[](const Key &key) const
+{
+    return value(key);
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE const Key QFlatHash<Key, T>::key(const T &avalue) const
+{
+    return key(avalue, Key());
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE const Key QFlatHash<Key, T>::key(const T &avalue, const Key &defaultKey) const
+{
+    for (const_iterator it = begin(); it != end(); ++it) {
+        if (it.value() == avalue)
+            return it.key();
+    }
+    return defaultKey;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE QList<Key> QFlatHash<Key, T>::keys() const
+{
+    QList<Key> res;
+    res.reserve(size());
+    for (const_iterator it = begin(); it != end(); ++it)
+        res.append(it.key());
+    return res;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE QList<T> QFlatHash<Key, T>::values() const
+{
+    QList<T> res;
+    res.reserve(size());
+    for (const_iterator it = begin(); it != end(); ++it)
+        res.append(it.value());
+    return res;
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::erase(iterator it)
+{
+    Q_ASSERT_X(it.d == d, "QFlatHash::erase", "The specified iterator argument 'it' is invalid");
+    if (it == end())
+        return it;
+    iterator next = it;
+    ++next;
+    eraseIndex(it.i);
+    return next;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::insert(const Key &key, const T &value)
+{
+    detach();
+    const uint h = hashOf(key, d->seed);
+    int i = findIndex(key, h);
+    if (i < 0)
+        i = insertNew(key, value, h);
+    else
+        nodes()[i].value = value;
+    return iterator(d, i);
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE typename QFlatHash<Key, T>::iterator QFlatHash<Key, T>::find(const Key &key)
+{
+    detach();
+    const int i = findIndex(key);
+    return iterator(d, i < 0 ? d->capacity : i);
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE typename QFlatHash<Key, T>::const_iterator QFlatHash<Key, T>::constFind(const Key &key) const
+{
+    const int i = findIndex(key);
+    return const_iterator(d, i < 0 ? d->capacity : i);
+}
+
+QT_END_NAMESPACE
+
+#endif // QFLATHASH_H
@@ -0,0 +1,637 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QFLATMAP_H
+#define QFLATMAP_H
+
+#include <QtCore/qmap.h>
+#include <QtCore/qpair.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
+#include <iterator>
+
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+#include <initializer_list>
+#endif
+
+QT_BEGIN_NAMESPACE
+
+namespace QtPrivate {
+
+template <class Key>
+struct QFlatMapKeyLessThan
+{
+    inline bool operator()(const Key &key1, const Key &key2) const
+    { return qMapLessThanKey(key1, key2); }
+};
+
+template <class Key, class T>
+struct QFlatMapPairLessThan
+{
+    inline bool operator()(const QPair<Key, T> &p1, const QPair<Key, T> &p2) const
+    { return qMapLessThanKey(p1.first, p2.first); }
+};
+
+} // namespace QtPrivate
+
+template <class Key, class T>
+class QFlatMap
+{
+    QVector<Key> q_keys;
+    QVector<T> q_values;
+
+public:
+    inline QFlatMap() { }
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+    inline QFlatMap(std::initializer_list<std::pair<Key, T> > list)
+    {
+        QVector<QPair<Key, T> > pairs;
+        pairs.reserve(int(list.size()));
+        for (typename std::initializer_list<std::pair<Key, T> >::const_iterator it = list.begin(); it != list.end(); ++it)
+            pairs.append(qMakePair(it->first, it->second));
+        assignPairs(pairs);
+    }
+#endif
+    explicit QFlatMap(const QVector<QPair<Key, T> > &pairs) { assignPairs(pairs); }
+    explicit QFlatMap(const QMap<Key, T> &map);
+
+    inline void swap(QFlatMap<Key, T> &other) { q_keys.swap(other.q_keys); q_values.swap(other.q_values); }
+
+    inline bool operator==(const QFlatMap<Key, T> &other) const
+    { return q_keys == other.q_keys && q_values == other.q_values; }
+    inline bool operator!=(const QFlatMap<Key, T> &other) const { return !(*this == other); }
+
+    inline int size() const { return q_keys.size(); }
+    inline int count() const { return q_keys.size(); }
+    inline bool isEmpty() const { return q_keys.isEmpty(); }
+
+    inline int capacity() const { return q_keys.capacity(); }
+    inline void reserve(int size) { q_keys.reserve(size); q_values.reserve(size); }
+    inline void squeeze() { q_keys.squeeze(); q_values.squeeze(); }
+
+    inline void detach() { q_keys.detach(); q_values.detach(); }
+    inline bool isDetached() const { return q_keys.isDetached() && q_values.isDetached(); }
+
+    inline void clear() { *this = QFlatMap<Key, T>(); }
+
+    int remove(const Key &key);
+    T take(const Key &key);
+
+    inline bool contains(const Key &key) const { return indexOf(key) >= 0; }
+    inline const T value(const Key &key) const
+    { const int i = indexOf(key); return i < 0 ? T() : q_values.at(i); }
+    inline const T value(const Key &key, const T &defaultValue) const
+    { const int i = indexOf(key); return i < 0 ? defaultValue : q_values.at(i); }
+    T &operator[](const Key &key);
+    inline const T operator[](const Key &key) const { return value(key); }
+
+    const Key key(const T &value, const Key &defaultKey = Key()) const;
+    inline QVector<Key> keys() const { return q_keys; }
+    inline QVector<T> values() const { return q_values; }
+
+    inline const Key &firstKey() const { Q_ASSERT(!isEmpty()); return q_keys.first(); }
+    inline const Key &lastKey() const { Q_ASSERT(!isEmpty()); return q_keys.last(); }
+    inline T &first() { Q_ASSERT(!isEmpty()); return q_values.first(); }
+    inline const T &first() const { Q_ASSERT(!isEmpty()); return q_values.first(); }
+    inline T &last() { Q_ASSERT(!isEmpty()); return q_values.last(); }
+    inline const T &last() const { Q_ASSERT(!isEmpty()); return q_values.last(); }
+
+    QMap<Key, T> toMap() const;
+
+    class const_iterator;
+
+    class iterator
+    {
+        friend class const_iterator;
+        friend class QFlatMap<Key, T>;
+        const Key *k;
+        T *v;
+
+        inline iterator(const Key *key, T *value) : k(key), v(value) { }
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef T *pointer;
+        typedef T &reference;
+
+        inline iterator() : k(0), v(0) { }
+
+        inline const Key &key() const { return *k; }
+        inline T &value() const { return *v; }
+        inline T &operator*() const { return *v; }
+        inline T *operator->() const { return v; }
+        inline bool operator==(const iterator &o) const { return k == o.k; }
+        inline bool operator!=(const iterator &o) const { return k != o.k; }
+        inline bool operator<(const iterator &o) const { return k < o.k; }
+        inline bool operator<=(const iterator &o) const { return k <= o.k; }
+        inline bool operator>(const iterator &o) const { return k > o.k; }
+        inline bool operator>=(const iterator &o) const { return k >= o.k; }
+
+        inline iterator &operator++() { ++k; ++v; return *this; }
+        inline iterator operator++(int) { iterator r = *this; ++k; ++v; return r; }
+        inline iterator &operator--() { --k; --v; return *this; }
+        inline iterator operator--(int) { iterator r = *this; --k; --v; return r; }
+        inline iterator &operator+=(difference_type j) { k += j; v += j; return *this; }
+        inline iterator &operator-=(difference_type j) { k -= j; v -= j; return *this; }
+        inline iterator operator+(difference_type j) const { return iterator(k + j, v + j); }
+        inline iterator operator-(difference_type j) const { return iterator(k - j, v - j); }
+        inline difference_type operator-(const iterator &o) const { return k - o.k; }
+
+        inline bool operator==(const const_iterator &o) const { return k == o.k; }
+        inline bool operator!=(const const_iterator &o) const { return k != o.k; }
+    };
+    friend class iterator;
+
+    class const_iterator
+    {
+        friend class iterator;
+        friend class QFlatMap<Key, T>;
+        const Key *k;
+        const T *v;
+
+        inline const_iterator(const Key *key, const T *value) : k(key), v(value) { }
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef qptrdiff difference_type;
+        typedef T value_type;
+        typedef const T *pointer;
+        typedef const T &reference;
+
+        inline const_iterator() : k(0), v(0) { }
+        inline const_iterator(const iterator &o) : k(o.k), v(o.v) { }
+
+        inline const Key &key() const { return *k; }
+        inline const T &value() const { return *v; }
+        inline const T &operator*() const { return *v; }
+        inline const T *operator->() const { return v; }
+        inline bool operator==(const const_iterator &o) const { return k == o.k; }
+        inline bool operator!=(const const_iterator &o) const { return k != o.k; }
+        inline bool operator<(const const_iterator &o) const { return k < o.k; }
+        inline bool operator<=(const const_iterator &o) const { return k <= o.k; }
+        inline bool operator>(const const_iterator &o) const { return k > o.k; }
+        inline bool operator>=(const const_iterator &o) const { return k >= o.k; }
+
+        inline const_iterator &operator++() { ++k; ++v; return *this; }
+        inline const_iterator operator++(int) { const_iterator r = *this; ++k; ++v; return r; }
+        inline const_iterator &operator--() { --k; --v; return *this; }
+        inline const_iterator operator--(int) { const_iterator r = *this; --k; --v; return r; }
+        inline const_iterator &operator+=(difference_type j) { k += j; v += j; return *this; }
+        inline const_iterator &operator-=(difference_type j) { k -= j; v -= j; return *this; }
+        inline const_iterator operator+(difference_type j) const { return const_iterator(k + j, v + j); }
+        inline const_iterator operator-(difference_type j) const { return const_iterator(k - j, v - j); }
+        inline difference_type operator-(const const_iterator &o) const { return k - o.k; }
+    };
+    friend class const_iterator;
+
+    inline iterator begin() { return iterator(q_keys.constData(), q_values.data()); }
+    inline const_iterator begin() const { return constBegin(); }
+    inline const_iterator cbegin() const { return constBegin(); }
+    inline const_iterator constBegin() const { return const_iterator(q_keys.constData(), q_values.constData()); }
+    inline iterator end() { return begin() + size(); }
+    inline const_iterator end() const { return constEnd(); }
+    inline const_iterator cend() const { return constEnd(); }
+    inline const_iterator constEnd() const { return constBegin() + size(); }
+
+    iterator erase(iterator it);
+    iterator insert(const Key &key, const T &value);
+    void insert(const QFlatMap<Key, T> &other);
+    void insert(const QVector<QPair<Key, T> > &pairs);
+
+    inline iterator find(const Key &key)
+    { const int i = indexOf(key); return i < 0 ? end() : begin() + i; }
+    inline const_iterator find(const Key &key) const { return constFind(key); }
+    inline const_iterator constFind(const Key &key) const
+    { const int i = indexOf(key); return i < 0 ? constEnd() : constBegin() + i; }
+    inline iterator lowerBound(const Key &key) { return begin() + lowerBoundIndex(key); }
+    inline const_iterator lowerBound(const Key &key) const { return constBegin() + lowerBoundIndex(key); }
+    inline iterator upperBound(const Key &key) { return begin() + upperBoundIndex(key); }
+    inline const_iterator upperBound(const Key &key) const { return constBegin() + upperBoundIndex(key); }
+
+    // STL compatibility
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef qptrdiff difference_type;
+    typedef int size_type;
+    typedef iterator Iterator;
+    typedef const_iterator ConstIterator;
+
+    inline bool empty() const { return isEmpty(); }
+
+private:
+    inline int lowerBoundIndex(const Key &key) const
+    {
+        const Key *b = q_keys.constData();
+        return int(std::lower_bound(b, b + q_keys.size(), key, QtPrivate::QFlatMapKeyLessThan<Key>()) - b);
+    }
+    inline int upperBoundIndex(const Key &key) const
+    {
+        const Key *b = q_keys.constData();
+        return int(std::upper_bound(b, b + q_keys.size(), key, QtPrivate::QFlatMapKeyLessThan<Key>()) - b);
+    }
+    inline int indexOf(const Key &key) const
+    {
+        const int i = lowerBoundIndex(key);
+        return (i < q_keys.size() && !qMapLessThanKey(key, q_keys.at(i))) ? i : -1;
+    }
+
+    void assignPairs(const QVector<QPair<Key, T> > &pairs);
+    void merge(const QVector<Key> &keys, const QVector<T> &values);
+};
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE QFlatMap<Key, T>::QFlatMap(const QMap<Key, T> &map)
+{
+    q_keys.reserve(map.size());
+    q_values.reserve(map.size());
+    for (typename QMap<Key, T>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+        q_keys.append(it.key());
+        q_values.append(it.value());
+    }
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatMap<Key, T>::assignPairs(const QVector<QPair<Key, T> > &pairs)
+{
+    QtPrivate::QFlatMapPairLessThan<Key, T> lessThan;
+
+    // sort a copy unless the input is already in key order
+    QVector<QPair<Key, T> > sorted;
+    const QPair<Key, T> *b = pairs.constData();
+    const QPair<Key, T> *e = b + pairs.size();
+    for (const QPair<Key, T> *p = b + 1; p < e; ++p) {
+        if (lessThan(*p, *(p - 1))) {
+            sorted = pairs;
+            std::stable_sort(sorted.begin(), sorted.end(), lessThan);
+            b = sorted.constData();
+            e = b + sorted.size();
+            break;
+        }
+    }
+
+    // for equal keys the one that came last wins, as with repeated insert()
+    q_keys.clear();
+    q_values.clear();
+    q_keys.reserve(int(e - b));
+    q_values.reserve(int(e - b));
+    for (const QPair<Key, T> *p = b; p < e; ++p) {
+        if (!q_keys.isEmpty() && !qMapLessThanKey(q_keys.last(), p->first)) {
+            q_values.last() = p->second;
+        } else {
+            q_keys.append(p->first);
+            q_values.append(p->second);
+        }
+    }
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE void QFlatMap<Key, T>::merge(const QVector<Key> &keys, const QVector<T> &values)
+{
+    if (keys.isEmpty())
+        return;
+    if (q_keys.isEmpty() || qMapLessThanKey(q_keys.last(), keys.first())) {
+        q_keys += keys;
+        q_values += values;
+        return;
+    }
+
+    QVector<Key> newKeys;
+    QVector<T> newValues;
+    newKeys.reserve(q_keys.size() + keys.size());
+    newValues.reserve(q_keys.size() + keys.size());
+
+    int i = 0;
+    int j = 0;
+    while (i < q_keys.size() && j < keys.size()) {
+        if (qMapLessThanKey(q_keys.at(i), keys.at(j))) {
+            newKeys.append(q_keys.at(i));
+            newValues.append(q_values.at(i));
+            ++i;
+        } else {
+            if (!qMapLessThanKey(keys.at(j), q_keys.at(i)))
+                ++i;    // replaced by the incoming value
+            newKeys.append(keys.at(j));
+            newValues.append(values.at(j));
+            ++j;
+        }
+    }
+    for (; i < q_keys.size(); ++i) {
+        newKeys.append(q_keys.at(i));
+        newValues.append(q_values.at(i));
+    }
+    for (; j < keys.size(); ++j) {
+        newKeys.append(keys.at(j));
+        newValues.append(values.at(j));
+    }
+    q_keys.swap(newKeys);
+    q_values.swap(newValues);
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE int QFlatMap<Key, T>::remove(const Key &key)
+{
+    const int i = indexOf(key);
+    if (i < 0)
+        return 0;
+    q_keys.remove(i);
+    q_values.remove(i);
+    return 1;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE T QFlatMap<Key, T>::take(const Key &key)
+{
+    const int i = indexOf(key);
+    if (i < 0)
+        return T();
+    T t = q_values.at(i);
+    q_keys.remove(i);
+    q_values.remove(i);
+    return t;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE T &QFlatMap<Key, T>::operator[](const Key &akey)
+{
+    const int i = lowerBoundIndex(akey);
+    if (i == q_keys.size() || qMapLessThanKey(akey, q_keys.at(i))) {
+        q_keys.insert(i, akey);
+        q_values.insert(i, T());
+    }
+    return q_values[i];
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE const Key QFlatMap<Key, T>::key(const T &avalue, const Key &defaultKey) const
+{
+    const int i = q_values.indexOf(avalue);
+    return i < 0 ? defaultKey : q_keys.at(i);
+}
+
+template <class Key, class T>
+Q_OUTOFLINE_TEMPLATE QMap<Key, T> QFlatMap<Key, T>::toMap() const
+{
+    QMap<Key, T> map;
+    // the keys are sorted, so every item is appended with a hint
+    for (int i = 0; i < q_keys.size(); ++i)
+        map.insert(map.constEnd(), q_keys.at(i), q_values.at(i));
+    return map;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE typename QFlatMap<Key, T>::iterator QFlatMap<Key, T>::erase(iterator it)
+{
+    const int i = int(it.k - q_keys.constData());
+    Q_ASSERT_X(i >= 0 && i < q_keys.size(), "QFlatMap::erase", "The specified iterator argument 'it' is invalid");
+    q_keys.remove(i);
+    q_values.remove(i);
+    return begin() + i;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE typename QFlatMap<Key, T>::iterator QFlatMap<Key, T>::insert(const Key &akey, const T &avalue)
+{
+    const int i = lowerBoundIndex(akey);
+    if (i == q_keys.size() || qMapLessThanKey(akey, q_keys.at(i))) {
+        q_keys.insert(i, akey);
+        q_values.insert(i, avalue);
+    } else {
+        q_values[i] = avalue;
+    }
+    return begin() + i;
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE void QFlatMap<Key, T>::insert(const QFlatMap<Key, T> &other)
+{
+    if (isEmpty())
+        *this = other;
+    else
+        merge(other.q_keys, other.q_values);
+}
+
+template <class Key, class T>
+Q_INLINE_TEMPLATE void QFlatMap<Key, T>::insert(const QVector<QPair<Key, T> > &pairs)
+{
+    insert(QFlatMap<Key, T>(pairs));
+}
+
+template <class T>
+class QFlatSet
+{
+    QVector<T> q_values;
+
+public:
+    inline QFlatSet() { }
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+    inline QFlatSet(std::initializer_list<T> list)
+    {
+        QVector<T> values;
+        values.reserve(int(list.size()));
+        for (typename std::initializer_list<T>::const_iterator it = list.begin(); it != list.end(); ++it)
+            values.append(*it);
+        assignValues(values);
+    }
+#endif
+    explicit QFlatSet(const QVector<T> &values) { assignValues(values); }
+
+    inline void swap(QFlatSet<T> &other) { q_values.swap(other.q_values); }
+
+    inline bool operator==(const QFlatSet<T> &other) const { return q_values == other.q_values; }
+    inline bool operator!=(const QFlatSet<T> &other) const { return q_values != other.q_values; }
+
+    inline int size() const { return q_values.size(); }
+    inline int count() const { return q_values.size(); }
+    inline bool isEmpty() const { return q_values.isEmpty(); }
+
+    inline int capacity() const { return q_values.capacity(); }
+    inline void reserve(int size) { q_values.reserve(size); }
+    inline void squeeze() { q_values.squeeze(); }
+
+    inline void detach() { q_values.detach(); }
+    inline bool isDetached() const { return q_values.isDetached(); }
+
+    inline void clear() { q_values.clear(); }
+
+    inline bool remove(const T &value)
+    { const int i = indexOf(value); if (i < 0) return false; q_values.remove(i); return true; }
+    inline bool contains(const T &value) const { return indexOf(value) >= 0; }
+
+    inline QVector<T> values() const { return q_values; }
+    inline QList<T> toList() const { return q_values.toList(); }
+
+    inline const T &first() const { Q_ASSERT(!isEmpty()); return q_values.first(); }
+    inline const T &last() const { Q_ASSERT(!isEmpty()); return q_values.last(); }
+
+    typedef typename QVector<T>::const_iterator const_iterator;
+    typedef const_iterator iterator;
+
+    inline const_iterator begin() const { return q_values.constBegin(); }
+    inline const_iterator cbegin() const { return q_values.constBegin(); }
+    inline const_iterator constBegin() const { return q_values.constBegin(); }
+    inline const_iterator end() const { return q_values.constEnd(); }
+    inline const_iterator cend() const { return q_values.constEnd(); }
+    inline const_iterator constEnd() const { return q_values.constEnd(); }
+
+    const_iterator erase(const_iterator it);
+    const_iterator insert(const T &value);
+    void insert(const QFlatSet<T> &other);
+    inline void insert(const QVector<T> &values) { insert(QFlatSet<T>(values)); }
+
+    inline const_iterator find(const T &value) const { return constFind(value); }
+    inline const_iterator constFind(const T &value) const
+    { const int i = indexOf(value); return i < 0 ? constEnd() : constBegin() + i; }
+    inline const_iterator lowerBound(const T &value) const { return constBegin() + lowerBoundIndex(value); }
+    inline const_iterator upperBound(const T &value) const { return constBegin() + upperBoundIndex(value); }
+
+    // STL compatibility
+    typedef T key_type;
+    typedef T value_type;
+    typedef value_type *pointer;
+    typedef const value_type *const_pointer;
+    typedef value_type &reference;
+    typedef const value_type &const_reference;
+    typedef qptrdiff difference_type;
+    typedef int size_type;
+    typedef iterator Iterator;
+    typedef const_iterator ConstIterator;
+
+    inline bool empty() const { return isEmpty(); }
+
+private:
+    inline int lowerBoundIndex(const T &value) const
+    {
+        const T *b = q_values.constData();
+        return int(std::lower_bound(b, b + q_values.size(), value, QtPrivate::QFlatMapKeyLessThan<T>()) - b);
+    }
+    inline int upperBoundIndex(const T &value) const
+    {
+        const T *b = q_values.constData();
+        return int(std::upper_bound(b, b + q_values.size(), value, QtPrivate::QFlatMapKeyLessThan<T>()) - b);
+    }
+    inline int indexOf(const T &value) const
+    {
+        const int i = lowerBoundIndex(value);
+        return (i < q_values.size() && !qMapLessThanKey(value, q_values.at(i))) ? i : -1;
+    }
+
+    void assignValues(const QVector<T> &values);
+};
+
+template <class T>
+Q_OUTOFLINE_TEMPLATE void QFlatSet<T>::assignValues(const QVector<T> &values)
+{
+    QtPrivate::QFlatMapKeyLessThan<T> lessThan;
+    q_values = values;
+
+    const T *b = q_values.constData();
+    const T *e = b + q_values.size();
+    for (const T *p = b + 1; p < e; ++p) {
+        if (!lessThan(*(p - 1), *p)) {
+            // unsorted or has duplicates
+            std::sort(q_values.begin(), q_values.end(), lessThan);
+            typename QVector<T>::iterator last = q_values.begin();
+            for (typename QVector<T>::iterator it = last + 1; it != q_values.end(); ++it) {
+                if (lessThan(*last, *it))
+                    *++last = *it;
+            }
+            q_values.erase(last + 1, q_values.end());
+            break;
+        }
+    }
+}
+
+template <class T>
+Q_INLINE_TEMPLATE typename QFlatSet<T>::const_iterator QFlatSet<T>::erase(const_iterator it)
+{
+    const int i = int(it - q_values.constBegin());
+    Q_ASSERT_X(i >= 0 && i < q_values.size(), "QFlatSet::erase", "The specified iterator argument 'it' is invalid");
+    q_values.remove(i);
+    return q_values.constBegin() + i;
+}
+
+template <class T>
+Q_INLINE_TEMPLATE typename QFlatSet<T>::const_iterator QFlatSet<T>::insert(const T &value)
+{
+    const int i = lowerBoundIndex(value);
+    if (i == q_values.size() || qMapLessThanKey(value, q_values.at(i)))
+        q_values.insert(i, value);
+    return q_values.constBegin() + i;
+}
+
+template <class T>
+Q_OUTOFLINE_TEMPLATE void QFlatSet<T>::insert(const QFlatSet<T> &other)
+{
+    if (other.isEmpty())
+        return;
+    if (isEmpty() || qMapLessThanKey(q_values.last(), other.q_values.first())) {
+        q_values += other.q_values;
+        return;
+    }
+
+    QVector<T> merged;
+    merged.reserve(q_values.size() + other.q_values.size());
+    const T *a = q_values.constData();
+    const T *ae = a + q_values.size();
+    const T *b = other.q_values.constData();
+    const T *be = b + other.q_values.size();
+    while (a < ae && b < be) {
+        if (qMapLessThanKey(*a, *b)) {
+            merged.append(*a++);
+        } else {
+            if (!qMapLessThanKey(*b, *a))
+                ++a;
+            merged.append(*b++);
+        }
+    }
+    while (a < ae)
+        merged.append(*a++);
+    while (b < be)
+        merged.append(*b++);
+    q_values.swap(merged);
+}
+
+QT_END_NAMESPACE
+
+#endif // QFLATMAP_H
@@ -49,6 +49,8 @@
 #include <stdlib.h>
 
 #include "qhash.h"
+#include "qflathash.h"
+#include "private/qsimd_p.h"
 
 #ifdef truncate
 #undef truncate
@@ -71,46 +73,106 @@
 #endif // Q_OS_UNIX
 
 #include <limits.h>
+#include <string.h>
 
 QT_BEGIN_NAMESPACE
 
 /*
-    The Java's hashing algorithm for strings is a variation of D. J. Bernstein
-    hashing algorithm appeared here http://cr.yp.to/cdb/cdb.txt
-    and informally known as DJB33XX - DJB's 33 Times Xor.
-    Java uses DJB31XA, that is, 31 Times Add.
-
-    The original algorithm was a loop around
-        (h << 5) + h ^ c
-    (which is indeed h*33 ^ c); it was then changed to
-        (h << 5) - h ^ c
-    (so h*31^c: DJB31XX), and the XOR changed to a sum:
-        (h << 5) - h + c
-    (DJB31XA), which can save some assembly instructions.
+    The string hashes below are based on Austin Appleby's MurmurHash2
+    (MurmurHash64A on 64-bit platforms): the key is consumed one machine
+    word at a time, each word is scrambled with a multiply-xorshift-multiply
+    step and merged into the state, and a final avalanche spreads every input
+    bit over the whole result. Unlike a per-character multiplicative hash,
+    keys sharing a long prefix (paths, URLs) still differ in all bits of the
+    hash.
 
-    Still, we can avoid writing the multiplication as "(h << 5) - h"
-    -- the compiler will turn it into a shift and an addition anyway
-    (for instance, gcc 4.4 does that even at -O0).
+    QString, QStringRef and QLatin1String hash their UTF-16 representation,
+    so that equal strings of either type have equal hashes.
 */
+#if QT_POINTER_SIZE == 8
+typedef quint64 HashWord;
+static const HashWord hashMultiplier = Q_UINT64_C(0xc6a4a7935bd1e995);
+static const int hashShift = 47;
+#else
+typedef uint HashWord;
+static const HashWord hashMultiplier = 0x5bd1e995;
+static const int hashShift = 24;
+#endif
 
-static inline uint hash(const uchar *p, int len, uint seed) Q_DECL_NOTHROW
+static inline HashWord hashLoad(const void *p) Q_DECL_NOTHROW
 {
-    uint h = seed;
+    HashWord word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
 
-    for (int i = 0; i < len; ++i)
-        h = 31 * h + p[i];
+static inline HashWord hashWord(HashWord h, HashWord k) Q_DECL_NOTHROW
+{
+    k *= hashMultiplier;
+    k ^= k >> hashShift;
+    k *= hashMultiplier;
+    h ^= k;
+    return h * hashMultiplier;
+}
 
-    return h;
+static inline HashWord hashTail(HashWord h, const void *p, int len) Q_DECL_NOTHROW
+{
+    HashWord k = 0;
+    memcpy(&k, p, len);
+    h ^= k;
+    return h * hashMultiplier;
 }
 
-static inline uint hash(const QChar *p, int len, uint seed) Q_DECL_NOTHROW
+static inline uint hashFinish(HashWord h) Q_DECL_NOTHROW
+{
+#if QT_POINTER_SIZE == 8
+    h ^= h >> hashShift;
+    h *= hashMultiplier;
+    h ^= h >> hashShift;
+    return uint(h ^ (h >> 32));
+#else
+    h ^= h >> 13;
+    h *= hashMultiplier;
+    return h ^ (h >> 15);
+#endif
+}
+
+static inline uint hash(const uchar *p, int len, uint seed) Q_DECL_NOTHROW
 {
-    uint h = seed;
+    HashWord h = seed ^ (HashWord(len) * hashMultiplier);
+    const uchar *end = p + len;
+    for ( ; end - p >= int(sizeof(HashWord)); p += sizeof(HashWord))
+        h = hashWord(h, hashLoad(p));
+    if (p != end)
+        h = hashTail(h, p, int(end - p));
+    return hashFinish(h);
+}
 
-    for (int i = 0; i < len; ++i)
-        h = 31 * h + p[i].unicode();
+static inline uint hash(const QChar *p, int len, uint seed) Q_DECL_NOTHROW
+{
+    return hash(reinterpret_cast<const uchar *>(p), len * int(sizeof(QChar)), seed);
+}
 
-    return h;
+// Same result as hash(const QChar *, int, uint) for the widened string.
+static inline uint hashLatin1(const uchar *p, int len, uint seed) Q_DECL_NOTHROW
+{
+    enum { UnitsPerWord = sizeof(HashWord) / sizeof(ushort) };
+    ushort units[UnitsPerWord];
+
+    HashWord h = seed ^ (HashWord(len * sizeof(ushort)) * hashMultiplier);
+    const uchar *end = p + len;
+    for ( ; end - p >= int(UnitsPerWord); p += UnitsPerWord) {
+        for (int i = 0; i < UnitsPerWord; ++i)
+            units[i] = p[i];
+        h = hashWord(h, hashLoad(units));
+    }
+    if (p != end) {
+        const int tail = int(end - p);
+        for (int i = 0; i < tail; ++i)
+            units[i] = p[i];
+        h = hashTail(h, units, tail * int(sizeof(ushort)));
+    }
+    return hashFinish(h);
 }
 
 uint qHash(const QByteArray &key, uint seed) Q_DECL_NOTHROW
@@ -143,7 +205,7 @@ uint qHash(const QBitArray &bitArray, uint seed) Q_DECL_NOTHROW
 
 uint qHash(QLatin1String key, uint seed) Q_DECL_NOTHROW
 {
-    return hash(reinterpret_cast<const uchar *>(key.data()), key.size(), seed);
+    return hashLatin1(reinterpret_cast<const uchar *>(key.data()), key.size(), seed);
 }
 
 /*!
@@ -540,6 +602,106 @@ void QHashData::rehash(int hint)
     }
 }
 
+static const uchar qt_flathash_empty_group[QFlatHashData::GroupSize] = {
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80,
+    0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80
+};
+
+const QFlatHashData QFlatHashData::shared_null = {
+    Q_REFCOUNT_INITIALIZE_STATIC, 0, 0, 0, 0, const_cast<uchar *>(qt_flathash_empty_group), 0
+};
+
+/*
+    Every table mixes the next value of this counter into its seed.
+    With the same seed everywhere, the keys of one table arrive in slot
+    order when it is copied into another one by iterating over it, and
+    pile up in long clusters until the copy grows.
+*/
+static QBasicAtomicInt qt_flathash_salt = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+/*
+    Allocates the header, the nodes and the control bytes of a QFlatHash
+    with \a capacity slots in one block. All slots are empty.
+*/
+QFlatHashData *QFlatHashData::allocate(int capacity, int nodeSize, int nodeAlignment)
+{
+    Q_ASSERT(capacity >= MinimumCapacity && (capacity & (capacity - 1)) == 0);
+
+    const size_t alignment = qMax<size_t>(nodeAlignment, Q_ALIGNOF(QFlatHashData));
+    const size_t headerSize = (sizeof(QFlatHashData) + alignment - 1) & ~(alignment - 1);
+    const size_t ctrlSize = size_t(capacity) + GroupSize;
+    // size_t is only 32 bits wide on 32-bit targets
+    if (size_t(capacity) > (size_t(-1) - headerSize - ctrlSize) / size_t(nodeSize))
+        qBadAlloc();
+    const size_t nodesSize = size_t(capacity) * nodeSize;
+    void *block = qMallocAligned(headerSize + nodesSize + ctrlSize, alignment);
+    Q_CHECK_PTR(block);
+
+    QFlatHashData *d = static_cast<QFlatHashData *>(block);
+    d->ref.initializeOwned();
+    d->size = 0;
+    d->capacity = capacity;
+    qt_initialize_qhash_seed();
+    d->seed = uint(qt_qhash_seed.load())
+              ^ (uint(qt_flathash_salt.fetchAndAddRelaxed(1)) * 0x9e3779b9U);
+    d->nodes = static_cast<char *>(block) + headerSize;
+    d->ctrl = static_cast<uchar *>(d->nodes) + nodesSize;
+    d->resetControl();
+    return d;
+}
+
+uint QFlatHashData::match(int pos, uchar h2) const
+{
+#if defined(__SSE2__)
+    const __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl + pos));
+    return uint(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(char(h2)))));
+#else
+    uint mask = 0;
+    for (int i = 0; i < GroupSize; ++i)
+        mask |= uint(ctrl[pos + i] == h2) << i;
+    return mask;
+#endif
+}
+
+uint QFlatHashData::matchEmpty(int pos) const
+{
+    return match(pos, Empty);
+}
+
+uint QFlatHashData::matchFree(int pos) const
+{
+#if defined(__SSE2__)
+    // empty and deleted slots are the ones with the high bit set
+    return uint(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl + pos))));
+#else
+    uint mask = 0;
+    for (int i = 0; i < GroupSize; ++i)
+        mask |= uint(ctrl[pos + i] >> 7) << i;
+    return mask;
+#endif
+}
+
+void QFlatHashData::free(QFlatHashData *d)
+{
+    Q_ASSERT(d != &shared_null);
+    qFreeAligned(d);
+}
+
+/*
+    Returns the smallest capacity that holds \a size items without
+    exceeding the maximum load factor of 7/8.
+*/
+int QFlatHashData::capacityForSize(int size)
+{
+    int capacity = MinimumCapacity;
+    while (capacity - capacity / 8 < size) {
+        if (capacity > INT_MAX / 2)
+            qBadAlloc();
+        capacity *= 2;
+    }
+    return capacity;
+}
+
 #ifdef QT_QHASH_DEBUG
 
 void QHashData::dump()
@@ -714,6 +876,8 @@ void QHashData::checkSanity()
     \since 5.0
 
     Returns the hash value for the \a key, using \a seed to seed the calculation.
+
+    The result is the same as for a QString holding the same characters.
 */
 
 /*! \fn uint qHash(const T *key, uint seed = 0)
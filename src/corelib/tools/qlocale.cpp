@@ -2801,11 +2801,13 @@ QString QLocalePrivate::doubleToString(const QChar _zero, const QChar plus, cons
 
 #ifdef QT_QLOCALE_USES_FCVT
         // NOT thread safe!
-        if (form == DFDecimal) {
+        if (form == DFDecimal && precision != QLocale::FloatingPointShortest) {
             digits = QLatin1String(fcvt(d, precision, &decpt, &sign));
         } else {
             int pr = precision;
-            if (form == DFExponent)
+            if (precision == QLocale::FloatingPointShortest)
+                pr = 17;
+            else if (form == DFExponent)
                 ++pr;
             else if (form == DFSignificantDigits && pr == 0)
                 pr = 1;
@@ -2824,7 +2826,9 @@ QString QLocalePrivate::doubleToString(const QChar _zero, const QChar plus, cons
 
 #else
         int mode;
-        if (form == DFDecimal)
+        if (precision == QLocale::FloatingPointShortest)
+            mode = 0;
+        else if (form == DFDecimal)
             mode = 3;
         else
             mode = 2;
@@ -2839,19 +2843,38 @@ QString QLocalePrivate::doubleToString(const QChar _zero, const QChar plus, cons
         if (form == DFExponent)
             ++pr;
 
-        char *rve = 0;
-        char *buff = 0;
-        QT_TRY {
-            digits = QLatin1String(qdtoa(d, mode, pr, &decpt, &sign, &rve, &buff));
-        } QT_CATCH(...) {
+        char fast[17];
+        int length = qdtoa_fast(d, mode, pr, fast, &decpt, &sign);
+        if (length >= 0) {
+            digits = QString::fromLatin1(fast, length);
+        } else {
+            char *rve = 0;
+            char *buff = 0;
+            QT_TRY {
+                digits = QLatin1String(qdtoa(d, mode, pr, &decpt, &sign, &rve, &buff));
+            } QT_CATCH(...) {
+                if (buff != 0)
+                    free(buff);
+                QT_RETHROW;
+            }
             if (buff != 0)
                 free(buff);
-            QT_RETHROW;
         }
-        if (buff != 0)
-            free(buff);
 #endif // QT_QLOCALE_USES_FCVT
 
+        // show exactly the shortest digits, choosing the 'g' notation as
+        // a precision of 17 would
+        int maxDecpt = precision;
+        if (precision == QLocale::FloatingPointShortest) {
+            maxDecpt = 17;
+            if (form == DFExponent)
+                precision = digits.length() - 1;
+            else if (form == DFDecimal)
+                precision = qMax(digits.length() - decpt, 0);
+            else
+                precision = digits.length();
+        }
+
         if (_zero.unicode() != '0') {
             ushort z = _zero.unicode() - '0';
             for (int i = 0; i < digits.length(); ++i)
@@ -2876,7 +2899,7 @@ QString QLocalePrivate::doubleToString(const QChar _zero, const QChar plus, cons
                 PrecisionMode mode = (flags & Alternate) ?
                             PMSignificantDigits : PMChopTrailingZeros;
 
-                if (decpt != digits.length() && (decpt <= -4 || decpt > precision))
+                if (decpt != digits.length() && (decpt <= -4 || decpt > maxDecpt))
                     num_str = exponentForm(_zero, decimal, exponential, group, plus, minus,
                                            digits, decpt, precision, mode,
                                            always_show_decpt);
@@ -3386,9 +3409,13 @@ double QLocalePrivate::bytearrayToDouble(const char *num, bool *ok, bool *overfl
     if (qstrcmp(num, "-inf") == 0)
         return -qt_inf();
 
+    double d;
+    if (qstrtod_fast(num, &d))
+        return d;
+
     bool _ok;
     const char *endptr;
-    double d = qstrtod(num, &endptr, &_ok);
+    d = qstrtod(num, &endptr, &_ok);
 
     if (!_ok) {
         // the only way strtod can fail with *endptr != '\0' on a non-empty
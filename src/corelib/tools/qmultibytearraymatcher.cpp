@@ -0,0 +1,320 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmultibytearraymatcher.h"
+#include "qmultimatcher_p.h"
+
+#include <QtCore/qchar.h>
+
+QT_BEGIN_NAMESPACE
+
+class QMultiByteArrayMatcherPrivate : public QSharedData
+{
+public:
+    QMultiByteArrayMatcherPrivate() : cs(Qt::CaseSensitive) { build(); }
+
+    void build();
+
+    QList<QByteArray> patterns;
+    Qt::CaseSensitivity cs;
+    QMultiMatcherAutomaton automaton;
+    int byteClass[256];
+};
+
+static inline uchar foldCase(uchar c)
+{
+    // same as qstricmp()
+    return uchar(QChar::toLower(ushort(c)));
+}
+
+void QMultiByteArrayMatcherPrivate::build()
+{
+    // class 0 is for the bytes not appearing in any pattern
+    int foldedClass[256];
+    memset(foldedClass, 0, sizeof(foldedClass));
+    int classCount = 1;
+
+    QVector<QVector<int> > classPatterns;
+    classPatterns.reserve(patterns.size());
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QByteArray &pattern = patterns.at(i);
+        QVector<int> classes(pattern.size());
+        for (int j = 0; j < pattern.size(); ++j) {
+            uchar c = uchar(pattern.at(j));
+            if (cs == Qt::CaseInsensitive)
+                c = foldCase(c);
+            if (!foldedClass[c])
+                foldedClass[c] = classCount++;
+            classes[j] = foldedClass[c];
+        }
+        classPatterns.append(classes);
+    }
+
+    for (int c = 0; c < 256; ++c)
+        byteClass[c] = foldedClass[cs == Qt::CaseInsensitive ? foldCase(uchar(c)) : c];
+
+    automaton.build(classPatterns, classCount);
+}
+
+namespace {
+struct ByteClass
+{
+    ByteClass(const uchar *str, const int *classes) : s(str), byteClass(classes) {}
+    inline int operator()(int i) const { return byteClass[s[i]]; }
+
+    const uchar *s;
+    const int *byteClass;
+};
+
+struct MatchCollector
+{
+    inline void operator()(int position, int pattern)
+    {
+        QMultiByteArrayMatcher::Match match = { position, pattern };
+        matches.append(match);
+    }
+
+    QVector<QMultiByteArrayMatcher::Match> matches;
+};
+}
+
+/*! \class QMultiByteArrayMatcher
+    \inmodule QtCore
+    \brief The QMultiByteArrayMatcher class holds a set of sequences of bytes
+    that can be quickly matched in a byte array.
+
+    \since 5.3
+
+    \ingroup tools
+    \ingroup string-processing
+
+    This class is useful when you want to find which of many byte
+    sequences occur in a byte array, for instance when filtering a stream
+    of log lines against a list of keywords. Looping over one
+    QByteArrayMatcher per keyword scans each byte array once per keyword;
+    QMultiByteArrayMatcher builds an Aho-Corasick automaton out of all the
+    patterns when setPatterns() is called, and then finds all of them with
+    a single scan of the byte array, costing one table lookup per byte
+    regardless of the number of patterns.
+
+    Call indexIn() to find the leftmost occurrence of any of the patterns,
+    or matchesIn() to find all the occurrences of all of them, including
+    overlapping ones.
+
+    Case insensitive matching treats the bytes as Latin-1 characters, like
+    qstricmp() does. Empty patterns never match.
+
+    \sa QByteArrayMatcher, QMultiStringMatcher
+*/
+
+/*!
+    \class QMultiByteArrayMatcher::Match
+    \inmodule QtCore
+
+    \brief The QMultiByteArrayMatcher::Match struct describes an occurrence
+    of a pattern found by QMultiByteArrayMatcher::matchesIn().
+
+    \variable QMultiByteArrayMatcher::Match::position
+    The index position of the occurrence in the byte array.
+
+    \variable QMultiByteArrayMatcher::Match::pattern
+    The index of the pattern in the list of patterns.
+*/
+
+/*!
+    Constructs an empty multi byte array matcher that won't match anything.
+    Call setPatterns() to give it some patterns to match.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher()
+    : d(new QMultiByteArrayMatcherPrivate)
+{
+}
+
+/*!
+    Constructs a multi byte array matcher that will search for the given
+    \a patterns, with case sensitivity \a cs.
+
+    Call indexIn() or matchesIn() to perform a search.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher(const QList<QByteArray> &patterns,
+                                               Qt::CaseSensitivity cs)
+    : d(new QMultiByteArrayMatcherPrivate)
+{
+    d->patterns = patterns;
+    d->cs = cs;
+    d->build();
+}
+
+/*!
+    Copies the \a other multi byte array matcher to this one.
+*/
+QMultiByteArrayMatcher::QMultiByteArrayMatcher(const QMultiByteArrayMatcher &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Destroys the multi byte array matcher.
+*/
+QMultiByteArrayMatcher::~QMultiByteArrayMatcher()
+{
+}
+
+/*!
+    Assigns the \a other multi byte array matcher to this one.
+*/
+QMultiByteArrayMatcher &QMultiByteArrayMatcher::operator=(const QMultiByteArrayMatcher &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn void QMultiByteArrayMatcher::swap(QMultiByteArrayMatcher &other)
+
+    Swaps the matcher \a other with this matcher. This operation is very
+    fast and never fails.
+*/
+
+/*!
+    Sets the patterns to search for to \a patterns.
+
+    The index of a pattern in \a patterns is what indexIn() and matchesIn()
+    report when that pattern is found.
+
+    \sa patterns(), indexIn(), matchesIn()
+*/
+void QMultiByteArrayMatcher::setPatterns(const QList<QByteArray> &patterns)
+{
+    d->patterns = patterns;
+    d->build();
+}
+
+/*!
+    Returns the patterns that this matcher searches for.
+
+    \sa setPatterns()
+*/
+QList<QByteArray> QMultiByteArrayMatcher::patterns() const
+{
+    return d->patterns;
+}
+
+/*!
+    Sets the case sensitivity setting of this matcher to \a cs.
+
+    \sa caseSensitivity(), setPatterns()
+*/
+void QMultiByteArrayMatcher::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (d->cs == cs)
+        return;
+    d->cs = cs;
+    d->build();
+}
+
+/*!
+    Returns the case sensitivity setting of this matcher.
+
+    \sa setCaseSensitivity()
+*/
+Qt::CaseSensitivity QMultiByteArrayMatcher::caseSensitivity() const
+{
+    return d->cs;
+}
+
+/*!
+    Searches the byte array \a ba, from byte position \a from (default 0,
+    i.e. from the first byte), for the leftmost occurrence of any of the
+    patterns. Returns the position where it was found, or -1 if none of the
+    patterns was found. If \a pattern is not null, it is set to the index of
+    the pattern that was found, or to -1; if more than one pattern occurs at
+    the returned position, the one with the lowest index is reported.
+*/
+int QMultiByteArrayMatcher::indexIn(const QByteArray &ba, int from, int *pattern) const
+{
+    return indexIn(ba.constData(), ba.size(), from, pattern);
+}
+
+/*!
+    \overload
+
+    Searches the char string \a str, which has length \a len, from byte
+    position \a from (default 0, i.e. from the first byte), for the leftmost
+    occurrence of any of the patterns. Returns the position where it was
+    found, or -1 if none of the patterns was found. If \a pattern is not
+    null, it is set to the index of the pattern that was found, or to -1.
+*/
+int QMultiByteArrayMatcher::indexIn(const char *str, int len, int from, int *pattern) const
+{
+    const ByteClass byteClass(reinterpret_cast<const uchar *>(str), d->byteClass);
+    return d->automaton.indexIn(len, from, byteClass, pattern);
+}
+
+/*!
+    Searches the byte array \a ba, from byte position \a from (default 0,
+    i.e. from the first byte), for all the occurrences of all the patterns,
+    and returns them, overlapping ones included.
+
+    The occurrences are sorted by their end position; occurrences ending at
+    the same position are sorted from the longest to the shortest.
+*/
+QVector<QMultiByteArrayMatcher::Match> QMultiByteArrayMatcher::matchesIn(const QByteArray &ba, int from) const
+{
+    return matchesIn(ba.constData(), ba.size(), from);
+}
+
+/*!
+    \overload
+
+    Searches the char string \a str, which has length \a len, from byte
+    position \a from (default 0, i.e. from the first byte), for all the
+    occurrences of all the patterns, and returns them.
+*/
+QVector<QMultiByteArrayMatcher::Match> QMultiByteArrayMatcher::matchesIn(const char *str, int len, int from) const
+{
+    const ByteClass byteClass(reinterpret_cast<const uchar *>(str), d->byteClass);
+    MatchCollector collector;
+    d->automaton.matchesIn(len, from, byteClass, collector);
+    return collector.matches;
+}
+
+QT_END_NAMESPACE
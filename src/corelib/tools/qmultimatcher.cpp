@@ -0,0 +1,193 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmultimatcher_p.h"
+
+#include <QtCore/qhash.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+struct TrieEdge
+{
+    int state;
+    int c;
+    int target;
+
+    bool operator<(const TrieEdge &other) const
+    { return state < other.state || (state == other.state && c < other.c); }
+};
+}
+
+Q_DECLARE_TYPEINFO(TrieEdge, Q_PRIMITIVE_TYPE);
+
+/*!
+    \internal
+
+    Builds the automaton matching \a patterns, which are given as sequences
+    of character classes in [1, \a classCount).
+*/
+void QMultiMatcherAutomaton::build(const QVector<QVector<int> > &patterns, int classCount)
+{
+    classes = classCount;
+    longestPattern = 0;
+    transitions.clear();
+
+    // the trie of the patterns
+    QHash<quint64, int> trie;
+    QVector<TrieEdge> edges;
+    depth = QVector<int>(1, 0);
+    patternAt = QVector<int>(1, -1);
+    nextDuplicate = QVector<int>(patterns.size(), -1);
+
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QVector<int> &pattern = patterns.at(i);
+        if (pattern.isEmpty())
+            continue;
+
+        int state = 0;
+        for (int j = 0; j < pattern.size(); ++j) {
+            Q_ASSERT(pattern.at(j) > 0 && pattern.at(j) < classes);
+            const quint64 key = (quint64(state) << 32) | uint(pattern.at(j));
+            QHash<quint64, int>::const_iterator it = trie.constFind(key);
+            if (it != trie.constEnd()) {
+                state = it.value();
+                continue;
+            }
+
+            const TrieEdge edge = { state, pattern.at(j), depth.size() };
+            edges.append(edge);
+            trie.insert(key, edge.target);
+            depth.append(depth.at(state) + 1);
+            patternAt.append(-1);
+            state = edge.target;
+        }
+
+        if (patternAt.at(state) == -1) {
+            patternAt[state] = i;
+        } else {
+            int p = patternAt.at(state);
+            while (nextDuplicate.at(p) != -1)
+                p = nextDuplicate.at(p);
+            nextDuplicate[p] = i;
+        }
+
+        longestPattern = qMax(longestPattern, pattern.size());
+    }
+    trie.clear();
+
+    const int stateCount = depth.size();
+
+    // the edges leaving each state, sorted by class
+    std::sort(edges.begin(), edges.end());
+    edgeStart = QVector<int>(stateCount + 1, 0);
+    edgeClass.resize(edges.size());
+    edgeTarget.resize(edges.size());
+    for (int i = 0; i < edges.size(); ++i) {
+        ++edgeStart[edges.at(i).state + 1];
+        edgeClass[i] = edges.at(i).c;
+        edgeTarget[i] = edges.at(i).target;
+    }
+    for (int state = 0; state < stateCount; ++state)
+        edgeStart[state + 1] += edgeStart.at(state);
+    edges.clear();
+
+    // compute the failure links breadth first, so that the failure state of
+    // each state is complete by the time the state is visited
+    failure = QVector<int>(stateCount, 0);
+    dictionaryLink = QVector<int>(stateCount, -1);
+    rootTransitions = QVector<int>(classes, 0);
+
+    QVector<int> queue;
+    queue.reserve(stateCount);
+    for (int e = edgeStart.at(0); e < edgeStart.at(1); ++e) {
+        rootTransitions[edgeClass.at(e)] = edgeTarget.at(e);
+        queue.append(edgeTarget.at(e));
+    }
+
+    for (int head = 0; head < queue.size(); ++head) {
+        const int state = queue.at(head);
+        const int fail = failure.at(state);
+        dictionaryLink[state] = patternAt.at(fail) != -1 ? fail : dictionaryLink.at(fail);
+
+        for (int e = edgeStart.at(state); e < edgeStart.at(state + 1); ++e) {
+            const int target = edgeTarget.at(e);
+            failure[target] = sparseNext(fail, edgeClass.at(e));
+            queue.append(target);
+        }
+    }
+
+    firstOutput.resize(stateCount);
+    for (int state = 0; state < stateCount; ++state)
+        firstOutput[state] = patternAt.at(state) != -1 ? state : dictionaryLink.at(state);
+
+    if (qint64(stateCount) * classes > MaxDenseTransitions)
+        return;
+
+    // complete the trie into a DFA: each row starts as a copy of the row of
+    // the failure state, which comes earlier in breadth-first order
+    transitions.resize(stateCount * classes);
+    int *table = transitions.data();
+    std::copy(rootTransitions.constBegin(), rootTransitions.constEnd(), table);
+    for (int head = 0; head < queue.size(); ++head) {
+        const int state = queue.at(head);
+        int *row = table + state * classes;
+        const int *failureRow = table + failure.at(state) * classes;
+        std::copy(failureRow, failureRow + classes, row);
+        for (int e = edgeStart.at(state); e < edgeStart.at(state + 1); ++e)
+            row[edgeClass.at(e)] = edgeTarget.at(e);
+    }
+
+    for (int i = 0; i < transitions.size(); ++i) {
+        const int target = table[i];
+        table[i] = firstOutput.at(target) != -1 ? ~(target * classes) : target * classes;
+    }
+
+    rootTransitions.clear();
+    edgeStart.clear();
+    edgeClass.clear();
+    edgeTarget.clear();
+    failure.clear();
+}
+
+QT_END_NAMESPACE
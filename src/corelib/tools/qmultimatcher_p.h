@@ -0,0 +1,241 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QMULTIMATCHER_P_H
+#define QMULTIMATCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists for the convenience
+// of qmultibytearraymatcher.cpp and qmultistringmatcher.cpp.  This header
+// file may change from version to version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*
+    An Aho-Corasick automaton, compiled into a DFA over character classes.
+
+    The matchers map every code unit of the subject to a class in
+    [0, classCount()); class 0 is used for the code units that don't appear
+    in any pattern, and case insensitivity is implemented by mapping the
+    case variants of a code unit to the same class. The automaton therefore
+    only deals with small integers, and scanning a subject costs one table
+    lookup per code unit, whatever the number of patterns.
+
+    The transition table stores the target state premultiplied by
+    classCount(), and complemented if a pattern ends in the target state, so
+    that the scanning loop needs neither a multiplication nor an extra
+    lookup for the common case.
+
+    The table has one row per state, so its size grows with the total
+    length of the patterns times the number of classes. Above
+    MaxDenseTransitions entries the automaton stays sparse instead: each
+    state only keeps its own edges, sorted by class, and a scan follows the
+    failure links like the textbook algorithm does, which costs a few
+    lookups more per code unit.
+*/
+class QMultiMatcherAutomaton
+{
+public:
+    QMultiMatcherAutomaton() : classes(1), longestPattern(0) {}
+
+    // each pattern is a sequence of classes in [1, classCount); empty
+    // patterns never match
+    void build(const QVector<QVector<int> > &patterns, int classCount);
+
+    inline int classCount() const { return classes; }
+
+    // ClassOf maps a position in the subject to the class of its code unit
+    template <typename ClassOf>
+    int indexIn(int length, int from, const ClassOf &classOf, int *patternIndex) const;
+
+    // Output is called with the position and the pattern of each match
+    template <typename ClassOf, typename Output>
+    void matchesIn(int length, int from, const ClassOf &classOf, Output &output) const;
+
+private:
+    enum { MaxDenseTransitions = 1 << 21 };
+
+    inline int sparseNext(int state, int c) const;
+    inline void updateBest(int state, int i, int *bestPosition, int *bestPattern) const;
+    template <typename Output>
+    inline void report(int state, int i, Output &output) const;
+
+    QVector<int> transitions;   // see above; empty if the automaton is sparse
+    QVector<int> depth;         // the length of the prefix leading to a state
+    QVector<int> patternAt;     // the first pattern ending in a state, or -1
+    QVector<int> nextDuplicate; // the next pattern equal to a pattern, or -1
+    QVector<int> firstOutput;   // the longest suffix of a state where a pattern ends, or -1
+    QVector<int> dictionaryLink; // the same, for proper suffixes
+
+    // sparse automaton only
+    QVector<int> rootTransitions; // the target of every class from the root
+    QVector<int> edgeStart;     // the edges of state s are [edgeStart[s], edgeStart[s + 1])
+    QVector<int> edgeClass;     // sorted within each state
+    QVector<int> edgeTarget;
+    QVector<int> failure;       // the longest proper suffix of a state that is a state
+
+    int classes;
+    int longestPattern;
+};
+
+inline int QMultiMatcherAutomaton::sparseNext(int state, int c) const
+{
+    const int *classBegin = edgeClass.constData();
+    while (state != 0) {
+        const int *begin = classBegin + edgeStart.at(state);
+        const int *end = classBegin + edgeStart.at(state + 1);
+        const int *edge = std::lower_bound(begin, end, c);
+        if (edge != end && *edge == c)
+            return edgeTarget.at(edge - classBegin);
+        state = failure.at(state);
+    }
+    return rootTransitions.at(c);
+}
+
+inline void QMultiMatcherAutomaton::updateBest(int state, int i, int *bestPosition, int *bestPattern) const
+{
+    for (int s = firstOutput.at(state); s != -1; s = dictionaryLink.at(s)) {
+        const int position = i + 1 - depth.at(s);
+        if (*bestPosition == -1 || position < *bestPosition
+                || (position == *bestPosition && patternAt.at(s) < *bestPattern)) {
+            *bestPosition = position;
+            *bestPattern = patternAt.at(s);
+        }
+    }
+}
+
+template <typename Output>
+inline void QMultiMatcherAutomaton::report(int state, int i, Output &output) const
+{
+    for (int s = firstOutput.at(state); s != -1; s = dictionaryLink.at(s)) {
+        const int position = i + 1 - depth.at(s);
+        for (int p = patternAt.at(s); p != -1; p = nextDuplicate.at(p))
+            output(position, p);
+    }
+}
+
+template <typename ClassOf>
+int QMultiMatcherAutomaton::indexIn(int length, int from, const ClassOf &classOf, int *patternIndex) const
+{
+    int bestPosition = -1;
+    int bestPattern = -1;
+
+    if (from < 0)
+        from = 0;
+
+    if (longestPattern > 0 && !transitions.isEmpty()) {
+        const int *table = transitions.constData();
+        int state = 0;
+        int end = length;
+        for (int i = from; i < end; ++i) {
+            state = table[state + classOf(i)];
+            if (state >= 0)
+                continue;
+
+            state = ~state;
+            updateBest(state / classes, i, &bestPosition, &bestPattern);
+
+            // the matches ending after this point start after the best one
+            end = qMin(length, bestPosition + longestPattern);
+        }
+    } else if (longestPattern > 0) {
+        int state = 0;
+        int end = length;
+        for (int i = from; i < end; ++i) {
+            state = sparseNext(state, classOf(i));
+            if (firstOutput.at(state) == -1)
+                continue;
+
+            updateBest(state, i, &bestPosition, &bestPattern);
+            end = qMin(length, bestPosition + longestPattern);
+        }
+    }
+
+    if (patternIndex)
+        *patternIndex = bestPattern;
+    return bestPosition;
+}
+
+template <typename ClassOf, typename Output>
+void QMultiMatcherAutomaton::matchesIn(int length, int from, const ClassOf &classOf, Output &output) const
+{
+    if (longestPattern == 0)
+        return;
+
+    if (from < 0)
+        from = 0;
+
+    if (transitions.isEmpty()) {
+        int state = 0;
+        for (int i = from; i < length; ++i) {
+            state = sparseNext(state, classOf(i));
+            if (firstOutput.at(state) != -1)
+                report(state, i, output);
+        }
+        return;
+    }
+
+    const int *table = transitions.constData();
+    int state = 0;
+    for (int i = from; i < length; ++i) {
+        state = table[state + classOf(i)];
+        if (state >= 0)
+            continue;
+
+        state = ~state;
+        report(state / classes, i, output);
+    }
+}
+
+QT_END_NAMESPACE
+
+#endif // QMULTIMATCHER_P_H
@@ -0,0 +1,389 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qmultistringmatcher.h"
+#include "qmultimatcher_p.h"
+
+#include <QtCore/qhash.h>
+
+QT_BEGIN_NAMESPACE
+
+class QMultiStringMatcherPrivate : public QSharedData
+{
+public:
+    QMultiStringMatcherPrivate() : cs(Qt::CaseSensitive) { build(); }
+
+    void build();
+
+    QStringList patterns;
+    Qt::CaseSensitivity cs;
+    QMultiMatcherAutomaton automaton;
+
+    // the class of each code unit, after case folding, in blocks of 256
+    // code units sharing their high byte. classBlock holds the offset of the
+    // block of each high byte in classTable; the high bytes that appear in
+    // no pattern share the first block, which is all class 0, and the second
+    // block is for Latin-1, case folded in advance.
+    int classBlock[256];
+    QVector<int> classTable;
+};
+
+/*
+    Returns the case folded code unit at position i of s, which has the
+    given length. Surrogate pairs are folded as a whole.
+*/
+static inline ushort foldedCodeUnit(const ushort *s, int i, int length)
+{
+    const ushort c = s[i];
+    if (QChar::isHighSurrogate(c)) {
+        if (i + 1 < length && QChar::isLowSurrogate(s[i + 1]))
+            return QChar::highSurrogate(QChar::toCaseFolded(QChar::surrogateToUcs4(c, s[i + 1])));
+    } else if (QChar::isLowSurrogate(c)) {
+        if (i > 0 && QChar::isHighSurrogate(s[i - 1]))
+            return QChar::lowSurrogate(QChar::toCaseFolded(QChar::surrogateToUcs4(s[i - 1], c)));
+    }
+    return ushort(QChar::toCaseFolded(c));
+}
+
+void QMultiStringMatcherPrivate::build()
+{
+    // class 0 is for the code units not appearing in any pattern
+    QHash<ushort, int> unitClass;
+    int classCount = 1;
+
+    QVector<QVector<int> > classPatterns;
+    classPatterns.reserve(patterns.size());
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QString &pattern = patterns.at(i);
+        const ushort *units = pattern.utf16();
+        const int length = pattern.size();
+        QVector<int> classes(length);
+        for (int j = 0; j < length; ++j) {
+            const ushort c = cs == Qt::CaseInsensitive ? foldedCodeUnit(units, j, length) : units[j];
+            QHash<ushort, int>::const_iterator it = unitClass.constFind(c);
+            if (it == unitClass.constEnd())
+                it = unitClass.insert(c, classCount++);
+            classes[j] = it.value();
+        }
+        classPatterns.append(classes);
+    }
+
+    classTable.fill(0, 2 * 256);
+    for (int i = 0; i < 256; ++i)
+        classBlock[i] = 0;
+    classBlock[0] = 256;
+    for (int c = 0; c < 256; ++c) {
+        const ushort folded = cs == Qt::CaseInsensitive ? ushort(QChar::toCaseFolded(uint(c))) : ushort(c);
+        classTable[256 + c] = unitClass.value(folded, 0);
+    }
+
+    for (QHash<ushort, int>::const_iterator it = unitClass.constBegin(); it != unitClass.constEnd(); ++it) {
+        const ushort c = it.key();
+        if (c < 0x100)
+            continue;
+        int &block = classBlock[c >> 8];
+        if (!block) {
+            block = classTable.size();
+            classTable.insert(classTable.end(), 256, 0);
+        }
+        classTable[block + (c & 0xff)] = it.value();
+    }
+
+    automaton.build(classPatterns, classCount);
+}
+
+namespace {
+struct CaseSensitiveClass
+{
+    CaseSensitiveClass(const ushort *str, const QMultiStringMatcherPrivate *d)
+        : s(str), classBlock(d->classBlock), classTable(d->classTable.constData()) {}
+
+    inline int operator()(int i) const
+    {
+        const ushort c = s[i];
+        return classTable[classBlock[c >> 8] + (c & 0xff)];
+    }
+
+    const ushort *s;
+    const int *classBlock;
+    const int *classTable;
+};
+
+struct CaseInsensitiveClass
+{
+    CaseInsensitiveClass(const ushort *str, int length, const QMultiStringMatcherPrivate *d)
+        : s(str), l(length), classBlock(d->classBlock), classTable(d->classTable.constData()) {}
+
+    inline int operator()(int i) const
+    {
+        // the Latin-1 block is case folded already; the other code units are
+        // folded here, and the ones folding into Latin-1, like U+212A KELVIN
+        // SIGN, find the right class there as folding twice changes nothing
+        const ushort c = s[i] < 0x100 ? s[i] : foldedCodeUnit(s, i, l);
+        return classTable[classBlock[c >> 8] + (c & 0xff)];
+    }
+
+    const ushort *s;
+    const int l;
+    const int *classBlock;
+    const int *classTable;
+};
+
+struct MatchCollector
+{
+    inline void operator()(int position, int pattern)
+    {
+        QMultiStringMatcher::Match match = { position, pattern };
+        matches.append(match);
+    }
+
+    QVector<QMultiStringMatcher::Match> matches;
+};
+}
+
+/*! \class QMultiStringMatcher
+    \inmodule QtCore
+    \brief The QMultiStringMatcher class holds a set of sequences of
+    characters that can be quickly matched in a Unicode string.
+
+    \since 5.3
+
+    \ingroup tools
+    \ingroup string-processing
+
+    This class is useful when you want to find which of many sequences of
+    \l{QChar}s occur in a string, for instance when filtering a stream of
+    log lines against a list of keywords. Looping over one QStringMatcher
+    per keyword scans each string once per keyword; QMultiStringMatcher
+    builds an Aho-Corasick automaton out of all the patterns when
+    setPatterns() is called, and then finds all of them with a single scan
+    of the string, costing one table lookup per character regardless of the
+    number of patterns, plus the case folding of the characters outside
+    Latin-1 when matching case insensitively.
+
+    Call indexIn() to find the leftmost occurrence of any of the patterns,
+    or matchesIn() to find all the occurrences of all of them, including
+    overlapping ones.
+
+    Case insensitive matching compares the case folded characters, like
+    QString::indexOf() does. Empty patterns never match.
+
+    \sa QStringMatcher, QMultiByteArrayMatcher
+*/
+
+/*!
+    \class QMultiStringMatcher::Match
+    \inmodule QtCore
+
+    \brief The QMultiStringMatcher::Match struct describes an occurrence of
+    a pattern found by QMultiStringMatcher::matchesIn().
+
+    \variable QMultiStringMatcher::Match::position
+    The index position of the occurrence in the string.
+
+    \variable QMultiStringMatcher::Match::pattern
+    The index of the pattern in the list of patterns.
+*/
+
+/*!
+    Constructs an empty multi string matcher that won't match anything.
+    Call setPatterns() to give it some patterns to match.
+*/
+QMultiStringMatcher::QMultiStringMatcher()
+    : d(new QMultiStringMatcherPrivate)
+{
+}
+
+/*!
+    Constructs a multi string matcher that will search for the given
+    \a patterns, with case sensitivity \a cs.
+
+    Call indexIn() or matchesIn() to perform a search.
+*/
+QMultiStringMatcher::QMultiStringMatcher(const QStringList &patterns, Qt::CaseSensitivity cs)
+    : d(new QMultiStringMatcherPrivate)
+{
+    d->patterns = patterns;
+    d->cs = cs;
+    d->build();
+}
+
+/*!
+    Copies the \a other multi string matcher to this one.
+*/
+QMultiStringMatcher::QMultiStringMatcher(const QMultiStringMatcher &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Destroys the multi string matcher.
+*/
+QMultiStringMatcher::~QMultiStringMatcher()
+{
+}
+
+/*!
+    Assigns the \a other multi string matcher to this one.
+*/
+QMultiStringMatcher &QMultiStringMatcher::operator=(const QMultiStringMatcher &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn void QMultiStringMatcher::swap(QMultiStringMatcher &other)
+
+    Swaps the matcher \a other with this matcher. This operation is very
+    fast and never fails.
+*/
+
+/*!
+    Sets the patterns to search for to \a patterns.
+
+    The index of a pattern in \a patterns is what indexIn() and matchesIn()
+    report when that pattern is found.
+
+    \sa patterns(), indexIn(), matchesIn()
+*/
+void QMultiStringMatcher::setPatterns(const QStringList &patterns)
+{
+    d->patterns = patterns;
+    d->build();
+}
+
+/*!
+    Returns the patterns that this matcher searches for.
+
+    \sa setPatterns()
+*/
+QStringList QMultiStringMatcher::patterns() const
+{
+    return d->patterns;
+}
+
+/*!
+    Sets the case sensitivity setting of this matcher to \a cs.
+
+    \sa caseSensitivity(), setPatterns()
+*/
+void QMultiStringMatcher::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (d->cs == cs)
+        return;
+    d->cs = cs;
+    d->build();
+}
+
+/*!
+    Returns the case sensitivity setting of this matcher.
+
+    \sa setCaseSensitivity()
+*/
+Qt::CaseSensitivity QMultiStringMatcher::caseSensitivity() const
+{
+    return d->cs;
+}
+
+/*!
+    Searches the string \a str, from character position \a from (default 0,
+    i.e. from the first character), for the leftmost occurrence of any of
+    the patterns. Returns the position where it was found, or -1 if none of
+    the patterns was found. If \a pattern is not null, it is set to the index
+    of the pattern that was found, or to -1; if more than one pattern occurs
+    at the returned position, the one with the lowest index is reported.
+*/
+int QMultiStringMatcher::indexIn(const QString &str, int from, int *pattern) const
+{
+    return indexIn(str.unicode(), str.size(), from, pattern);
+}
+
+/*!
+    \overload
+
+    Searches the string starting at \a str, which has length \a length, from
+    character position \a from (default 0, i.e. from the first character),
+    for the leftmost occurrence of any of the patterns. Returns the position
+    where it was found, or -1 if none of the patterns was found. If
+    \a pattern is not null, it is set to the index of the pattern that was
+    found, or to -1.
+*/
+int QMultiStringMatcher::indexIn(const QChar *str, int length, int from, int *pattern) const
+{
+    const ushort *s = reinterpret_cast<const ushort *>(str);
+    if (d->cs == Qt::CaseSensitive)
+        return d->automaton.indexIn(length, from, CaseSensitiveClass(s, d.constData()), pattern);
+    return d->automaton.indexIn(length, from, CaseInsensitiveClass(s, length, d.constData()), pattern);
+}
+
+/*!
+    Searches the string \a str, from character position \a from (default 0,
+    i.e. from the first character), for all the occurrences of all the
+    patterns, and returns them, overlapping ones included.
+
+    The occurrences are sorted by their end position; occurrences ending at
+    the same position are sorted from the longest to the shortest.
+*/
+QVector<QMultiStringMatcher::Match> QMultiStringMatcher::matchesIn(const QString &str, int from) const
+{
+    return matchesIn(str.unicode(), str.size(), from);
+}
+
+/*!
+    \overload
+
+    Searches the string starting at \a str, which has length \a length, from
+    character position \a from (default 0, i.e. from the first character),
+    for all the occurrences of all the patterns, and returns them.
+*/
+QVector<QMultiStringMatcher::Match> QMultiStringMatcher::matchesIn(const QChar *str, int length, int from) const
+{
+    const ushort *s = reinterpret_cast<const ushort *>(str);
+    MatchCollector collector;
+    if (d->cs == Qt::CaseSensitive)
+        d->automaton.matchesIn(length, from, CaseSensitiveClass(s, d.constData()), collector);
+    else
+        d->automaton.matchesIn(length, from, CaseInsensitiveClass(s, length, d.constData()), collector);
+    return collector.matches;
+}
+
+QT_END_NAMESPACE
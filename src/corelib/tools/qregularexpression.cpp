@@ -42,6 +42,7 @@
 ****************************************************************************/
 
 #include "qregularexpression.h"
+#include "qregularexpression_p.h"
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qmutex.h>
@@ -51,9 +52,14 @@
 #include <QtCore/qthreadstorage.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qatomic.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qshareddata.h>
+#include <QtCore/qset.h>
 
 #include <pcre.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -522,6 +528,25 @@ QT_BEGIN_NAMESPACE
     QRegExp::CaretAtOffset behaviour. There is no equivalent for the other
     QRegExp::CaretMode modes.
 
+    \section1 Pattern cache
+
+    Compiling a pattern string is expensive, and so is optimizing it with the
+    JIT. QRegularExpression therefore keeps the compiled patterns in a
+    process-wide cache, keyed on the pattern string and the pattern options:
+    all the QRegularExpression objects using the same pattern share a single
+    compiled (and, once used often enough, JIT-compiled) pattern, even if they
+    were constructed independently, and constructing a QRegularExpression
+    with a recently used pattern doesn't compile it again.
+
+    The cache holds up to patternCacheLimit() patterns; the least recently
+    used ones are evicted first. Evicting a pattern never invalidates the
+    QRegularExpression objects using it. Use setPatternCacheLimit() to tune
+    the limit and clearPatternCache() to release the memory.
+
+    To match many patterns against the same subject string, use
+    QRegularExpressionSet, which finds the leftmost match of all of them in a
+    single scan of the subject in most cases.
+
     \section1 Debugging code that uses QRegularExpression
 
     QRegularExpression internally uses a just in time compiler (JIT) to
@@ -538,7 +563,7 @@ QT_BEGIN_NAMESPACE
     \c{QT_ENABLE_REGEXP_JIT} environment variable to a non-zero or zero value
     respectively.
 
-    \sa QRegularExpressionMatch, QRegularExpressionMatchIterator
+    \sa QRegularExpressionMatch, QRegularExpressionMatchIterator, QRegularExpressionSet
 */
 
 /*!
@@ -637,6 +662,50 @@ QT_BEGIN_NAMESPACE
     \sa QRegularExpression, QRegularExpressionMatch
 */
 
+/*!
+    \class QRegularExpressionSet
+    \inmodule QtCore
+    \reentrant
+
+    \brief The QRegularExpressionSet class matches a list of regular
+    expressions against a string at once.
+
+    \since 5.3
+
+    \ingroup tools
+    \ingroup shared
+
+    \keyword regular expression set
+
+    Lexers, log filters, routing tables and syntax highlighters typically
+    look for the first of many patterns in a string. Calling
+    QRegularExpression::match() for each of them scans the subject string once
+    per pattern; QRegularExpressionSet instead combines the patterns so that
+    a single scan finds the leftmost match of all of them:
+
+    \code
+    QRegularExpressionSet set(QStringList() << "\\d+" << "[a-z]+" << "\\s+");
+    int index;
+    QRegularExpressionMatch match = set.match("  abc 42", 0, &index);
+    // index == 2, match.captured() == "  "
+    \endcode
+
+    The match() function returns the leftmost match; when more than one
+    regular expression matches at that position, the one that comes first in
+    the set wins. The returned QRegularExpressionMatch refers to the regular
+    expression that matched, and reports its capturing groups (both by index
+    and by name) exactly as QRegularExpression::match() would.
+
+    Patterns using back references, recursion, subroutine calls, conditions,
+    PCRE verbs such as \c{(*COMMIT)}, or the
+    QRegularExpression::DontCaptureOption and
+    QRegularExpression::UseUnicodePropertiesOption pattern options, can't be
+    combined with other patterns; they are still supported, but each of them
+    costs a separate scan of the subject string.
+
+    \sa QRegularExpression, QRegularExpressionMatch
+*/
+
 
 /*!
     \enum QRegularExpression::PatternOption
@@ -793,16 +862,44 @@ static int convertToPcreOptions(QRegularExpression::MatchOptions matchOptions)
     return options;
 }
 
+/*
+    The compiled form of a pattern string. It is shared between all the
+    QRegularExpression objects that have the same pattern string and pattern
+    options, and kept alive by the global pattern cache for a while after the
+    last one went away, so that constructing the same pattern again doesn't
+    compile it again.
+
+    Everything but the study data is immutable after construction, and it's
+    therefore safe to use it from multiple threads at the same time.
+*/
+struct QPcrePattern : QSharedData
+{
+    QPcrePattern(const QString &pattern, QRegularExpression::PatternOptions patternOptions);
+    ~QPcrePattern();
+
+    void getPatternInfo(const QString &pattern);
+    void optimize();
+
+    // serializes optimize(); the result is published through studyData
+    QMutex mutex;
+
+    pcre16 *compiledPattern;
+    QAtomicPointer<pcre16_extra> studyData;
+    const char *errorString;
+    int errorOffset;
+    int capturingCount;
+    unsigned int usedCount;
+    QAtomicInt isOptimized;
+    bool usingCrLfNewlines;
+};
+
 struct QRegularExpressionPrivate : QSharedData
 {
     QRegularExpressionPrivate();
     ~QRegularExpressionPrivate();
     QRegularExpressionPrivate(const QRegularExpressionPrivate &other);
 
-    void cleanCompiledPattern();
     void compilePattern();
-    void getPatternInfo();
-    void optimizePattern();
 
     QRegularExpressionMatchPrivate *doMatch(const QString &subject,
                                             int offset,
@@ -817,24 +914,16 @@ struct QRegularExpressionPrivate : QSharedData
     QRegularExpression::PatternOptions patternOptions;
     QString pattern;
 
-    // *All* of the following members are set managed while holding this mutex,
-    // except for isDirty which is set to true by QRegularExpression setters
-    // (right after a detach happened).
-    // On the other hand, after the compilation and studying,
-    // it's safe to *use* (i.e. read) them from multiple threads at the same time.
-    // Therefore, doMatch doesn't need to lock this mutex.
+    // compiled and isDirty are managed while holding this mutex, except
+    // for isDirty being set to true by QRegularExpression setters (right
+    // after a detach happened). Once compilePattern() returned, compiled
+    // is safe to use from multiple threads at the same time; therefore,
+    // doMatch doesn't need to lock this mutex.
     QMutex mutex;
 
-    // The PCRE pointers are reference-counted by the QRegularExpressionPrivate
-    // objects themselves; when the private is copied (i.e. a detach happened)
-    // they are set to 0
-    pcre16 *compiledPattern;
-    QAtomicPointer<pcre16_extra> studyData;
-    const char *errorString;
-    int errorOffset;
-    int capturingCount;
-    unsigned int usedCount;
-    bool usingCrLfNewlines;
+    // Set to 0 when the private is copied (i.e. a detach happened); it is
+    // picked up again from the pattern cache by compilePattern().
+    QExplicitlySharedDataPointer<QPcrePattern> compiled;
     bool isDirty;
 };
 
@@ -878,6 +967,54 @@ struct QRegularExpressionMatchIteratorPrivate : QSharedData
     const QRegularExpression::MatchOptions matchOptions;
 };
 
+/*
+    A QRegularExpressionSet matches most of its patterns with a few combined
+    programs, each one being an alternation of the original patterns wrapped
+    in capturing groups:
+
+        ((?i-msxU)pattern0)|((?-imsxU)pattern1)|...
+
+    so that a single scan of the subject finds the leftmost match of all of
+    them. The wrapping group that took part in the match tells which pattern
+    matched, and the capturing groups that follow it are the ones of that
+    pattern. Patterns whose meaning would change inside such a program (see
+    canCombine()) are matched separately.
+*/
+struct QRegularExpressionSetPrivate : QSharedData
+{
+    QRegularExpressionSetPrivate();
+    QRegularExpressionSetPrivate(const QRegularExpressionSetPrivate &other);
+
+    void compile();
+    bool canCombine(const QRegularExpression &re, QSet<QString> *groupNames) const;
+    void addProgram(const QVector<int> &indexes);
+
+    struct Branch {
+        int index;          // in expressions
+        int group;          // of the wrapping capturing group
+        int captureCount;   // of the pattern itself
+    };
+
+    struct Program {
+        QRegularExpression re;
+        QVector<Branch> branches;
+    };
+
+    enum {
+        MaximumBranchCount = 64,
+        MaximumProgramLength = 16 * 1024
+    };
+
+    QList<QRegularExpression> expressions;
+
+    // programs, separate and isDirty are managed while holding this mutex,
+    // like QRegularExpressionPrivate does with the compiled pattern
+    QMutex mutex;
+    QVector<Program> programs;
+    QVector<int> separate;
+    bool isDirty;
+};
+
 /*!
     \internal
 */
@@ -892,11 +1029,7 @@ QRegularExpression::QRegularExpression(QRegularExpressionPrivate &dd)
 QRegularExpressionPrivate::QRegularExpressionPrivate()
     : patternOptions(0), pattern(),
       mutex(),
-      compiledPattern(0), studyData(0),
-      errorString(0), errorOffset(-1),
-      capturingCount(0),
-      usedCount(0),
-      usingCrLfNewlines(false),
+      compiled(),
       isDirty(true)
 {
 }
@@ -906,43 +1039,147 @@ QRegularExpressionPrivate::QRegularExpressionPrivate()
 */
 QRegularExpressionPrivate::~QRegularExpressionPrivate()
 {
-    cleanCompiledPattern();
 }
 
 /*!
     \internal
 
     Copies the private, which means copying only the pattern and the pattern
-    options. The compiledPattern and the studyData pointers are NOT copied (we
-    do not own them any more), and in general all the members set when
-    compiling a pattern are set to default values. isDirty is set back to true
-    so that the pattern has to be recompiled again.
+    options. The compiled pattern is NOT copied, as the copy is about to be
+    modified; isDirty is set back to true so that the compiled pattern is
+    looked up again.
 */
 QRegularExpressionPrivate::QRegularExpressionPrivate(const QRegularExpressionPrivate &other)
     : QSharedData(other),
       patternOptions(other.patternOptions), pattern(other.pattern),
       mutex(),
+      compiled(),
+      isDirty(true)
+{
+}
+
+/*!
+    \internal
+
+    Compiles \a pattern with the given \a patternOptions. If the pattern
+    string is invalid, compiledPattern is left to 0 and the error is
+    recorded.
+*/
+QPcrePattern::QPcrePattern(const QString &pattern, QRegularExpression::PatternOptions patternOptions)
+    : mutex(),
       compiledPattern(0), studyData(0),
-      errorString(0),
-      errorOffset(-1), capturingCount(0),
+      errorString(0), errorOffset(-1),
+      capturingCount(0),
       usedCount(0),
-      usingCrLfNewlines(false), isDirty(true)
+      isOptimized(0),
+      usingCrLfNewlines(false)
 {
+    int options = convertToPcreOptions(patternOptions);
+    options |= PCRE_UTF16;
+
+    int errorCode;
+    compiledPattern = pcre16_compile2(pattern.utf16(), options,
+                                      &errorCode, &errorString, &errorOffset, 0);
+
+    if (!compiledPattern)
+        return;
+
+    Q_ASSERT(errorCode == 0);
+    errorOffset = -1;
+
+    getPatternInfo(pattern);
 }
 
 /*!
     \internal
 */
-void QRegularExpressionPrivate::cleanCompiledPattern()
+QPcrePattern::~QPcrePattern()
 {
     pcre16_free(compiledPattern);
     pcre16_free_study(studyData.load());
-    usedCount = 0;
-    compiledPattern = 0;
-    studyData.store(0);
-    usingCrLfNewlines = false;
-    errorOffset = -1;
-    capturingCount = 0;
+}
+
+namespace {
+struct QPcrePatternKey
+{
+    QPcrePatternKey(const QString &patternString, QRegularExpression::PatternOptions options)
+        : pattern(patternString), patternOptions(options) {}
+
+    bool operator==(const QPcrePatternKey &other) const
+    {
+        return patternOptions == other.patternOptions && pattern == other.pattern;
+    }
+
+    QString pattern;
+    QRegularExpression::PatternOptions patternOptions;
+};
+
+uint qHash(const QPcrePatternKey &key, uint seed = 0) Q_DECL_NOTHROW
+{
+    return qHash(key.pattern, seed) ^ uint(key.patternOptions);
+}
+
+// The cache owns one reference to each of its patterns; evicting a pattern
+// that is still in use by some QRegularExpression doesn't free it.
+typedef QExplicitlySharedDataPointer<QPcrePattern> QPcrePatternPointer;
+
+struct QPcrePatternCache
+{
+    enum { DefaultLimit = 256 };
+
+    QPcrePatternCache()
+        : cache(DefaultLimit), hits(0), misses(0), evictions(0) {}
+
+    QCache<QPcrePatternKey, QPcrePatternPointer> cache;
+    quint64 hits;
+    quint64 misses;
+    quint64 evictions;
+};
+}
+
+Q_GLOBAL_STATIC(QPcrePatternCache, patternCache)
+static QBasicMutex patternCacheMutex;
+
+/*!
+    \internal
+
+    Returns the compiled form of \a pattern with the given \a patternOptions,
+    from the pattern cache if possible.
+*/
+static QPcrePatternPointer lookupPattern(const QString &pattern,
+                                         QRegularExpression::PatternOptions patternOptions)
+{
+    const QPcrePatternKey key(pattern, patternOptions);
+    QPcrePatternCache *c = patternCache();
+    if (c) {
+        QMutexLocker locker(&patternCacheMutex);
+        if (QPcrePatternPointer *cached = c->cache.object(key)) {
+            ++c->hits;
+            return *cached;
+        }
+        ++c->misses;
+    }
+
+    // compile without holding the lock; if another thread compiled the
+    // same pattern meanwhile, use its result instead of ours so that
+    // every user shares the same JIT code
+    QPcrePatternPointer compiled(new QPcrePattern(pattern, patternOptions));
+
+    if (c) {
+        QMutexLocker locker(&patternCacheMutex);
+        if (QPcrePatternPointer *cached = c->cache.object(key))
+            return *cached;
+
+        const int count = c->cache.count();
+        QT_TRY {
+            if (c->cache.insert(key, new QPcrePatternPointer(compiled)))
+                c->evictions += count + 1 - c->cache.count();
+        } QT_CATCH(const std::bad_alloc &) {
+            // not caching is fine
+        }
+    }
+
+    return compiled;
 }
 
 /*!
@@ -956,29 +1193,13 @@ void QRegularExpressionPrivate::compilePattern()
         return;
 
     isDirty = false;
-    cleanCompiledPattern();
-
-    int options = convertToPcreOptions(patternOptions);
-    options |= PCRE_UTF16;
-
-    int errorCode;
-    compiledPattern = pcre16_compile2(pattern.utf16(), options,
-                                      &errorCode, &errorString, &errorOffset, 0);
-
-    if (!compiledPattern)
-        return;
-
-    Q_ASSERT(errorCode == 0);
-    Q_ASSERT(studyData.load() == 0); // studying (=>optimizing) is always done later
-    errorOffset = -1;
-
-    getPatternInfo();
+    compiled = lookupPattern(pattern, patternOptions);
 }
 
 /*!
     \internal
 */
-void QRegularExpressionPrivate::getPatternInfo()
+void QPcrePattern::getPatternInfo(const QString &pattern)
 {
     Q_ASSERT(compiledPattern);
     Q_ASSERT(studyData.load() == 0);
@@ -1106,16 +1327,25 @@ static bool isJitEnabled()
     the memory pointed by studyData isn't. Therefore, we work on a local copy
     (localStudyData) before using storeRelease on studyData. In doMatch there's
     the corresponding loadAcquire.
+
+    As the compiled pattern is shared by all the QRegularExpression objects
+    using the same pattern, isOptimized is checked before taking the mutex,
+    so that matching a hot pattern from many threads doesn't serialize on it.
 */
-void QRegularExpressionPrivate::optimizePattern()
+void QPcrePattern::optimize()
 {
     Q_ASSERT(compiledPattern);
 
+    if (isOptimized.loadAcquire())
+        return;
+
     QMutexLocker lock(&mutex);
 
-    if (studyData.load() || (++usedCount != qt_qregularexpression_optimize_after_use_count))
+    if (isOptimized.load() || (++usedCount < qt_qregularexpression_optimize_after_use_count))
         return;
 
+    isOptimized.storeRelease(1);
+
     static const bool enableJit = isJitEnabled();
 
     int studyOptions = 0;
@@ -1144,10 +1374,10 @@ int QRegularExpressionPrivate::captureIndexForName(const QString &name) const
 {
     Q_ASSERT(!name.isEmpty());
 
-    if (!compiledPattern)
+    if (!compiled || !compiled->compiledPattern)
         return -1;
 
-    int index = pcre16_get_stringnumber(compiledPattern, name.utf16());
+    int index = pcre16_get_stringnumber(compiled->compiledPattern, name.utf16());
     if (index >= 0)
         return index;
 
@@ -1215,7 +1445,9 @@ QRegularExpressionMatchPrivate *QRegularExpressionPrivate::doMatch(const QString
     if (offset < 0 || offset > subject.length())
         return new QRegularExpressionMatchPrivate(re, subject, matchType, matchOptions);
 
-    if (!compiledPattern) {
+    QPcrePattern * const p = compiled.data();
+
+    if (!p || !p->compiledPattern) {
         qWarning("QRegularExpressionPrivate::doMatch(): called on an invalid QRegularExpression object");
         return new QRegularExpressionMatchPrivate(re, subject, matchType, matchOptions);
     }
@@ -1231,15 +1463,15 @@ QRegularExpressionMatchPrivate *QRegularExpressionPrivate::doMatch(const QString
     // capturingCount doesn't include the implicit "0" capturing group
     QRegularExpressionMatchPrivate *priv = new QRegularExpressionMatchPrivate(re, subject,
                                                                               matchType, matchOptions,
-                                                                              capturingCount + 1);
+                                                                              p->capturingCount + 1);
 
-    // this is mutex protected
-    const_cast<QRegularExpressionPrivate *>(this)->optimizePattern();
+    p->optimize();
 
     // work with a local copy of the study data, as we are running pcre_exec
     // potentially more than once, and we don't want to run call it
     // with different study data
-    const pcre16_extra * const currentStudyData = studyData.loadAcquire();
+    const pcre16_extra * const currentStudyData = p->studyData.loadAcquire();
+    const pcre16 * const compiledPattern = p->compiledPattern;
 
     int pcreOptions = convertToPcreOptions(matchOptions);
 
@@ -1279,7 +1511,7 @@ QRegularExpressionMatchPrivate *QRegularExpressionPrivate::doMatch(const QString
         if (result == PCRE_ERROR_NOMATCH) {
             ++offset;
 
-            if (usingCrLfNewlines
+            if (p->usingCrLfNewlines
                     && offset < subjectLength
                     && subjectUtf16[offset - 1] == QLatin1Char('\r')
                     && subjectUtf16[offset] == QLatin1Char('\n')) {
@@ -1512,7 +1744,7 @@ int QRegularExpression::captureCount() const
 {
     if (!isValid()) // will compile the pattern
         return -1;
-    return d->capturingCount;
+    return d->compiled->capturingCount;
 }
 
 /*!
@@ -1558,15 +1790,15 @@ QStringList QRegularExpression::namedCaptureGroups() const
     int namedCapturingTableEntryCount;
     int namedCapturingTableEntrySize;
 
-    pcre16_fullinfo(d->compiledPattern, 0, PCRE_INFO_NAMETABLE, &namedCapturingTable);
-    pcre16_fullinfo(d->compiledPattern, 0, PCRE_INFO_NAMECOUNT, &namedCapturingTableEntryCount);
-    pcre16_fullinfo(d->compiledPattern, 0, PCRE_INFO_NAMEENTRYSIZE, &namedCapturingTableEntrySize);
+    pcre16_fullinfo(d->compiled->compiledPattern, 0, PCRE_INFO_NAMETABLE, &namedCapturingTable);
+    pcre16_fullinfo(d->compiled->compiledPattern, 0, PCRE_INFO_NAMECOUNT, &namedCapturingTableEntryCount);
+    pcre16_fullinfo(d->compiled->compiledPattern, 0, PCRE_INFO_NAMEENTRYSIZE, &namedCapturingTableEntrySize);
 
     QStringList result;
 
     // no QList::resize nor fill is available. The +1 is for the implicit group #0
-    result.reserve(d->capturingCount + 1);
-    for (int i = 0; i < d->capturingCount + 1; ++i)
+    result.reserve(d->compiled->capturingCount + 1);
+    for (int i = 0; i < d->compiled->capturingCount + 1; ++i)
         result.append(QString());
 
     for (int i = 0; i < namedCapturingTableEntryCount; ++i) {
@@ -1590,7 +1822,7 @@ QStringList QRegularExpression::namedCaptureGroups() const
 bool QRegularExpression::isValid() const
 {
     d.data()->compilePattern();
-    return d->compiledPattern;
+    return d->compiled->compiledPattern;
 }
 
 /*!
@@ -1602,8 +1834,8 @@ bool QRegularExpression::isValid() const
 QString QRegularExpression::errorString() const
 {
     d.data()->compilePattern();
-    if (d->errorString)
-        return QCoreApplication::translate("QRegularExpression", d->errorString);
+    if (d->compiled->errorString)
+        return QCoreApplication::translate("QRegularExpression", d->compiled->errorString);
     return QCoreApplication::translate("QRegularExpression", "no error");
 }
 
@@ -1617,7 +1849,7 @@ QString QRegularExpression::errorString() const
 int QRegularExpression::patternErrorOffset() const
 {
     d.data()->compilePattern();
-    return d->errorOffset;
+    return d->compiled->errorOffset;
 }
 
 /*!
@@ -1741,6 +1973,86 @@ QString QRegularExpression::escape(const QString &str)
     return result;
 }
 
+/*!
+    \since 5.3
+
+    Returns the maximum number of compiled patterns kept in the pattern cache.
+    The default limit is 256.
+
+    \sa setPatternCacheLimit(), clearPatternCache()
+*/
+int QRegularExpression::patternCacheLimit()
+{
+    QPcrePatternCache *c = patternCache();
+    if (!c)
+        return 0;
+
+    QMutexLocker locker(&patternCacheMutex);
+    return c->cache.maxCost();
+}
+
+/*!
+    \since 5.3
+
+    Sets the maximum number of compiled patterns kept in the pattern cache
+    to \a limit. If the cache currently holds more patterns than that, the
+    least recently used ones are removed. A limit of 0 disables the cache.
+
+    \sa patternCacheLimit(), clearPatternCache()
+*/
+void QRegularExpression::setPatternCacheLimit(int limit)
+{
+    QPcrePatternCache *c = patternCache();
+    if (!c)
+        return;
+
+    QMutexLocker locker(&patternCacheMutex);
+    const int count = c->cache.count();
+    c->cache.setMaxCost(qMax(limit, 0));
+    c->evictions += count - c->cache.count();
+}
+
+/*!
+    \since 5.3
+
+    Removes all the compiled patterns from the pattern cache. Existing
+    QRegularExpression objects keep working; the next QRegularExpression
+    object constructed with the same pattern compiles it again.
+
+    \sa patternCacheLimit(), setPatternCacheLimit()
+*/
+void QRegularExpression::clearPatternCache()
+{
+    QPcrePatternCache *c = patternCache();
+    if (!c)
+        return;
+
+    QMutexLocker locker(&patternCacheMutex);
+    c->cache.clear();
+}
+
+/*!
+    \internal
+
+    Returns the current state of the pattern cache; the counters are never
+    reset.
+*/
+QRegularExpressionCacheStatistics qt_qregularexpression_cache_statistics()
+{
+    QRegularExpressionCacheStatistics statistics = { 0, 0, 0, 0, 0 };
+    QPcrePatternCache *c = patternCache();
+    if (!c)
+        return statistics;
+
+    QMutexLocker locker(&patternCacheMutex);
+    statistics.count = c->cache.count();
+    statistics.limit = c->cache.maxCost();
+    statistics.hits = c->hits;
+    statistics.misses = c->misses;
+    statistics.evictions = c->evictions;
+    return statistics;
+}
+
 /*!
     \since 5.1
 
@@ -2250,6 +2562,442 @@ QRegularExpression::MatchOptions QRegularExpressionMatchIterator::matchOptions()
     return d->matchOptions;
 }
 
+/*!
+    \internal
+*/
+QRegularExpressionSetPrivate::QRegularExpressionSetPrivate()
+    : expressions(),
+      mutex(),
+      isDirty(true)
+{
+}
+
+/*!
+    \internal
+
+    Copies only the expressions; the programs are rebuilt on the next match.
+*/
+QRegularExpressionSetPrivate::QRegularExpressionSetPrivate(const QRegularExpressionSetPrivate &other)
+    : QSharedData(other),
+      expressions(other.expressions),
+      mutex(),
+      isDirty(true)
+{
+}
+
+/*!
+    \internal
+
+    Returns the inline option setting equivalent to the given \a options,
+    which must not contain DontCaptureOption or UseUnicodePropertiesOption.
+*/
+static QString inlinePatternOptions(QRegularExpression::PatternOptions options)
+{
+    static const struct {
+        QRegularExpression::PatternOption option;
+        char letter;
+    } inlineOptions[] = {
+        { QRegularExpression::CaseInsensitiveOption, 'i' },
+        { QRegularExpression::MultilineOption, 'm' },
+        { QRegularExpression::DotMatchesEverythingOption, 's' },
+        { QRegularExpression::ExtendedPatternSyntaxOption, 'x' },
+        { QRegularExpression::InvertedGreedinessOption, 'U' }
+    };
+    const int inlineOptionCount = sizeof(inlineOptions) / sizeof(inlineOptions[0]);
+
+    QString set;
+    QString unset;
+    for (int i = 0; i < inlineOptionCount; ++i) {
+        if (options & inlineOptions[i].option)
+            set += QLatin1Char(inlineOptions[i].letter);
+        else
+            unset += QLatin1Char(inlineOptions[i].letter);
+    }
+
+    QString result = QStringLiteral("(?") + set;
+    if (!unset.isEmpty())
+        result += QLatin1Char('-') + unset;
+    result += QLatin1Char(')');
+    return result;
+}
+
+/*!
+    \internal
+
+    Returns true if \a re can be embedded in a combined program, that is, if
+    wrapping it in a group and putting it next to other patterns doesn't
+    change what it matches nor the numbers of its capturing groups. The names
+    of its capturing groups are added to \a groupNames, as the combined
+    program can't have duplicated names.
+*/
+bool QRegularExpressionSetPrivate::canCombine(const QRegularExpression &re,
+                                              QSet<QString> *groupNames) const
+{
+    const QRegularExpression::PatternOptions options = re.patternOptions();
+    if (options & (QRegularExpression::DontCaptureOption | QRegularExpression::UseUnicodePropertiesOption))
+        return false;
+
+    // back references would need renumbering
+    int backReferenceMax = 0;
+    pcre16_fullinfo(re.d->compiled->compiledPattern, 0, PCRE_INFO_BACKREFMAX, &backReferenceMax);
+    if (backReferenceMax > 0)
+        return false;
+
+    // verbs and start-of-pattern settings, recursion, subroutine calls and
+    // conditions refer to the whole pattern or to group numbers; \Q without
+    // \E would quote the closing parenthesis of the wrapping group. This is
+    // a conservative textual check: false positives only cost a separate scan.
+    const QString pattern = re.pattern();
+    static const char * const unsafeSequences[] = {
+        "(*", "(?R", "(?(", "(?&", "(?P>", "\\g", "\\Q"
+    };
+    const int unsafeSequenceCount = sizeof(unsafeSequences) / sizeof(unsafeSequences[0]);
+    for (int i = 0; i < unsafeSequenceCount; ++i) {
+        if (pattern.contains(QLatin1String(unsafeSequences[i])))
+            return false;
+    }
+
+    for (int i = pattern.indexOf(QLatin1String("(?")); i != -1; i = pattern.indexOf(QLatin1String("(?"), i + 2)) {
+        int j = i + 2;
+        if (j < pattern.length() && (pattern.at(j) == QLatin1Char('+') || pattern.at(j) == QLatin1Char('-')))
+            ++j;
+        if (j < pattern.length() && pattern.at(j).isDigit())
+            return false;
+    }
+
+    // a comment running to the end of the pattern would swallow the closing
+    // parenthesis; the extended syntax case is handled by addProgram(), the
+    // inline (?x) one is not worth parsing for
+    if (pattern.contains(QLatin1Char('#')) && !(options & QRegularExpression::ExtendedPatternSyntaxOption)
+            && pattern.contains(QLatin1String("(?"))) {
+        return false;
+    }
+
+    const QStringList names = re.namedCaptureGroups();
+    for (int i = 1; i < names.size(); ++i) {
+        if (!names.at(i).isEmpty() && groupNames->contains(names.at(i)))
+            return false;
+    }
+    for (int i = 1; i < names.size(); ++i) {
+        if (!names.at(i).isEmpty())
+            groupNames->insert(names.at(i));
+    }
+
+    return true;
+}
+
+/*!
+    \internal
+
+    Builds a combined program out of the expressions at \a indexes. If PCRE
+    refuses it (for instance, because it exceeds the maximum compiled pattern
+    size), the patterns are split over two programs.
+*/
+void QRegularExpressionSetPrivate::addProgram(const QVector<int> &indexes)
+{
+    if (indexes.size() < 2) {
+        separate += indexes;
+        return;
+    }
+
+    Program program;
+    program.branches.reserve(indexes.size());
+
+    QString pattern;
+    int group = 1;
+    for (int i = 0; i < indexes.size(); ++i) {
+        const QRegularExpression &re = expressions.at(indexes.at(i));
+
+        if (i > 0)
+            pattern += QLatin1Char('|');
+        pattern += QLatin1Char('(');
+        pattern += inlinePatternOptions(re.patternOptions());
+        pattern += re.pattern();
+        // terminate a trailing comment
+        if (re.patternOptions() & QRegularExpression::ExtendedPatternSyntaxOption)
+            pattern += QLatin1Char('\n');
+        pattern += QLatin1Char(')');
+
+        Branch branch;
+        branch.index = indexes.at(i);
+        branch.group = group;
+        branch.captureCount = re.captureCount();
+        program.branches.append(branch);
+
+        group += 1 + branch.captureCount;
+    }
+
+    program.re.setPattern(pattern);
+    if (program.re.isValid()) {
+        programs.append(program);
+    } else {
+        const int half = indexes.size() / 2;
+        addProgram(indexes.mid(0, half));
+        addProgram(indexes.mid(half));
+    }
+}
+
+/*!
+    \internal
+*/
+void QRegularExpressionSetPrivate::compile()
+{
+    QMutexLocker lock(&mutex);
+
+    if (!isDirty)
+        return;
+
+    isDirty = false;
+    programs.clear();
+    separate.clear();
+
+    QSet<QString> groupNames;
+    QVector<int> pending;
+    int pendingLength = 0;
+
+    for (int i = 0; i < expressions.size(); ++i) {
+        const QRegularExpression &re = expressions.at(i);
+
+        // invalid patterns never match
+        if (!re.isValid())
+            continue;
+
+        if (!canCombine(re, &groupNames)) {
+            separate.append(i);
+            continue;
+        }
+
+        pending.append(i);
+        pendingLength += re.pattern().length();
+        if (pending.size() == MaximumBranchCount || pendingLength >= MaximumProgramLength) {
+            addProgram(pending);
+            pending.clear();
+            pendingLength = 0;
+        }
+    }
+
+    addProgram(pending);
+
+    std::sort(separate.begin(), separate.end());
+}
+
+/*!
+    Constructs an empty QRegularExpressionSet.
+*/
+QRegularExpressionSet::QRegularExpressionSet()
+    : d(new QRegularExpressionSetPrivate)
+{
+}
+
+/*!
+    Constructs a QRegularExpressionSet holding the given \a expressions.
+*/
+QRegularExpressionSet::QRegularExpressionSet(const QList<QRegularExpression> &expressions)
+    : d(new QRegularExpressionSetPrivate)
+{
+    d->expressions = expressions;
+}
+
+/*!
+    Constructs a QRegularExpressionSet holding one regular expression for each
+    pattern string in \a patterns, all of them using the pattern options
+    \a options.
+*/
+QRegularExpressionSet::QRegularExpressionSet(const QStringList &patterns,
+                                             QRegularExpression::PatternOptions options)
+    : d(new QRegularExpressionSetPrivate)
+{
+    d->expressions.reserve(patterns.size());
+    for (int i = 0; i < patterns.size(); ++i)
+        d->expressions.append(QRegularExpression(patterns.at(i), options));
+}
+
+/*!
+    Constructs a QRegularExpressionSet object as a copy of \a other.
+*/
+QRegularExpressionSet::QRegularExpressionSet(const QRegularExpressionSet &other)
+    : d(other.d)
+{
+}
+
+/*!
+    Destroys the QRegularExpressionSet object.
+*/
+QRegularExpressionSet::~QRegularExpressionSet()
+{
+}
+
+/*!
+    Assigns \a other to this object, and returns a reference to the copy.
+*/
+QRegularExpressionSet &QRegularExpressionSet::operator=(const QRegularExpressionSet &other)
+{
+    d = other.d;
+    return *this;
+}
+
+/*!
+    \fn void QRegularExpressionSet::swap(QRegularExpressionSet &other)
+
+    Swaps the set \a other with this set. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    Returns the number of regular expressions in the set.
+
+    \sa isEmpty(), at()
+*/
+int QRegularExpressionSet::count() const
+{
+    return d->expressions.size();
+}
+
+/*!
+    \fn bool QRegularExpressionSet::isEmpty() const
+
+    Returns \c true if the set contains no regular expressions, or false
+    otherwise.
+*/
+
+/*!
+    Returns the regular expression at index position \a i in the set.
+    \a i must be a valid index position (i.e., 0 <= \a i < count()).
+*/
+QRegularExpression QRegularExpressionSet::at(int i) const
+{
+    return d->expressions.at(i);
+}
+
+/*!
+    Returns all the regular expressions in the set.
+*/
+QList<QRegularExpression> QRegularExpressionSet::expressions() const
+{
+    return d->expressions;
+}
+
+/*!
+    Appends the regular expression \a re to the set.
+*/
+void QRegularExpressionSet::append(const QRegularExpression &re)
+{
+    d.detach();
+    d->expressions.append(re);
+    d->isDirty = true;
+}
+
+/*!
+    Removes all the regular expressions from the set.
+*/
+void QRegularExpressionSet::clear()
+{
+    d.detach();
+    d->expressions.clear();
+    d->isDirty = true;
+}
+
+/*!
+    Returns \c true if all the regular expressions in the set are valid, or
+    false otherwise. Invalid regular expressions never match.
+
+    \sa QRegularExpression::isValid()
+*/
+bool QRegularExpressionSet::isValid() const
+{
+    for (int i = 0; i < d->expressions.size(); ++i) {
+        if (!d->expressions.at(i).isValid())
+            return false;
+    }
+    return true;
+}
+
+/*!
+    Attempts to match all the regular expressions in the set against the
+    \a subject string, starting at the position \a offset inside the
+    subject, and returns the leftmost match. If more than one regular
+    expression matches at that position, the one with the lowest index in
+    the set wins. If \a index is not null, it is set to the index of that
+    regular expression, or to -1 if none of them matched.
+
+    The returned QRegularExpressionMatch refers to the regular expression
+    that matched, and its capturing groups are the ones of that regular
+    expression. If none of them matched, a valid QRegularExpressionMatch
+    without a match is returned.
+
+    This is considerably faster than calling QRegularExpression::match() on
+    each regular expression in turn, as most patterns are matched together
+    in a single scan of the subject.
+*/
+QRegularExpressionMatch QRegularExpressionSet::match(const QString &subject, int offset, int *index) const
+{
+    d.data()->compile();
+
+    QRegularExpressionMatch result;
+    int resultIndex = -1;
+    int resultStart = -1;
+
+    for (int p = 0; p < d->programs.size(); ++p) {
+        const QRegularExpressionSetPrivate::Program &program = d->programs.at(p);
+        const QRegularExpressionMatch match = program.re.match(subject, offset);
+        if (!match.hasMatch())
+            continue;
+
+        const int start = match.capturedStart();
+        for (int b = 0; b < program.branches.size(); ++b) {
+            const QRegularExpressionSetPrivate::Branch &branch = program.branches.at(b);
+            if (match.capturedStart(branch.group) == -1)
+                continue;
+
+            if (resultIndex == -1 || start < resultStart
+                    || (start == resultStart && branch.index < resultIndex)) {
+                const QRegularExpression &re = d->expressions.at(branch.index);
+                QRegularExpressionMatchPrivate *priv = new QRegularExpressionMatchPrivate(re, subject,
+                                                                                          QRegularExpression::NormalMatch,
+                                                                                          QRegularExpression::NoMatchOption,
+                                                                                          branch.captureCount + 1);
+                // group 0 comes from the combined program, so that \K works
+                priv->capturedOffsets[0] = start;
+                priv->capturedOffsets[1] = match.capturedEnd();
+                priv->capturedCount = 1;
+                for (int n = 1; n <= branch.captureCount; ++n) {
+                    priv->capturedOffsets[2 * n] = match.capturedStart(branch.group + n);
+                    priv->capturedOffsets[2 * n + 1] = match.capturedEnd(branch.group + n);
+                    if (priv->capturedOffsets.at(2 * n) != -1)
+                        priv->capturedCount = n + 1;
+                }
+                priv->capturedOffsets.resize(priv->capturedCount * 2);
+                priv->isValid = true;
+                priv->hasMatch = true;
+
+                result = QRegularExpressionMatch(*priv);
+                resultIndex = branch.index;
+                resultStart = start;
+            }
+            break;
+        }
+    }
+
+    for (int i = 0; i < d->separate.size(); ++i) {
+        const int separateIndex = d->separate.at(i);
+        const QRegularExpressionMatch match = d->expressions.at(separateIndex).match(subject, offset);
+        if (!match.hasMatch())
+            continue;
+
+        const int start = match.capturedStart();
+        if (resultIndex == -1 || start < resultStart
+                || (start == resultStart && separateIndex < resultIndex)) {
+            result = match;
+            resultIndex = separateIndex;
+            resultStart = start;
+        }
+    }
+
+    if (index)
+        *index = resultIndex;
+    return result;
+}
+
 #ifndef QT_NO_DATASTREAM
 /*!
     \relates QRegularExpression
@@ -57,6 +57,7 @@ QT_BEGIN_NAMESPACE
 class QRegularExpressionMatch;
 class QRegularExpressionMatchIterator;
 struct QRegularExpressionPrivate;
+struct QRegularExpressionSetPrivate;
 
 class Q_CORE_EXPORT QRegularExpression
 {
@@ -124,6 +125,10 @@ public:
 
     static QString escape(const QString &str);
 
+    static int patternCacheLimit();
+    static void setPatternCacheLimit(int limit);
+    static void clearPatternCache();
+
     bool operator==(const QRegularExpression &re) const;
     inline bool operator!=(const QRegularExpression &re) const { return !operator==(re); }
 
@@ -132,6 +137,7 @@ private:
     friend class QRegularExpressionMatch;
     friend struct QRegularExpressionMatchPrivate;
     friend class QRegularExpressionMatchIterator;
+    friend struct QRegularExpressionSetPrivate;
 
     QRegularExpression(QRegularExpressionPrivate &dd);
     QExplicitlySharedDataPointer<QRegularExpressionPrivate> d;
@@ -198,6 +204,7 @@ private:
     friend class QRegularExpression;
     friend struct QRegularExpressionMatchPrivate;
     friend class QRegularExpressionMatchIterator;
+    friend class QRegularExpressionSet;
 
     QRegularExpressionMatch(QRegularExpressionMatchPrivate &dd);
     QSharedDataPointer<QRegularExpressionMatchPrivate> d;
@@ -243,6 +250,40 @@ private:
 
 Q_DECLARE_SHARED(QRegularExpressionMatchIterator)
 
+class Q_CORE_EXPORT QRegularExpressionSet
+{
+public:
+    QRegularExpressionSet();
+    explicit QRegularExpressionSet(const QList<QRegularExpression> &expressions);
+    explicit QRegularExpressionSet(const QStringList &patterns,
+                                   QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption);
+    QRegularExpressionSet(const QRegularExpressionSet &other);
+    ~QRegularExpressionSet();
+    QRegularExpressionSet &operator=(const QRegularExpressionSet &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    inline QRegularExpressionSet &operator=(QRegularExpressionSet &&other)
+    { d.swap(other.d); return *this; }
+#endif
+    void swap(QRegularExpressionSet &other) { d.swap(other.d); }
+
+    int count() const;
+    inline bool isEmpty() const { return count() == 0; }
+    QRegularExpression at(int i) const;
+    QList<QRegularExpression> expressions() const;
+
+    void append(const QRegularExpression &re);
+    void clear();
+
+    bool isValid() const;
+
+    QRegularExpressionMatch match(const QString &subject, int offset = 0, int *index = 0) const;
+
+private:
+    QExplicitlySharedDataPointer<QRegularExpressionSetPrivate> d;
+};
+
+Q_DECLARE_SHARED(QRegularExpressionSet)
+
 QT_END_NAMESPACE
 
 #endif // QT_NO_REGULAREXPRESSION
@@ -21,6 +21,8 @@ HEADERS +=  \
         tools/qdatetime_p.h \
         tools/qdatetimeparser_p.h \
         tools/qeasingcurve.h \
+        tools/qflathash.h \
+        tools/qflatmap.h \
         tools/qfreelist_p.h \
         tools/qhash.h \
         tools/qiterator.h \
@@ -34,6 +36,9 @@ HEADERS +=  \
         tools/qmap.h \
         tools/qmargins.h \
         tools/qmessageauthenticationcode.h \
+        tools/qmultibytearraymatcher.h \
+        tools/qmultimatcher_p.h \
+        tools/qmultistringmatcher.h \
         tools/qcontiguouscache.h \
         tools/qpodlist_p.h \
         tools/qpair.h \
@@ -42,6 +47,7 @@ HEADERS +=  \
         tools/qrect.h \
         tools/qregexp.h \
         tools/qregularexpression.h \
+        tools/qregularexpression_p.h \
         tools/qringbuffer_p.h \
         tools/qrefcount.h \
         tools/qscopedpointer.h \
@@ -90,10 +96,14 @@ SOURCES += \
         tools/qlist.cpp \
         tools/qlocale.cpp \
         tools/qlocale_tools.cpp \
+        tools/qlocale_fastdouble.cpp \
         tools/qpoint.cpp \
         tools/qmap.cpp \
         tools/qmargins.cpp \
         tools/qmessageauthenticationcode.cpp \
+        tools/qmultibytearraymatcher.cpp \
+        tools/qmultimatcher.cpp \
+        tools/qmultistringmatcher.cpp \
         tools/qcontiguouscache.cpp \
         tools/qrect.cpp \
         tools/qregexp.cpp \
@@ -94,6 +94,7 @@ SOURCES += \
            ../../corelib/tools/qlinkedlist.cpp \
            ../../corelib/tools/qlocale.cpp \
            ../../corelib/tools/qlocale_tools.cpp \
+           ../../corelib/tools/qlocale_fastdouble.cpp \
            ../../corelib/tools/qmap.cpp \
            ../../corelib/tools/qregexp.cpp \
            ../../corelib/tools/qpoint.cpp \
@@ -154,6 +154,20 @@ RCCFileInfo::~RCCFileInfo()
     qDeleteAll(m_children);
 }
 
+static bool qt_rcc_compare_name(const RCCFileInfo *left, const RCCFileInfo *right)
+{
+    return left->m_name < right->m_name;
+}
+
+// QHash order depends on the hash function and its seed; walk the
+// children by name so the generated output doesn't.
+static QList<RCCFileInfo*> sortedChildren(const RCCFileInfo *file)
+{
+    QList<RCCFileInfo*> children = file->m_children.values();
+    std::stable_sort(children.begin(), children.end(), qt_rcc_compare_name);
+    return children;
+}
+
 QString RCCFileInfo::resourceName() const
 {
     QString resource = m_name;
@@ -679,9 +693,9 @@ QStringList RCCResourceLibrary::dataFiles() const
     pending.push(m_root);
     while (!pending.isEmpty()) {
         RCCFileInfo *file = pending.pop();
-        for (QHash<QString, RCCFileInfo*>::iterator it = file->m_children.begin();
-            it != file->m_children.end(); ++it) {
-            RCCFileInfo *child = it.value();
+        const QList<RCCFileInfo*> children = sortedChildren(file);
+        for (int i = 0; i < children.size(); ++i) {
+            RCCFileInfo *child = children.at(i);
             if (child->m_flags & RCCFileInfo::Directory)
                 pending.push(child);
             ret.append(child->m_fileInfo.filePath());
@@ -828,9 +842,9 @@ bool RCCResourceLibrary::writeDataBlobs()
     QString errorMessage;
     while (!pending.isEmpty()) {
         RCCFileInfo *file = pending.pop();
-        for (QHash<QString, RCCFileInfo*>::iterator it = file->m_children.begin();
-            it != file->m_children.end(); ++it) {
-            RCCFileInfo *child = it.value();
+        const QList<RCCFileInfo*> children = sortedChildren(file);
+        for (int i = 0; i < children.size(); ++i) {
+            RCCFileInfo *child = children.at(i);
             if (child->m_flags & RCCFileInfo::Directory)
                 pending.push(child);
             else {
@@ -864,9 +878,9 @@ bool RCCResourceLibrary::writeDataNames()
     qint64 offset = 0;
     while (!pending.isEmpty()) {
         RCCFileInfo *file = pending.pop();
-        for (QHash<QString, RCCFileInfo*>::iterator it = file->m_children.begin();
-            it != file->m_children.end(); ++it) {
-            RCCFileInfo *child = it.value();
+        const QList<RCCFileInfo*> children = sortedChildren(file);
+        for (int i = 0; i < children.size(); ++i) {
+            RCCFileInfo *child = children.at(i);
             if (child->m_flags & RCCFileInfo::Directory)
                 pending.push(child);
             if (names.contains(child->m_name)) {
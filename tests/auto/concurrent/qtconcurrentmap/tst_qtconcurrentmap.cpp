@@ -70,6 +70,8 @@ private slots:
     void qFutureAssignmentLeak();
     void stressTest();
     void persistentResultTest();
+    void mappedStreamed();
+    void mappedStreamedCancel();
 public slots:
     void throttling();
 };
@@ -2431,5 +2433,98 @@ void tst_QtConcurrentMap::persistentResultTest()
     QCOMPARE(ref.loadAcquire(), 3);
 }
 
+static QAtomicInt streamedComputed;
+
+static int countedSquare(int x)
+{
+    streamedComputed.ref();
+    return x * x;
+}
+
+void tst_QtConcurrentMap::mappedStreamed()
+{
+    QList<int> list;
+    for (int i = 0; i < 10000; ++i)
+        list << i;
+
+    const int bufferSizes[] = { 1, 7, 100 };
+    for (uint b = 0; b < sizeof(bufferSizes) / sizeof(bufferSizes[0]); ++b) {
+        const int bufferSize = bufferSizes[b];
+        streamedComputed.store(0);
+
+        QFuture<int> future = QtConcurrent::mappedStreamed(list, countedSquare, bufferSize);
+        int taken = 0;
+        while (future.hasNextResult()) {
+            // the map function never runs further ahead than the buffer allows
+            QVERIFY(streamedComputed.load() <= taken + bufferSize);
+            const int result = future.takeNextResult();
+            QCOMPARE(result, taken * taken);
+            ++taken;
+        }
+        QCOMPARE(taken, list.count());
+        QVERIFY(future.isFinished());
+        QVERIFY(!future.isCanceled());
+        QCOMPARE(future.resultCount(), list.count());
+    }
+
+    // iterator ranges, including ones that are not random access
+    {
+        QFuture<int> future = QtConcurrent::mappedStreamed(list.constBegin(), list.constEnd(),
+                                                           countedSquare, 16);
+        int taken = 0;
+        while (future.hasNextResult()) {
+            QCOMPARE(future.takeNextResult(), taken * taken);
+            ++taken;
+        }
+        QCOMPARE(taken, list.count());
+    }
+    {
+        QLinkedList<int> linkedList;
+        for (int i = 0; i < 1000; ++i)
+            linkedList << i;
+        QFuture<int> future = QtConcurrent::mappedStreamed(linkedList, countedSquare, 16);
+        int taken = 0;
+        while (future.hasNextResult()) {
+            QCOMPARE(future.takeNextResult(), taken * taken);
+            ++taken;
+        }
+        QCOMPARE(taken, linkedList.count());
+    }
+
+    // empty sequence
+    {
+        QFuture<int> future = QtConcurrent::mappedStreamed(QList<int>(), countedSquare);
+        QVERIFY(!future.hasNextResult());
+    }
+}
+
+void tst_QtConcurrentMap::mappedStreamedCancel()
+{
+    QList<int> list;
+    for (int i = 0; i < 10000; ++i)
+        list << i;
+
+    // canceling releases the waiting threads
+    {
+        streamedComputed.store(0);
+        QFuture<int> future = QtConcurrent::mappedStreamed(list, countedSquare, 10);
+        QCOMPARE(future.takeNextResult(), 0);
+        future.cancel();
+        future.waitForFinished();
+        QVERIFY(streamedComputed.load() <= 11);
+    }
+
+    // and so does dropping the future without taking all results
+    {
+        streamedComputed.store(0);
+        {
+            QFuture<int> future = QtConcurrent::mappedStreamed(list, countedSquare, 10);
+            QCOMPARE(future.takeNextResult(), 0);
+        }
+        QVERIFY(QThreadPool::globalInstance()->waitForDone(10000));
+        QVERIFY(streamedComputed.load() <= 11);
+    }
+}
+
 QTEST_MAIN(tst_QtConcurrentMap)
 #include "tst_qtconcurrentmap.moc"
@@ -73,6 +73,10 @@ private slots:
 
     void nonCharacters_data();
     void nonCharacters();
+
+    void asciiBlockBoundaries_data();
+    void asciiBlockBoundaries();
+    void asciiBlockBoundariesWithoutAvx2();
 };
 
 void tst_Utf8::initTestCase()
@@ -293,5 +297,87 @@ void tst_Utf8::nonCharacters()
         qWarning("System codec reports failure when it shouldn't. Should report bug upstream.");
 }
 
+void tst_Utf8::asciiBlockBoundaries_data()
+{
+    QTest::addColumn<QByteArray>("sequence");
+    QTest::addColumn<QString>("utf16");
+    QTest::addColumn<QByteArray>("suffix");
+    QTest::addColumn<bool>("valid");
+
+    static const char suffix[] = "after the multibyte sequence comes more US-ASCII text";
+    static const ushort utf16_4[] = { 0xd800, 0xdf03, 0 };
+
+    QTest::newRow("2-byte") << QByteArray("\303\251") << QString(QChar(0xe9))
+                            << QByteArray(suffix) << true;
+    QTest::newRow("3-byte") << QByteArray("\342\202\254") << QString(QChar(0x20ac))
+                            << QByteArray(suffix) << true;
+    QTest::newRow("4-byte") << QByteArray("\360\220\214\203") << QString::fromUtf16(utf16_4)
+                            << QByteArray(suffix) << true;
+    QTest::newRow("invalid-byte") << QByteArray("\377") << QString(QChar(QChar::ReplacementCharacter))
+                                  << QByteArray(suffix) << false;
+    QTest::newRow("continuation-byte") << QByteArray("\200") << QString(QChar(QChar::ReplacementCharacter))
+                                       << QByteArray(suffix) << false;
+    QTest::newRow("truncated") << QByteArray("\342\202") << QString(2, QChar(QChar::ReplacementCharacter))
+                               << QByteArray(suffix) << false;
+    QTest::newRow("overlong") << QByteArray("\300\200") << QString(QChar(QChar::ReplacementCharacter))
+                              << QByteArray(suffix) << false;
+}
+
+void tst_Utf8::asciiBlockBoundaries()
+{
+    QFETCH(QByteArray, sequence);
+    QFETCH(QString, utf16);
+    QFETCH(QByteArray, suffix);
+    QFETCH(bool, valid);
+    QFETCH_GLOBAL(bool, useLocale);
+
+    // Only enforce the replacement characters on our UTF-8 decoder
+    if (!valid && useLocale)
+        QSKIP("The system's UTF-8 codec may replace invalid sequences differently");
+
+    // the ASCII fast paths work on blocks of up to 32 bytes; put the
+    // sequence at every position around the first few block boundaries
+    for (int len = 0; len <= 100; ++len) {
+        const QByteArray prefix(len, 'a');
+        const QByteArray utf8 = prefix + sequence + suffix;
+        const QString expected = QString::fromLatin1(prefix) + utf16 + QString::fromLatin1(suffix);
+
+        QCOMPARE(from8Bit(utf8), expected);
+
+        QSharedPointer<QTextDecoder> decoder(codec->makeDecoder());
+        QCOMPARE(decoder->toUnicode(utf8), expected);
+        if (!useLocale)
+            QCOMPARE(decoder->hasFailure(), !valid);
+
+        if (valid)
+            QCOMPARE((expected.*to8Bit)(), utf8);
+    }
+}
+
+void tst_Utf8::asciiBlockBoundariesWithoutAvx2()
+{
+#ifdef QT_NO_PROCESS
+    QSKIP("This test requires QProcess support");
+#else
+    // The AVX2 kernels are picked at run time, so asciiBlockBoundaries only
+    // covers them on a machine with AVX2. Run it again with AVX2 disabled
+    // so that the SSE2 kernels get covered on such a machine too.
+    if (!qgetenv("QT_NO_CPU_FEATURE").isEmpty())
+        QSKIP("CPU features are already restricted by QT_NO_CPU_FEATURE");
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert(QStringLiteral("QT_NO_CPU_FEATURE"), QStringLiteral("avx2"));
+
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(QCoreApplication::applicationFilePath(),
+                  QStringList() << QStringLiteral("asciiBlockBoundaries"));
+    QVERIFY2(process.waitForFinished(), qPrintable(process.errorString()));
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+    QVERIFY2(process.exitCode() == 0, process.readAll().constData());
+#endif
+}
+
 QTEST_MAIN(tst_Utf8)
 #include "tst_utf8.moc"
@@ -49,6 +49,11 @@
 #include <qstringlist.h>
 
 #include <QtCore/private/qfsfileengine_p.h>
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_LINUX)
+#  include <QtCore/private/qfilesystemengine_p.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
 
 #if defined(Q_OS_VXWORKS)
 #define Q_NO_SYMLINKS
@@ -116,6 +121,10 @@ private slots:
     void longPath();
     void dirorder();
     void relativePaths();
+    void parallelSubdirectories_data();
+    void parallelSubdirectories();
+    void parallelSubdirectoriesStopEarly();
+    void parallelSubdirectoriesLargeDirectories();
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINCE)
     void uncPaths_data();
     void uncPaths();
@@ -123,6 +132,14 @@ private slots:
 #ifndef Q_OS_WIN
     void hiddenDirs_hiddenFiles();
 #endif
+#if !defined(Q_NO_SYMLINKS) && !defined(Q_OS_WIN)
+    void symLinkTypes_data();
+    void symLinkTypes();
+#endif
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_LINUX)
+    void unknownEntryTypes_data();
+    void unknownEntryTypes();
+#endif
 };
 
 void tst_QDirIterator::initTestCase()
@@ -580,6 +597,166 @@ void tst_QDirIterator::relativePaths()
     }
 }
 
+static bool createTree(const QString &path, int depth)
+{
+    QDir dir(path);
+    for (int i = 0; i < 5; ++i) {
+        QFile file(dir.filePath(QString::fromLatin1("file%1.txt").arg(i)));
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+    }
+    if (!QFile(dir.filePath(".hidden")).open(QIODevice::WriteOnly))
+        return false;
+    if (depth == 0)
+        return true;
+    for (int i = 0; i < 4; ++i) {
+        const QString subdirectory = QString::fromLatin1("dir%1").arg(i);
+        if (!dir.mkdir(subdirectory) || !createTree(dir.filePath(subdirectory), depth - 1))
+            return false;
+    }
+#ifndef Q_NO_SYMLINKS_TO_DIRS
+    if (!QFile::link("dir0", dir.filePath("link")))
+        return false;
+#endif
+    return dir.mkdir(".hiddendir");
+}
+
+static QStringList listEntries(const QString &path, QDir::Filters filters,
+                               QDirIterator::IteratorFlags flags,
+                               const QStringList &nameFilters = QStringList())
+{
+    QStringList entries;
+    QDirIterator it(path, nameFilters, filters, flags);
+    while (it.hasNext()) {
+        entries << it.next();
+        if (it.fileInfo().filePath() != entries.last())
+            return QStringList() << "fileInfo() does not match next()";
+    }
+    return entries;
+}
+
+void tst_QDirIterator::parallelSubdirectories_data()
+{
+    QTest::addColumn<QDir::Filters>("filters");
+    QTest::addColumn<QDirIterator::IteratorFlags>("flags");
+    QTest::addColumn<QStringList>("nameFilters");
+
+    QTest::newRow("AllEntries")
+        << QDir::Filters(QDir::AllEntries)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories)
+        << QStringList();
+    QTest::newRow("AllEntries|Hidden|NoDotAndDotDot")
+        << QDir::Filters(QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories)
+        << QStringList();
+    QTest::newRow("Files")
+        << QDir::Filters(QDir::Files)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories)
+        << QStringList();
+    QTest::newRow("Dirs|NoSymLinks")
+        << QDir::Filters(QDir::Dirs | QDir::NoSymLinks)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories)
+        << QStringList();
+    QTest::newRow("Files, FollowSymlinks")
+        << QDir::Filters(QDir::Files)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories | QDirIterator::FollowSymlinks)
+        << QStringList();
+    QTest::newRow("Files, name filters")
+        << QDir::Filters(QDir::Files)
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories)
+        << (QStringList() << "file1*" << "*2.TXT");
+}
+
+void tst_QDirIterator::parallelSubdirectories()
+{
+    QFETCH(QDir::Filters, filters);
+    QFETCH(QDirIterator::IteratorFlags, flags);
+    QFETCH(QStringList, nameFilters);
+
+    QTemporaryDir tree;
+    QVERIFY(tree.isValid());
+    QVERIFY(createTree(tree.path(), 3));
+
+    const QStringList expected = listEntries(tree.path(), filters, flags, nameFilters);
+    QVERIFY(expected.size() > 100);
+
+    // same entries, in the same order
+    QCOMPARE(listEntries(tree.path(), filters, flags | QDirIterator::ParallelSubdirectories,
+                         nameFilters),
+             expected);
+
+    // same entries, in any order
+    QStringList unordered = listEntries(tree.path(), filters,
+        flags | QDirIterator::ParallelSubdirectories | QDirIterator::UnorderedResults,
+        nameFilters);
+    QStringList sortedExpected = expected;
+    unordered.sort();
+    sortedExpected.sort();
+    QCOMPARE(unordered, sortedExpected);
+
+    // without Subdirectories the flag does nothing
+    QCOMPARE(listEntries(tree.path(), filters, QDirIterator::ParallelSubdirectories, nameFilters),
+             listEntries(tree.path(), filters, QDirIterator::NoIteratorFlags, nameFilters));
+}
+
+void tst_QDirIterator::parallelSubdirectoriesStopEarly()
+{
+    QTemporaryDir tree;
+    QVERIFY(tree.isValid());
+    QVERIFY(createTree(tree.path(), 4));
+
+    // Destroying the iterators while the pool is still listing must be safe
+    for (int i = 0; i < 20; ++i) {
+        QDirIterator ordered(tree.path(), QDir::Files,
+                             QDirIterator::Subdirectories | QDirIterator::ParallelSubdirectories);
+        QDirIterator unordered(tree.path(), QDir::Files,
+                               QDirIterator::Subdirectories | QDirIterator::ParallelSubdirectories
+                               | QDirIterator::UnorderedResults);
+        for (int j = 0; j < i; ++j) {
+            QVERIFY(ordered.hasNext());
+            QVERIFY(unordered.hasNext());
+            ordered.next();
+            unordered.next();
+        }
+    }
+}
+
+void tst_QDirIterator::parallelSubdirectoriesLargeDirectories()
+{
+    QTemporaryDir tree;
+    QVERIFY(tree.isValid());
+
+    // Directories much larger than the chunks they are listed in, with
+    // subdirectories found in the middle of the listing
+    QDir dir(tree.path());
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 700; ++j) {
+            QFile file(dir.filePath(QString::fromLatin1("file%1.txt").arg(j)));
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+        QVERIFY(dir.mkdir("sub"));
+        QVERIFY(dir.mkdir("other"));
+        QVERIFY(QFile(dir.filePath("other/file.txt")).open(QIODevice::WriteOnly));
+        QVERIFY(dir.cd("sub"));
+    }
+
+    const QDir::Filters filters = QDir::AllEntries | QDir::NoDotAndDotDot;
+    const QStringList expected = listEntries(tree.path(), filters, QDirIterator::Subdirectories);
+    QCOMPARE(expected.size(), 3 * 703);
+
+    QCOMPARE(listEntries(tree.path(), filters,
+                         QDirIterator::Subdirectories | QDirIterator::ParallelSubdirectories),
+             expected);
+
+    QStringList unordered = listEntries(tree.path(), filters,
+        QDirIterator::Subdirectories | QDirIterator::ParallelSubdirectories
+        | QDirIterator::UnorderedResults);
+    QStringList sortedExpected = expected;
+    unordered.sort();
+    sortedExpected.sort();
+    QCOMPARE(unordered, sortedExpected);
+}
+
 #if defined(Q_OS_WIN) && !defined(Q_OS_WINCE)
 void tst_QDirIterator::uncPaths_data()
 {
@@ -640,6 +817,134 @@ void tst_QDirIterator::hiddenDirs_hiddenFiles()
 }
 #endif // Q_OS_WIN
 
+#if !defined(Q_NO_SYMLINKS) && !defined(Q_OS_WIN)
+void tst_QDirIterator::symLinkTypes_data()
+{
+    QTest::addColumn<QDirIterator::IteratorFlags>("flags");
+    QTest::addColumn<QDir::Filters>("filters");
+    QTest::addColumn<QStringList>("entries");
+
+    // all of these filters need to know what the symlinks point to
+    QTest::newRow("Files")
+        << QDirIterator::IteratorFlags(0) << QDir::Filters(QDir::Files)
+        << QString("entrylist/file,entrylist/linktofile.lnk,entrylist/writable").split(',');
+    QTest::newRow("Dirs")
+        << QDirIterator::IteratorFlags(0) << QDir::Filters(QDir::Dirs | QDir::NoDotAndDotDot)
+        << QString("entrylist/directory"
+#ifndef Q_NO_SYMLINKS_TO_DIRS
+                   ",entrylist/linktodirectory.lnk"
+#endif
+                   ).split(',');
+    QTest::newRow("NoSymLinks")
+        << QDirIterator::IteratorFlags(0)
+        << QDir::Filters(QDir::AllEntries | QDir::NoSymLinks | QDir::NoDotAndDotDot)
+        << QString("entrylist/file,entrylist/directory,entrylist/writable").split(',');
+    QTest::newRow("System")
+        << QDirIterator::IteratorFlags(0)
+        << QDir::Filters(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot)
+        << QString("entrylist/file,entrylist/linktofile.lnk,entrylist/directory,"
+#ifndef Q_NO_SYMLINKS_TO_DIRS
+                   "entrylist/linktodirectory.lnk,"
+#endif
+                   "entrylist/brokenlink.lnk,entrylist/writable").split(',');
+    QTest::newRow("Subdirectories")
+        << QDirIterator::IteratorFlags(QDirIterator::Subdirectories) << QDir::Filters(QDir::Files)
+        << QString("entrylist/file,entrylist/linktofile.lnk,entrylist/writable,"
+                   "entrylist/directory/dummy").split(',');
+}
+
+void tst_QDirIterator::symLinkTypes()
+{
+    QFETCH(QDirIterator::IteratorFlags, flags);
+    QFETCH(QDir::Filters, filters);
+    QFETCH(QStringList, entries);
+
+    QDirIterator it(QLatin1String("entrylist"), filters, flags);
+    QStringList list;
+    while (it.hasNext()) {
+        it.next();
+
+        // what the iterator found out while listing must match a fresh lookup
+        const QFileInfo info = it.fileInfo();
+        const QFileInfo expected(it.filePath());
+        QVERIFY2(info.exists() == expected.exists(), qPrintable(it.filePath()));
+        QVERIFY2(info.isSymLink() == expected.isSymLink(), qPrintable(it.filePath()));
+        QVERIFY2(info.isFile() == expected.isFile(), qPrintable(it.filePath()));
+        QVERIFY2(info.isDir() == expected.isDir(), qPrintable(it.filePath()));
+        QVERIFY2(info.isHidden() == expected.isHidden(), qPrintable(it.filePath()));
+        QVERIFY2(info.size() == expected.size(), qPrintable(it.filePath()));
+
+        // stopLinkLoop() leaves its links to the directory behind
+        if (!it.fileName().startsWith(QLatin1String("entrylist")))
+            list << it.filePath();
+    }
+
+    list.sort();
+    entries.sort();
+    QCOMPARE(list, entries);
+}
+#endif
+
+#if defined(QT_BUILD_INTERNAL) && defined(Q_OS_LINUX)
+void tst_QDirIterator::unknownEntryTypes_data()
+{
+    QTest::addColumn<QString>("fileName");
+
+    QTest::newRow("file") << QString("file");
+    QTest::newRow("directory") << QString("directory");
+    QTest::newRow("missing") << QString("nothing");
+#ifndef Q_NO_SYMLINKS
+    QTest::newRow("link to file") << QString("linktofile.lnk");
+#  ifndef Q_NO_SYMLINKS_TO_DIRS
+    QTest::newRow("link to directory") << QString("linktodirectory.lnk");
+#  endif
+    QTest::newRow("broken link") << QString("brokenlink.lnk");
+#endif
+}
+
+void tst_QDirIterator::unknownEntryTypes()
+{
+    // Some file systems report DT_UNKNOWN for every entry; the iterator then
+    // resolves the entry relative to the directory it is listing, starting
+    // without any known flags. That must agree with a lookup by path.
+    QFETCH(QString, fileName);
+
+    const int dirFd = ::open("entrylist", O_RDONLY | O_DIRECTORY);
+    QVERIFY(dirFd != -1);
+
+    QFileSystemMetaData metaData;
+    QFileSystemEngine::fillMetaData(dirFd, QFile::encodeName(fileName).constData(), metaData,
+                                    QFileSystemMetaData::LinkType
+                                    | QFileSystemMetaData::PosixStatFlags
+                                    | QFileSystemMetaData::UserPermissions
+                                    | QFileSystemMetaData::HiddenAttribute);
+    ::close(dirFd);
+
+    const QFileInfo expected(QLatin1String("entrylist/") + fileName);
+    if (!expected.exists()) {
+        QVERIFY(!metaData.hasFlags(QFileSystemMetaData::ExistsAttribute));
+        return;
+    }
+
+    QVERIFY(metaData.hasFlags(QFileSystemMetaData::ExistsAttribute
+                              | QFileSystemMetaData::LinkType
+                              | QFileSystemMetaData::FileType
+                              | QFileSystemMetaData::DirectoryType
+                              | QFileSystemMetaData::SizeAttribute
+                              | QFileSystemMetaData::UserPermissions
+                              | QFileSystemMetaData::HiddenAttribute));
+    QVERIFY(metaData.exists());
+    QCOMPARE(metaData.isLink(), expected.isSymLink());
+    QCOMPARE(metaData.isFile(), expected.isFile());
+    QCOMPARE(metaData.isDirectory(), expected.isDir());
+    QCOMPARE(metaData.isHidden(), expected.isHidden());
+    QCOMPARE(metaData.size(), expected.size());
+    QCOMPARE(bool(metaData.permissions() & QFile::ReadUser), expected.isReadable());
+    QCOMPARE(bool(metaData.permissions() & QFile::WriteUser), expected.isWritable());
+    QCOMPARE(bool(metaData.permissions() & QFile::ExeUser), expected.isExecutable());
+}
+#endif
+
 QTEST_MAIN(tst_QDirIterator)
 
 #include "tst_qdiriterator.moc"
@@ -55,6 +55,14 @@
 # if defined(Q_OS_WIN)
 #  include <windows.h>
 # endif
+# if defined(Q_OS_UNIX)
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <string.h>
+#  include <sys/resource.h>
+#  include <unistd.h>
+# endif
 
 Q_DECLARE_METATYPE(QProcess::ExitStatus);
 Q_DECLARE_METATYPE(QProcess::ProcessState);
@@ -126,6 +134,14 @@ private slots:
     void setStandardOutputFile2();
     void setStandardOutputProcess_data();
     void setStandardOutputProcess();
+#ifdef Q_OS_UNIX
+    void setStandardOutputDevice_data();
+    void setStandardOutputDevice();
+    void setStandardOutputDeviceFull();
+    void setStandardInputDevice();
+    void setStandardInputDeviceSequential();
+    void forwardThroughProcess();
+#endif
     void removeFileWhileProcessIsRunning();
     void fileWriterProcess();
     void switchReadChannels();
@@ -147,6 +163,9 @@ private slots:
     void nativeArguments();
 #endif
     void exitCodeTest();
+#ifdef Q_OS_UNIX
+    void exitCodeWithSigChldIgnored();
+#endif
     void systemEnvironment();
     void lockupsInStartDetached();
     void waitForReadyReadForNonexistantProcess();
@@ -1528,6 +1547,52 @@ void tst_QProcess::exitCodeTest()
     }
 }
 
+//-----------------------------------------------------------------------------
+#ifdef Q_OS_UNIX
+void tst_QProcess::exitCodeWithSigChldIgnored()
+{
+    // With SIGCHLD ignored, the kernel reaps children by itself and their
+    // exit status would be lost, so QProcess has to install its own handler.
+    struct SigChldIgnorer
+    {
+        SigChldIgnorer()
+        {
+            struct sigaction ignore;
+            memset(&ignore, 0, sizeof(ignore));
+            ignore.sa_handler = SIG_IGN;
+            ::sigaction(SIGCHLD, &ignore, &oldAction);
+        }
+        ~SigChldIgnorer()
+        {
+            // put the old disposition back, unless QProcess replaced ours
+            struct sigaction current;
+            ::sigaction(SIGCHLD, 0, &current);
+            if (!(current.sa_flags & SA_SIGINFO) && current.sa_handler == SIG_IGN)
+                ::sigaction(SIGCHLD, &oldAction, 0);
+        }
+        struct sigaction oldAction;
+    } ignorer;
+    Q_UNUSED(ignorer);
+
+    for (int i = 0; i < 3; ++i) {
+        QProcess process;
+        process.start("testExitCodes/testExitCodes " + QString::number(42 + i));
+        QVERIFY(process.waitForFinished(5000));
+        QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+        QCOMPARE(process.exitCode(), 42 + i);
+    }
+
+    {
+        QProcess process;
+        QSignalSpy finishedSpy(&process, SIGNAL(finished(int,QProcess::ExitStatus)));
+        process.start("testExitCodes/testExitCodes 7");
+        QTRY_COMPARE(finishedSpy.count(), 1);
+        QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+        QCOMPARE(process.exitCode(), 7);
+    }
+}
+#endif
+
 //-----------------------------------------------------------------------------
 void tst_QProcess::failToStart()
 {
@@ -2044,6 +2109,244 @@ void tst_QProcess::setStandardOutputProcess()
 }
 #endif
 
+//-----------------------------------------------------------------------------
+#if !defined(Q_OS_WINCE) && defined(Q_OS_UNIX)
+static QByteArray forwardingTestData(int size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; ++i)
+        data[i] = 'a' + i % 26;
+    return data;
+}
+
+static qint64 forwardedBytes(const QSignalSpy &spy)
+{
+    qint64 total = 0;
+    for (int i = 0; i < spy.count(); ++i)
+        total += spy.at(i).at(0).toLongLong();
+    return total;
+}
+
+void tst_QProcess::setStandardOutputDevice_data()
+{
+    QTest::addColumn<int>("channelToTest");
+    QTest::addColumn<bool>("append");
+
+    QTest::newRow("stdout") << int(QProcess::StandardOutput) << false;
+    QTest::newRow("stdout-append") << int(QProcess::StandardOutput) << true;
+    QTest::newRow("stderr") << int(QProcess::StandardError) << false;
+    QTest::newRow("stderr-append") << int(QProcess::StandardError) << true;
+}
+
+void tst_QProcess::setStandardOutputDevice()
+{
+    static const char data[] = "Original data. ";
+
+    QFETCH(int, channelToTest);
+    QFETCH(bool, append);
+
+    QFile file("data");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(data, sizeof data - 1);
+    if (append) {
+        file.close();
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    }
+
+    QProcess process;
+    const char *signal;
+    if (channelToTest == QProcess::StandardOutput) {
+        process.setStandardOutputDevice(&file);
+        signal = SIGNAL(standardOutputForwarded(qint64));
+    } else {
+        process.setStandardErrorDevice(&file);
+        signal = SIGNAL(standardErrorForwarded(qint64));
+    }
+    QSignalSpy spy(&process, signal);
+    QVERIFY(spy.isValid());
+
+    const QByteArray testdata = forwardingTestData(200000);
+    process.start("testProcessEcho2/testProcessEcho2");
+    process.write(testdata);
+    process.closeWriteChannel();
+    QPROCESS_VERIFY(process, waitForFinished());
+
+    // the forwarded channel never shows up in QProcess itself
+    QByteArray out = process.readAllStandardOutput();
+    QByteArray err = process.readAllStandardError();
+    if (channelToTest == QProcess::StandardOutput) {
+        QVERIFY(out.isEmpty());
+        QCOMPARE(err, testdata);
+    } else {
+        QCOMPARE(out, testdata);
+        QVERIFY(err.isEmpty());
+    }
+    QCOMPARE(forwardedBytes(spy), qint64(testdata.size()));
+
+    // the device position follows the forwarded data
+    QCOMPARE(file.pos(), qint64(sizeof data - 1 + testdata.size()));
+    file.write("!");
+    file.close();
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray(data) + testdata + '!');
+}
+
+static qint64 cpuTime(const struct rusage &usage)
+{
+    return qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+void tst_QProcess::setStandardOutputDeviceFull()
+{
+#ifndef F_SETPIPE_SZ
+    QSKIP("This test needs to shrink the capacity of a pipe");
+#else
+    int fds[2];
+    QVERIFY(::pipe(fds) == 0);
+    QVERIFY(::fcntl(fds[0], F_SETFL, O_NONBLOCK) == 0);
+    QVERIFY(::fcntl(fds[1], F_SETFL, O_NONBLOCK) == 0);
+    // a pipe of a single page is full long before the process is done
+    QVERIFY(::fcntl(fds[1], F_SETPIPE_SZ, 4096) != -1);
+
+    QFile pipe;
+    QVERIFY(pipe.open(fds[1], QIODevice::WriteOnly, QFileDevice::AutoCloseHandle));
+
+    QProcess process;
+    process.setStandardOutputDevice(&pipe);
+    QSignalSpy spy(&process, SIGNAL(standardOutputForwarded(qint64)));
+    QVERIFY(spy.isValid());
+    connect(&process, SIGNAL(finished(int)), &QTestEventLoop::instance(), SLOT(exitLoop()));
+
+    const QByteArray testdata = forwardingTestData(32768);
+    process.start("testProcessEcho/testProcessEcho");
+    process.write(testdata);
+    process.closeWriteChannel();
+
+    // the process exits with most of its output still in its pipe; waiting
+    // for the device must neither spin nor report the process as finished
+    struct rusage before, after;
+    QVERIFY(::getrusage(RUSAGE_SELF, &before) == 0);
+    QTestEventLoop::instance().enterLoop(2);
+    QVERIFY(::getrusage(RUSAGE_SELF, &after) == 0);
+    QVERIFY(QTestEventLoop::instance().timeout());
+    QVERIFY(::kill(pid_t(process.pid()), 0) == -1 && errno == ESRCH);
+    QCOMPARE(process.state(), QProcess::Running);
+    QVERIFY2(cpuTime(after) - cpuTime(before) < 500000,
+             QByteArray::number(cpuTime(after) - cpuTime(before)).constData());
+
+    QByteArray received;
+    QElapsedTimer timer;
+    timer.start();
+    forever {
+        const bool finished = process.state() == QProcess::NotRunning;
+        char buffer[4096];
+        ssize_t readBytes;
+        while ((readBytes = ::read(fds[0], buffer, sizeof buffer)) > 0)
+            received.append(buffer, readBytes);
+        if (finished)
+            break;
+        QVERIFY(timer.elapsed() < 30000);
+        QTest::qWait(10);
+    }
+    ::close(fds[0]);
+
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+    QCOMPARE(received, testdata);
+    for (int i = 0; i < spy.count(); ++i)
+        QVERIFY(spy.at(i).at(0).toLongLong() > 0);
+    QCOMPARE(forwardedBytes(spy), qint64(testdata.size()));
+#endif
+}
+
+void tst_QProcess::setStandardInputDevice()
+{
+    static const char skipped[] = "skipped";
+    const QByteArray testdata = forwardingTestData(1000000);
+
+    QFile file("data");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(skipped, sizeof skipped - 1);
+    file.write(testdata);
+    file.close();
+
+    // forwarding starts at the current position of the device
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QVERIFY(file.seek(sizeof skipped - 1));
+
+    QProcess process;
+    process.setStandardInputDevice(&file);
+    QSignalSpy spy(&process, SIGNAL(standardInputForwarded(qint64)));
+    QVERIFY(spy.isValid());
+
+    // the end of the device closes the write channel, which ends the process
+    process.start("testProcessEcho/testProcessEcho");
+    QPROCESS_VERIFY(process, waitForFinished());
+    QCOMPARE(process.readAll(), testdata);
+    QCOMPARE(forwardedBytes(spy), qint64(testdata.size()));
+    QVERIFY(file.atEnd());
+}
+
+void tst_QProcess::setStandardInputDeviceSequential()
+{
+    int fds[2];
+    QVERIFY(::pipe(fds) == 0);
+
+    // reading from a pipe could block the event loop, so it is refused
+    QFile pipe;
+    QVERIFY(pipe.open(fds[0], QIODevice::ReadOnly, QFileDevice::AutoCloseHandle));
+    QVERIFY(pipe.isSequential());
+    QCOMPARE(::write(fds[1], "data", 4), ssize_t(4));
+
+    QProcess process;
+    process.setStandardInputDevice(&pipe);
+    QSignalSpy spy(&process, SIGNAL(standardInputForwarded(qint64)));
+    QVERIFY(spy.isValid());
+
+    process.start("testProcessEcho/testProcessEcho");
+    QPROCESS_VERIFY(process, waitForFinished());
+    QCOMPARE(process.error(), QProcess::WriteError);
+    QVERIFY(process.readAll().isEmpty());
+    QCOMPARE(spy.count(), 0);
+    ::close(fds[1]);
+}
+
+void tst_QProcess::forwardThroughProcess()
+{
+    const QByteArray testdata = forwardingTestData(1000000);
+
+    QFile input("data");
+    QVERIFY(input.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    input.write(testdata);
+    input.close();
+    QVERIFY(input.open(QIODevice::ReadOnly));
+
+    QFile output("data2");
+    QVERIFY(output.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+    QProcess process;
+    process.setStandardInputDevice(&input);
+    process.setStandardOutputDevice(&output);
+    QSignalSpy inputSpy(&process, SIGNAL(standardInputForwarded(qint64)));
+    QSignalSpy outputSpy(&process, SIGNAL(standardOutputForwarded(qint64)));
+    connect(&process, SIGNAL(finished(int)), &QTestEventLoop::instance(), SLOT(exitLoop()));
+
+    process.start("testProcessEcho/testProcessEcho");
+    QTestEventLoop::instance().enterLoop(30);
+    QVERIFY(!QTestEventLoop::instance().timeout());
+    QCOMPARE(process.exitStatus(), QProcess::NormalExit);
+
+    QCOMPARE(forwardedBytes(inputSpy), qint64(testdata.size()));
+    QCOMPARE(forwardedBytes(outputSpy), qint64(testdata.size()));
+    output.close();
+    QVERIFY(output.open(QIODevice::ReadOnly));
+    QCOMPARE(output.readAll(), testdata);
+    output.close();
+    QVERIFY(output.remove());
+}
+#endif
+
 //-----------------------------------------------------------------------------
 #ifndef Q_OS_WINCE
 // Reading and writing to a process is not supported on Qt/CE
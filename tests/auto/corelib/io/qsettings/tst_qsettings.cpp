@@ -142,6 +142,8 @@ private slots:
     void rainersSyncBugOnMac_data();
     void rainersSyncBugOnMac();
     void recursionBug();
+    void journalFormat();
+    void journalFormatRecovery();
 
     void testByteArray_data();
     void testByteArray();
@@ -253,6 +255,7 @@ static void populateWithFormats()
 
     QTest::newRow("native") << QSettings::NativeFormat;
     QTest::newRow("ini") << QSettings::IniFormat;
+    QTest::newRow("journal") << QSettings::JournalFormat;
     QTest::newRow("custom1") << QSettings::CustomFormat1;
     QTest::newRow("custom2") << QSettings::CustomFormat2;
 }
@@ -1128,7 +1131,7 @@ void tst_QSettings::testVariantTypes()
 
     // We store key sequences as strings instead of binary variant blob, for improved
     // readability in the resulting format.
-    if (format >= QSettings::InvalidFormat) {
+    if (format >= QSettings::InvalidFormat || format == QSettings::JournalFormat) {
         testVal("keysequence", QKeySequence(Qt::ControlModifier + Qt::Key_F1), QKeySequence, KeySequence);
     } else {
         testVal("keysequence", QKeySequence(Qt::ControlModifier + Qt::Key_F1), QString, String);
@@ -2587,6 +2590,9 @@ void tst_QSettings::testCaseSensitivity()
         case QSettings::IniFormat:
             cs = false;
             break;
+        case QSettings::JournalFormat:
+            cs = false;
+            break;
         case QSettings::CustomFormat1:
             cs = true;
             break;
@@ -3197,6 +3203,224 @@ void tst_QSettings::recursionBug()
     }
 }
 
+void tst_QSettings::journalFormat()
+{
+    const QString fileName = settingsPath("journal/settings.journal");
+
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        for (int i = 0; i < 100; ++i)
+            settings.setValue(QString("group/key%1").arg(i), i);
+        settings.setValue("list", QStringList() << "a" << "b");
+        settings.sync();
+        QVERIFY(settings.status() == QSettings::NoError);
+        qint64 initialSize = QFileInfo(fileName).size();
+        QVERIFY(initialSize > 0);
+
+        // only the key that changed gets appended
+        settings.setValue("group/key50", 5000);
+        settings.setValue("group/key51", 51);
+        settings.sync();
+        qint64 size = QFileInfo(fileName).size();
+        QVERIFY(size > initialSize);
+        QVERIFY(size - initialSize < 64);
+
+        settings.remove("group/key0");
+        settings.sync();
+        QVERIFY(QFileInfo(fileName).size() > size);
+        QVERIFY(settings.status() == QSettings::NoError);
+    }
+
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.value("group/key50").toInt(), 5000);
+        QCOMPARE(settings.value("group/key51").toInt(), 51);
+        QVERIFY(!settings.contains("group/key0"));
+        QCOMPARE(settings.value("list").toStringList(), QStringList() << "a" << "b");
+        settings.beginGroup("group");
+        QCOMPARE(settings.childKeys().count(), 99);
+    }
+
+#ifdef Q_OS_UNIX
+    // a symlink gives us a second QConfFile for the same journal, like another process would have
+    const QString alias = settingsPath("journal/alias.journal");
+    QVERIFY(QFile::link(fileName, alias));
+    {
+        QSettings settings1(fileName, QSettings::JournalFormat);
+        QSettings settings2(alias, QSettings::JournalFormat);
+        QCOMPARE(settings2.value("group/key50").toInt(), 5000);
+
+        settings1.setValue("fromFirst", 1);
+        settings1.sync();
+        settings2.setValue("fromSecond", 2);
+        settings2.remove("group/key50");
+        settings2.sync();
+        settings1.sync();
+
+        QCOMPARE(settings1.value("fromSecond").toInt(), 2);
+        QVERIFY(!settings1.contains("group/key50"));
+
+        // records appended to a section that hasn't been read yet are kept for it
+        const QString readerAlias = settingsPath("journal/reader.journal");
+        QVERIFY(QFile::link(fileName, readerAlias));
+        QSettings reader(readerAlias, QSettings::JournalFormat);
+        QCOMPARE(reader.value("fromSecond").toInt(), 2);
+        settings2.setValue("group/key60", 6000);
+        settings2.remove("group/key61");
+        settings2.sync();
+        reader.sync();
+        QCOMPARE(reader.value("group/key60").toInt(), 6000);
+        QVERIFY(!reader.contains("group/key61"));
+        QCOMPARE(reader.value("group/key62").toInt(), 62);
+        settings1.sync();
+        QCOMPARE(settings2.value("fromFirst").toInt(), 1);
+        QCOMPARE(settings1.allKeys(), settings2.allKeys());
+    }
+
+    // a journal that gets replaced behind our back is replayed from the start
+    {
+        QSettings settings1(fileName, QSettings::JournalFormat);
+        QSettings settings2(alias, QSettings::JournalFormat);
+        QVERIFY(settings1.contains("fromFirst"));
+
+        QVERIFY(QFile::remove(fileName));
+        settings2.clear();
+        for (int i = 0; i < 200; ++i)
+            settings2.setValue(QString("replaced/key%1").arg(i), i);
+        settings2.sync();
+        QVERIFY(QFileInfo(fileName).size() > 0);
+
+        settings1.sync();
+        QVERIFY(!settings1.contains("fromFirst"));
+        QCOMPARE(settings1.allKeys().count(), 200);
+        QCOMPARE(settings1.value("replaced/key0").toInt(), 0);
+    }
+#endif
+}
+
+void tst_QSettings::journalFormatRecovery()
+{
+    const QString fileName = settingsPath("journal/recovery.journal");
+
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        settings.setValue("alpha", 1);
+        settings.setValue("beta", "two");
+    }
+    qint64 size = QFileInfo(fileName).size();
+
+    // a writer that died halfway through an append leaves an incomplete record behind
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::Append));
+        QCOMPARE(file.write("\0\0\1\0\0\0ab", 8), qint64(8));
+    }
+
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.value("alpha").toInt(), 1);
+        QCOMPARE(settings.value("beta").toString(), QString("two"));
+        settings.setValue("gamma", 3.5);
+    }
+    QVERIFY(QFileInfo(fileName).size() > size);
+
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.allKeys().count(), 3);
+        QCOMPARE(settings.value("gamma").toDouble(), 3.5);
+
+        // superseded records get compacted away
+        for (int i = 0; i < 3000; ++i) {
+            settings.setValue("counter", i);
+            settings.sync();
+        }
+        QVERIFY(settings.status() == QSettings::NoError);
+        QVERIFY(QFileInfo(fileName).size() < 64 * 1024);
+    }
+
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.allKeys().count(), 4);
+        QCOMPARE(settings.value("alpha").toInt(), 1);
+        QCOMPARE(settings.value("counter").toInt(), 2999);
+    }
+
+    // a complete record with a bad checksum at the end is a torn append too
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::Append));
+        QCOMPARE(file.write("\0\0\0\2\0\0ab", 8), qint64(8));
+    }
+    size = QFileInfo(fileName).size();
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.value("counter").toInt(), 2999);
+        settings.setValue("counter", -1);
+        settings.sync();
+        QVERIFY(settings.status() == QSettings::NoError);
+    }
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::NoError);
+        QCOMPARE(settings.allKeys().count(), 4);
+        QCOMPARE(settings.value("counter").toInt(), -1);
+    }
+
+    // a bad record in the middle stops the replay, but nothing after it is overwritten
+    QByteArray journal;
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        journal = file.readAll();
+    }
+    QByteArray damaged = journal;
+    const int firstRecordSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(damaged.constData() + 20));
+    damaged[20 + 6 + firstRecordSize - 1] = damaged.at(20 + 6 + firstRecordSize - 1) ^ 1;
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(damaged), qint64(damaged.size()));
+    }
+    QConfFile::clearCache();
+    {
+        QSettings settings(fileName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::FormatError);
+        QVERIFY(!settings.contains("counter"));
+        settings.setValue("delta", 4);
+        settings.sync();
+        QVERIFY(settings.status() == QSettings::FormatError);
+    }
+    {
+        QFile file(fileName);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), damaged);
+    }
+
+    // files that aren't journals are reported, not silently misread
+    const QString iniName = settingsPath("journal/notajournal.journal");
+    {
+        QFile file(iniName);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("[General]\nalpha=1\n");
+    }
+    {
+        QSettings settings(iniName, QSettings::JournalFormat);
+        QVERIFY(settings.status() == QSettings::FormatError);
+        QVERIFY(!settings.contains("alpha"));
+    }
+}
+
 #if defined(Q_OS_WIN)
 
 static DWORD readKeyType(HKEY handle, const QString &rSubKey)
@@ -45,6 +45,7 @@
 #include "qjsonobject.h"
 #include "qjsonvalue.h"
 #include "qjsondocument.h"
+#include "qjsonstream.h"
 #include <limits>
 
 #define INVALID_UNICODE "\xCE\xBA\xE1"
@@ -106,6 +107,7 @@ private Q_SLOTS:
     void fromBinary();
     void toAndFromBinary_data();
     void toAndFromBinary();
+    void fromBinaryFile();
     void parseNumbers();
     void parseStrings();
     void parseDuplicateKeys();
@@ -115,6 +117,7 @@ private Q_SLOTS:
     void compactObject();
 
     void validation();
+    void validationOnAccess();
 
     void assignToDocument();
 
@@ -137,6 +140,15 @@ private Q_SLOTS:
     void nesting();
 
     void longStrings();
+
+    void streamReader();
+    void streamReaderIncremental_data();
+    void streamReaderIncremental();
+    void streamReaderErrors_data();
+    void streamReaderErrors();
+    void streamReaderJsonLines();
+    void streamWriter();
+    void streamRoundTrip();
 private:
     QString testDataDir;
 };
@@ -1265,19 +1277,17 @@ void tst_QtJson::toJsonLargeNumericValues()
             "    \"Array\": [\n"
             "        1.234567,\n"
             "        1.7976931348623157e+308,\n"
-            //     ((4.9406564584124654e-324 == 5e-324) == true)
-            // I can only think JavaScript has a special formatter to
-            //  emit this value for this IEEE754 bit pattern.
-            "        4.9406564584124654e-324,\n"
+            // the shortest representations, as JavaScript emits them
+            "        5e-324,\n"
             "        2.2250738585072014e-308,\n"
             "        1.7976931348623157e+308,\n"
-            "        2.2204460492503131e-16,\n"
-            "        4.9406564584124654e-324,\n"
+            "        2.220446049250313e-16,\n"
+            "        5e-324,\n"
             "        0,\n"
             "        -2.2250738585072014e-308,\n"
             "        -1.7976931348623157e+308,\n"
-            "        -2.2204460492503131e-16,\n"
-            "        -4.9406564584124654e-324,\n"
+            "        -2.220446049250313e-16,\n"
+            "        -5e-324,\n"
             "        0,\n"
             "        9007199254740992,\n"
             "        -9007199254740992\n"
@@ -1624,6 +1634,64 @@ void tst_QtJson::toAndFromBinary()
     QVERIFY(doc == outdoc);
 }
 
+void tst_QtJson::fromBinaryFile()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    QJsonObject root;
+    root.insert("test", QJsonDocument::fromJson(file.readAll()).array());
+    root.insert("latin1", QLatin1String("text"));
+    root.insert("unicode", QString::fromUtf8(UNICODE_DJE));
+    root.insert(QString::fromUtf8("unicode" UNICODE_DJE), 42);
+    const QJsonDocument doc(root);
+    const QByteArray binary = doc.toBinaryData();
+
+    QTemporaryFile binaryFile;
+    QVERIFY(binaryFile.open());
+    QCOMPARE(binaryFile.write(binary), qint64(binary.size()));
+    binaryFile.close();
+
+    QJsonObject object;
+    {
+        QJsonDocument mapped = QJsonDocument::fromBinaryFile(binaryFile.fileName());
+        QVERIFY(!mapped.isNull());
+        QVERIFY(mapped == doc);
+        QCOMPARE(mapped.toJson(), doc.toJson());
+
+        QJsonDocument validated = QJsonDocument::fromBinaryFile(binaryFile.fileName(), QJsonDocument::Validate);
+        QVERIFY(validated == doc);
+
+        object = mapped.object();
+    }
+
+    // the mapping outlives the document, and is copied before it is modified
+    const QJsonObject original = doc.object();
+    QVERIFY(object == original);
+    QVERIFY(!object.isEmpty());
+    const QString firstKey = object.keys().first();
+    object.remove(firstKey);
+    QVERIFY(!object.contains(firstKey));
+    object.insert("added", QLatin1String("value"));
+    QCOMPARE(object.value("added").toString(), QString("value"));
+
+    QVERIFY(binaryFile.open());
+    QCOMPARE(binaryFile.readAll(), binary);
+    binaryFile.close();
+
+    // copying a value out of a mapped document into another one
+    {
+        QJsonDocument mapped = QJsonDocument::fromBinaryFile(binaryFile.fileName());
+        QJsonObject other;
+        foreach (const QString &key, original.keys())
+            other.insert(key, mapped.object().value(key));
+        mapped = QJsonDocument();
+        QVERIFY(other == original);
+    }
+
+    QVERIFY(QJsonDocument::fromBinaryFile(testDataDir + "/doesnotexist.bjson").isNull());
+    QVERIFY(QJsonDocument::fromBinaryFile(testDataDir + "/test.json").isNull());
+}
+
 void tst_QtJson::parseNumbers()
 {
     {
@@ -1700,6 +1768,49 @@ void tst_QtJson::parseNumbers()
             QCOMPARE(val.toDouble(), numbers[i].n);
         }
     }
+    {
+        // numbers on both sides of the limits of the exact conversion path
+        // must be correctly rounded
+        struct Numbers {
+            const char *str;
+            double n;
+        };
+        Numbers numbers [] = {
+            { "0.1", 0.1 },
+            { "0.3", 0.3 },
+            { "4.35", 4.35 },
+            { "123.456e-5", 123.456e-5 },
+            { "-0.0", -0.0 },
+            { "33554431", 33554431. },
+            { "33554432", 33554432. },
+            { "9007199254740992", 9007199254740992. },
+            { "9007199254740993", 9007199254740993. },
+            { "1234567890123456789", 1234567890123456789. },
+            { "12345678901234567890", 12345678901234567890. },
+            { "1e22", 1e22 },
+            { "1e23", 1e23 },
+            { "1e-22", 1e-22 },
+            { "1e-23", 1e-23 },
+            { "0.000000000000000000001", 1e-21 },
+            { "2.2250738585072014e-308", 2.2250738585072014e-308 },
+            { "4.9e-324", 4.9e-324 }
+        };
+        int size = sizeof(numbers)/sizeof(Numbers);
+        for (int i = 0; i < size; ++i) {
+            QByteArray json = "[ ";
+            json += numbers[i].str;
+            json += " ]";
+            QJsonDocument doc = QJsonDocument::fromJson(json);
+            const double d = doc.array().at(0).toDouble();
+            QVERIFY2(!memcmp(&d, &numbers[i].n, sizeof(double)), numbers[i].str);
+
+            QJsonStreamReader reader(json);
+            QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+            QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+            const double streamed = reader.toDouble();
+            QVERIFY2(!memcmp(&streamed, &numbers[i].n, sizeof(double)), numbers[i].str);
+        }
+    }
 }
 
 void tst_QtJson::parseStrings()
@@ -1921,6 +2032,48 @@ void tst_QtJson::validation()
     }
 }
 
+void tst_QtJson::validationOnAccess()
+{
+    QFile file(testDataDir + "/test3.json");
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    QVERIFY(!doc.isNull());
+    const QByteArray binary = doc.toBinaryData();
+
+    // a document validated on access must never crash, must serialize
+    // exactly when full validation accepts it, and then to the same JSON
+    for (int i = 0; i < binary.size(); ++i) {
+        for (int c = 0; c < 2; ++c) {
+            QByteArray corrupted = binary;
+            corrupted[i] = c ? char(0xff) : char(0x00);
+            if (corrupted == binary)
+                continue;
+
+            const QJsonDocument checked = QJsonDocument::fromBinaryData(corrupted);
+            const QJsonDocument lazy = QJsonDocument::fromBinaryData(corrupted, QJsonDocument::ValidateOnAccess);
+            if (lazy.isNull()) {
+                QVERIFY(checked.isNull());
+                continue;
+            }
+
+            // walk everything through the public API
+            const QVariant variant = lazy.toVariant();
+            Q_UNUSED(variant);
+            if (lazy.isObject()) {
+                const QJsonObject object = lazy.object();
+                for (QJsonObject::const_iterator it = object.begin(); it != object.end(); ++it)
+                    QJsonObject().insert(it.key(), it.value());
+            }
+
+            const QByteArray json = lazy.toJson();
+            if (checked.isNull())
+                QVERIFY(json.isEmpty());
+            else
+                QCOMPARE(json, checked.toJson());
+        }
+    }
+}
+
 void tst_QtJson::assignToDocument()
 {
     {
@@ -2345,5 +2498,351 @@ void tst_QtJson::longStrings()
     }
 }
 
+void tst_QtJson::streamReader()
+{
+    QByteArray json = "\xef\xbb\xbf{ \"a\": [1, -2.5e3, true, false, null],\n"
+                      "  \"b\\u00e9\\n\": \"" UNICODE_DJE "\\ud834\\udd1e\", \"c\": {} }";
+    QJsonStreamReader reader(json);
+    QVERIFY(!reader.atEnd());
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.depth(), 1);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Key);
+    QCOMPARE(reader.text(), QString("a"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QCOMPARE(reader.depth(), 2);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.toDouble(), 1.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.value(), QJsonValue(-2500.));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Bool);
+    QCOMPARE(reader.toBool(), true);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Bool);
+    QCOMPARE(reader.toBool(), false);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Null);
+    QVERIFY(reader.value().isNull());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.tokenString(), QString("EndArray"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Key);
+    QCOMPARE(reader.text(), QString::fromUtf8("b\xc3\xa9\n"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.text(), QString::fromUtf8(UNICODE_DJE "\xf0\x9d\x84\x9e"));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Key);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::EndObject);
+    QCOMPARE(reader.depth(), 0);
+    QVERIFY(!reader.atEnd());
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(!reader.hasError());
+    QCOMPARE(reader.characterOffset(), qint64(json.size()));
+
+    // a whole value
+    reader.clear();
+    reader.addData(json);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QJsonValue value = reader.readValue();
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::EndObject);
+    QCOMPARE(value, QJsonValue(QJsonDocument::fromJson(json).object()));
+
+    // skipping
+    reader.clear();
+    reader.addData(json);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Key);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartArray);
+    QVERIFY(reader.skipCurrentValue());
+    QCOMPARE(reader.tokenType(), QJsonStreamReader::EndArray);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Key);
+    QCOMPARE(reader.text(), QString::fromUtf8("b\xc3\xa9\n"));
+}
+
+void tst_QtJson::streamReaderIncremental_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::newRow("test.json") << QString("test.json");
+    QTest::newRow("test2.json") << QString("test2.json");
+    QTest::newRow("test3.json") << QString("test3.json");
+}
+
+static QList<QVariant> streamTokens(QJsonStreamReader &reader)
+{
+    QList<QVariant> tokens;
+    while (reader.readNext() != QJsonStreamReader::NoToken) {
+        if (reader.hasError())
+            return QList<QVariant>() << reader.errorString();
+        tokens << int(reader.tokenType());
+        if (reader.tokenType() == QJsonStreamReader::Key || reader.tokenType() == QJsonStreamReader::String)
+            tokens << reader.text();
+        else if (reader.tokenType() == QJsonStreamReader::Double)
+            tokens << reader.toDouble();
+        else if (reader.tokenType() == QJsonStreamReader::Bool)
+            tokens << reader.toBool();
+    }
+    return tokens;
+}
+
+void tst_QtJson::streamReaderIncremental()
+{
+    QFETCH(QString, fileName);
+    QFile file(testDataDir + "/" + fileName);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray json = file.readAll();
+    file.seek(0);
+
+    QJsonStreamReader fromDevice(&file);
+    const QList<QVariant> tokens = streamTokens(fromDevice);
+    QVERIFY(tokens.size() > 2);
+    QVERIFY(!fromDevice.hasError());
+
+    // feeding the data in pieces of any size must give the same tokens
+    for (int chunk = 1; chunk <= 7; chunk += 3) {
+        QJsonStreamReader reader;
+        QList<QVariant> chunked;
+        for (int i = 0; i < json.size(); i += chunk) {
+            reader.addData(json.mid(i, chunk));
+            chunked += streamTokens(reader);
+            QVERIFY(reader.atEnd());
+        }
+        QCOMPARE(chunked, tokens);
+    }
+
+    // and readValue() can be resumed
+    QJsonStreamReader reader;
+    reader.addData(json.left(1));
+    reader.readNext();
+    QJsonValue value = reader.readValue();
+    for (int i = 1; value.isUndefined() && i < json.size(); i += 5) {
+        QVERIFY(reader.atEnd());
+        QVERIFY(!reader.hasError());
+        reader.addData(json.mid(i, 5));
+        value = reader.readValue();
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(json);
+    QCOMPARE(value, doc.isObject() ? QJsonValue(doc.object()) : QJsonValue(doc.array()));
+}
+
+void tst_QtJson::streamReaderErrors_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<int>("error");
+
+    QTest::newRow("unterminated object") << QByteArray("{\"a\": 1 ]") << int(QJsonParseError::UnterminatedObject);
+    QTest::newRow("unterminated array") << QByteArray("[1, 2 ") << int(QJsonParseError::UnterminatedArray);
+    QTest::newRow("missing name separator") << QByteArray("{\"a\" 1}") << int(QJsonParseError::MissingNameSeparator);
+    QTest::newRow("missing value separator") << QByteArray("[1 2]") << int(QJsonParseError::MissingValueSeparator);
+    QTest::newRow("illegal value") << QByteArray("[nul]") << int(QJsonParseError::IllegalValue);
+    QTest::newRow("trailing comma") << QByteArray("[1,]") << int(QJsonParseError::IllegalValue);
+    QTest::newRow("termination by number") << QByteArray("[1") << int(QJsonParseError::TerminationByNumber);
+    QTest::newRow("illegal number") << QByteArray("[-]") << int(QJsonParseError::IllegalNumber);
+    QTest::newRow("escape sequence") << QByteArray("[\"\\u12x4\"]") << int(QJsonParseError::IllegalEscapeSequence);
+    QTest::newRow("utf8") << QByteArray("[\"" INVALID_UNICODE "\"]") << int(QJsonParseError::IllegalUTF8String);
+    QTest::newRow("unterminated string") << QByteArray("[\"abc") << int(QJsonParseError::UnterminatedString);
+    QTest::newRow("unterminated top-level string") << QByteArray("\"abc") << int(QJsonParseError::UnterminatedString);
+    QTest::newRow("truncated array") << QByteArray("[1, ") << int(QJsonParseError::UnterminatedArray);
+    QTest::newRow("truncated object") << QByteArray("{\"a\": ") << int(QJsonParseError::UnterminatedObject);
+    QTest::newRow("missing object") << QByteArray("{\"a\": 1, }") << int(QJsonParseError::MissingObject);
+    QTest::newRow("deep nesting") << QByteArray(1025, '[') << int(QJsonParseError::DeepNesting);
+}
+
+void tst_QtJson::streamReaderErrors()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(int, error);
+
+    QBuffer buffer(&json);
+    buffer.open(QIODevice::ReadOnly);
+    QJsonStreamReader reader(&buffer);
+    while (reader.readNext() != QJsonStreamReader::Invalid)
+        QVERIFY(reader.tokenType() != QJsonStreamReader::NoToken);
+    QVERIFY(reader.atEnd());
+    QVERIFY(reader.hasError());
+    QCOMPARE(int(reader.error()), error);
+    QVERIFY(!reader.errorString().isEmpty());
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Invalid);
+
+    // the same error for added data, once the reader knows it is complete
+    QJsonStreamReader added;
+    for (int i = 0; i < json.size(); i += 2) {
+        added.addData(json.mid(i, 2));
+        while (added.readNext() != QJsonStreamReader::NoToken && !added.hasError()) {}
+    }
+    if (!added.hasError()) {
+        added.finishData();
+        QVERIFY(!added.atEnd());
+        while (added.readNext() != QJsonStreamReader::Invalid)
+            QVERIFY(added.tokenType() != QJsonStreamReader::NoToken);
+    }
+    QCOMPARE(int(added.error()), error);
+
+    QJsonStreamReader fromArray(json);
+    while (fromArray.readNext() != QJsonStreamReader::Invalid)
+        QVERIFY(fromArray.tokenType() != QJsonStreamReader::NoToken);
+    QCOMPARE(int(fromArray.error()), error);
+}
+
+void tst_QtJson::streamReaderJsonLines()
+{
+    const QByteArray lines = "{\"id\": 1, \"tags\": [\"x\"]}\n"
+                             "{\"id\": 2, \"tags\": []}\n"
+                             "\"text\" 42 true\n";
+
+    QJsonStreamReader reader;
+    reader.addData(lines.left(9));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QVERIFY(reader.readValue().isUndefined());
+    QVERIFY(reader.atEnd());
+    reader.addData(lines.mid(9, 100));
+    QJsonObject first = reader.readValue().toObject();
+    QCOMPARE(first.value("id"), QJsonValue(1));
+    QJsonArray tags;
+    tags.append(QLatin1String("x"));
+    QCOMPARE(first.value("tags"), QJsonValue(tags));
+
+    QCOMPARE(reader.readNext(), QJsonStreamReader::StartObject);
+    QCOMPARE(reader.readValue().toObject().value("id"), QJsonValue(2));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::String);
+    QCOMPARE(reader.readValue(), QJsonValue(QLatin1String("text")));
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Bool);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    // a number at the end of the data is only complete at the end of the device
+    QByteArray number("12");
+    reader.clear();
+    reader.addData(number);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    reader.addData("3 ");
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.toDouble(), 123.);
+
+    // ... or once no more data will be added
+    reader.clear();
+    reader.addData(number);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    reader.finishData();
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.toDouble(), 12.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+
+    QJsonStreamReader fromArray(number);
+    QCOMPARE(fromArray.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(fromArray.toDouble(), 12.);
+
+    QBuffer buffer(&number);
+    buffer.open(QIODevice::ReadOnly);
+    reader.setDevice(&buffer);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::Double);
+    QCOMPARE(reader.toDouble(), 12.);
+    QCOMPARE(reader.readNext(), QJsonStreamReader::NoToken);
+    QVERIFY(!reader.hasError());
+}
+
+void tst_QtJson::streamWriter()
+{
+    QJsonArray array;
+    array.append(1);
+    array.append(QLatin1String("two"));
+    array.append(QJsonArray());
+    array.append(QJsonObject());
+    QJsonObject object;
+    object.insert("array", array);
+    object.insert("escaped", QLatin1String("\"\\\n\x01"));
+    object.insert("number", 2.5);
+    object.insert("object", QJsonObject());
+    QJsonObject nested;
+    nested.insert("null", QJsonValue());
+    nested.insert("true", true);
+    object.insert("pnested", nested);
+
+    for (int indented = 0; indented < 2; ++indented) {
+        QByteArray expected = QJsonDocument(object).toJson(indented ? QJsonDocument::Indented
+                                                                    : QJsonDocument::Compact);
+        if (!indented)
+            expected += '\n';
+
+        QByteArray out;
+        QJsonStreamWriter writer(&out);
+        writer.setAutoFormatting(indented);
+        writer.writeValue(object);
+        QCOMPARE(out, expected);
+
+        out.clear();
+        writer.writeStartObject();
+        writer.writeStartArray("array");
+        writer.writeValue(1);
+        writer.writeValue(QLatin1String("two"));
+        writer.writeStartArray();
+        writer.writeEndArray();
+        writer.writeValue(QJsonObject());
+        writer.writeEndArray();
+        writer.writeValue("escaped", QLatin1String("\"\\\n\x01"));
+        writer.writeKey("number");
+        writer.writeValue(2.5);
+        writer.writeStartObject("object");
+        writer.writeEndObject();
+        writer.writeValue("pnested", nested);
+        QCOMPARE(writer.depth(), 1);
+        writer.writeEndObject();
+        QCOMPARE(writer.depth(), 0);
+        QCOMPARE(out, expected);
+    }
+
+    // JSON lines to a device
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QJsonStreamWriter writer(&buffer);
+        writer.writeValue(nested);
+        writer.writeStartArray();
+        writer.writeValue(QJsonValue());
+        QCOMPARE(buffer.data(), QByteArray("{\"null\": null,\"true\": true}\n"));
+        writer.writeEndArray();
+        writer.writeValue(QLatin1String("s"));
+        QVERIFY(!writer.hasError());
+    }
+    QCOMPARE(buffer.data(), QByteArray("{\"null\": null,\"true\": true}\n[null]\n\"s\"\n"));
+}
+
+void tst_QtJson::streamRoundTrip()
+{
+    QFile file(testDataDir + "/test.json");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.seek(0);
+
+    QByteArray out;
+    QJsonStreamReader reader(&file);
+    QJsonStreamWriter writer(&out);
+    while (reader.readNext() != QJsonStreamReader::NoToken) {
+        QVERIFY(!reader.hasError());
+        switch (reader.tokenType()) {
+        case QJsonStreamReader::StartObject:
+            writer.writeStartObject();
+            break;
+        case QJsonStreamReader::EndObject:
+            writer.writeEndObject();
+            break;
+        case QJsonStreamReader::StartArray:
+            writer.writeStartArray();
+            break;
+        case QJsonStreamReader::EndArray:
+            writer.writeEndArray();
+            break;
+        case QJsonStreamReader::Key:
+            writer.writeKey(reader.text());
+            break;
+        default:
+            writer.writeValue(reader.value());
+            break;
+        }
+    }
+    QCOMPARE(QJsonDocument::fromJson(out), doc);
+}
+
 QTEST_MAIN(tst_QtJson)
 #include "tst_qtjson.moc"
@@ -267,6 +267,68 @@ void tst_QCoreApplication::postEvent()
     QCOMPARE(spy.recordedEvents, expected);
 }
 
+class EventPostingThread : public QThread
+{
+public:
+    QObject *receiver;
+
+    void run()
+    {
+        QCoreApplication::postEvent(receiver, new QEvent(QEvent::Type(QEvent::User + 14)));
+    }
+};
+
+class DuringSendEventGenerator : public QObject
+{
+    Q_OBJECT
+
+public:
+    bool event(QEvent *e)
+    {
+        if (e->type() == QEvent::User + 1) {
+            QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 11)));
+            QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 12)), 1);
+            QCoreApplication::postEvent(this, new QEvent(QEvent::Type(QEvent::User + 13)));
+
+            EventPostingThread thread;
+            thread.receiver = this;
+            thread.start();
+            thread.wait();
+        }
+
+        return QObject::event(e);
+    }
+};
+
+void tst_QCoreApplication::postEventDuringSendPostedEvents()
+{
+    int argc = 1;
+    char *argv[] = { const_cast<char*>(QTest::currentAppName()) };
+    TestApplication app(argc, argv);
+
+    EventSpy spy;
+    DuringSendEventGenerator generator;
+    generator.installEventFilter(&spy);
+
+    QCoreApplication::postEvent(&generator, new QEvent(QEvent::Type(QEvent::User + 1)));
+
+    QList<int> expected;
+    expected << QEvent::User + 1;
+    QCoreApplication::sendPostedEvents();
+    // the events posted meanwhile wait for the next call, whether they were
+    // posted with the default priority or not, and from whichever thread
+    QCOMPARE(spy.recordedEvents, expected);
+
+    expected.clear();
+    expected << QEvent::User + 12
+             << QEvent::User + 11
+             << QEvent::User + 13
+             << QEvent::User + 14;
+    spy.recordedEvents.clear();
+    QCoreApplication::sendPostedEvents();
+    QCOMPARE(spy.recordedEvents, expected);
+}
+
 void tst_QCoreApplication::removePostedEvents()
 {
     int argc = 1;
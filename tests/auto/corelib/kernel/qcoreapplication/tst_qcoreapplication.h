@@ -55,6 +55,7 @@ private slots:
     void argc();
 #endif
     void postEvent();
+    void postEventDuringSendPostedEvents();
     void removePostedEvents();
 #ifndef QT_NO_THREAD
     void deliverInDefinedOrder();
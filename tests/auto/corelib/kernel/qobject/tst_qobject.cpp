@@ -154,6 +154,9 @@ private slots:
     void qmlConnect();
     void exceptions();
     void noDeclarativeParentChangedOnDestruction();
+    void emitWhileDisconnecting();
+    void emitWhileDestroyingReceivers();
+    void emitWhileMovingToThread();
 };
 
 struct QObjectCreatedOnShutdown
@@ -6313,6 +6316,148 @@ void tst_QObject::noDeclarativeParentChangedOnDestruction()
 #endif
 }
 
+class ConcurrentSender : public SenderObject
+{
+public:
+    int signal1Receivers() const { return receivers(SIGNAL(signal1())); }
+};
+
+class ConcurrentEmitter : public QThread
+{
+public:
+    explicit ConcurrentEmitter(SenderObject *sender) : sender(sender), emissions(0) {}
+
+    void run()
+    {
+        while (!stop.load()) {
+            sender->emitSignal1();
+            ++emissions;
+        }
+    }
+
+    SenderObject *sender;
+    QAtomicInt stop;
+    int emissions;
+};
+
+static QAtomicInt concurrentFunctorCount;
+
+struct ConcurrentFunctor
+{
+    ConcurrentFunctor() { concurrentFunctorCount.ref(); }
+    ConcurrentFunctor(const ConcurrentFunctor &) { concurrentFunctorCount.ref(); }
+    ~ConcurrentFunctor() { concurrentFunctorCount.deref(); }
+    void operator()() const { }
+};
+
+class ConcurrentReceiver : public QObject
+{
+    Q_OBJECT
+public:
+    QAtomicInt calls;
+    QAtomicInt callsFromOtherThreads;
+
+    bool event(QEvent *e)
+    {
+        if (e->type() == QEvent::ThreadChange) {
+            // give the emitters a chance to call us before we have moved
+            for (int i = 0; i < 10; ++i)
+                QThread::yieldCurrentThread();
+        }
+        return QObject::event(e);
+    }
+
+public slots:
+    void slot()
+    {
+        calls.ref();
+        if (thread() != QThread::currentThread())
+            callsFromOtherThreads.ref();
+    }
+};
+
+void tst_QObject::emitWhileDisconnecting()
+{
+    ConcurrentSender sender;
+    ConcurrentReceiver receiver;
+    ConcurrentEmitter emitter1(&sender), emitter2(&sender);
+    emitter1.start();
+    emitter2.start();
+
+    for (int i = 0; i < 2000; ++i) {
+        QMetaObject::Connection c = connect(&sender, &SenderObject::signal1, ConcurrentFunctor());
+        QVERIFY(c);
+        QVERIFY(connect(&sender, SIGNAL(signal1()), &receiver, SLOT(slot())));
+        if (i % 100 == 0)
+            QCoreApplication::processEvents();
+        QVERIFY(QObject::disconnect(c));
+        QVERIFY(QObject::disconnect(&sender, SIGNAL(signal1()), &receiver, SLOT(slot())));
+    }
+
+    emitter1.stop.store(1);
+    emitter2.stop.store(1);
+    QVERIFY(emitter1.wait(30000));
+    QVERIFY(emitter2.wait(30000));
+
+    // the functors disconnected during an emission are destroyed once it ends
+    QCOMPARE(concurrentFunctorCount.load(), 0);
+    QCOMPARE(sender.signal1Receivers(), 0);
+
+    QCoreApplication::processEvents();
+    QCOMPARE(receiver.callsFromOtherThreads.load(), 0);
+}
+
+void tst_QObject::emitWhileDestroyingReceivers()
+{
+    ConcurrentSender sender;
+    ConcurrentEmitter emitter1(&sender), emitter2(&sender);
+    emitter1.start();
+    emitter2.start();
+
+    for (int i = 0; i < 2000; ++i) {
+        QObject *context = new QObject;
+        connect(&sender, &SenderObject::signal1, context, ConcurrentFunctor());
+        ConcurrentReceiver *receiver = new ConcurrentReceiver;
+        connect(&sender, SIGNAL(signal1()), receiver, SLOT(slot()));
+        if (i % 100 == 0)
+            QCoreApplication::processEvents();
+        delete receiver;
+        delete context;
+    }
+
+    emitter1.stop.store(1);
+    emitter2.stop.store(1);
+    QVERIFY(emitter1.wait(30000));
+    QVERIFY(emitter2.wait(30000));
+
+    QCOMPARE(concurrentFunctorCount.load(), 0);
+    QCOMPARE(sender.signal1Receivers(), 0);
+}
+
+void tst_QObject::emitWhileMovingToThread()
+{
+    SenderObject sender;
+    ConcurrentEmitter emitter(&sender);
+    emitter.start();
+
+    QList<ConcurrentReceiver *> receivers;
+    for (int i = 0; i < 500; ++i) {
+        ConcurrentReceiver *receiver = new ConcurrentReceiver;
+        receivers.append(receiver);
+        connect(&sender, SIGNAL(signal1()), receiver, SLOT(slot()));
+        // the emitter calls the slot directly once the receiver lives in its
+        // thread, and not before
+        receiver->moveToThread(&emitter);
+    }
+
+    emitter.stop.store(1);
+    QVERIFY(emitter.wait(30000));
+
+    for (int i = 0; i < receivers.size(); ++i)
+        QCOMPARE(receivers.at(i)->callsFromOtherThreads.load(), 0);
+    qDeleteAll(receivers);
+}
+
 // Test for QtPrivate::HasQ_OBJECT_Macro
 Q_STATIC_ASSERT(QtPrivate::HasQ_OBJECT_Macro<tst_QObject>::Value);
 Q_STATIC_ASSERT(!QtPrivate::HasQ_OBJECT_Macro<SiblingDeleter>::Value);
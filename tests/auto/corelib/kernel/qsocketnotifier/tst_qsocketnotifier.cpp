@@ -46,6 +46,8 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTimer>
 #include <QtCore/QSocketNotifier>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QThread>
 #include <QtNetwork/QTcpServer>
 #include <QtNetwork/QTcpSocket>
 #include <private/qnativesocketengine_p.h>
@@ -69,6 +71,8 @@ private slots:
     void mixingWithTimers();
 #ifdef Q_OS_UNIX
     void posixSockets();
+    void regularFile_data();
+    void regularFile();
 #endif
 };
 
@@ -301,6 +305,73 @@ void tst_QSocketNotifier::posixSockets()
     }
     qt_safe_close(posixSocket);
 }
+
+class RegularFileNotifierThread : public QThread
+{
+public:
+    int fd;
+    int readActivations;
+    int writeActivations;
+    QByteArray dispatcher;
+
+    RegularFileNotifierThread(int descriptor)
+        : fd(descriptor), readActivations(0), writeActivations(0)
+    { }
+
+    void run()
+    {
+        QSocketNotifier rn(fd, QSocketNotifier::Read);
+        QSignalSpy readSpy(&rn, SIGNAL(activated(int)));
+        QSocketNotifier wn(fd, QSocketNotifier::Write);
+        QSignalSpy writeSpy(&wn, SIGNAL(activated(int)));
+
+        QEventLoop loop;
+        QTimer::singleShot(100, &loop, SLOT(quit()));
+        loop.exec();
+
+        readActivations = readSpy.count();
+        writeActivations = writeSpy.count();
+        dispatcher = eventDispatcher()->metaObject()->className();
+    }
+};
+
+void tst_QSocketNotifier::regularFile_data()
+{
+    QTest::addColumn<QByteArray>("epoll");
+
+    QTest::newRow("select") << QByteArray();
+#ifdef Q_OS_LINUX
+    QTest::newRow("epoll") << QByteArray("1");
+#endif
+}
+
+// select() reports regular files as always readable and writable
+void tst_QSocketNotifier::regularFile()
+{
+    QFETCH(QByteArray, epoll);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write("hello", 5), qint64(5));
+    QVERIFY(file.flush());
+
+    // the dispatcher is created when the thread starts; the glib one
+    // would be picked before either of ours unless QT_NO_GLIB is set
+    const QByteArray oldNoGlib = qgetenv("QT_NO_GLIB");
+    const QByteArray oldEpoll = qgetenv("QT_EVENT_DISPATCHER_EPOLL");
+    qputenv("QT_NO_GLIB", "1");
+    qputenv("QT_EVENT_DISPATCHER_EPOLL", epoll);
+    RegularFileNotifierThread thread(file.handle());
+    thread.start();
+    const bool finished = thread.wait(30000);
+    qputenv("QT_EVENT_DISPATCHER_EPOLL", oldEpoll);
+    qputenv("QT_NO_GLIB", oldNoGlib);
+
+    QVERIFY(finished);
+    QCOMPARE(thread.dispatcher, QByteArray("QEventDispatcherUNIX"));
+    QVERIFY(thread.readActivations > 0);
+    QVERIFY(thread.writeActivations > 0);
+}
 #endif
 
 QTEST_MAIN(tst_QSocketNotifier)
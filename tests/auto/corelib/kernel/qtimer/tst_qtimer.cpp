@@ -80,6 +80,9 @@ private slots:
 
     void dontBlockEvents();
     void postedEventsShouldNotStarveTimers();
+#ifdef Q_OS_UNIX
+    void coalesceTimersAcrossThreads();
+#endif
 };
 
 class TimerHelper : public QObject
@@ -717,5 +720,53 @@ void tst_QTimer::postedEventsShouldNotStarveTimers()
     QVERIFY(timerHelper.count > 5);
 }
 
+#ifdef Q_OS_UNIX
+class CoarseTimerThread : public QThread
+{
+public:
+    CoarseTimerThread(int interval, const QElapsedTimer &clock)
+        : interval(interval), clock(clock), wakeup(-1)
+    { }
+
+    void run()
+    {
+        QTimer timer;
+        timer.setTimerType(Qt::CoarseTimer);
+        timer.start(interval);
+        // when the timer fires, on the clock shared with the other thread
+        wakeup = clock.elapsed() + timer.remainingTime();
+    }
+
+    const int interval;
+    const QElapsedTimer &clock;
+    qint64 wakeup;
+};
+
+void tst_QTimer::coalesceTimersAcrossThreads()
+{
+    QCoreApplication::setAttribute(Qt::AA_CoalesceTimersAcrossThreads, true);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    // The windows of the two timers overlap, but on their own they would be
+    // rounded to different multiples of 25 ms. With coalescing, the second
+    // thread wakes up when the first one does.
+    CoarseTimerThread first(1013, clock);
+    first.start();
+    QVERIFY(first.wait(30000));
+    CoarseTimerThread second(990, clock);
+    second.start();
+    QVERIFY(second.wait(30000));
+
+    QCoreApplication::setAttribute(Qt::AA_CoalesceTimersAcrossThreads, false);
+
+    QVERIFY(first.wakeup > 0);
+    QVERIFY2(qAbs(second.wakeup - first.wakeup) <= 2,
+             qPrintable(QString::fromLatin1("wakeups at %1 and %2 ms")
+                        .arg(first.wakeup).arg(second.wakeup)));
+}
+#endif
+
 QTEST_MAIN(tst_QTimer)
 #include "tst_qtimer.moc"
@@ -76,9 +76,17 @@ private slots:
     void pause();
     void throttling();
     void voidConversions();
+    void then();
+    void thenOnThreadPool();
+    void thenCanceled();
+    void whenAll();
+    void whenAny();
+    void droppedUnfinished();
 #ifndef QT_NO_EXCEPTIONS
     void exceptions();
     void nestedExceptions();
+    void thenExceptions();
+    void onFailed();
 #endif
 };
 
@@ -1280,6 +1288,309 @@ void tst_QFuture::voidConversions()
 }
 
 
+static int addOne(QFuture<int> future)
+{
+    return future.result() + 1;
+}
+
+static QString toText(QFuture<int> future)
+{
+    return QString::number(future.result());
+}
+
+static int voidContinuationCalls = 0;
+
+static void countCall(QFuture<int>)
+{
+    ++voidContinuationCalls;
+}
+
+static int fortyTwo(QFuture<void>)
+{
+    return 42;
+}
+
+struct SumResults
+{
+    typedef int result_type;
+
+    int operator()(QFuture<int> future) const
+    {
+        int sum = 0;
+        foreach (int result, future.results())
+            sum += result;
+        return sum;
+    }
+};
+
+void tst_QFuture::then()
+{
+    // continuation attached before the future finishes runs when it does
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future();
+
+        QFuture<int> plusOne = f.then(addOne);
+        QFuture<QString> text = plusOne.then(toText);
+        QVERIFY(plusOne.isStarted());
+        QVERIFY(plusOne.isRunning());
+        QVERIFY(!text.isFinished());
+
+        i.reportFinished(new int(41));
+        QVERIFY(plusOne.isFinished());
+        QCOMPARE(plusOne.result(), 42);
+        QVERIFY(text.isFinished());
+        QCOMPARE(text.result(), QString("42"));
+    }
+
+    // continuation attached to a finished future runs right away
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        i.reportFinished(new int(1));
+
+        QFuture<int> f = i.future().then(addOne);
+        QVERIFY(f.isFinished());
+        QCOMPARE(f.result(), 2);
+    }
+
+    // continuations returning void, continuations of QFuture<void>
+    {
+        voidContinuationCalls = 0;
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<void> f = i.future().then(countCall);
+        QCOMPARE(voidContinuationCalls, 0);
+        i.reportFinished(new int(1));
+        QVERIFY(f.isFinished());
+        QCOMPARE(voidContinuationCalls, 1);
+
+        QFuture<int> g = f.then(fortyTwo);
+        QCOMPARE(g.result(), 42);
+    }
+
+    // function object with multiple results
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> sum = i.future().then(SumResults());
+        i.reportResult(1);
+        i.reportResult(2);
+        i.reportResult(3);
+        QVERIFY(!sum.isFinished());
+        i.reportFinished();
+        QCOMPARE(sum.result(), 6);
+    }
+
+    // several continuations on the same future
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> a = i.future().then(addOne);
+        QFuture<QString> b = i.future().then(toText);
+        i.reportFinished(new int(7));
+        QCOMPARE(a.result(), 8);
+        QCOMPARE(b.result(), QString("7"));
+    }
+
+#ifdef Q_COMPILER_LAMBDA
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<double> f = i.future().then([](QFuture<int> future) {
+            return future.result() / 2.0;
+        });
+        i.reportFinished(new int(5));
+        QCOMPARE(f.result(), 2.5);
+    }
+#endif
+}
+
+class ThreadRecorder
+{
+public:
+    typedef int result_type;
+
+    explicit ThreadRecorder(QThread **thread) : m_thread(thread) { }
+    int operator()(QFuture<int> future) const
+    {
+        *m_thread = QThread::currentThread();
+        return future.result() * 2;
+    }
+
+private:
+    QThread **m_thread;
+};
+
+class FinishRunnable : public QRunnable
+{
+public:
+    explicit FinishRunnable(QFutureInterface<int> *interface) : m_interface(interface) { }
+    void run() { m_interface->reportFinished(new int(21)); }
+
+private:
+    QFutureInterface<int> *m_interface;
+};
+
+void tst_QFuture::thenOnThreadPool()
+{
+    QThreadPool pool;
+
+    // inline continuations run in the thread that finished the future
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QThread *thread = 0;
+        QFuture<int> f = i.future().then(ThreadRecorder(&thread));
+        pool.start(new FinishRunnable(&i));
+        QCOMPARE(f.result(), 42);
+        QVERIFY(thread);
+        QVERIFY(thread != QThread::currentThread());
+        pool.waitForDone();
+    }
+
+    // continuations given a pool run in it, even for finished futures
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        i.reportFinished(new int(21));
+        QThread *thread = 0;
+        QFuture<int> f = i.future().then(&pool, ThreadRecorder(&thread));
+        f.waitForFinished();
+        QCOMPARE(f.result(), 42);
+        QVERIFY(thread);
+        QVERIFY(thread != QThread::currentThread());
+        pool.waitForDone();
+    }
+}
+
+void tst_QFuture::thenCanceled()
+{
+    voidContinuationCalls = 0;
+
+    QFutureInterface<int> i;
+    i.reportStarted();
+    QFuture<void> f = i.future().then(countCall);
+    QFuture<QString> g = i.future().then(addOne).then(toText);
+    i.reportCanceled();
+    i.reportFinished();
+
+    QVERIFY(f.isFinished());
+    QVERIFY(f.isCanceled());
+    QVERIFY(g.isFinished());
+    QVERIFY(g.isCanceled());
+    QCOMPARE(voidContinuationCalls, 0);
+
+    // canceling the continuation itself
+    QFutureInterface<int> j;
+    j.reportStarted();
+    QFuture<void> h = j.future().then(countCall);
+    h.cancel();
+    j.reportFinished(new int(0));
+    QVERIFY(h.isFinished());
+    QCOMPARE(voidContinuationCalls, 0);
+}
+
+void tst_QFuture::whenAll()
+{
+    QFutureInterface<int> i1, i2, i3;
+    i1.reportStarted();
+    i2.reportStarted();
+    i3.reportStarted();
+
+    QList<QFuture<int> > futures;
+    futures << i1.future() << i2.future() << i3.future();
+    QFuture<QList<QFuture<int> > > all = QtFuture::whenAll(futures);
+    QVERIFY(all.isRunning());
+
+    i2.reportFinished(new int(2));
+    i1.reportFinished(new int(1));
+    QVERIFY(!all.isFinished());
+    i3.reportCanceled();
+    i3.reportFinished();
+    QVERIFY(all.isFinished());
+
+    const QList<QFuture<int> > results = all.result();
+    QCOMPARE(results.count(), 3);
+    QCOMPARE(results.at(0).result(), 1);
+    QCOMPARE(results.at(1).result(), 2);
+    QVERIFY(results.at(2).isCanceled());
+
+    // already finished and empty inputs
+    QFuture<QList<QFuture<int> > > finished = QtFuture::whenAll(results);
+    QVERIFY(finished.isFinished());
+    QCOMPARE(finished.result().count(), 3);
+    QFuture<QList<QFuture<int> > > empty = QtFuture::whenAll(QList<QFuture<int> >());
+    QVERIFY(empty.isFinished());
+    QVERIFY(empty.result().isEmpty());
+
+    // mixed types through QFuture<void>
+    QFutureInterface<QString> i4;
+    i4.reportStarted();
+    QList<QFuture<void> > mixed;
+    mixed << i1.future() << i4.future();
+    QFuture<QList<QFuture<void> > > allMixed = QtFuture::whenAll(mixed);
+    QVERIFY(!allMixed.isFinished());
+    i4.reportFinished(new QString("done"));
+    QVERIFY(allMixed.isFinished());
+}
+
+void tst_QFuture::whenAny()
+{
+    QFutureInterface<int> i1, i2;
+    i1.reportStarted();
+    i2.reportStarted();
+
+    QList<QFuture<int> > futures;
+    futures << i1.future() << i2.future();
+    QFuture<QtFuture::WhenAnyResult<int> > any = QtFuture::whenAny(futures);
+    QVERIFY(!any.isFinished());
+
+    i2.reportFinished(new int(2));
+    QVERIFY(any.isFinished());
+    QCOMPARE(any.result().index, 1);
+    QCOMPARE(any.result().future.result(), 2);
+
+    i1.reportFinished(new int(1));
+    QCOMPARE(any.result().index, 1);
+
+    QFuture<QtFuture::WhenAnyResult<int> > empty = QtFuture::whenAny(QList<QFuture<int> >());
+    QVERIFY(empty.isFinished());
+    QCOMPARE(empty.result().index, -1);
+}
+
+void tst_QFuture::droppedUnfinished()
+{
+    QFuture<int> plusOne;
+    QFuture<QList<QFuture<int> > > all;
+    QFuture<QtFuture::WhenAnyResult<int> > any;
+    QFutureInterface<int> other;
+    other.reportStarted();
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        plusOne = i.future().then(addOne);
+        all = QtFuture::whenAll(QList<QFuture<int> >() << i.future() << other.future());
+        any = QtFuture::whenAny(QList<QFuture<int> >() << i.future());
+        QVERIFY(!plusOne.isFinished());
+        QVERIFY(!all.isFinished());
+        QVERIFY(!any.isFinished());
+    }
+
+    // nothing keeps a future alive through its continuations, so once the
+    // last reference is gone they are canceled instead of waiting forever
+    QVERIFY(plusOne.isFinished());
+    QVERIFY(plusOne.isCanceled());
+    QVERIFY(any.isFinished());
+    QVERIFY(any.isCanceled());
+
+    QVERIFY(!all.isFinished());
+    other.reportFinished(new int(1));
+    QVERIFY(all.isFinished());
+    QVERIFY(all.isCanceled());
+}
+
 #ifndef QT_NO_EXCEPTIONS
 
 QFuture<void> createExceptionFuture()
@@ -1444,6 +1755,129 @@ void tst_QFuture::nestedExceptions()
     QVERIFY(MyClass::caught);
 }
 
+static int throwDerived(QFuture<int>)
+{
+    throw DerivedException();
+}
+
+static int throwInt(QFuture<int>)
+{
+    throw 1;
+}
+
+static int recoverFromFailure(const QException &exception)
+{
+    return dynamic_cast<const DerivedException *>(&exception) ? -1 : -2;
+}
+
+static bool voidHandlerCalled = false;
+
+static void voidHandler(const QException &)
+{
+    voidHandlerCalled = true;
+}
+
+void tst_QFuture::thenExceptions()
+{
+    // exceptions thrown by a continuation end up in its future
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future().then(throwDerived);
+        i.reportFinished(new int(1));
+        QVERIFY(f.isFinished());
+        QVERIFY(f.isCanceled());
+        bool caught = false;
+        try {
+            f.waitForFinished();
+        } catch (DerivedException &) {
+            caught = true;
+        }
+        QVERIFY(caught);
+    }
+
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future().then(throwInt);
+        i.reportFinished(new int(1));
+        bool caught = false;
+        try {
+            f.waitForFinished();
+        } catch (QUnhandledException &) {
+            caught = true;
+        }
+        QVERIFY(caught);
+    }
+
+    // and are passed along the chain without running later continuations
+    {
+        voidContinuationCalls = 0;
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<void> f = i.future().then(throwDerived).then(countCall);
+        i.reportFinished(new int(1));
+        QVERIFY(f.isFinished());
+        QCOMPARE(voidContinuationCalls, 0);
+        bool caught = false;
+        try {
+            f.waitForFinished();
+        } catch (DerivedException &) {
+            caught = true;
+        }
+        QVERIFY(caught);
+    }
+}
+
+void tst_QFuture::onFailed()
+{
+    // handler recovers from an exception
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future().then(throwDerived).onFailed(recoverFromFailure).then(addOne);
+        i.reportFinished(new int(1));
+        QVERIFY(f.isFinished());
+        QVERIFY(!f.isCanceled());
+        QCOMPARE(f.result(), 0);
+    }
+
+    {
+        QFuture<int> f = createExceptionFuture().then(fortyTwo).onFailed(recoverFromFailure);
+        QCOMPARE(f.result(), -2);
+    }
+
+    // successful results are passed through untouched
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future().onFailed(recoverFromFailure);
+        i.reportResult(1);
+        i.reportResult(2);
+        i.reportFinished();
+        QCOMPARE(f.results(), QList<int>() << 1 << 2);
+    }
+
+    // plain cancellation is not a failure
+    {
+        QFutureInterface<int> i;
+        i.reportStarted();
+        QFuture<int> f = i.future().onFailed(recoverFromFailure);
+        i.reportCanceled();
+        i.reportFinished();
+        QVERIFY(f.isCanceled());
+        QCOMPARE(f.resultCount(), 0);
+    }
+
+    {
+        voidHandlerCalled = false;
+        QFuture<void> f = createDerivedExceptionFuture().onFailed(voidHandler);
+        QVERIFY(f.isFinished());
+        QVERIFY(!f.isCanceled());
+        QVERIFY(voidHandlerCalled);
+    }
+}
+
 #endif // QT_NO_EXCEPTIONS
 
 QTEST_MAIN(tst_QFuture)
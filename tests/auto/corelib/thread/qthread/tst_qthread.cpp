@@ -53,6 +53,9 @@
 #ifdef Q_OS_UNIX
 #include <pthread.h>
 #endif
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+#include <sched.h>
+#endif
 #if defined(Q_OS_WINCE)
 #include <windows.h>
 #elif defined(Q_OS_WIN)
@@ -71,6 +74,8 @@ private slots:
     void isRunning();
     void setPriority();
     void setStackSize();
+    void setCpuAffinity();
+    void numaNodes();
     void exit();
     void start();
     void terminate();
@@ -409,6 +414,85 @@ void tst_QThread::setStackSize()
     QCOMPARE(thread.stackSize(), 0u);
 }
 
+static QList<int> currentCpuAffinity()
+{
+    QList<int> cpus;
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set))
+                cpus.append(cpu);
+        }
+    }
+#endif
+    return cpus;
+}
+
+class AffinityThread : public QThread
+{
+public:
+    QList<int> runningOn;
+    QSemaphore proceed;
+    bool waitBeforeSampling;
+
+    AffinityThread() : waitBeforeSampling(false) {}
+
+    void run()
+    {
+        if (waitBeforeSampling)
+            proceed.acquire();
+        runningOn = currentCpuAffinity();
+    }
+};
+
+void tst_QThread::setCpuAffinity()
+{
+    AffinityThread thread;
+    QVERIFY(thread.cpuAffinity().isEmpty());
+    const QList<int> firstCpu = QList<int>() << 0;
+    thread.setCpuAffinity(firstCpu);
+    QCOMPARE(thread.cpuAffinity(), firstCpu);
+
+    thread.start();
+    QVERIFY(thread.wait(five_minutes));
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    QCOMPARE(thread.runningOn, firstCpu);
+#endif
+
+    // lifting the restriction of a running thread gives it the processors
+    // the process may use, not every processor in the system
+    const QList<int> processCpus = currentCpuAffinity();
+    thread.waitBeforeSampling = true;
+    thread.start();
+    thread.setCpuAffinity(QList<int>());
+    QVERIFY(thread.cpuAffinity().isEmpty());
+    thread.proceed.release();
+    QVERIFY(thread.wait(five_minutes));
+#if defined(Q_OS_LINUX) && defined(__GLIBC__)
+    QVERIFY(!processCpus.isEmpty());
+    QCOMPARE(thread.runningOn, processCpus);
+#endif
+}
+
+void tst_QThread::numaNodes()
+{
+    QVERIFY(QThread::numaNodeCount() >= 1);
+
+    QSet<int> cpus;
+    for (int node = 0; node < QThread::numaNodeCount(); ++node) {
+        foreach (int cpu, QThread::numaNodeCpus(node)) {
+            QVERIFY(cpu >= 0);
+            QVERIFY2(!cpus.contains(cpu), "a CPU belongs to more than one node");
+            cpus.insert(cpu);
+        }
+    }
+    QVERIFY(!cpus.isEmpty());
+    QVERIFY(QThread::numaNodeCpus(-1).isEmpty());
+    QVERIFY(QThread::numaNodeCpus(QThread::numaNodeCount()).isEmpty());
+}
+
 void tst_QThread::exit()
 {
     Exit_Thread thread;
@@ -101,6 +101,12 @@ private slots:
     void clear();
     void waitForDoneTimeout();
     void destroyingWaitsForTasksToFinish();
+    void workStealing_data();
+    void workStealing();
+    void workStealingPriorityStart();
+    void workStealingClear();
+    void numaAware();
+    void cpuAffinity();
     void stressTest();
 
 private:
@@ -976,6 +982,197 @@ void tst_QThreadPool::destroyingWaitsForTasksToFinish()
     }
 }
 
+void tst_QThreadPool::workStealing_data()
+{
+    QTest::addColumn<int>("maxThreadCount");
+    QTest::newRow("1") << 1;
+    QTest::newRow("2") << 2;
+    QTest::newRow("8") << 8;
+}
+
+void tst_QThreadPool::workStealing()
+{
+    // each runnable starts its children from within the pool, so that they
+    // end up on the worker's own queue and have to be stolen by the others
+    class SpawningRunnable : public QRunnable
+    {
+    public:
+        QThreadPool *pool;
+        int depth;
+        SpawningRunnable(QThreadPool *pool, int depth) : pool(pool), depth(depth) {}
+        void run()
+        {
+            count.ref();
+            if (depth > 0) {
+                pool->start(new SpawningRunnable(pool, depth - 1));
+                pool->start(new SpawningRunnable(pool, depth - 1));
+            }
+        }
+    };
+
+    QFETCH(int, maxThreadCount);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(maxThreadCount);
+    QVERIFY(!threadPool.isWorkStealingEnabled());
+    threadPool.setWorkStealingEnabled(true);
+    QVERIFY(threadPool.isWorkStealingEnabled());
+
+    const int depth = 10;
+    const int roots = 4;
+    count.store(0);
+    for (int i = 0; i < roots; ++i)
+        threadPool.start(new SpawningRunnable(&threadPool, depth));
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(count.load(), roots * ((2 << depth) - 1));
+    QCOMPARE(threadPool.activeThreadCount(), 0);
+
+    // switching the mode back must not lose anything
+    count.store(0);
+    for (int i = 0; i < 1000; ++i) {
+        threadPool.start(new CountingRunnable());
+        if (i == 500)
+            threadPool.setWorkStealingEnabled(false);
+    }
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(count.load(), 1000);
+}
+
+void tst_QThreadPool::workStealingPriorityStart()
+{
+    class Holder : public QRunnable
+    {
+    public:
+        QSemaphore &sem;
+        Holder(QSemaphore &sem) : sem(sem) {}
+        void run()
+        {
+            sem.acquire();
+        }
+    };
+    class Runner : public QRunnable
+    {
+    public:
+        QAtomicPointer<QRunnable> &ptr;
+        Runner(QAtomicPointer<QRunnable> &ptr) : ptr(ptr) {}
+        void run()
+        {
+            ptr.testAndSetRelaxed(0, this);
+        }
+    };
+
+    QSemaphore sem;
+    QAtomicPointer<QRunnable> firstStarted;
+    QRunnable *expected;
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(1);
+    threadPool.setWorkStealingEnabled(true);
+
+    threadPool.start(new Holder(sem));
+    for (int i = 0; i < 10; ++i)
+        threadPool.start(new Runner(firstStarted));
+    threadPool.start(expected = new Runner(firstStarted), 1);
+
+    sem.release();
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(firstStarted.load(), expected);
+}
+
+void tst_QThreadPool::workStealingClear()
+{
+    QSemaphore sem(0);
+    class BlockingRunnable : public QRunnable
+    {
+        public:
+            QSemaphore & sem;
+            BlockingRunnable(QSemaphore & sem) : sem(sem){}
+            void run()
+            {
+                sem.acquire();
+                count.ref();
+            }
+    };
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(4);
+    threadPool.setWorkStealingEnabled(true);
+    count.store(0);
+    for (int i = 0; i < 20; ++i)
+        threadPool.start(new BlockingRunnable(sem));
+
+    // wait for all threads to have picked up their first runnable
+    QTRY_COMPARE(threadPool.activeThreadCount(), threadPool.maxThreadCount());
+    QTest::qWait(50);
+    threadPool.clear();
+    sem.release(threadPool.maxThreadCount());
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(count.load(), threadPool.maxThreadCount());
+}
+
+class AffinityRecordingRunnable : public QRunnable
+{
+public:
+    static QMutex mutex;
+    static QList<QList<int> > affinities;
+
+    void run()
+    {
+        QMutexLocker locker(&mutex);
+        affinities.append(QThread::currentThread()->cpuAffinity());
+    }
+};
+
+QMutex AffinityRecordingRunnable::mutex;
+QList<QList<int> > AffinityRecordingRunnable::affinities;
+
+void tst_QThreadPool::numaAware()
+{
+    QThreadPool threadPool;
+    QVERIFY(!threadPool.isNumaAware());
+    threadPool.setNumaAware(true);
+    QVERIFY(threadPool.isNumaAware());
+    QVERIFY(threadPool.isWorkStealingEnabled());
+
+    AffinityRecordingRunnable::affinities.clear();
+    for (int i = 0; i < 100; ++i)
+        threadPool.start(new AffinityRecordingRunnable);
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(AffinityRecordingRunnable::affinities.size(), 100);
+
+    // every thread is restricted to exactly the processors of one node
+    foreach (const QList<int> &affinity, AffinityRecordingRunnable::affinities) {
+        bool found = false;
+        for (int node = 0; node < QThread::numaNodeCount() && !found; ++node)
+            found = !affinity.isEmpty() && affinity == QThread::numaNodeCpus(node);
+        QVERIFY(found);
+    }
+}
+
+void tst_QThreadPool::cpuAffinity()
+{
+    QThreadPool threadPool;
+    QVERIFY(threadPool.cpuAffinity().isEmpty());
+    const QList<int> firstCpu = QList<int>() << 0;
+    threadPool.setCpuAffinity(firstCpu);
+    QCOMPARE(threadPool.cpuAffinity(), firstCpu);
+
+    AffinityRecordingRunnable::affinities.clear();
+    for (int i = 0; i < 20; ++i)
+        threadPool.start(new AffinityRecordingRunnable);
+    QVERIFY(threadPool.waitForDone());
+    QCOMPARE(AffinityRecordingRunnable::affinities.size(), 20);
+    foreach (const QList<int> &affinity, AffinityRecordingRunnable::affinities)
+        QCOMPARE(affinity, firstCpu);
+
+    // NUMA awareness narrows the pool's affinity down, but never widens it
+    threadPool.setNumaAware(true);
+    AffinityRecordingRunnable::affinities.clear();
+    for (int i = 0; i < 20; ++i)
+        threadPool.start(new AffinityRecordingRunnable);
+    QVERIFY(threadPool.waitForDone());
+    foreach (const QList<int> &affinity, AffinityRecordingRunnable::affinities)
+        QCOMPARE(affinity, firstCpu);
+}
+
 void tst_QThreadPool::stressTest()
 {
     class Task : public QRunnable
@@ -0,0 +1,334 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qflathash.h>
+
+class tst_QFlatHash : public QObject
+{
+    Q_OBJECT
+private slots:
+    void basics();
+    void randomOperations();
+    void implicitSharing();
+    void iterators();
+    void eraseWhileIterating();
+    void stringKeys();
+    void complexValues();
+    void reserveAndSqueeze();
+    void tombstones();
+    void equality();
+    void initializerList();
+};
+
+struct Counted
+{
+    static int count;
+    Counted(int v = 0) : value(v) { ++count; }
+    Counted(const Counted &other) : value(other.value) { ++count; }
+    ~Counted() { --count; }
+    bool operator==(const Counted &other) const { return value == other.value; }
+    int value;
+};
+int Counted::count = 0;
+
+void tst_QFlatHash::basics()
+{
+    QFlatHash<int, int> hash;
+    QVERIFY(hash.isEmpty());
+    QCOMPARE(hash.size(), 0);
+    QVERIFY(!hash.contains(1));
+    QCOMPARE(hash.value(1), 0);
+    QCOMPARE(hash.value(1, 42), 42);
+    QVERIFY(hash.constFind(1) == hash.constEnd());
+    QCOMPARE(hash.remove(1), 0);
+
+    hash.insert(1, 10);
+    hash.insert(2, 20);
+    hash[3] = 30;
+    QCOMPARE(hash.size(), 3);
+    QCOMPARE(hash.value(1), 10);
+    QCOMPARE(hash.value(2), 20);
+    QCOMPARE(hash[3], 30);
+    QCOMPARE(hash.key(20), 2);
+    QCOMPARE(hash.key(99, -1), -1);
+
+    hash.insert(1, 11);
+    QCOMPARE(hash.size(), 3);
+    QCOMPARE(hash.value(1), 11);
+
+    QCOMPARE(hash.take(2), 20);
+    QCOMPARE(hash.take(2), 0);
+    QCOMPARE(hash.size(), 2);
+    QCOMPARE(hash.remove(3), 1);
+    QCOMPARE(hash.remove(3), 0);
+
+    QList<int> keys = hash.keys();
+    QCOMPARE(keys, QList<int>() << 1);
+    QCOMPARE(hash.values(), QList<int>() << 11);
+
+    hash.clear();
+    QVERIFY(hash.isEmpty());
+    QCOMPARE(hash.capacity(), 0);
+}
+
+void tst_QFlatHash::randomOperations()
+{
+    QFlatHash<int, int> hash;
+    QHash<int, int> reference;
+
+    qsrand(42);
+    for (int i = 0; i < 100000; ++i) {
+        const int key = qrand() % 5000;
+        switch (qrand() % 4) {
+        case 0:
+        case 1:
+            hash.insert(key, i);
+            reference.insert(key, i);
+            break;
+        case 2:
+            QCOMPARE(hash.remove(key), reference.remove(key));
+            break;
+        case 3:
+            QCOMPARE(hash.value(key, -1), reference.value(key, -1));
+            break;
+        }
+        QCOMPARE(hash.size(), reference.size());
+    }
+
+    int visited = 0;
+    for (QFlatHash<int, int>::const_iterator it = hash.constBegin(); it != hash.constEnd(); ++it) {
+        QCOMPARE(it.value(), reference.value(it.key(), -1));
+        ++visited;
+    }
+    QCOMPARE(visited, reference.size());
+}
+
+void tst_QFlatHash::implicitSharing()
+{
+    QFlatHash<int, QString> hash;
+    for (int i = 0; i < 100; ++i)
+        hash.insert(i, QString::number(i));
+
+    QFlatHash<int, QString> copy = hash;
+    QVERIFY(copy.isSharedWith(hash));
+    QVERIFY(!hash.isDetached());
+
+    copy.insert(100, QStringLiteral("100"));
+    QVERIFY(!copy.isSharedWith(hash));
+    QVERIFY(hash.isDetached());
+    QCOMPARE(hash.size(), 100);
+    QCOMPARE(copy.size(), 101);
+    QVERIFY(!hash.contains(100));
+
+    copy = hash;
+    copy.remove(5);
+    QVERIFY(hash.contains(5));
+    QVERIFY(!copy.contains(5));
+
+    copy = hash;
+    copy[7] = QStringLiteral("seven");
+    QCOMPARE(hash.value(7), QStringLiteral("7"));
+    QCOMPARE(copy.value(7), QStringLiteral("seven"));
+
+    QFlatHash<int, QString> other;
+    other.swap(copy);
+    QVERIFY(copy.isEmpty());
+    QCOMPARE(other.size(), 100);
+}
+
+void tst_QFlatHash::iterators()
+{
+    QFlatHash<int, int> hash;
+    QVERIFY(hash.constBegin() == hash.constEnd());
+
+    int expectedSum = 0;
+    for (int i = 0; i < 1000; ++i) {
+        hash.insert(i, 2 * i);
+        expectedSum += 2 * i;
+    }
+
+    int sum = 0;
+    for (QFlatHash<int, int>::iterator it = hash.begin(); it != hash.end(); ++it) {
+        QCOMPARE(*it, 2 * it.key());
+        ++it.value();
+        sum += it.value() - 1;
+    }
+    QCOMPARE(sum, expectedSum);
+    QCOMPARE(hash.value(10), 21);
+
+    QFlatHash<int, int>::iterator it = hash.find(500);
+    QVERIFY(it != hash.end());
+    QCOMPARE(it.key(), 500);
+    QVERIFY(hash.find(5000) == hash.end());
+
+    const QFlatHash<int, int> &constHash = hash;
+    QFlatHash<int, int>::const_iterator cit = constHash.find(500);
+    QCOMPARE(cit.value(), 1001);
+}
+
+void tst_QFlatHash::eraseWhileIterating()
+{
+    QFlatHash<int, int> hash;
+    for (int i = 0; i < 1000; ++i)
+        hash.insert(i, i);
+
+    QFlatHash<int, int>::iterator it = hash.begin();
+    while (it != hash.end()) {
+        if (it.key() % 2)
+            it = hash.erase(it);
+        else
+            ++it;
+    }
+    QCOMPARE(hash.size(), 500);
+    for (int i = 0; i < 1000; ++i)
+        QCOMPARE(hash.contains(i), i % 2 == 0);
+
+    it = hash.begin();
+    while (it != hash.end())
+        it = hash.erase(it);
+    QVERIFY(hash.isEmpty());
+    QVERIFY(hash.begin() == hash.end());
+}
+
+void tst_QFlatHash::stringKeys()
+{
+    QFlatHash<QString, int> hash;
+    for (int i = 0; i < 10000; ++i)
+        hash.insert(QStringLiteral("/usr/share/doc/package%1/README").arg(i), i);
+    QCOMPARE(hash.size(), 10000);
+    for (int i = 0; i < 10000; ++i)
+        QCOMPARE(hash.value(QStringLiteral("/usr/share/doc/package%1/README").arg(i), -1), i);
+    QVERIFY(!hash.contains(QStringLiteral("/usr/share/doc/package10000/README")));
+}
+
+void tst_QFlatHash::complexValues()
+{
+    {
+        QFlatHash<int, Counted> hash;
+        for (int i = 0; i < 1000; ++i)
+            hash.insert(i, Counted(i));
+        QCOMPARE(Counted::count, 1000);
+
+        QFlatHash<int, Counted> copy = hash;
+        copy.insert(1000, Counted(1000));
+        QCOMPARE(Counted::count, 2001);
+
+        for (int i = 0; i < 500; ++i)
+            copy.remove(i);
+        QCOMPARE(Counted::count, 1501);
+        QCOMPARE(copy.take(600).value, 600);
+        QCOMPARE(Counted::count, 1500);
+
+        copy.squeeze();
+        QCOMPARE(Counted::count, 1500);
+        QCOMPARE(copy.value(999).value, 999);
+    }
+    QCOMPARE(Counted::count, 0);
+}
+
+void tst_QFlatHash::reserveAndSqueeze()
+{
+    QFlatHash<int, int> hash;
+    hash.reserve(1000);
+    const int capacity = hash.capacity();
+    QVERIFY(capacity >= 1000);
+    for (int i = 0; i < 1000; ++i)
+        hash.insert(i, i);
+    QCOMPARE(hash.capacity(), capacity);
+
+    for (int i = 10; i < 1000; ++i)
+        hash.remove(i);
+    hash.squeeze();
+    QVERIFY(hash.capacity() < capacity);
+    QCOMPARE(hash.size(), 10);
+    for (int i = 0; i < 10; ++i)
+        QCOMPARE(hash.value(i), i);
+}
+
+void tst_QFlatHash::tombstones()
+{
+    // inserting and removing different keys must not grow the table
+    QFlatHash<int, int> hash;
+    for (int i = 0; i < 100; ++i)
+        hash.insert(i, i);
+    const int capacity = hash.capacity();
+    for (int i = 100; i < 100000; ++i) {
+        hash.insert(i, i);
+        hash.remove(i - 100);
+    }
+    QCOMPARE(hash.size(), 100);
+    QCOMPARE(hash.capacity(), capacity);
+    for (int i = 99900; i < 100000; ++i)
+        QCOMPARE(hash.value(i), i);
+}
+
+void tst_QFlatHash::equality()
+{
+    QFlatHash<int, int> a;
+    QFlatHash<int, int> b;
+    QVERIFY(a == b);
+    for (int i = 0; i < 100; ++i)
+        a.insert(i, i);
+    for (int i = 99; i >= 0; --i)
+        b.insert(i, i);
+    QVERIFY(a == b);
+    b.insert(5, 6);
+    QVERIFY(a != b);
+    b.insert(5, 5);
+    b.insert(100, 100);
+    QVERIFY(a != b);
+}
+
+void tst_QFlatHash::initializerList()
+{
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+    QFlatHash<int, QString> hash = { { 1, QStringLiteral("one") }, { 2, QStringLiteral("two") } };
+    QCOMPARE(hash.size(), 2);
+    QCOMPARE(hash.value(1), QStringLiteral("one"));
+    QCOMPARE(hash.value(2), QStringLiteral("two"));
+#else
+    QSKIP("Compiler doesn't support initializer lists");
+#endif
+}
+
+QTEST_APPLESS_MAIN(tst_QFlatHash)
+#include "tst_qflathash.moc"
@@ -0,0 +1,382 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+#include <qflatmap.h>
+
+class tst_QFlatMap : public QObject
+{
+    Q_OBJECT
+private slots:
+    void basics();
+    void randomOperations();
+    void bulkConstruction();
+    void batchInsert();
+    void implicitSharing();
+    void iterators();
+    void bounds();
+    void conversions();
+    void pointerKeys();
+    void initializerList();
+    void flatSet();
+    void flatSetBatchInsert();
+};
+
+void tst_QFlatMap::basics()
+{
+    QFlatMap<int, int> map;
+    QVERIFY(map.isEmpty());
+    QCOMPARE(map.size(), 0);
+    QVERIFY(!map.contains(1));
+    QCOMPARE(map.value(1), 0);
+    QCOMPARE(map.value(1, 42), 42);
+    QVERIFY(map.constFind(1) == map.constEnd());
+    QCOMPARE(map.remove(1), 0);
+
+    map.insert(3, 30);
+    map.insert(1, 10);
+    map[2] = 20;
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(map.value(1), 10);
+    QCOMPARE(map.value(2), 20);
+    QCOMPARE(map[3], 30);
+    QCOMPARE(map.firstKey(), 1);
+    QCOMPARE(map.lastKey(), 3);
+    QCOMPARE(map.first(), 10);
+    QCOMPARE(map.last(), 30);
+    QCOMPARE(map.key(20), 2);
+    QCOMPARE(map.key(99, -1), -1);
+    QCOMPARE(map.keys(), QVector<int>() << 1 << 2 << 3);
+    QCOMPARE(map.values(), QVector<int>() << 10 << 20 << 30);
+
+    map.insert(1, 11);
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(map.value(1), 11);
+
+    QCOMPARE(map.take(2), 20);
+    QCOMPARE(map.take(2), 0);
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map.remove(3), 1);
+    QCOMPARE(map.remove(3), 0);
+    QCOMPARE(map.keys(), QVector<int>() << 1);
+
+    map.clear();
+    QVERIFY(map.isEmpty());
+}
+
+void tst_QFlatMap::randomOperations()
+{
+    QFlatMap<int, int> map;
+    QMap<int, int> reference;
+
+    qsrand(42);
+    for (int i = 0; i < 20000; ++i) {
+        const int key = qrand() % 1000;
+        switch (qrand() % 4) {
+        case 0:
+        case 1:
+            map.insert(key, i);
+            reference.insert(key, i);
+            break;
+        case 2:
+            QCOMPARE(map.remove(key), reference.remove(key));
+            break;
+        case 3:
+            QCOMPARE(map.value(key, -1), reference.value(key, -1));
+            break;
+        }
+    }
+
+    QCOMPARE(map.size(), reference.size());
+    QVERIFY(map.toMap() == reference);
+    QVERIFY((QFlatMap<int, int>(reference) == map));
+}
+
+void tst_QFlatMap::bulkConstruction()
+{
+    QVector<QPair<int, QString> > pairs;
+    pairs << qMakePair(5, QString("five"))
+          << qMakePair(1, QString("one"))
+          << qMakePair(3, QString("three"))
+          << qMakePair(1, QString("uno"))
+          << qMakePair(4, QString("four"));
+
+    const QFlatMap<int, QString> map(pairs);
+    QCOMPARE(map.size(), 4);
+    QCOMPARE(map.keys(), QVector<int>() << 1 << 3 << 4 << 5);
+    // the last of several equal keys wins, as with repeated insert()
+    QCOMPARE(map.value(1), QString("uno"));
+    QCOMPARE(map.value(5), QString("five"));
+
+    // already sorted input is taken as is
+    QVector<QPair<int, int> > sorted;
+    for (int i = 0; i < 100; ++i)
+        sorted << qMakePair(i * 2, i);
+    const QFlatMap<int, int> sortedMap(sorted);
+    QCOMPARE(sortedMap.size(), 100);
+    QCOMPARE(sortedMap.value(198), 99);
+    QVERIFY(!sortedMap.contains(199));
+
+    const QFlatMap<int, int> empty((QVector<QPair<int, int> >()));
+    QVERIFY(empty.isEmpty());
+}
+
+void tst_QFlatMap::batchInsert()
+{
+    QFlatMap<int, int> map;
+    for (int i = 0; i < 10; ++i)
+        map.insert(i * 10, i);
+
+    QVector<QPair<int, int> > batch;
+    batch << qMakePair(95, -1) << qMakePair(5, -2) << qMakePair(50, -3) << qMakePair(200, -4);
+    map.insert(batch);
+    QCOMPARE(map.size(), 13);
+    QCOMPARE(map.value(5), -2);
+    QCOMPARE(map.value(50), -3);
+    QCOMPARE(map.value(95), -1);
+    QCOMPARE(map.value(200), -4);
+    QCOMPARE(map.value(40), 4);
+
+    int previous = -1;
+    for (QFlatMap<int, int>::const_iterator it = map.constBegin(); it != map.constEnd(); ++it) {
+        QVERIFY(previous < it.key());
+        previous = it.key();
+    }
+
+    // appending past the end
+    QFlatMap<int, int> tail;
+    tail.insert(300, 1);
+    tail.insert(400, 2);
+    map.insert(tail);
+    QCOMPARE(map.size(), 15);
+    QCOMPARE(map.lastKey(), 400);
+
+    QFlatMap<int, int> empty;
+    empty.insert(map);
+    QVERIFY(empty == map);
+}
+
+void tst_QFlatMap::implicitSharing()
+{
+    QFlatMap<int, QString> map;
+    map.insert(1, "one");
+    map.insert(2, "two");
+
+    QFlatMap<int, QString> copy = map;
+    QVERIFY(!map.isDetached());
+    QVERIFY(copy == map);
+
+    copy.insert(3, "three");
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(copy.size(), 3);
+    QVERIFY(!map.contains(3));
+
+    QFlatMap<int, QString> copy2 = map;
+    copy2[1] = "uno";
+    QCOMPARE(map.value(1), QString("one"));
+    QCOMPARE(copy2.value(1), QString("uno"));
+
+    QFlatMap<int, QString> copy3 = map;
+    *copy3.begin() = "eins";
+    QCOMPARE(map.value(1), QString("one"));
+    QCOMPARE(copy3.value(1), QString("eins"));
+}
+
+void tst_QFlatMap::iterators()
+{
+    QFlatMap<int, int> map;
+    for (int i = 0; i < 100; ++i)
+        map.insert(99 - i, i);
+
+    int expected = 0;
+    for (QFlatMap<int, int>::iterator it = map.begin(); it != map.end(); ++it) {
+        QCOMPARE(it.key(), expected);
+        QCOMPARE(it.value(), 99 - expected);
+        *it = expected;
+        ++expected;
+    }
+    QCOMPARE(map.value(42), 42);
+
+    QCOMPARE(map.end() - map.begin(), qptrdiff(100));
+    QFlatMap<int, int>::const_iterator it = map.constEnd();
+    --it;
+    QCOMPARE(it.key(), 99);
+    it -= 9;
+    QCOMPARE(it.key(), 90);
+    QVERIFY(map.constBegin() < it);
+
+    QFlatMap<int, int>::iterator e = map.begin();
+    while (e != map.end()) {
+        if (e.key() % 2)
+            e = map.erase(e);
+        else
+            ++e;
+    }
+    QCOMPARE(map.size(), 50);
+    QCOMPARE(map.firstKey(), 0);
+    QCOMPARE(map.lastKey(), 98);
+
+    QVERIFY(map.find(3) == map.end());
+    QCOMPARE(map.find(4).value(), 4);
+    QCOMPARE(std::distance(map.constBegin(), map.constFind(10)), qptrdiff(5));
+}
+
+void tst_QFlatMap::bounds()
+{
+    QFlatMap<int, int> map;
+    map.insert(10, 1);
+    map.insert(20, 2);
+    map.insert(30, 3);
+
+    QCOMPARE(map.lowerBound(20).key(), 20);
+    QCOMPARE(map.upperBound(20).key(), 30);
+    QCOMPARE(map.lowerBound(15).key(), 20);
+    QCOMPARE(map.upperBound(15).key(), 20);
+    QVERIFY(map.lowerBound(5) == map.begin());
+    QVERIFY(map.lowerBound(31) == map.end());
+    QVERIFY(map.upperBound(30) == map.end());
+
+    const QFlatMap<int, int> &cmap = map;
+    QCOMPARE(cmap.lowerBound(25).value(), 3);
+}
+
+void tst_QFlatMap::conversions()
+{
+    QMap<QString, int> qmap;
+    qmap.insert("banana", 2);
+    qmap.insert("apple", 1);
+    qmap.insert("cherry", 3);
+
+    const QFlatMap<QString, int> map(qmap);
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(map.firstKey(), QString("apple"));
+    QCOMPARE(map.value("cherry"), 3);
+    QVERIFY(map.toMap() == qmap);
+}
+
+void tst_QFlatMap::pointerKeys()
+{
+    int values[4];
+    QFlatMap<int *, int> map;
+    map.insert(&values[2], 2);
+    map.insert(&values[0], 0);
+    map.insert(&values[3], 3);
+    map.insert(&values[1], 1);
+    QCOMPARE(map.size(), 4);
+    for (int i = 0; i < 4; ++i)
+        QCOMPARE(map.value(&values[i]), i);
+}
+
+void tst_QFlatMap::initializerList()
+{
+#ifdef Q_COMPILER_INITIALIZER_LISTS
+    QFlatMap<int, QString> map = { { 2, "two" }, { 1, "one" }, { 2, "zwei" } };
+    QCOMPARE(map.size(), 2);
+    QCOMPARE(map.firstKey(), 1);
+    QCOMPARE(map.value(2), QString("zwei"));
+
+    QFlatSet<int> set = { 3, 1, 2, 3 };
+    QCOMPARE(set.values(), QVector<int>() << 1 << 2 << 3);
+#else
+    QSKIP("Compiler doesn't support initializer lists");
+#endif
+}
+
+void tst_QFlatMap::flatSet()
+{
+    QFlatSet<QString> set;
+    QVERIFY(set.isEmpty());
+    QVERIFY(!set.contains("a"));
+    QVERIFY(!set.remove("a"));
+
+    set.insert("c");
+    set.insert("a");
+    set.insert("b");
+    QCOMPARE(*set.insert("a"), QString("a"));
+    QCOMPARE(set.size(), 3);
+    QCOMPARE(set.values(), QVector<QString>() << "a" << "b" << "c");
+    QCOMPARE(set.first(), QString("a"));
+    QCOMPARE(set.last(), QString("c"));
+    QVERIFY(set.contains("b"));
+    QVERIFY(set.find("d") == set.end());
+    QCOMPARE(*set.lowerBound("bb"), QString("c"));
+    QCOMPARE(*set.upperBound("a"), QString("b"));
+
+    QFlatSet<QString> copy = set;
+    QVERIFY(copy.remove("b"));
+    QCOMPARE(copy.size(), 2);
+    QCOMPARE(set.size(), 3);
+    QVERIFY(copy != set);
+
+    QFlatSet<QString>::const_iterator it = set.erase(set.constFind("a"));
+    QCOMPARE(*it, QString("b"));
+    QCOMPARE(set.toList(), QList<QString>() << "b" << "c");
+
+    QVector<int> unsorted;
+    unsorted << 5 << 3 << 5 << 1 << 3 << 9;
+    const QFlatSet<int> ints(unsorted);
+    QCOMPARE(ints.values(), QVector<int>() << 1 << 3 << 5 << 9);
+}
+
+void tst_QFlatMap::flatSetBatchInsert()
+{
+    QFlatSet<int> set;
+    QSet<int> reference;
+
+    qsrand(7);
+    for (int round = 0; round < 20; ++round) {
+        QVector<int> batch;
+        for (int i = 0; i < 50; ++i) {
+            const int v = qrand() % 500;
+            batch << v;
+            reference.insert(v);
+        }
+        set.insert(batch);
+    }
+
+    QCOMPARE(set.size(), reference.size());
+    QList<int> expected = reference.toList();
+    std::sort(expected.begin(), expected.end());
+    QCOMPARE(set.toList(), expected);
+}
+
+QTEST_APPLESS_MAIN(tst_QFlatMap)
+#include "tst_qflatmap.moc"
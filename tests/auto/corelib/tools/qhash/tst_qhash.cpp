@@ -79,6 +79,9 @@ private slots:
     void qthash_data();
     void qthash();
     void eraseValidIteratorOnSharedHash();
+    void stringHashes_data();
+    void stringHashes();
+    void commonPrefixDistribution();
 };
 
 struct Foo {
@@ -1382,5 +1385,53 @@ void tst_QHash::eraseValidIteratorOnSharedHash()
     QCOMPARE(itemsWith10, 3);
 }
 
+void tst_QHash::stringHashes_data()
+{
+    QTest::addColumn<QString>("key");
+
+    // cover every tail length of the word-at-a-time loop
+    const QString alphabet = QStringLiteral("abcdefghijklmnopqrstuvwxyz");
+    for (int i = 0; i <= 20; ++i)
+        QTest::newRow(qPrintable(QString::number(i))) << alphabet.left(i);
+    QTest::newRow("latin1") << QString::fromLatin1("gr\xf6\xdf" "e");
+}
+
+void tst_QHash::stringHashes()
+{
+    QFETCH(QString, key);
+    const QByteArray latin1 = key.toLatin1();
+    const QString padded = QLatin1Char('x') + key + QLatin1Char('x');
+    const QStringRef ref(&padded, 1, key.size());
+
+    const uint seeds[] = { 0, 1, 0xdeadbeef };
+    for (uint i = 0; i < sizeof(seeds) / sizeof(seeds[0]); ++i) {
+        const uint seed = seeds[i];
+        QCOMPARE(qHash(ref, seed), qHash(key, seed));
+        QCOMPARE(qHash(QLatin1String(latin1), seed), qHash(key, seed));
+    }
+    if (!key.isEmpty()) {
+        QVERIFY(qHash(key, 1) != qHash(key, 2));
+        QVERIFY(qHash(latin1, 1) != qHash(latin1, 2));
+    }
+}
+
+void tst_QHash::commonPrefixDistribution()
+{
+    // keys that only differ near the end must still spread over the buckets
+    const int count = 1000;
+    const int buckets = 1024;
+    QSet<uint> hashes;
+    QSet<uint> usedBuckets;
+    for (int i = 0; i < count; ++i) {
+        const QString key = QStringLiteral("/home/user/projects/application/src/module/file%1.cpp").arg(i);
+        const uint h = qHash(key, 0);
+        hashes.insert(h);
+        usedBuckets.insert(h % buckets);
+    }
+    QCOMPARE(hashes.size(), count);
+    // about 640 buckets are expected to be used for a uniform hash
+    QVERIFY2(usedBuckets.size() > 550, QByteArray::number(usedBuckets.size()));
+}
+
 QTEST_APPLESS_MAIN(tst_QHash)
 #include "tst_qhash.moc"
@@ -155,6 +155,9 @@ private slots:
     void testInfAndNan();
     void fpExceptions();
     void negativeZero();
+    void toStringShortest_data();
+    void toStringShortest();
+    void doubleRoundTrip();
     void dayOfWeek();
     void dayOfWeek_data();
     void formatDate();
@@ -988,6 +991,88 @@ void tst_QLocale::negativeZero()
     QCOMPARE(s, QString("0"));
 }
 
+void tst_QLocale::toStringShortest_data()
+{
+    QTest::addColumn<double>("num");
+    QTest::addColumn<char>("format");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("0.1 g")      << 0.1 << 'g' << QString("0.1");
+    QTest::newRow("0.1 e")      << 0.1 << 'e' << QString("1e-01");
+    QTest::newRow("0.1 f")      << 0.1 << 'f' << QString("0.1");
+    QTest::newRow("0.3 g")      << 0.1 + 0.2 << 'g' << QString("0.30000000000000004");
+    QTest::newRow("1/3 g")      << 1.0 / 3 << 'g' << QString("0.3333333333333333");
+    QTest::newRow("0 g")        << 0.0 << 'g' << QString("0");
+    QTest::newRow("-0 g")       << -0.0 << 'g' << QString("0");
+    QTest::newRow("-1.5 g")     << -1.5 << 'g' << QString("-1.5");
+    QTest::newRow("100 g")      << 100.0 << 'g' << QString("100");
+    QTest::newRow("100 e")      << 100.0 << 'e' << QString("1e+02");
+    QTest::newRow("123.456 e")  << 123.456 << 'E' << QString("1.23456E+02");
+    QTest::newRow("1e16 g")     << 1e16 << 'g' << QString("10000000000000000");
+    QTest::newRow("1e17 g")     << 1e17 << 'g' << QString("1e+17");
+    QTest::newRow("1e18 g")     << 1e18 << 'g' << QString("1e+18");
+    QTest::newRow("1e18 f")     << 1e18 << 'f' << QString("1000000000000000000");
+    QTest::newRow("1e-4 g")     << 1e-4 << 'g' << QString("0.0001");
+    QTest::newRow("1e-5 g")     << 1e-5 << 'g' << QString("1e-05");
+    QTest::newRow("1e-5 f")     << 1e-5 << 'f' << QString("0.00001");
+    QTest::newRow("1e23 g")     << 1e23 << 'g' << QString("1e+23");
+    QTest::newRow("2^53 g")     << 9007199254740992.0 << 'g' << QString("9007199254740992");
+    QTest::newRow("max g")      << DBL_MAX << 'g' << QString("1.7976931348623157e+308");
+    QTest::newRow("min g")      << DBL_MIN << 'g' << QString("2.2250738585072014e-308");
+    QTest::newRow("epsilon g")  << DBL_EPSILON << 'g' << QString("2.220446049250313e-16");
+    QTest::newRow("denorm g")   << 4.9406564584124654e-324 << 'g' << QString("5e-324");
+    QTest::newRow("denorm e")   << 4.9406564584124654e-324 << 'e' << QString("5e-324");
+}
+
+void tst_QLocale::toStringShortest()
+{
+    QFETCH(double, num);
+    QFETCH(char, format);
+    QFETCH(QString, expected);
+
+    QLocale locale(QLocale::C);
+    locale.setNumberOptions(QLocale::OmitGroupSeparator);
+    QCOMPARE(locale.toString(num, format, QLocale::FloatingPointShortest), expected);
+    QCOMPARE(QString::number(num, format, QLocale::FloatingPointShortest), expected);
+    QCOMPARE(QByteArray::number(num, format, QLocale::FloatingPointShortest), expected.toLatin1());
+}
+
+void tst_QLocale::doubleRoundTrip()
+{
+    // compare the fast conversions with qdtoa() and qstrtod() on
+    // pseudo-random doubles of all magnitudes
+    QLocale locale(QLocale::C);
+    quint64 state = Q_UINT64_C(0x9e3779b97f4a7c15);
+    for (int i = 0; i < 20000; ++i) {
+        state = state * Q_UINT64_C(6364136223846793005) + Q_UINT64_C(1442695040888963407);
+        union { quint64 bits; double num; } u;
+        u.bits = state;
+        const double num = u.num;
+        if (!qIsFinite(num))
+            continue;
+
+        const QString shortest = QString::number(num, 'g', QLocale::FloatingPointShortest);
+        bool ok;
+        double back = locale.toDouble(shortest, &ok);
+        QVERIFY2(ok, qPrintable(shortest));
+        QVERIFY2(back == num, qPrintable(shortest));
+        QVERIFY(shortest.length() <= QString::number(num, 'g', 17).length());
+
+        const QString full = QString::number(num, 'e', 20);
+        back = full.toDouble(&ok);
+        QVERIFY2(ok, qPrintable(full));
+        QVERIFY2(back == num, qPrintable(full));
+
+        for (int precision = 1; precision <= 17; precision += 4) {
+            char buf[64];
+            qsnprintf(buf, sizeof(buf), "%.*g", precision, num);
+            QCOMPARE(QString::number(num, 'g', precision), QString::fromLatin1(buf));
+            qsnprintf(buf, sizeof(buf), "%.*e", precision, num);
+            QCOMPARE(QString::number(num, 'e', precision), QString::fromLatin1(buf));
+        }
+    }
+}
+
 void tst_QLocale::dayOfWeek_data()
 {
     QTest::addColumn<QDate>("date");
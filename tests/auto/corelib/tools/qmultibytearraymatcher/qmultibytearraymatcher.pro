@@ -0,0 +1,5 @@
+CONFIG += testcase parallel_test
+TARGET = tst_qmultibytearraymatcher
+QT = core testlib
+SOURCES = tst_qmultibytearraymatcher.cpp
+DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0
@@ -0,0 +1,306 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <qmultibytearraymatcher.h>
+
+typedef QList<QByteArray> ByteArrayList;
+typedef QPair<int, int> Occurrence; // position, pattern
+
+class tst_QMultiByteArrayMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultConstructed();
+    void indexIn_data();
+    void indexIn();
+    void matchesIn();
+    void caseInsensitive();
+    void copyAndAssign();
+    void compareWithQByteArrayMatcher();
+    void manyPatternsAndClasses();
+};
+
+// the occurrences as found by QByteArray::indexOf, sorted like matchesIn() does
+static QList<Occurrence> referenceMatches(const ByteArrayList &patterns, const QByteArray &haystack, int from = 0)
+{
+    QMap<QPair<int, int>, Occurrence> sorted; // (end, -length) -> occurrence
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QByteArray &pattern = patterns.at(i);
+        if (pattern.isEmpty())
+            continue;
+        for (int pos = haystack.indexOf(pattern, from); pos != -1; pos = haystack.indexOf(pattern, pos + 1))
+            sorted.insertMulti(qMakePair(pos + pattern.size(), -pattern.size()), qMakePair(pos, i));
+    }
+
+    QList<Occurrence> result;
+    QMap<QPair<int, int>, Occurrence>::const_iterator it = sorted.constBegin();
+    while (it != sorted.constEnd()) {
+        // duplicates in pattern order
+        QList<Occurrence> same = sorted.values(it.key());
+        std::sort(same.begin(), same.end());
+        result += same;
+        it += same.size();
+    }
+    return result;
+}
+
+static QList<Occurrence> toList(const QVector<QMultiByteArrayMatcher::Match> &matches)
+{
+    QList<Occurrence> result;
+    for (int i = 0; i < matches.size(); ++i)
+        result.append(qMakePair(matches.at(i).position, matches.at(i).pattern));
+    return result;
+}
+
+void tst_QMultiByteArrayMatcher::defaultConstructed()
+{
+    QMultiByteArrayMatcher matcher;
+    QVERIFY(matcher.patterns().isEmpty());
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseSensitive);
+
+    int pattern = 42;
+    QCOMPARE(matcher.indexIn(QByteArray("abc"), 0, &pattern), -1);
+    QCOMPARE(pattern, -1);
+    QVERIFY(matcher.matchesIn(QByteArray("abc")).isEmpty());
+
+    matcher.setPatterns(ByteArrayList() << QByteArray());
+    QCOMPARE(matcher.indexIn(QByteArray("abc")), -1);
+}
+
+void tst_QMultiByteArrayMatcher::indexIn_data()
+{
+    QTest::addColumn<ByteArrayList>("patterns");
+    QTest::addColumn<QByteArray>("haystack");
+    QTest::addColumn<int>("from");
+    QTest::addColumn<int>("position");
+    QTest::addColumn<int>("pattern");
+
+    const ByteArrayList he = ByteArrayList() << "he" << "she" << "his" << "hers";
+    QTest::newRow("ushers") << he << QByteArray("ushers") << 0 << 1 << 1;
+    QTest::newRow("ushers-from") << he << QByteArray("ushers") << 2 << 2 << 0;
+    QTest::newRow("ahishers") << he << QByteArray("ahishers") << 0 << 1 << 2;
+    QTest::newRow("none") << he << QByteArray("abcdefg") << 0 << -1 << -1;
+    QTest::newRow("empty-haystack") << he << QByteArray() << 0 << -1 << -1;
+    QTest::newRow("from-negative") << he << QByteArray("she") << -5 << 0 << 1;
+    QTest::newRow("from-beyond") << he << QByteArray("she") << 10 << -1 << -1;
+    // the leftmost occurrence wins, even when a shorter one ends first
+    QTest::newRow("leftmost") << (ByteArrayList() << "bcd" << "abcdef") << QByteArray("xabcdefg") << 0 << 1 << 1;
+    // at the same position, the lowest index wins
+    QTest::newRow("same-position01") << (ByteArrayList() << "abc" << "ab") << QByteArray("xabc") << 0 << 1 << 0;
+    QTest::newRow("same-position02") << (ByteArrayList() << "ab" << "abc") << QByteArray("xabc") << 0 << 1 << 0;
+    QTest::newRow("duplicates") << (ByteArrayList() << "x" << "ab" << "ab") << QByteArray("ab") << 0 << 0 << 1;
+    QTest::newRow("binary") << (ByteArrayList() << QByteArray("\0\0\1", 3) << QByteArray("\xff", 1))
+                            << QByteArray("\0\0\0\0\1\xff", 6) << 0 << 2 << 0;
+}
+
+void tst_QMultiByteArrayMatcher::indexIn()
+{
+    QFETCH(ByteArrayList, patterns);
+    QFETCH(QByteArray, haystack);
+    QFETCH(int, from);
+    QFETCH(int, position);
+    QFETCH(int, pattern);
+
+    const QMultiByteArrayMatcher matcher(patterns);
+    QCOMPARE(matcher.patterns(), patterns);
+
+    int foundPattern = 42;
+    QCOMPARE(matcher.indexIn(haystack, from, &foundPattern), position);
+    QCOMPARE(foundPattern, pattern);
+    QCOMPARE(matcher.indexIn(haystack.constData(), haystack.size(), from), position);
+}
+
+void tst_QMultiByteArrayMatcher::matchesIn()
+{
+    const ByteArrayList patterns = ByteArrayList() << "he" << "she" << "his" << "hers" << "e" << "she";
+    const QMultiByteArrayMatcher matcher(patterns);
+
+    QList<Occurrence> expected;
+    expected << qMakePair(1, 1) << qMakePair(1, 5) << qMakePair(2, 0) << qMakePair(3, 4)
+             << qMakePair(2, 3);
+    QCOMPARE(toList(matcher.matchesIn(QByteArray("ushers"))), expected);
+    QCOMPARE(toList(matcher.matchesIn(QByteArray("ushers"))), referenceMatches(patterns, "ushers"));
+
+    // random patterns over a small alphabet have lots of overlaps
+    qsrand(0x5eed);
+    for (int round = 0; round < 50; ++round) {
+        ByteArrayList randomPatterns;
+        const int count = 1 + qrand() % 20;
+        for (int i = 0; i < count; ++i) {
+            QByteArray pattern;
+            const int length = qrand() % 6;
+            for (int j = 0; j < length; ++j)
+                pattern += char('a' + qrand() % 3);
+            randomPatterns << pattern;
+        }
+        QByteArray haystack;
+        for (int i = 0; i < 200; ++i)
+            haystack += char('a' + qrand() % 4);
+
+        const QMultiByteArrayMatcher randomMatcher(randomPatterns);
+        const int from = qrand() % 10;
+        const QList<Occurrence> reference = referenceMatches(randomPatterns, haystack, from);
+        QCOMPARE(toList(randomMatcher.matchesIn(haystack, from)), reference);
+
+        int pattern;
+        const int position = randomMatcher.indexIn(haystack, from, &pattern);
+        int expectedPosition = -1;
+        int expectedPattern = -1;
+        for (int i = 0; i < reference.size(); ++i) {
+            if (expectedPosition == -1 || reference.at(i).first < expectedPosition
+                    || (reference.at(i).first == expectedPosition && reference.at(i).second < expectedPattern)) {
+                expectedPosition = reference.at(i).first;
+                expectedPattern = reference.at(i).second;
+            }
+        }
+        QCOMPARE(position, expectedPosition);
+        QCOMPARE(pattern, expectedPattern);
+    }
+}
+
+void tst_QMultiByteArrayMatcher::caseInsensitive()
+{
+    const ByteArrayList patterns = ByteArrayList() << "Error" << "WARN" << "\xc4rger";
+    QMultiByteArrayMatcher matcher(patterns, Qt::CaseInsensitive);
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseInsensitive);
+
+    int pattern;
+    QCOMPARE(matcher.indexIn(QByteArray("an ERROR occurred"), 0, &pattern), 3);
+    QCOMPARE(pattern, 0);
+    QCOMPARE(matcher.indexIn(QByteArray("[warn] disk"), 0, &pattern), 1);
+    QCOMPARE(pattern, 1);
+    QCOMPARE(matcher.indexIn(QByteArray("viel \xe4rger"), 0, &pattern), 5);
+    QCOMPARE(pattern, 2);
+    QCOMPARE(matcher.matchesIn(QByteArray("error ERROR eRrOr")).size(), 3);
+
+    matcher.setCaseSensitivity(Qt::CaseSensitive);
+    QCOMPARE(matcher.indexIn(QByteArray("an ERROR occurred")), -1);
+    QCOMPARE(matcher.indexIn(QByteArray("an Error occurred")), 3);
+}
+
+void tst_QMultiByteArrayMatcher::copyAndAssign()
+{
+    QMultiByteArrayMatcher matcher1(ByteArrayList() << "abc" << "123");
+    QMultiByteArrayMatcher matcher2(matcher1);
+    QMultiByteArrayMatcher matcher3;
+    matcher3 = matcher1;
+
+    matcher1.setPatterns(ByteArrayList() << "xyz");
+    QCOMPARE(matcher1.indexIn(QByteArray("abc xyz")), 4);
+    QCOMPARE(matcher2.indexIn(QByteArray("abc xyz")), 0);
+    QCOMPARE(matcher3.indexIn(QByteArray("xyz 123")), 4);
+
+    matcher3.swap(matcher1);
+    QCOMPARE(matcher3.patterns(), ByteArrayList() << "xyz");
+    QCOMPARE(matcher1.patterns(), ByteArrayList() << "abc" << "123");
+}
+
+void tst_QMultiByteArrayMatcher::compareWithQByteArrayMatcher()
+{
+    ByteArrayList patterns;
+    for (int i = 0; i < 500; ++i)
+        patterns << "keyword" + QByteArray::number(i * 7919 % 100000) + ';';
+    const QMultiByteArrayMatcher matcher(patterns);
+
+    QByteArray haystack;
+    for (int i = 0; i < 1000; ++i)
+        haystack += "noise keyword" + QByteArray::number(i * 13) + "; ";
+
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QByteArrayMatcher single(patterns.at(i));
+        int pattern;
+        int position = matcher.indexIn(haystack, 0, &pattern);
+        while (position != -1 && pattern != i)
+            position = matcher.indexIn(haystack, position + 1, &pattern);
+        QCOMPARE(position, single.indexIn(haystack));
+    }
+}
+
+void tst_QMultiByteArrayMatcher::manyPatternsAndClasses()
+{
+    // enough states and byte values that the automaton is kept sparse,
+    // plus overlapping patterns over a small alphabet to exercise the
+    // failure links
+    qsrand(0xc1a55);
+    ByteArrayList patterns;
+    for (int i = 0; i < 1200; ++i) {
+        QByteArray pattern;
+        for (int j = 0; j < 8; ++j)
+            pattern += char(1 + qrand() % 255);
+        patterns << pattern;
+    }
+    for (int i = 0; i < 50; ++i) {
+        QByteArray pattern;
+        const int length = 1 + qrand() % 5;
+        for (int j = 0; j < length; ++j)
+            pattern += char('a' + qrand() % 3);
+        patterns << pattern;
+    }
+
+    QByteArray haystack;
+    for (int i = 0; i < 200; ++i) {
+        for (int j = 0; j < 20; ++j)
+            haystack += char('a' + qrand() % 4);
+        haystack += patterns.at(qrand() % 1200);
+    }
+
+    const QMultiByteArrayMatcher matcher(patterns);
+    const QList<Occurrence> reference = referenceMatches(patterns, haystack);
+    QVERIFY(reference.size() > 200);
+    QCOMPARE(toList(matcher.matchesIn(haystack)), reference);
+
+    int pattern;
+    QCOMPARE(matcher.indexIn(haystack, 0, &pattern), reference.first().first);
+    const int expected = reference.first().first;
+    int expectedPattern = -1;
+    for (int i = 0; i < reference.size(); ++i) {
+        if (reference.at(i).first == expected
+                && (expectedPattern == -1 || reference.at(i).second < expectedPattern))
+            expectedPattern = reference.at(i).second;
+    }
+    QCOMPARE(pattern, expectedPattern);
+}
+
+QTEST_APPLESS_MAIN(tst_QMultiByteArrayMatcher)
+#include "tst_qmultibytearraymatcher.moc"
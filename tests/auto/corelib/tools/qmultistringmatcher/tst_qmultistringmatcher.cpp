@@ -0,0 +1,236 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtTest/QtTest>
+
+#include <qmultistringmatcher.h>
+
+typedef QPair<int, int> Occurrence; // position, pattern
+
+class tst_QMultiStringMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void defaultConstructed();
+    void indexIn_data();
+    void indexIn();
+    void matchesIn();
+    void caseInsensitive_data();
+    void caseInsensitive();
+    void copyAndAssign();
+};
+
+static QList<Occurrence> toList(const QVector<QMultiStringMatcher::Match> &matches)
+{
+    QList<Occurrence> result;
+    for (int i = 0; i < matches.size(); ++i)
+        result.append(qMakePair(matches.at(i).position, matches.at(i).pattern));
+    return result;
+}
+
+void tst_QMultiStringMatcher::defaultConstructed()
+{
+    QMultiStringMatcher matcher;
+    QVERIFY(matcher.patterns().isEmpty());
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseSensitive);
+
+    int pattern = 42;
+    QCOMPARE(matcher.indexIn(QStringLiteral("abc"), 0, &pattern), -1);
+    QCOMPARE(pattern, -1);
+    QVERIFY(matcher.matchesIn(QStringLiteral("abc")).isEmpty());
+}
+
+void tst_QMultiStringMatcher::indexIn_data()
+{
+    QTest::addColumn<QStringList>("patterns");
+    QTest::addColumn<QString>("haystack");
+    QTest::addColumn<int>("from");
+    QTest::addColumn<int>("position");
+    QTest::addColumn<int>("pattern");
+
+    const QStringList he = QStringList() << "he" << "she" << "his" << "hers";
+    QTest::newRow("ushers") << he << "ushers" << 0 << 1 << 1;
+    QTest::newRow("ushers-from") << he << "ushers" << 2 << 2 << 0;
+    QTest::newRow("none") << he << "abcdefg" << 0 << -1 << -1;
+    QTest::newRow("leftmost") << (QStringList() << "bcd" << "abcdef") << "xabcdefg" << 0 << 1 << 1;
+    QTest::newRow("same-position") << (QStringList() << "ab" << "abc") << "xabc" << 0 << 1 << 0;
+
+    const QString greek = QString::fromUtf8("\xce\xb1\xce\xb2\xce\xb3");        // alpha beta gamma
+    const QString cyrillic = QString::fromUtf8("\xd0\xb4\xd0\xb0");             // de a
+    QTest::newRow("non-latin1") << (QStringList() << greek << cyrillic)
+                                << QString("x" + cyrillic + greek) << 0 << 1 << 1;
+    // a pattern sharing the low byte of its code units with the text
+    QTest::newRow("low-byte") << (QStringList() << QString(QChar(0x141)))
+                              << QString(QLatin1String("A")) + QChar(0x41) + QChar(0x141) << 0 << 2 << 0;
+    // and with a block of code units that appears in no pattern
+    QTest::newRow("other-block") << (QStringList() << QString(QChar(0x141)))
+                                 << QString(QChar(0x241)) + QChar(0x1141) + QChar(0x141) << 0 << 2 << 0;
+    const QString deseret = QString::fromUtf8("\xf0\x90\x90\x80");             // U+10400
+    QTest::newRow("surrogates") << (QStringList() << deseret) << QString("ab" + deseret) << 0 << 2 << 0;
+}
+
+void tst_QMultiStringMatcher::indexIn()
+{
+    QFETCH(QStringList, patterns);
+    QFETCH(QString, haystack);
+    QFETCH(int, from);
+    QFETCH(int, position);
+    QFETCH(int, pattern);
+
+    const QMultiStringMatcher matcher(patterns);
+    QCOMPARE(matcher.patterns(), patterns);
+
+    int foundPattern = 42;
+    QCOMPARE(matcher.indexIn(haystack, from, &foundPattern), position);
+    QCOMPARE(foundPattern, pattern);
+    QCOMPARE(matcher.indexIn(haystack.constData(), haystack.size(), from), position);
+
+    // the text isn't case folded when case sensitive
+    if (position != -1) {
+        const QString changed = haystack.left(position) + haystack.mid(position).toUpper();
+        if (changed != haystack)
+            QVERIFY(matcher.indexIn(changed, from) != position);
+    }
+}
+
+void tst_QMultiStringMatcher::matchesIn()
+{
+    const QStringList patterns = QStringList() << "he" << "she" << "his" << "hers";
+    const QMultiStringMatcher matcher(patterns);
+
+    QList<Occurrence> expected;
+    expected << qMakePair(1, 1) << qMakePair(2, 0) << qMakePair(2, 3);
+    QCOMPARE(toList(matcher.matchesIn(QStringLiteral("ushers"))), expected);
+
+    expected.clear();
+    expected << qMakePair(2, 0) << qMakePair(2, 3);
+    QCOMPARE(toList(matcher.matchesIn(QStringLiteral("ushers"), 2)), expected);
+
+    // every occurrence of every pattern, checked against QString::indexOf
+    qsrand(0x5eed);
+    for (int round = 0; round < 50; ++round) {
+        QStringList randomPatterns;
+        const int count = 1 + qrand() % 20;
+        for (int i = 0; i < count; ++i) {
+            QString pattern;
+            const int length = 1 + qrand() % 5;
+            for (int j = 0; j < length; ++j)
+                pattern += QChar(ushort(0x3b1 + qrand() % 3));
+            randomPatterns << pattern;
+        }
+        QString haystack;
+        for (int i = 0; i < 200; ++i)
+            haystack += QChar(ushort(0x3b1 + qrand() % 4));
+
+        const Qt::CaseSensitivity cs = round % 2 ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        if (cs == Qt::CaseInsensitive)
+            haystack = haystack.toUpper();
+
+        const QMultiStringMatcher randomMatcher(randomPatterns, cs);
+        int expectedCount = 0;
+        for (int i = 0; i < randomPatterns.size(); ++i)
+            expectedCount += haystack.count(randomPatterns.at(i), cs);
+
+        const QVector<QMultiStringMatcher::Match> matches = randomMatcher.matchesIn(haystack);
+        QCOMPARE(matches.size(), expectedCount);
+        for (int i = 0; i < matches.size(); ++i) {
+            const QString &pattern = randomPatterns.at(matches.at(i).pattern);
+            QVERIFY(haystack.midRef(matches.at(i).position, pattern.size()).compare(pattern, cs) == 0);
+        }
+    }
+}
+
+void tst_QMultiStringMatcher::caseInsensitive_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QString>("haystack");
+    QTest::addColumn<int>("position");
+
+    QTest::newRow("ascii") << "Error" << "an ERROR occurred" << 3;
+    QTest::newRow("latin1") << QString::fromUtf8("\xc3\x84rger") << QString::fromUtf8("viel \xc3\xa4RGER") << 5;
+    QTest::newRow("greek") << QString::fromUtf8("\xce\xb1\xce\xb2") << QString::fromUtf8("x\xce\x91\xce\x92") << 1;
+    // MICRO SIGN folds to GREEK SMALL LETTER MU
+    QTest::newRow("micro") << QString::fromUtf8("\xc2\xb5m") << QString::fromUtf8("5 \xce\x9cM") << 2;
+    // KELVIN SIGN folds to k
+    QTest::newRow("kelvin") << "5k" << QString::fromUtf8("5\xe2\x84\xaa") << 0;
+    // DESERET CAPITAL LETTER LONG I folds to U+10428
+    QTest::newRow("surrogates") << QString::fromUtf8("a\xf0\x90\x90\xa8") << QString::fromUtf8("xA\xf0\x90\x90\x80") << 1;
+}
+
+void tst_QMultiStringMatcher::caseInsensitive()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QString, haystack);
+    QFETCH(int, position);
+
+    QMultiStringMatcher matcher(QStringList() << "unrelated" << pattern, Qt::CaseInsensitive);
+    QCOMPARE(matcher.caseSensitivity(), Qt::CaseInsensitive);
+
+    int foundPattern;
+    QCOMPARE(matcher.indexIn(haystack, 0, &foundPattern), position);
+    QCOMPARE(foundPattern, 1);
+    QCOMPARE(haystack.indexOf(pattern, 0, Qt::CaseInsensitive), position);
+    QCOMPARE(matcher.matchesIn(haystack).size(), 1);
+
+    matcher.setCaseSensitivity(Qt::CaseSensitive);
+    QCOMPARE(matcher.indexIn(haystack), -1);
+}
+
+void tst_QMultiStringMatcher::copyAndAssign()
+{
+    QMultiStringMatcher matcher1(QStringList() << "abc" << "123");
+    QMultiStringMatcher matcher2(matcher1);
+    QMultiStringMatcher matcher3;
+    matcher3 = matcher1;
+
+    matcher1.setPatterns(QStringList() << "xyz");
+    QCOMPARE(matcher1.indexIn(QStringLiteral("abc xyz")), 4);
+    QCOMPARE(matcher2.indexIn(QStringLiteral("abc xyz")), 0);
+    QCOMPARE(matcher3.indexIn(QStringLiteral("xyz 123")), 4);
+
+    matcher3.swap(matcher1);
+    QCOMPARE(matcher3.patterns(), QStringList() << "xyz");
+    QCOMPARE(matcher1.patterns(), QStringList() << "abc" << "123");
+}
+
+QTEST_APPLESS_MAIN(tst_QMultiStringMatcher)
+#include "tst_qmultistringmatcher.moc"
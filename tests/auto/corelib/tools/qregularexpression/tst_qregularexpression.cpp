@@ -45,6 +45,7 @@
 #include <qlist.h>
 #include <qstringlist.h>
 #include <qhash.h>
+#include <private/qregularexpression_p.h>
 
 #include "tst_qregularexpression.h"
 
@@ -1582,3 +1583,247 @@ void tst_QRegularExpression::JOptionUsage()
         QTest::ignoreMessage(QtWarningMsg, qPrintable(warningMessage.arg(pattern)));
     QCOMPARE(re.isValid(), isValid);
 }
+
+void tst_QRegularExpression::patternCache()
+{
+    const int limit = QRegularExpression::patternCacheLimit();
+    QVERIFY(limit > 0);
+
+    QRegularExpression::clearPatternCache();
+    const QRegularExpressionCacheStatistics before = qt_qregularexpression_cache_statistics();
+    QCOMPARE(before.count, 0);
+    QCOMPARE(before.limit, limit);
+
+    // independently constructed objects share the compiled pattern
+    const QString pattern = QStringLiteral("(\\d+)-(\\w+)");
+    QRegularExpression re1(pattern);
+    QVERIFY(re1.isValid());
+    QRegularExpression re2(pattern);
+    QVERIFY(re2.isValid());
+    QRegularExpression re3(pattern, QRegularExpression::CaseInsensitiveOption);
+    QVERIFY(re3.isValid());
+
+    // so do invalid ones
+    QRegularExpression invalid1(QStringLiteral("(abc"));
+    QVERIFY(!invalid1.isValid());
+    QRegularExpression invalid2(QStringLiteral("(abc"));
+    QVERIFY(!invalid2.isValid());
+    QCOMPARE(invalid2.errorString(), invalid1.errorString());
+    QCOMPARE(invalid2.patternErrorOffset(), invalid1.patternErrorOffset());
+
+    QRegularExpressionCacheStatistics after = qt_qregularexpression_cache_statistics();
+    QCOMPARE(after.count, 3);
+    QCOMPARE(after.misses - before.misses, quint64(3));
+    QCOMPARE(after.hits - before.hits, quint64(2));
+    QCOMPARE(after.evictions, before.evictions);
+
+    // evicted patterns keep working
+    QRegularExpression::setPatternCacheLimit(1);
+    QCOMPARE(QRegularExpression::patternCacheLimit(), 1);
+    after = qt_qregularexpression_cache_statistics();
+    QCOMPARE(after.count, 1);
+    QCOMPARE(after.evictions - before.evictions, quint64(2));
+
+    QRegularExpressionMatch match = re1.match(QStringLiteral("12-ab"));
+    consistencyCheck(match);
+    QVERIFY(match.hasMatch());
+    QCOMPARE(match.captured(2), QStringLiteral("ab"));
+
+    // a limit of 0 disables the cache
+    QRegularExpression::setPatternCacheLimit(0);
+    QRegularExpression re4(pattern);
+    QVERIFY(re4.isValid());
+    match = re4.match(QStringLiteral("34-cd"));
+    consistencyCheck(match);
+    QCOMPARE(match.captured(1), QStringLiteral("34"));
+    QCOMPARE(qt_qregularexpression_cache_statistics().count, 0);
+
+    QRegularExpression::setPatternCacheLimit(limit);
+    QCOMPARE(QRegularExpression::patternCacheLimit(), limit);
+}
+
+static void verifyEquivalentMatches(const QRegularExpressionMatch &match, const QRegularExpressionMatch &expected)
+{
+    QCOMPARE(match.isValid(), expected.isValid());
+    QCOMPARE(match.hasMatch(), expected.hasMatch());
+    if (!expected.hasMatch())
+        return;
+
+    QCOMPARE(match.regularExpression(), expected.regularExpression());
+    QCOMPARE(match.lastCapturedIndex(), expected.lastCapturedIndex());
+    QCOMPARE(match.capturedTexts(), expected.capturedTexts());
+    for (int i = 0; i <= expected.lastCapturedIndex(); ++i) {
+        QCOMPARE(match.capturedStart(i), expected.capturedStart(i));
+        QCOMPARE(match.capturedEnd(i), expected.capturedEnd(i));
+    }
+}
+
+// the leftmost match, ties broken by the lowest index
+static QRegularExpressionMatch referenceSetMatch(const QList<QRegularExpression> &expressions,
+                                                 const QString &subject, int offset, int *index)
+{
+    QRegularExpressionMatch result;
+    *index = -1;
+    for (int i = 0; i < expressions.size(); ++i) {
+        if (!expressions.at(i).isValid())
+            continue;
+        QRegularExpressionMatch match = expressions.at(i).match(subject, offset);
+        if (match.hasMatch() && (*index == -1 || match.capturedStart() < result.capturedStart())) {
+            result = match;
+            *index = i;
+        }
+    }
+    return result;
+}
+
+void tst_QRegularExpression::regularExpressionSet_data()
+{
+    QTest::addColumn<QStringList>("patterns");
+    QTest::addColumn<QString>("subject");
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<int>("index");
+    QTest::addColumn<QString>("captured");
+
+    QTest::newRow("leftmost") << (QStringList() << "foo" << "bar") << "xx bar foo" << 0 << 1 << "bar";
+    QTest::newRow("offset") << (QStringList() << "foo" << "bar") << "foo bar" << 1 << 1 << "bar";
+    QTest::newRow("tie01") << (QStringList() << "ab" << "a") << "xab" << 0 << 0 << "ab";
+    QTest::newRow("tie02") << (QStringList() << "a" << "ab") << "xab" << 0 << 0 << "a";
+    QTest::newRow("nomatch") << (QStringList() << "foo" << "bar") << "baz" << 0 << -1 << QString();
+    QTest::newRow("empty-set") << QStringList() << "abc" << 0 << -1 << QString();
+    QTest::newRow("empty-pattern") << (QStringList() << "x" << "") << "abc" << 0 << 1 << "";
+    QTest::newRow("single") << (QStringList() << "b+") << "abbc" << 0 << 0 << "bb";
+    QTest::newRow("anchor") << (QStringList() << "^b" << "a") << "ab" << 0 << 1 << "a";
+    QTest::newRow("alternation") << (QStringList() << "c|d" << "a|b") << "xbd" << 0 << 1 << "b";
+    QTest::newRow("inline-option") << (QStringList() << "(?i)A" << "a") << "xa" << 0 << 0 << "a";
+    QTest::newRow("lookbehind") << (QStringList() << "(?<=x)a" << "b") << "ab xa" << 0 << 1 << "b";
+    QTest::newRow("\\K") << (QStringList() << "foo\\Kbar" << "x") << "foobar x" << 0 << 0 << "bar";
+    QTest::newRow("invalid") << (QStringList() << "(abc" << "abc") << "abc" << 0 << 1 << "abc";
+
+    // patterns that can't be combined with the others
+    QTest::newRow("backreference01") << (QStringList() << "(a)\\1" << "b") << "b aa" << 0 << 1 << "b";
+    QTest::newRow("backreference02") << (QStringList() << "(a)\\1" << "c") << "aa c" << 0 << 0 << "aa";
+    QTest::newRow("named-backreference") << (QStringList() << "(?<x>a)\\k<x>" << "c") << "caa" << 0 << 1 << "c";
+    QTest::newRow("recursion") << (QStringList() << "\\((?:[^()]|(?R))*\\)" << "x") << "y (a(b)) x" << 0 << 0 << "(a(b))";
+    QTest::newRow("subroutine") << (QStringList() << "(a)(?1)" << "x") << "x aa" << 0 << 1 << "x";
+    QTest::newRow("condition") << (QStringList() << "(a)?(?(1)b|c)" << "x") << "x ab" << 0 << 1 << "x";
+    QTest::newRow("verb") << (QStringList() << "a(*COMMIT)b" << "ac") << "ac" << 0 << 1 << "ac";
+    QTest::newRow("quote") << (QStringList() << "\\Q(a" << "b") << "b (a" << 0 << 1 << "b";
+    QTest::newRow("duplicate-names") << (QStringList() << "(?<n>a)" << "(?<n>b)") << "ba" << 0 << 1 << "b";
+}
+
+void tst_QRegularExpression::regularExpressionSet()
+{
+    QFETCH(QStringList, patterns);
+    QFETCH(QString, subject);
+    QFETCH(int, offset);
+    QFETCH(int, index);
+    QFETCH(QString, captured);
+
+    const QRegularExpressionSet set(patterns);
+    QCOMPARE(set.count(), patterns.size());
+    QCOMPARE(set.isEmpty(), patterns.isEmpty());
+
+    int matchIndex = -2;
+    const QRegularExpressionMatch match = set.match(subject, offset, &matchIndex);
+    consistencyCheck(match);
+    QCOMPARE(matchIndex, index);
+    QCOMPARE(match.hasMatch(), index != -1);
+    QCOMPARE(match.captured(), captured);
+    if (index != -1)
+        QCOMPARE(match.regularExpression(), set.at(index));
+
+    int referenceIndex;
+    const QRegularExpressionMatch reference = referenceSetMatch(set.expressions(), subject, offset, &referenceIndex);
+    QCOMPARE(matchIndex, referenceIndex);
+    verifyEquivalentMatches(match, reference);
+
+    // the result doesn't depend on previous matches
+    QCOMPARE(set.match(subject, offset).captured(), captured);
+}
+
+void tst_QRegularExpression::regularExpressionSetCaptures()
+{
+    QList<QRegularExpression> expressions;
+    expressions << QRegularExpression("(?<year>\\d{4})-(?<month>\\d\\d)")
+                << QRegularExpression("(\\w+)@(\\w+)")
+                << QRegularExpression("HELLO (w)orld", QRegularExpression::CaseInsensitiveOption)
+                << QRegularExpression("a b  # a comment", QRegularExpression::ExtendedPatternSyntaxOption)
+                << QRegularExpression("x(y)?(z)?(w)?")
+                << QRegularExpression("^line$", QRegularExpression::MultilineOption)
+                << QRegularExpression("<.+>", QRegularExpression::InvertedGreedinessOption);
+
+    QRegularExpressionSet set(expressions);
+    QVERIFY(set.isValid());
+
+    const char * const subjects[] = {
+        "mail: me@host",
+        "on 2013-12, ok",
+        "say hello World",
+        "ab",
+        "--xz--",
+        "first\nline\nlast",
+        "<b>bold</b>",
+        "nothing"
+    };
+    const int expectedIndexes[] = { 1, 0, 2, 3, 4, 5, 6, -1 };
+
+    for (int i = 0; i < int(sizeof(subjects) / sizeof(subjects[0])); ++i) {
+        const QString subject = QString::fromLatin1(subjects[i]);
+        int index;
+        const QRegularExpressionMatch match = set.match(subject, 0, &index);
+        consistencyCheck(match);
+        QCOMPARE(index, expectedIndexes[i]);
+
+        int referenceIndex;
+        const QRegularExpressionMatch reference = referenceSetMatch(expressions, subject, 0, &referenceIndex);
+        QCOMPARE(referenceIndex, index);
+        verifyEquivalentMatches(match, reference);
+    }
+
+    QRegularExpressionMatch match = set.match("on 2013-12, ok");
+    QCOMPARE(match.captured("year"), QStringLiteral("2013"));
+    QCOMPARE(match.captured("month"), QStringLiteral("12"));
+    QCOMPARE(match.capturedStart("month"), 8);
+
+    match = set.match("--xz--");
+    QCOMPARE(match.lastCapturedIndex(), 2);
+    QCOMPARE(match.capturedStart(1), -1);
+    QVERIFY(match.captured(1).isNull());
+    QCOMPARE(match.captured(2), QStringLiteral("z"));
+
+    // implicit sharing
+    QRegularExpressionSet copy = set;
+    copy.append(QRegularExpression("nothing"));
+    QCOMPARE(copy.count(), set.count() + 1);
+    int index;
+    QVERIFY(!set.match("nothing", 0, &index).hasMatch());
+    QCOMPARE(index, -1);
+    QVERIFY(copy.match("nothing", 0, &index).hasMatch());
+    QCOMPARE(index, set.count());
+
+    copy.clear();
+    QVERIFY(copy.isEmpty());
+    QVERIFY(!copy.match("nothing").hasMatch());
+    QCOMPARE(set.count(), expressions.size());
+
+    set.append(QRegularExpression("(abc"));
+    QVERIFY(!set.isValid());
+}
+
+void tst_QRegularExpression::regularExpressionSetManyPatterns()
+{
+    // more patterns than what fits in a single combined program
+    QStringList patterns;
+    for (int i = 0; i < 300; ++i)
+        patterns << QString::fromLatin1("word%1\\b").arg(i);
+    const QRegularExpressionSet set(patterns);
+
+    for (int i = 0; i < 300; i += 37) {
+        const QString subject = QString::fromLatin1("some words, then word%1 and word7").arg(i);
+        int index;
+        const QRegularExpressionMatch match = set.match(subject, 0, &index);
+        consistencyCheck(match);
+        QCOMPARE(index, i);
+        QCOMPARE(match.captured(), QString::fromLatin1("word%1").arg(i));
+    }
+}
@@ -80,6 +80,11 @@ private slots:
     void regularExpressionMatch();
     void JOptionUsage_data();
     void JOptionUsage();
+    void patternCache();
+    void regularExpressionSet_data();
+    void regularExpressionSet();
+    void regularExpressionSetCaptures();
+    void regularExpressionSetManyPatterns();
 
 private:
     void provideRegularExpressions();
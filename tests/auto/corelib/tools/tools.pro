@@ -17,6 +17,8 @@ SUBDIRS=\
     qeasingcurve \
     qelapsedtimer \
     qexplicitlyshareddatapointer \
+    qflathash \
+    qflatmap \
     qfreelist \
     qhash \
     qline \
@@ -26,6 +28,8 @@ SUBDIRS=\
     qmap \
     qmargins \
     qmessageauthenticationcode \
+    qmultibytearraymatcher \
+    qmultistringmatcher \
     qpair \
     qpoint \
     qpointf \
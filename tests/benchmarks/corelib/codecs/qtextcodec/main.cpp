@@ -55,6 +55,10 @@ private slots:
     void fromUnicode() const;
     void toUnicode_data() const;
     void toUnicode() const;
+    void utf8Decode_data() const;
+    void utf8Decode() const;
+    void utf8Encode_data() const;
+    void utf8Encode() const;
 };
 
 void tst_QTextCodec::codecForName() const
@@ -174,8 +178,70 @@ void tst_QTextCodec::toUnicode() const
     }
 }
 
+static QByteArray repeatToSize(const QByteArray &text, int size)
+{
+    QByteArray result;
+    result.reserve(size + text.size());
+    while (result.size() < size)
+        result += text;
+    return result;
+}
 
+// About 64 kB of UTF-8 text each: pure ASCII, Western European text with
+// occasional two-byte sequences, CJK text consisting of three-byte sequences
+// and the multi-script sample from utf-8.txt.
+static void addUtf8Rows()
+{
+    QTest::addColumn<QByteArray>("utf8");
+
+    const int size = 64 * 1024;
+    QTest::newRow("ascii")
+            << repeatToSize("The quick brown fox jumps over the lazy dog; "
+                            "Content-Type: application/json; charset=utf-8\r\n", size);
+    QTest::newRow("european")
+            << repeatToSize("Die Gr\xc3\xb6\xc3\x9f" "e der B\xc3\xa4ume \xc3\xbc" "berrascht. "
+                            "\xc3\x87" "a co\xc3\xbbte tr\xc3\xa8s cher, se\xc3\xb1or! "
+                            "\xc3\x86rlig talt er \xc3\x85land \xc3\xb8-rikt. ", size);
+    QTest::newRow("cjk")
+            << repeatToSize("\xe6\x97\xa5\xe6\x9c\xac\xe8\xaa\x9e\xe3\x81\xae\xe3\x83\x86\xe3\x82\xad"
+                            "\xe3\x82\xb9\xe3\x83\x88\xe3\x81\xa8\xe4\xb8\xad\xe6\x96\x87\xe6\x96\x87"
+                            "\xe6\x9c\xac\xef\xbc\x8c\xe6\xbc\xa2\xe5\xad\x97\xe3\x81\xa8\xe3\x81\x8b"
+                            "\xe3\x81\xaa\xe3\x82\x92\xe5\x90\xab\xe3\x82\x80\xe6\x96\x87\xe7\xab\xa0"
+                            "\xe3\x81\xa7\xe3\x81\x99\xe3\x80\x82", size);
+
+    QFile file(QFINDTESTDATA("utf-8.txt"));
+    if (file.open(QFile::ReadOnly))
+        QTest::newRow("mixed") << repeatToSize(file.readAll(), size);
+}
 
+void tst_QTextCodec::utf8Decode_data() const
+{
+    addUtf8Rows();
+}
+
+void tst_QTextCodec::utf8Decode() const
+{
+    QFETCH(QByteArray, utf8);
+
+    QBENCHMARK {
+        QString::fromUtf8(utf8);
+    }
+}
+
+void tst_QTextCodec::utf8Encode_data() const
+{
+    addUtf8Rows();
+}
+
+void tst_QTextCodec::utf8Encode() const
+{
+    QFETCH(QByteArray, utf8);
+    const QString s = QString::fromUtf8(utf8);
+
+    QBENCHMARK {
+        s.toUtf8();
+    }
+}
 
 QTEST_MAIN(tst_QTextCodec)
 
@@ -156,10 +156,10 @@ private slots:
     }
 
     void sorted_byTime() {
-        QDir testdir(QDir::tempPath() + QLatin1String("/test_speed"));
-        testdir.setSorting(QDir::Time);
-        testdir.setFilter(QDir::AllEntries | QDir::System | QDir::Hidden);
         QBENCHMARK {
+            QDir testdir(QDir::tempPath() + QLatin1String("/test_speed"));
+            testdir.setSorting(QDir::Time);
+            testdir.setFilter(QDir::AllEntries | QDir::System | QDir::Hidden);
             QStringList fileList = testdir.entryList(QDir::NoFilter, QDir::Time);
             foreach (const QString &filename, fileList) {
 
@@ -167,6 +167,24 @@ private slots:
         }
     }
 
+    void sorted_byName() {
+        QBENCHMARK {
+            // a fresh QDir each time, or its cached entry list would be used
+            QDir testdir(QDir::tempPath() + QLatin1String("/test_speed"));
+            QStringList fileList = testdir.entryList(QDir::NoFilter, QDir::Name | QDir::DirsFirst);
+            QCOMPARE(fileList.size(), 10002);
+        }
+    }
+
+    void sorted_byNameIgnoreCase() {
+        QBENCHMARK {
+            // a fresh QDir each time, or its cached entry list would be used
+            QDir testdir(QDir::tempPath() + QLatin1String("/test_speed"));
+            QStringList fileList = testdir.entryList(QDir::NoFilter, QDir::Name | QDir::IgnoreCase);
+            QCOMPARE(fileList.size(), 10002);
+        }
+    }
+
     void sizeSpeedWithoutFilterLowLevel() {
         QDir testdir(QDir::tempPath() + QLatin1String("/test_speed"));
 #ifdef Q_OS_WIN
@@ -186,13 +186,26 @@ private slots:
         QCOMPARE(count, entryCount);
     }
 
+    void traverseDirectory_data() const
+    {
+        QTest::addColumn<int>("flags");
+
+        QTest::newRow("sequential") << int(QDirIterator::NoIteratorFlags);
+        QTest::newRow("parallel") << int(QDirIterator::ParallelSubdirectories);
+        QTest::newRow("parallel, unordered")
+            << int(QDirIterator::ParallelSubdirectories | QDirIterator::UnorderedResults);
+    }
+
     void traverseDirectory() const
     {
+        QFETCH(int, flags);
+
         int count = 0;
         QBENCHMARK {
-            QDirIterator iterator(prefix,
+            QDirIterator iterator(fs.absoluteFilePath(QString::fromLatin1(prefix)),
                     QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
-                    QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+                    QDirIterator::Subdirectories | QDirIterator::FollowSymlinks
+                    | QDirIterator::IteratorFlags(flags));
 
             count = 0;
             while (iterator.hasNext()) {
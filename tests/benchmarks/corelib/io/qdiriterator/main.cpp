@@ -41,6 +41,7 @@
 #include <QDebug>
 #include <QDirIterator>
 #include <QString>
+#include <QTemporaryDir>
 
 #ifdef Q_OS_WIN
 #   include <qt_windows.h>
@@ -67,6 +68,18 @@ private slots:
     void fsiterator();
     void fsiterator_data() { data(); }
     void data();
+
+    void largeDirectory_data() { largeDirectoryData(); }
+    void largeDirectory();
+    void largeDirectoryEntryList_data() { largeDirectoryData(); }
+    void largeDirectoryEntryList();
+    void largeDirectoryPosix();
+
+private:
+    void largeDirectoryData();
+    QString largeDirectoryPath();
+
+    QScopedPointer<QTemporaryDir> largeDir;
 };
 
 
@@ -247,6 +260,92 @@ void tst_qdiriterator::fsiterator()
     qDebug() << count;
 }
 
+// One million entries in a single directory; every hundredth one is a
+// symbolic link, which needs a stat to find out what it points to.
+enum { LargeDirectoryEntries = 1000000, LargeDirectoryLinkInterval = 100 };
+
+QString tst_qdiriterator::largeDirectoryPath()
+{
+    if (largeDir)
+        return largeDir->path();
+
+    largeDir.reset(new QTemporaryDir);
+    if (!largeDir->isValid())
+        qFatal("Cannot create a temporary directory");
+
+    const QString path = largeDir->path() + QLatin1Char('/');
+    for (int i = 0; i < LargeDirectoryEntries; ++i) {
+        const QString fileName = path + QString::number(i);
+        if (i % LargeDirectoryLinkInterval == 1) {
+            if (!QFile::link(QString::number(i - 1), fileName))
+                qFatal("Cannot create %s", qPrintable(fileName));
+        } else {
+            QFile file(fileName);
+            if (!file.open(QIODevice::WriteOnly))
+                qFatal("Cannot create %s: %s", qPrintable(fileName), qPrintable(file.errorString()));
+        }
+    }
+    return largeDir->path();
+}
+
+void tst_qdiriterator::largeDirectoryData()
+{
+    QTest::addColumn<int>("filters");
+
+    QTest::newRow("AllEntries|System") << int(QDir::AllEntries | QDir::System | QDir::Hidden);
+    QTest::newRow("AllEntries") << int(QDir::AllEntries);
+    QTest::newRow("Files") << int(QDir::Files);
+    QTest::newRow("Files|NoSymLinks") << int(QDir::Files | QDir::NoSymLinks);
+    QTest::newRow("Files|Readable") << int(QDir::Files | QDir::Readable);
+}
+
+void tst_qdiriterator::largeDirectory()
+{
+    QFETCH(int, filters);
+    const QString path = largeDirectoryPath();
+
+    int count = 0;
+    QBENCHMARK {
+        int c = 0;
+        QDirIterator dir(path, QDir::Filters(filters) | QDir::NoDotAndDotDot);
+        while (dir.hasNext()) {
+            dir.next();
+            ++c;
+        }
+        count = c;
+    }
+    qDebug() << count;
+}
+
+void tst_qdiriterator::largeDirectoryEntryList()
+{
+    QFETCH(int, filters);
+    const QString path = largeDirectoryPath();
+
+    int count = 0;
+    QBENCHMARK {
+        count = QDir(path).entryList(QDir::Filters(filters) | QDir::NoDotAndDotDot, QDir::NoSort).count();
+    }
+    qDebug() << count;
+}
+
+void tst_qdiriterator::largeDirectoryPosix()
+{
+    const QString path = largeDirectoryPath();
+
+    int count = 0;
+    QBENCHMARK {
+#ifdef Q_OS_WIN
+        wchar_t wPath[MAX_PATH];
+        wPath[path.toWCharArray(wPath)] = 0;
+        count = posix_helper(wPath);
+#else
+        count = posix_helper(QFile::encodeName(path).constData());
+#endif
+    }
+    qDebug() << count;
+}
+
 QTEST_MAIN(tst_qdiriterator)
 
 #include "main.moc"
@@ -50,6 +50,8 @@ class tst_QProcess : public QObject
 private slots:
 
     void echoTest_performance();
+    void startLatency_data();
+    void startLatency();
 
 #endif // QT_NO_PROCESS
 };
@@ -101,6 +103,46 @@ void tst_QProcess::echoTest_performance()
     QVERIFY(process.waitForFinished());
 }
 
+// A subclass may override setupChildProcess(), which forces QProcess to
+// fork() instead of spawning the child.
+class ForkingProcess : public QProcess
+{
+};
+
+void tst_QProcess::startLatency_data()
+{
+    QTest::addColumn<int>("residentMegabytes");
+    QTest::addColumn<bool>("subclass");
+
+    const int sizes[] = { 0, 64, 512 };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        QByteArray name = QByteArray::number(sizes[i]) + " MB";
+        QTest::newRow(name + ", QProcess") << sizes[i] << false;
+        QTest::newRow(name + ", subclass") << sizes[i] << true;
+    }
+}
+
+// Measures how long it takes to start a child and see it exit, depending on
+// the size of the parent's address space.
+void tst_QProcess::startLatency()
+{
+    QFETCH(int, residentMegabytes);
+    QFETCH(bool, subclass);
+
+    // touch every page so that it is really resident
+    QByteArray ballast(residentMegabytes * 1024 * 1024, Qt::Uninitialized);
+    for (int i = 0; i < ballast.size(); i += 4096)
+        ballast[i] = char(i);
+
+    QBENCHMARK {
+        QScopedPointer<QProcess> process(subclass ? new ForkingProcess : new QProcess);
+        process->start("testProcessLoopback/testProcessLoopback");
+        QVERIFY(process->waitForStarted());
+        process->closeWriteChannel();
+        QVERIFY(process->waitForFinished());
+    }
+}
+
 #endif // QT_NO_PROCESS && Q_OS_WINCE
 
 QTEST_MAIN(tst_QProcess)
@@ -0,0 +1,134 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtTest/QtTest>
+#include <QtCore/QSettings>
+#include <QtCore/QTemporaryDir>
+
+#include "private/qsettings_p.h"
+
+Q_DECLARE_METATYPE(QSettings::Format)
+
+class tst_qsettings : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void syncChangedKey_data();
+    void syncChangedKey();
+    void open_data();
+    void open();
+
+private:
+    void populate(const QString &fileName, QSettings::Format format, int keyCount);
+    QTemporaryDir dir;
+};
+
+void tst_qsettings::initTestCase()
+{
+    QVERIFY(dir.isValid());
+}
+
+void tst_qsettings::populate(const QString &fileName, QSettings::Format format, int keyCount)
+{
+    QSettings settings(fileName, format);
+    for (int i = 0; i < keyCount; ++i)
+        settings.setValue(QString::fromLatin1("group%1/key%2").arg(i / 100).arg(i),
+                          QString::fromLatin1("value %1").arg(i));
+    settings.sync();
+    QCOMPARE(settings.status(), QSettings::NoError);
+}
+
+static void formatAndKeyCountData()
+{
+    QTest::addColumn<QSettings::Format>("format");
+    QTest::addColumn<int>("keyCount");
+
+    QTest::newRow("ini, 1000 keys") << QSettings::IniFormat << 1000;
+    QTest::newRow("ini, 100000 keys") << QSettings::IniFormat << 100000;
+    QTest::newRow("journal, 1000 keys") << QSettings::JournalFormat << 1000;
+    QTest::newRow("journal, 100000 keys") << QSettings::JournalFormat << 100000;
+}
+
+void tst_qsettings::syncChangedKey_data()
+{
+    formatAndKeyCountData();
+}
+
+void tst_qsettings::syncChangedKey()
+{
+    QFETCH(QSettings::Format, format);
+    QFETCH(int, keyCount);
+
+    const QString fileName = dir.path() + QLatin1String("/sync-") + QTest::currentDataTag();
+    populate(fileName, format, keyCount);
+
+    QSettings settings(fileName, format);
+    int i = 0;
+    QBENCHMARK {
+        settings.setValue(QLatin1String("group0/key0"), ++i);
+        settings.sync();
+    }
+    QCOMPARE(settings.status(), QSettings::NoError);
+}
+
+void tst_qsettings::open_data()
+{
+    formatAndKeyCountData();
+}
+
+void tst_qsettings::open()
+{
+    QFETCH(QSettings::Format, format);
+    QFETCH(int, keyCount);
+
+    const QString fileName = dir.path() + QLatin1String("/open-") + QTest::currentDataTag();
+    populate(fileName, format, keyCount);
+
+    QBENCHMARK {
+        QConfFile::clearCache();
+        QSettings settings(fileName, format);
+        QCOMPARE(settings.value(QLatin1String("group0/key1")).toString(), QString::fromLatin1("value 1"));
+    }
+}
+
+QTEST_MAIN(tst_qsettings)
+
+#include "main.moc"
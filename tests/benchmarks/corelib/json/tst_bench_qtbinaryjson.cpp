@@ -40,8 +40,10 @@
 ****************************************************************************/
 
 #include <QtTest>
+#include <qjsonarray.h>
 #include <qjsondocument.h>
 #include <qjsonobject.h>
+#include <qjsonstream.h>
 
 class BenchmarkQtBinaryJson: public QObject
 {
@@ -58,12 +60,32 @@ private Q_SLOTS:
     void parseNumbers();
     void parseJson();
     void parseJsonToVariant();
+    void streamJson();
+    void throughput_data();
+    void throughput();
+    void streamJsonLines();
 
     void toByteArray();
     void fromByteArray();
 
     void jsonObjectInsert();
     void variantMapInsert();
+
+    void loadSnapshot_data();
+    void loadSnapshot();
+    void objectLookup_data();
+    void objectLookup();
+
+private:
+    enum LoadMode {
+        ReadFile,
+        MapFileValidate,
+        MapFileValidateOnAccess,
+        MapFileBypassValidation
+    };
+
+    QTemporaryFile snapshotFile;
+    QStringList snapshotKeys;
 };
 
 BenchmarkQtBinaryJson::BenchmarkQtBinaryJson(QObject *parent) : QObject(parent)
@@ -71,9 +93,33 @@ BenchmarkQtBinaryJson::BenchmarkQtBinaryJson(QObject *parent) : QObject(parent)
 
 }
 
-void BenchmarkQtBinaryJson::initTestCase()
+// about 13MB of binary JSON, like a configuration or state snapshot
+static QJsonObject createSnapshot(QStringList *keys)
 {
+    QJsonObject root;
+    for (int i = 0; i < 50000; ++i) {
+        QJsonObject entry;
+        entry.insert("id", i);
+        entry.insert("name", QString("entry number %1").arg(i));
+        entry.insert("enabled", (i % 3) != 0);
+        entry.insert("weight", i / 7.0);
+        QJsonArray tags;
+        for (int j = 0; j < 8; ++j)
+            tags.append(QString("tag%1").arg((i + j) % 100));
+        entry.insert("tags", tags);
+        const QString key = QString("/config/section%1/item%2").arg(i % 100).arg(i);
+        root.insert(key, entry);
+        keys->append(key);
+    }
+    return root;
+}
 
+void BenchmarkQtBinaryJson::initTestCase()
+{
+    QVERIFY(snapshotFile.open());
+    const QByteArray binary = QJsonDocument(createSnapshot(&snapshotKeys)).toBinaryData();
+    QCOMPARE(snapshotFile.write(binary), qint64(binary.size()));
+    snapshotFile.close();
 }
 
 void BenchmarkQtBinaryJson::cleanupTestCase()
@@ -133,6 +179,87 @@ void BenchmarkQtBinaryJson::parseJsonToVariant()
     }
 }
 
+void BenchmarkQtBinaryJson::streamJson()
+{
+    QString testFile = QFINDTESTDATA("test.json");
+    QVERIFY2(!testFile.isEmpty(), "cannot find test file test.json!");
+    QFile file(testFile);
+    file.open(QFile::ReadOnly);
+    QByteArray testJson = file.readAll();
+
+    QBENCHMARK {
+        QJsonStreamReader reader(testJson);
+        while (reader.readNext() != QJsonStreamReader::NoToken)
+            ;
+    }
+}
+
+void BenchmarkQtBinaryJson::throughput_data()
+{
+    QTest::addColumn<QString>("fileName");
+    QTest::addColumn<bool>("stream");
+
+    QTest::newRow("test.json-document") << QString("test.json") << false;
+    QTest::newRow("test.json-stream") << QString("test.json") << true;
+    QTest::newRow("numbers.json-document") << QString("numbers.json") << false;
+    QTest::newRow("numbers.json-stream") << QString("numbers.json") << true;
+}
+
+void BenchmarkQtBinaryJson::throughput()
+{
+    QFETCH(QString, fileName);
+    QFETCH(bool, stream);
+
+    QString testFile = QFINDTESTDATA(fileName);
+    QVERIFY2(!testFile.isEmpty(), "cannot find test file!");
+    QFile file(testFile);
+    file.open(QFile::ReadOnly);
+    QByteArray testJson = file.readAll();
+
+    // parse for half a second and report the rate in bytes per second
+    QElapsedTimer timer;
+    qint64 bytes = 0;
+    timer.start();
+    do {
+        for (int i = 0; i < 16; ++i) {
+            if (stream) {
+                QJsonStreamReader reader(testJson);
+                while (reader.readNext() != QJsonStreamReader::NoToken)
+                    ;
+            } else {
+                QJsonDocument doc = QJsonDocument::fromJson(testJson);
+            }
+        }
+        bytes += 16 * testJson.size();
+    } while (timer.elapsed() < 500);
+    QTest::setBenchmarkResult(bytes * 1e9 / timer.nsecsElapsed(), QTest::BytesPerSecond);
+}
+
+void BenchmarkQtBinaryJson::streamJsonLines()
+{
+    // a JSON-lines export, written and read back one record at a time
+    QString testFile = QFINDTESTDATA("test.json");
+    QVERIFY2(!testFile.isEmpty(), "cannot find test file test.json!");
+    QFile file(testFile);
+    file.open(QFile::ReadOnly);
+    QJsonArray records = QJsonDocument::fromJson(file.readAll()).array();
+
+    QByteArray lines;
+    QJsonStreamWriter writer(&lines);
+    for (int i = 0; i < 100; ++i) {
+        for (int j = 0; j < records.size(); ++j)
+            writer.writeValue(records.at(j));
+    }
+
+    QBENCHMARK {
+        QJsonStreamReader reader(lines);
+        while (reader.readNext() != QJsonStreamReader::NoToken) {
+            if (reader.isStartObject())
+                reader.readValue();
+        }
+    }
+}
+
 void BenchmarkQtBinaryJson::toByteArray()
 {
     // Example: send information over a datastream to another process
@@ -187,6 +314,79 @@ void BenchmarkQtBinaryJson::variantMapInsert()
     }
 }
 
+void BenchmarkQtBinaryJson::loadSnapshot_data()
+{
+    QTest::addColumn<int>("mode");
+
+    QTest::newRow("read-fromBinaryData") << int(ReadFile);
+    QTest::newRow("map-Validate") << int(MapFileValidate);
+    QTest::newRow("map-ValidateOnAccess") << int(MapFileValidateOnAccess);
+    QTest::newRow("map-BypassValidation") << int(MapFileBypassValidation);
+}
+
+// Time to start up from a snapshot: load it and read a few entries
+void BenchmarkQtBinaryJson::loadSnapshot()
+{
+    QFETCH(int, mode);
+    const QString fileName = snapshotFile.fileName();
+
+    QBENCHMARK {
+        QJsonDocument doc;
+        switch (mode) {
+        case ReadFile: {
+            QFile file(fileName);
+            file.open(QFile::ReadOnly);
+            doc = QJsonDocument::fromBinaryData(file.readAll());
+            break;
+        }
+        case MapFileValidate:
+            doc = QJsonDocument::fromBinaryFile(fileName, QJsonDocument::Validate);
+            break;
+        case MapFileValidateOnAccess:
+            doc = QJsonDocument::fromBinaryFile(fileName, QJsonDocument::ValidateOnAccess);
+            break;
+        case MapFileBypassValidation:
+            doc = QJsonDocument::fromBinaryFile(fileName, QJsonDocument::BypassValidation);
+            break;
+        }
+
+        const QJsonObject root = doc.object();
+        for (int i = 0; i < 10; ++i) {
+            const QJsonObject entry = root.value(snapshotKeys.at(i * 4999)).toObject();
+            if (entry.value("id").toDouble() != i * 4999)
+                QFAIL("unexpected snapshot contents");
+        }
+    }
+}
+
+void BenchmarkQtBinaryJson::objectLookup_data()
+{
+    QTest::addColumn<bool>("unicodeKeys");
+
+    QTest::newRow("latin1") << false;
+    QTest::newRow("unicode") << true;
+}
+
+void BenchmarkQtBinaryJson::objectLookup()
+{
+    QFETCH(bool, unicodeKeys);
+
+    QStringList keys;
+    QJsonObject object;
+    for (int i = 0; i < 10000; ++i) {
+        QString key = QString("key number %1").arg(i);
+        if (unicodeKeys)
+            key += QChar(0x20ac);
+        object.insert(key, i);
+        keys.append(key);
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < keys.size(); ++i)
+            object.value(keys.at(i));
+    }
+}
+
 QTEST_MAIN(BenchmarkQtBinaryJson)
 #include "tst_bench_qtbinaryjson.moc"
 
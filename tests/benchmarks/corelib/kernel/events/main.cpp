@@ -43,6 +43,12 @@
 #include <qtest.h>
 #include <qtesteventloop.h>
 
+#ifdef Q_OS_UNIX
+#  include <sys/resource.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
 class PingPong : public QObject
 {
 public:
@@ -96,6 +102,79 @@ int EventTester::foo(int bar)
     return bar + 1;
 }
 
+class EventCounter : public QObject
+{
+public:
+    EventCounter() : m_remaining(0) {}
+    void expect(int count) { m_remaining = count; }
+
+protected:
+    bool event(QEvent *e)
+    {
+        if (e->type() != QEvent::User)
+            return QObject::event(e);
+        if (--m_remaining == 0)
+            QTestEventLoop::instance().exitLoop();
+        return true;
+    }
+
+private:
+    int m_remaining;
+};
+
+class EventPoster : public QThread
+{
+public:
+    EventPoster(QObject *receiver, int count, QSemaphore *start)
+        : m_receiver(receiver), m_count(count), m_start(start) {}
+
+protected:
+    void run()
+    {
+        m_start->acquire();
+        for (int i = 0; i < m_count; ++i)
+            QCoreApplication::postEvent(m_receiver, new QEvent(QEvent::User));
+    }
+
+private:
+    QObject *m_receiver;
+    int m_count;
+    QSemaphore *m_start;
+};
+
+class NotifierSink : public QObject
+{
+    Q_OBJECT
+public:
+    NotifierSink(const QList<int> &fds, QSemaphore *semaphore)
+        : m_fds(fds), m_semaphore(semaphore) {}
+
+public slots:
+    void watch()
+    {
+        foreach (int fd, m_fds) {
+            QSocketNotifier *notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+            connect(notifier, SIGNAL(activated(int)), this, SLOT(readyRead(int)));
+        }
+    }
+
+    void unwatch()
+    {
+        qDeleteAll(children());
+    }
+
+    void readyRead(int fd)
+    {
+        char c;
+        if (::read(fd, &c, 1) == 1)
+            m_semaphore->release();
+    }
+
+private:
+    QList<int> m_fds;
+    QSemaphore *m_semaphore;
+};
+
 class EventsBench : public QObject
 {
     Q_OBJECT
@@ -109,6 +188,10 @@ private slots:
     void sendEvent();
     void postEvent_data();
     void postEvent();
+    void postEventFromThreads_data();
+    void postEventFromThreads();
+    void socketNotifiers_data();
+    void socketNotifiers();
 };
 
 void EventsBench::initTestCase()
@@ -182,6 +265,125 @@ void EventsBench::postEvent()
     }
 }
 
+void EventsBench::postEventFromThreads_data()
+{
+    QTest::addColumn<int>("producers");
+    QTest::newRow("1 producer") << 1;
+    QTest::newRow("2 producers") << 2;
+    QTest::newRow("4 producers") << 4;
+    QTest::newRow("8 producers") << 8;
+}
+
+// Several threads post events to one object in the main thread at the same
+// time; measures the time until all of them have been delivered.
+void EventsBench::postEventFromThreads()
+{
+    QFETCH(int, producers);
+    const int eventsPerProducer = 20000;
+
+    EventCounter counter;
+    QBENCHMARK {
+        QSemaphore start;
+        QList<EventPoster *> posters;
+        for (int i = 0; i < producers; ++i) {
+            posters << new EventPoster(&counter, eventsPerProducer, &start);
+            posters.last()->start();
+        }
+
+        counter.expect(producers * eventsPerProducer);
+        start.release(producers);
+        QTestEventLoop::instance().enterLoop(60);
+        QVERIFY(!QTestEventLoop::instance().timeout());
+
+        foreach (EventPoster *poster, posters)
+            poster->wait();
+        qDeleteAll(posters);
+    }
+}
+
+void EventsBench::socketNotifiers_data()
+{
+    QTest::addColumn<bool>("epoll");
+    QTest::addColumn<int>("count");
+
+    static const int counts[] = { 10, 100, 1000, 10000 };
+    for (int i = 0; i < int(sizeof(counts) / sizeof(counts[0])); ++i) {
+        QTest::newRow(QByteArray("select, " + QByteArray::number(counts[i])).constData())
+                << false << counts[i];
+        QTest::newRow(QByteArray("epoll, " + QByteArray::number(counts[i])).constData())
+                << true << counts[i];
+    }
+}
+
+void EventsBench::socketNotifiers()
+{
+#ifndef Q_OS_UNIX
+    QSKIP("This benchmark needs socketpair()");
+#else
+    QFETCH(bool, epoll);
+    QFETCH(int, count);
+#  ifndef Q_OS_LINUX
+    if (epoll)
+        QSKIP("epoll is only available on Linux");
+#  endif
+
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < rlim_t(2 * count + 64)) {
+        limit.rlim_cur = qMin<rlim_t>(2 * count + 64, limit.rlim_max);
+        setrlimit(RLIMIT_NOFILE, &limit);
+        if (limit.rlim_cur < rlim_t(2 * count + 64))
+            QSKIP("Not enough file descriptors available");
+    }
+
+    QList<int> readEnds;
+    QList<int> writeEnds;
+    for (int i = 0; i < count; ++i) {
+        int sv[2];
+        QVERIFY(::socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+        readEnds << sv[0];
+        writeEnds << sv[1];
+    }
+    if (!epoll && sizeof(fd_set) * 8 <= size_t(writeEnds.last())) {
+        for (int i = 0; i < count; ++i) {
+            ::close(readEnds.at(i));
+            ::close(writeEnds.at(i));
+        }
+        QSKIP("select() cannot watch descriptors above FD_SETSIZE");
+    }
+
+    // the event dispatcher backend is chosen when the thread starts
+    qputenv("QT_NO_GLIB", "1");
+    qputenv("QT_EVENT_DISPATCHER_EPOLL", epoll ? "1" : "");
+
+    QSemaphore semaphore;
+    QThread thread;
+    NotifierSink sink(readEnds, &semaphore);
+    sink.moveToThread(&thread);
+    thread.start();
+    QMetaObject::invokeMethod(&sink, "watch", Qt::BlockingQueuedConnection);
+
+    // only a single descriptor is ready per iteration, so the cost is
+    // dominated by how the dispatcher scales with the idle ones
+    int next = 0;
+    QBENCHMARK {
+        const char c = 'x';
+        QVERIFY(::write(writeEnds.at(next), &c, 1) == 1);
+        semaphore.acquire();
+        next = (next + 7919) % count;
+    }
+
+    QMetaObject::invokeMethod(&sink, "unwatch", Qt::BlockingQueuedConnection);
+    thread.quit();
+    thread.wait();
+    qunsetenv("QT_EVENT_DISPATCHER_EPOLL");
+    qunsetenv("QT_NO_GLIB");
+    for (int i = 0; i < count; ++i) {
+        ::close(readEnds.at(i));
+        ::close(writeEnds.at(i));
+    }
+#endif
+}
+
 QTEST_MAIN(EventsBench)
 
 #include "main.moc"
@@ -62,6 +62,8 @@ private slots:
     void connect_disconnect_benchmark_data();
     void connect_disconnect_benchmark();
     void receiver_destroyed_benchmark();
+    void multithreaded_signal_slot_benchmark_data();
+    void multithreaded_signal_slot_benchmark();
 };
 
 struct Functor {
@@ -246,6 +248,67 @@ void QObjectBenchmark::receiver_destroyed_benchmark()
     }
 }
 
+class EmitterThread : public QThread
+{
+public:
+    EmitterThread(Object *sender, int count, QSemaphore *start)
+        : m_sender(sender), m_count(count), m_start(start) {}
+
+protected:
+    void run()
+    {
+        m_start->acquire();
+        for (int i = 0; i < m_count; ++i)
+            m_sender->emitSignal0();
+    }
+
+private:
+    Object *m_sender;
+    int m_count;
+    QSemaphore *m_start;
+};
+
+void QObjectBenchmark::multithreaded_signal_slot_benchmark_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<bool>("sharedSender");
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        QTest::newRow(qPrintable(QString("%1 threads, shared sender").arg(threads))) << threads << true;
+        QTest::newRow(qPrintable(QString("%1 threads, own senders").arg(threads))) << threads << false;
+    }
+}
+
+// Several threads emit a signal that is directly connected to a slot, either
+// all on the same sender or each on its own one.
+void QObjectBenchmark::multithreaded_signal_slot_benchmark()
+{
+    QFETCH(int, threads);
+    QFETCH(bool, sharedSender);
+    const int emissionsPerThread = 100000;
+
+    QVector<Object *> senders;
+    for (int i = 0; i < (sharedSender ? 1 : threads); ++i) {
+        Object *sender = new Object;
+        QObject::connect(sender, &Object::signal0, sender, &Object::slot0, Qt::DirectConnection);
+        senders << sender;
+    }
+
+    QBENCHMARK {
+        QSemaphore start;
+        QList<EmitterThread *> emitters;
+        for (int i = 0; i < threads; ++i) {
+            emitters << new EmitterThread(senders.at(sharedSender ? 0 : i), emissionsPerThread, &start);
+            emitters.last()->start();
+        }
+        start.release(threads);
+        foreach (EmitterThread *emitter, emitters)
+            emitter->wait();
+        qDeleteAll(emitters);
+    }
+
+    qDeleteAll(senders);
+}
+
 QTEST_MAIN(QObjectBenchmark)
 
 #include "main.moc"
@@ -0,0 +1,207 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include <QtCore>
+
+#include <qtest.h>
+
+#ifdef Q_OS_UNIX
+#  include <private/qtimerinfo_unix_p.h>
+#endif
+
+class TimerBench : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void restartTimers_data();
+    void restartTimers();
+    void startStopTimer_data();
+    void startStopTimer();
+    void threadWakeups_data();
+    void threadWakeups();
+};
+
+static void addTimerCountRows()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("50000") << 50000;
+}
+
+void TimerBench::restartTimers_data()
+{
+    addTimerCountRows();
+}
+
+// Models per-connection idle timers: every timer is restarted once (as if
+// data had arrived on its connection) and the event loop runs once.
+void TimerBench::restartTimers()
+{
+    QFETCH(int, count);
+
+    QVector<QTimer *> timers;
+    timers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QTimer *timer = new QTimer(this);
+        timer->setInterval(30000 + (i % 1000));
+        timer->start();
+        timers.append(timer);
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i)
+            timers.at(i)->start();
+        QCoreApplication::processEvents();
+    }
+
+    qDeleteAll(timers);
+}
+
+void TimerBench::startStopTimer_data()
+{
+    addTimerCountRows();
+}
+
+// Cost of starting and stopping one timer while many others are registered.
+void TimerBench::startStopTimer()
+{
+    QFETCH(int, count);
+
+    QVector<QTimer *> timers;
+    timers.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QTimer *timer = new QTimer(this);
+        timer->start(30000 + (i % 1000));
+        timers.append(timer);
+    }
+
+    QTimer timer;
+    QBENCHMARK {
+        timer.start(15000);
+        timer.stop();
+    }
+
+    qDeleteAll(timers);
+}
+
+// Housekeeping timers of a worker thread, with intervals that differ from
+// thread to thread.
+class HousekeepingWorker : public QObject
+{
+    Q_OBJECT
+public:
+    HousekeepingWorker(int index)
+        : index(index)
+    { }
+
+public slots:
+    void start()
+    {
+        for (int i = 0; i < 3; ++i) {
+            QTimer *timer = new QTimer(this);
+            timer->setTimerType(Qt::CoarseTimer);
+            timer->start(500 + (index * 37 + i * 131) % 1500);
+        }
+    }
+
+private:
+    int index;
+};
+
+void TimerBench::threadWakeups_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("coalesce");
+    QTest::newRow("8 threads") << 8 << false;
+    QTest::newRow("8 threads, coalesced") << 8 << true;
+    QTest::newRow("64 threads") << 64 << false;
+    QTest::newRow("64 threads, coalesced") << 64 << true;
+}
+
+// Process-wide wakeups per second caused by coarse timers in many threads,
+// with and without Qt::AA_CoalesceTimersAcrossThreads.
+void TimerBench::threadWakeups()
+{
+#ifdef Q_OS_UNIX
+    QFETCH(int, threadCount);
+    QFETCH(bool, coalesce);
+
+    QCoreApplication::setAttribute(Qt::AA_CoalesceTimersAcrossThreads, coalesce);
+
+    QVector<QThread *> threads;
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *thread = new QThread;
+        HousekeepingWorker *worker = new HousekeepingWorker(i);
+        worker->moveToThread(thread);
+        connect(thread, SIGNAL(started()), worker, SLOT(start()));
+        connect(thread, SIGNAL(finished()), worker, SLOT(deleteLater()));
+        thread->start();
+        threads.append(thread);
+    }
+
+    // let the timers settle on their wakeup times before measuring
+    QTest::qWait(1000);
+    qt_setTimerWakeupStatisticsEnabled(true);
+    QTest::qWait(3000);
+    const QTimerWakeupStatistics statistics = qt_timerWakeupStatistics();
+    qt_setTimerWakeupStatisticsEnabled(false);
+
+    for (int i = 0; i < threadCount; ++i) {
+        threads.at(i)->quit();
+        threads.at(i)->wait();
+    }
+    qDeleteAll(threads);
+    QCoreApplication::setAttribute(Qt::AA_CoalesceTimersAcrossThreads, false);
+
+    const qreal seconds = statistics.elapsed / 1000.;
+    qDebug("thread wakeups/s: %.1f, process wakeups/s: %.1f",
+           statistics.threadWakeups / seconds, statistics.processWakeups / seconds);
+    QTest::setBenchmarkResult(statistics.processWakeups / seconds, QTest::Events);
+#else
+    QSKIP("Timer wakeup statistics are only available on Unix");
+#endif
+}
+
+QTEST_MAIN(TimerBench)
+
+#include "main.moc"
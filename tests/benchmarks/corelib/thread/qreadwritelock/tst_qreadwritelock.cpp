@@ -0,0 +1,164 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the test suite of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QtCore/QtCore>
+#include <QtTest/QtTest>
+
+// Read-mostly workloads: a number of threads look values up in a shared
+// hash, some fraction of the accesses being updates.
+
+class tst_QReadWriteLock : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void uncontendedRead();
+    void uncontendedWrite();
+    void readersWriters_data();
+    void readersWriters();
+};
+
+void tst_QReadWriteLock::uncontendedRead()
+{
+    QReadWriteLock lock;
+    QBENCHMARK {
+        for (int i = 0; i < 100000; ++i) {
+            lock.lockForRead();
+            lock.unlock();
+        }
+    }
+}
+
+void tst_QReadWriteLock::uncontendedWrite()
+{
+    QReadWriteLock lock;
+    QBENCHMARK {
+        for (int i = 0; i < 100000; ++i) {
+            lock.lockForWrite();
+            lock.unlock();
+        }
+    }
+}
+
+class AccessThread : public QThread
+{
+public:
+    AccessThread(QReadWriteLock *lock, QHash<int, int> *hash, int iterations,
+                 int writePermille, QSemaphore *start)
+        : m_lock(lock), m_hash(hash), m_iterations(iterations),
+          m_writePermille(writePermille), m_start(start), m_sum(0)
+    { }
+
+protected:
+    void run()
+    {
+        m_start->acquire();
+        uint seed = uint(quintptr(this));
+        for (int i = 0; i < m_iterations; ++i) {
+            seed = seed * 1103515245 + 12345;
+            const int key = (seed >> 8) % 1024;
+            if (int((seed >> 20) % 1000) < m_writePermille) {
+                QWriteLocker locker(m_lock);
+                (*m_hash)[key] = i;
+            } else {
+                QReadLocker locker(m_lock);
+                m_sum += m_hash->value(key);
+            }
+        }
+    }
+
+private:
+    QReadWriteLock *m_lock;
+    QHash<int, int> *m_hash;
+    int m_iterations;
+    int m_writePermille;
+    QSemaphore *m_start;
+    int m_sum;
+};
+
+void tst_QReadWriteLock::readersWriters_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<int>("writePermille");
+
+    const int threadCounts[] = { 1, 2, 4, 8, 16 };
+    const int writeRates[] = { 0, 1, 10, 100 };
+    for (uint i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i) {
+        for (uint j = 0; j < sizeof(writeRates) / sizeof(writeRates[0]); ++j) {
+            const QByteArray name = QByteArray::number(threadCounts[i]) + " threads, "
+                    + QByteArray::number(writeRates[j] / 10.0) + "% writes";
+            QTest::newRow(name.constData()) << threadCounts[i] << writeRates[j];
+        }
+    }
+}
+
+void tst_QReadWriteLock::readersWriters()
+{
+    QFETCH(int, threadCount);
+    QFETCH(int, writePermille);
+
+    // the total amount of work is the same for every row, so the times
+    // show how well the lock scales with the number of threads
+    const int totalIterations = 400000;
+
+    QReadWriteLock lock;
+    QHash<int, int> hash;
+    for (int i = 0; i < 1024; ++i)
+        hash.insert(i, i);
+
+    QBENCHMARK {
+        QSemaphore start;
+        QList<AccessThread *> threads;
+        for (int i = 0; i < threadCount; ++i) {
+            threads.append(new AccessThread(&lock, &hash, totalIterations / threadCount,
+                                            writePermille, &start));
+            threads.last()->start();
+        }
+        start.release(threadCount);
+        foreach (AccessThread *thread, threads)
+            thread->wait();
+        qDeleteAll(threads);
+    }
+}
+
+QTEST_MAIN(tst_QReadWriteLock)
+
+#include "tst_qreadwritelock.moc"
@@ -53,6 +53,8 @@ public:
 private slots:
     void startRunnables();
     void activeThreadCount();
+    void tinyTaskThroughput_data();
+    void tinyTaskThroughput();
 };
 
 tst_QThreadPool::tst_QThreadPool()
@@ -88,5 +90,82 @@ void tst_QThreadPool::activeThreadCount()
     }
 }
 
+void tst_QThreadPool::tinyTaskThroughput_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<bool>("workStealing");
+    QTest::addColumn<bool>("nested");
+
+    const int threadCounts[] = { 1, 2, 4, 8, 16, 32 };
+    for (uint i = 0; i < sizeof(threadCounts) / sizeof(threadCounts[0]); ++i) {
+        const int n = threadCounts[i];
+        const QByteArray threads = QByteArray::number(n) + " threads, ";
+        QTest::newRow(threads + "shared queue, from outside") << n << false << false;
+        QTest::newRow(threads + "work stealing, from outside") << n << true << false;
+        QTest::newRow(threads + "shared queue, from workers") << n << false << true;
+        QTest::newRow(threads + "work stealing, from workers") << n << true << true;
+    }
+}
+
+class CountingRunnable : public QRunnable
+{
+public:
+    CountingRunnable(QAtomicInt *counter) : counter(counter) {}
+    void run() Q_DECL_OVERRIDE {
+        counter->ref();
+    }
+
+private:
+    QAtomicInt *counter;
+};
+
+class SpawningRunnable : public QRunnable
+{
+public:
+    SpawningRunnable(QThreadPool *pool, QAtomicInt *counter, int count)
+        : pool(pool), counter(counter), count(count) {}
+    void run() Q_DECL_OVERRIDE {
+        for (int i = 0; i < count; ++i)
+            pool->start(new CountingRunnable(counter));
+    }
+
+private:
+    QThreadPool *pool;
+    QAtomicInt *counter;
+    int count;
+};
+
+// Throughput of runnables that do next to nothing, so that the cost of
+// queueing and dequeueing dominates. They are either all started from the
+// main thread, or started from within the pool in batches, like
+// Qt Concurrent does.
+void tst_QThreadPool::tinyTaskThroughput()
+{
+    QFETCH(int, threadCount);
+    QFETCH(bool, workStealing);
+    QFETCH(bool, nested);
+
+    const int taskCount = 20000;
+    const int batchSize = 500;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+    threadPool.setWorkStealingEnabled(workStealing);
+    QAtomicInt counter;
+
+    QBENCHMARK {
+        counter.store(0);
+        if (nested) {
+            for (int i = 0; i < taskCount / batchSize; ++i)
+                threadPool.start(new SpawningRunnable(&threadPool, &counter, batchSize));
+        } else {
+            for (int i = 0; i < taskCount; ++i)
+                threadPool.start(new CountingRunnable(&counter));
+        }
+        threadPool.waitForDone();
+    }
+    QCOMPARE(counter.load(), taskCount);
+}
+
 QTEST_MAIN(tst_QThreadPool)
 #include "tst_qthreadpool.moc"
@@ -1,5 +1,6 @@
 TEMPLATE = subdirs
 SUBDIRS = \
         qmutex \
+        qreadwritelock \
         qthreadstorage \
         qthreadpool \
@@ -39,9 +39,18 @@
 **
 ****************************************************************************/
 #include <QString>
+#include <QFlatHash>
+#include <QFlatMap>
 
 #include <qtest.h>
 
+enum Container {
+    Hash,
+    FlatHash,
+    Map,
+    FlatMap
+};
+
 class tst_associative_containers : public QObject
 {
     Q_OBJECT
@@ -50,6 +59,8 @@ private slots:
     void insert();
     void lookup_data();
     void lookup();
+    void construct_data();
+    void construct();
 };
 
 template <typename T>
@@ -65,30 +76,38 @@ void testInsert(int size)
 
 void tst_associative_containers::insert_data()
 {
-    QTest::addColumn<bool>("useHash");
+    QTest::addColumn<int>("container");
     QTest::addColumn<int>("size");
 
     for (int size = 10; size < 20000; size += 100) {
 
         const QByteArray sizeString = QByteArray::number(size);
 
-        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << true << size;
-        QTest::newRow(QByteArray("map--" + sizeString).constData()) << false << size;
+        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << int(Hash) << size;
+        QTest::newRow(QByteArray("flathash--" + sizeString).constData()) << int(FlatHash) << size;
+        QTest::newRow(QByteArray("map--" + sizeString).constData()) << int(Map) << size;
+        QTest::newRow(QByteArray("flatmap--" + sizeString).constData()) << int(FlatMap) << size;
     }
 }
 
 void tst_associative_containers::insert()
 {
-    QFETCH(bool, useHash);
+    QFETCH(int, container);
     QFETCH(int, size);
 
-    QHash<int, int> testHash;
-    QMap<int, int> testMap;
-
-    if (useHash) {
+    switch (container) {
+    case Hash:
         testInsert<QHash<int, int> >(size);
-    } else {
+        break;
+    case FlatHash:
+        testInsert<QFlatHash<int, int> >(size);
+        break;
+    case Map:
         testInsert<QMap<int, int> >(size);
+        break;
+    case FlatMap:
+        testInsert<QFlatMap<int, int> >(size);
+        break;
     }
 }
 
@@ -97,15 +116,17 @@ void tst_associative_containers::lookup_data()
 //    setReportType(LineChartReport);
 //    setChartTitle("Time to call value(), with an increasing number of items in the container");
 
-    QTest::addColumn<bool>("useHash");
+    QTest::addColumn<int>("container");
     QTest::addColumn<int>("size");
 
     for (int size = 10; size < 20000; size += 100) {
 
         const QByteArray sizeString = QByteArray::number(size);
 
-        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << true << size;
-        QTest::newRow(QByteArray("map--" + sizeString).constData()) << false << size;
+        QTest::newRow(QByteArray("hash--" + sizeString).constData()) << int(Hash) << size;
+        QTest::newRow(QByteArray("flathash--" + sizeString).constData()) << int(FlatHash) << size;
+        QTest::newRow(QByteArray("map--" + sizeString).constData()) << int(Map) << size;
+        QTest::newRow(QByteArray("flatmap--" + sizeString).constData()) << int(FlatMap) << size;
     }
 }
 
@@ -128,13 +149,62 @@ void testLookup(int size)
 
 void tst_associative_containers::lookup()
 {
-    QFETCH(bool, useHash);
+    QFETCH(int, container);
     QFETCH(int, size);
 
-    if (useHash) {
+    switch (container) {
+    case Hash:
         testLookup<QHash<int, int> >(size);
-    } else {
+        break;
+    case FlatHash:
+        testLookup<QFlatHash<int, int> >(size);
+        break;
+    case Map:
         testLookup<QMap<int, int> >(size);
+        break;
+    case FlatMap:
+        testLookup<QFlatMap<int, int> >(size);
+        break;
+    }
+}
+
+void tst_associative_containers::construct_data()
+{
+    QTest::addColumn<int>("container");
+    QTest::addColumn<int>("size");
+
+    for (int size = 10; size <= 100000; size *= 10) {
+
+        const QByteArray sizeString = QByteArray::number(size);
+
+        QTest::newRow(QByteArray("map--" + sizeString).constData()) << int(Map) << size;
+        QTest::newRow(QByteArray("flatmap--" + sizeString).constData()) << int(FlatMap) << size;
+    }
+}
+
+// build a container from unsorted data once, as a registry or routing
+// table would be
+void tst_associative_containers::construct()
+{
+    QFETCH(int, container);
+    QFETCH(int, size);
+
+    QVector<QPair<int, int> > pairs;
+    pairs.reserve(size);
+    qsrand(size);
+    for (int i = 0; i < size; ++i)
+        pairs.append(qMakePair(qrand(), i));
+
+    if (container == Map) {
+        QBENCHMARK {
+            QMap<int, int> map;
+            for (int i = 0; i < pairs.size(); ++i)
+                map.insert(pairs.at(i).first, pairs.at(i).second);
+        }
+    } else {
+        QBENCHMARK {
+            QFlatMap<int, int> map(pairs);
+        }
     }
 }
 
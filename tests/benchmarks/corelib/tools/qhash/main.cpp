@@ -59,6 +59,12 @@ private slots:
     void qhash_qt4();
     void javaString_data() { data(); }
     void javaString();
+    void qhash_current_data() { data(); }
+    void qhash_current();
+    void lookup_current_data() { data(); }
+    void lookup_current();
+    void hashing_data() { data(); }
+    void hashing();
 
 private:
     void data();
@@ -67,6 +73,8 @@ private:
     QStringList uuids;
     QStringList dict;
     QStringList numbers;
+    QStringList deepPaths;
+    QStringList urls;
 };
 
 ///////////////////// QHash /////////////////////
@@ -122,6 +130,20 @@ void tst_QHash::initTestCase()
     // string versions of numbers.
     for (int i = 5000000; i < 5005001; ++i)
         numbers.append(QString::number(i));
+
+    // deep file paths sharing long prefixes, as in a file system cache
+    const char *directories[] = { "src/corelib/tools", "src/corelib/kernel", "src/gui/painting",
+                                  "tests/auto/corelib/tools/qhash", "3rdparty/harfbuzz-ng/src" };
+    for (int i = 0; i < 100000; ++i) {
+        deepPaths.append(QString::fromLatin1("/home/developer/projects/qt5/qtbase/%1/module%2/file%3.cpp")
+                         .arg(QLatin1String(directories[i % 5])).arg(i / 1000).arg(i % 1000));
+    }
+
+    // URLs of a REST API that differ only in identifiers and the query
+    for (int i = 0; i < 100000; ++i) {
+        urls.append(QString::fromLatin1("https://api.example.com/v2/users/%1/repositories/%2/issues?page=%3")
+                    .arg(10000 + i / 100).arg(i % 100).arg(i % 7));
+    }
 }
 
 void tst_QHash::data()
@@ -131,6 +153,8 @@ void tst_QHash::data()
     QTest::newRow("uuids-list") << uuids;
     QTest::newRow("dictionary") << dict;
     QTest::newRow("numbers") << numbers;
+    QTest::newRow("deep-paths") << deepPaths;
+    QTest::newRow("urls") << urls;
 }
 
 void tst_QHash::qhash_qt4()
@@ -164,7 +188,44 @@ void tst_QHash::javaString()
         }
     }
 }
+void tst_QHash::qhash_current()
+{
+    QFETCH(QStringList, items);
+    QHash<QString, int> hash;
+
+    QBENCHMARK {
+        for (int i = 0, n = items.size(); i != n; ++i) {
+            hash[items.at(i)] = i;
+        }
+    }
+}
+
+void tst_QHash::lookup_current()
+{
+    QFETCH(QStringList, items);
+    QHash<QString, int> hash;
+    for (int i = 0, n = items.size(); i != n; ++i)
+        hash.insert(items.at(i), i);
+
+    int found = 0;
+    QBENCHMARK {
+        for (int i = 0, n = items.size(); i != n; ++i)
+            found += hash.contains(items.at(i));
+    }
+    QVERIFY(found > 0);
+}
 
+void tst_QHash::hashing()
+{
+    QFETCH(QStringList, items);
+
+    uint result = 0;
+    QBENCHMARK {
+        for (int i = 0, n = items.size(); i != n; ++i)
+            result ^= qHash(items.at(i), 0);
+    }
+    Q_UNUSED(result);
+}
 
 QTEST_MAIN(tst_QHash)
 
@@ -41,6 +41,7 @@
 
 #include <QLocale>
 #include <QTest>
+#include <QVector>
 
 class tst_QLocale : public QObject
 {
@@ -50,6 +51,10 @@ private Q_SLOTS:
     void toUpper_QLocale_1();
     void toUpper_QLocale_2();
     void toUpper_QString();
+    void toString_double_data();
+    void toString_double();
+    void toDouble_data();
+    void toDouble();
 };
 
 static QString data()
@@ -78,6 +83,74 @@ void tst_QLocale::toUpper_QString()
     QBENCHMARK { LOOP(s.toUpper()) }
 }
 
+// a mix of short decimals, as found in CSV files, and full precision values
+static QVector<double> doubles()
+{
+    QVector<double> values;
+    quint64 state = Q_UINT64_C(0x853c49e6748fea9b);
+    for (int i = 0; i < 1000; ++i) {
+        state = state * Q_UINT64_C(6364136223846793005) + Q_UINT64_C(1442695040888963407);
+        if (i % 2)
+            values.append(double(state >> 40) / 100);
+        else
+            values.append(double(state >> 11) / double(Q_UINT64_C(1) << 53) * 1e6);
+    }
+    return values;
+}
+
+void tst_QLocale::toString_double_data()
+{
+    QTest::addColumn<char>("format");
+    QTest::addColumn<int>("precision");
+
+    QTest::newRow("g 6") << 'g' << 6;
+    QTest::newRow("g 17") << 'g' << 17;
+    QTest::newRow("g shortest") << 'g' << int(QLocale::FloatingPointShortest);
+    QTest::newRow("f 2") << 'f' << 2;
+    QTest::newRow("e 10") << 'e' << 10;
+}
+
+void tst_QLocale::toString_double()
+{
+    QFETCH(char, format);
+    QFETCH(int, precision);
+
+    const QVector<double> values = doubles();
+    QLocale l(QLocale::C);
+    QBENCHMARK {
+        for (int i = 0; i < values.size(); ++i)
+            l.toString(values.at(i), format, precision);
+    }
+}
+
+void tst_QLocale::toDouble_data()
+{
+    QTest::addColumn<char>("format");
+    QTest::addColumn<int>("precision");
+
+    QTest::newRow("g 6") << 'g' << 6;
+    QTest::newRow("g 17") << 'g' << 17;
+    QTest::newRow("g shortest") << 'g' << int(QLocale::FloatingPointShortest);
+    QTest::newRow("e 20") << 'e' << 20;
+}
+
+void tst_QLocale::toDouble()
+{
+    QFETCH(char, format);
+    QFETCH(int, precision);
+
+    const QVector<double> values = doubles();
+    QStringList strings;
+    for (int i = 0; i < values.size(); ++i)
+        strings.append(QString::number(values.at(i), format, precision));
+
+    QLocale l(QLocale::C);
+    QBENCHMARK {
+        for (int i = 0; i < strings.size(); ++i)
+            l.toDouble(strings.at(i));
+    }
+}
+
 QTEST_MAIN(tst_QLocale)
 
 #include "main.moc"
@@ -0,0 +1,173 @@
+/****************************************************************************
+**
+** Copyright (C) 2013 Digia Plc and/or its subsidiary(-ies).
+** Contact: http://www.qt-project.org/legal
+**
+** This file is part of the QtCore module of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and Digia.  For licensing terms and
+** conditions see http://qt.digia.com/licensing.  For further information
+** use the contact form at http://qt.digia.com/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 2.1 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU Lesser General Public License version 2.1 requirements
+** will be met: http://www.gnu.org/licenses/old-licenses/lgpl-2.1.html.
+**
+** In addition, as a special exception, Digia gives you certain additional
+** rights.  These rights are described in the Digia Qt LGPL Exception
+** version 1.1, included in the file LGPL_EXCEPTION.txt in this package.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3.0 as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL included in the
+** packaging of this file.  Please review the following information to
+** ensure the GNU General Public License version 3.0 requirements will be
+** met: http://www.gnu.org/copyleft/gpl.html.
+**
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <QByteArrayMatcher>
+#include <QMultiByteArrayMatcher>
+#include <QTest>
+
+// filters log lines against a list of keywords: which lines contain any of them?
+class tst_QMultiByteArrayMatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void byteArrayMatchers_data() { data(); }
+    void byteArrayMatchers();
+    void multiByteArrayMatcher_data() { data(); }
+    void multiByteArrayMatcher();
+    void multiByteArrayMatcherCaseInsensitive_data() { data(); }
+    void multiByteArrayMatcherCaseInsensitive();
+    void construction_data() { data(); }
+    void construction();
+
+private:
+    void data();
+};
+
+static QList<QByteArray> keywords(int count)
+{
+    QList<QByteArray> result;
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+        result << "session-" + QByteArray::number(i * 7919 % 1000003) + "-expired";
+    return result;
+}
+
+static QList<QByteArray> logLines()
+{
+    QList<QByteArray> result;
+    for (int i = 0; i < 1000; ++i) {
+        QByteArray line = "2013-12-01 12:00:" + QByteArray::number(i % 60)
+                + " [info] request from 10.0.0." + QByteArray::number(i % 256)
+                + " took " + QByteArray::number(i % 97) + "ms path=/index.html user=session-"
+                + QByteArray::number(i * 31) + "-active";
+        if (i % 100 == 0)
+            line += " session-" + QByteArray::number(i / 100 * 7919 % 1000003) + "-expired";
+        result << line;
+    }
+    return result;
+}
+
+void tst_QMultiByteArrayMatcher::data()
+{
+    QTest::addColumn<int>("keywordCount");
+
+    QTest::newRow("10 keywords") << 10;
+    QTest::newRow("100 keywords") << 100;
+    QTest::newRow("1000 keywords") << 1000;
+    QTest::newRow("5000 keywords") << 5000;
+}
+
+void tst_QMultiByteArrayMatcher::byteArrayMatchers()
+{
+    QFETCH(int, keywordCount);
+
+    const QList<QByteArray> patterns = keywords(keywordCount);
+    QVector<QByteArrayMatcher> matchers;
+    for (int i = 0; i < patterns.size(); ++i)
+        matchers.append(QByteArrayMatcher(patterns.at(i)));
+    const QList<QByteArray> lines = logLines();
+
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (int i = 0; i < lines.size(); ++i) {
+            for (int j = 0; j < matchers.size(); ++j) {
+                if (matchers.at(j).indexIn(lines.at(i)) != -1) {
+                    ++hits;
+                    break;
+                }
+            }
+        }
+    }
+    QCOMPARE(hits, qMin(10, keywordCount));
+}
+
+void tst_QMultiByteArrayMatcher::multiByteArrayMatcher()
+{
+    QFETCH(int, keywordCount);
+
+    const QMultiByteArrayMatcher matcher(keywords(keywordCount));
+    const QList<QByteArray> lines = logLines();
+
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (int i = 0; i < lines.size(); ++i) {
+            if (matcher.indexIn(lines.at(i)) != -1)
+                ++hits;
+        }
+    }
+    QCOMPARE(hits, qMin(10, keywordCount));
+}
+
+void tst_QMultiByteArrayMatcher::multiByteArrayMatcherCaseInsensitive()
+{
+    QFETCH(int, keywordCount);
+
+    const QMultiByteArrayMatcher matcher(keywords(keywordCount), Qt::CaseInsensitive);
+    const QList<QByteArray> lines = logLines();
+
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (int i = 0; i < lines.size(); ++i) {
+            if (matcher.indexIn(lines.at(i)) != -1)
+                ++hits;
+        }
+    }
+    QCOMPARE(hits, qMin(10, keywordCount));
+}
+
+void tst_QMultiByteArrayMatcher::construction()
+{
+    QFETCH(int, keywordCount);
+
+    const QList<QByteArray> patterns = keywords(keywordCount);
+    QBENCHMARK {
+        QMultiByteArrayMatcher matcher(patterns);
+        Q_UNUSED(matcher);
+    }
+}
+
+QTEST_MAIN(tst_QMultiByteArrayMatcher)
+
+#include "main.moc"
@@ -8,6 +8,7 @@ SUBDIRS = \
         qlist \
         qlocale \
         qmap \
+        qmultibytearraymatcher \
         qrect \
         qregexp \
         qstring \